@@ -472,7 +472,7 @@ bool late_init(EmuEnvState &state) {
     // the renderer is not using it yet, just storing it for later uses
     state.renderer->late_init(state.cfg, state.app_path, state.mem);
 
-    if (!init(state.mem, state.renderer->need_page_table)) {
+    if (!init(state.mem, state.renderer->need_page_table, state.cfg.huge_pages)) {
         LOG_ERROR("Failed to initialize memory for emulator state!");
         return false;
     }
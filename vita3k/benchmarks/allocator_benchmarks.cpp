@@ -0,0 +1,91 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <mem/allocator.h>
+#include <mem/util.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+// Throughput of the allocator on a fragmented heap the size of the guest address space in pages.
+class bitmap_allocator_benchmark : public ::testing::Test {
+protected:
+    static constexpr size_t PAGE_COUNT = GiB(4) / KiB(4);
+
+    BitmapAllocator allocator{ PAGE_COUNT };
+    std::mt19937 rng{ 1234 };
+
+    // fill the lower half with small blocks then free one out of two, leaving holes of 1 to 16 pages
+    void fragment() {
+        uint32_t offset = 0;
+        bool keep = true;
+        while (offset < PAGE_COUNT / 2) {
+            uint32_t size = rng() % 16 + 1;
+            ASSERT_EQ(allocator.allocate_at(offset, size), 0);
+            if (!keep)
+                allocator.free(offset, size);
+            keep = !keep;
+            offset += size;
+        }
+    }
+
+    void run(const char *name, uint32_t min_size, uint32_t max_size, bool best_fit) {
+        constexpr int ITERATIONS = 10000;
+        std::vector<std::pair<int, uint32_t>> blocks;
+        blocks.reserve(ITERATIONS);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITERATIONS; i++) {
+            uint32_t size = min_size + rng() % (max_size - min_size + 1);
+            const int offset = allocator.allocate_from(0, size, best_fit);
+            ASSERT_GE(offset, 0);
+            blocks.emplace_back(offset, size);
+            // keep the heap fragmented by giving back some blocks
+            if (i % 4 == 3) {
+                const size_t index = rng() % blocks.size();
+                allocator.free(blocks[index].first, blocks[index].second);
+                blocks[index] = blocks.back();
+                blocks.pop_back();
+            }
+        }
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        for (const auto &[offset, size] : blocks)
+            ASSERT_EQ(allocator.free_slot_count(offset, offset + size), 0);
+
+        std::cout << name << ": " << ITERATIONS << " allocations in " << elapsed << "us ("
+                  << (elapsed * 1000 / ITERATIONS) << "ns per allocation)" << std::endl;
+    }
+};
+
+TEST_F(bitmap_allocator_benchmark, first_fit_small) {
+    fragment();
+    run("first fit, 1-8 pages", 1, 8, false);
+}
+
+TEST_F(bitmap_allocator_benchmark, first_fit_larger_than_holes) {
+    fragment();
+    run("first fit, 17-64 pages", 17, 64, false);
+}
+
+TEST_F(bitmap_allocator_benchmark, best_fit_small) {
+    fragment();
+    run("best fit, 1-8 pages", 1, 8, true);
+}
@@ -0,0 +1,116 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <mem/functions.h>
+#include <mem/ptr.h>
+#include <mem/state.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// returns -1 if the counter is not available (no permission or virtualized PMU)
+static int open_dtlb_miss_counter() {
+    perf_event_attr attr{};
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+static uint64_t anon_huge_pages_kib() {
+    std::ifstream smaps("/proc/self/smaps_rollup");
+    std::string line;
+    while (std::getline(smaps, line)) {
+        if (line.starts_with("AnonHugePages:"))
+            return std::stoull(line.substr(line.find_first_of("0123456789")));
+    }
+    return 0;
+}
+#endif
+
+// Random reads over a large guest buffer, the access pattern of JIT code walking big guest
+// data structures, with and without huge pages.
+TEST(huge_pages, random_access) {
+    constexpr uint32_t buffer_size = MiB(512);
+    constexpr int access_count = 20'000'000;
+
+    for (const bool use_huge_pages : { false, true }) {
+        MemState mem;
+        ASSERT_TRUE(init(mem, false, use_huge_pages));
+        if (use_huge_pages && !mem.use_huge_pages)
+            GTEST_SKIP() << "huge pages are not available";
+
+        const Address base = alloc_aligned(mem, buffer_size, "benchmark", MiB(2));
+        ASSERT_NE(base, 0);
+        uint32_t *data = Ptr<uint32_t>(base).get(mem);
+        constexpr uint32_t word_count = buffer_size / sizeof(uint32_t);
+        for (uint32_t i = 0; i < word_count; i++)
+            data[i] = i * 2654435761U;
+
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<uint32_t> distribution(0, word_count - 1);
+        std::vector<uint32_t> indices(access_count);
+        for (uint32_t &index : indices)
+            index = distribution(rng);
+
+#ifdef __linux__
+        const int counter = open_dtlb_miss_counter();
+        if (counter != -1) {
+            ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+            ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+        const auto start = std::chrono::steady_clock::now();
+        uint32_t sum = 0;
+        for (const uint32_t index : indices)
+            sum += data[index];
+        const auto end = std::chrono::steady_clock::now();
+
+        std::string tlb_misses = "n/a";
+#ifdef __linux__
+        if (counter != -1) {
+            ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t misses = 0;
+            if (read(counter, &misses, sizeof(misses)) == sizeof(misses))
+                tlb_misses = std::to_string(misses);
+            close(counter);
+        }
+        const uint64_t huge_kib = anon_huge_pages_kib();
+#else
+        const uint64_t huge_kib = 0;
+#endif
+
+        const double ns = std::chrono::duration<double, std::nano>(end - start).count() / access_count;
+        std::cout << (use_huge_pages ? "huge pages: " : "4 KiB pages: ") << ns << " ns/access, "
+                  << tlb_misses << " dTLB misses, " << huge_kib / 1024 << " MiB in huge pages (checksum " << sum << ")" << std::endl;
+    }
+}
@@ -0,0 +1,101 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <mem/functions.h>
+#include <mem/ptr.h>
+#include <mem/state.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+class protect_benchmark : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(init(mem, false));
+    }
+
+    // one protected block per page, each one counting its callbacks
+    Address protect_pages(uint32_t page_count) {
+        const Address base = alloc(mem, page_count * KiB(4), "protect");
+        callback_counts = std::vector<std::atomic<int>>(page_count);
+        for (uint32_t i = 0; i < page_count; i++) {
+            add_protect(mem, base + i * KiB(4), KiB(4), MemPerm::ReadOnly, [this, base](Address addr, bool) {
+                callback_counts[(addr - base) / KiB(4)]++;
+                return true;
+            });
+        }
+        return base;
+    }
+
+    MemState mem;
+    std::vector<std::atomic<int>> callback_counts;
+};
+
+// Fault throughput with 4 threads writing to the same protected pages, like guest threads
+// updating textures and surfaces tracked by the renderer. With the same order, the threads
+// keep faulting on the same page at the same time.
+TEST_F(protect_benchmark, concurrent_faults) {
+    constexpr uint32_t page_count = 16384;
+    constexpr int thread_count = 4;
+    constexpr int iterations = 4;
+
+    for (const bool shuffled : { false, true }) {
+        double total_ms = 0;
+        for (int iteration = 0; iteration < iterations; iteration++) {
+            const Address base = protect_pages(page_count);
+            volatile uint32_t *data = Ptr<uint32_t>(base).get(mem);
+
+            std::vector<std::vector<uint32_t>> orders(thread_count, std::vector<uint32_t>(page_count));
+            for (int t = 0; t < thread_count; t++) {
+                std::iota(orders[t].begin(), orders[t].end(), 0);
+                if (shuffled)
+                    std::shuffle(orders[t].begin(), orders[t].end(), std::mt19937(t));
+            }
+
+            std::atomic<int> ready = 0;
+            std::vector<std::thread> threads;
+            const auto start = std::chrono::steady_clock::now();
+            for (int t = 0; t < thread_count; t++) {
+                threads.emplace_back([&, t] {
+                    ready++;
+                    while (ready < thread_count)
+                        std::this_thread::yield();
+                    for (const uint32_t page : orders[t])
+                        data[page * KiB(4) / sizeof(uint32_t) + t] = page;
+                });
+            }
+            for (auto &thread : threads)
+                thread.join();
+            total_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            for (uint32_t page = 0; page < page_count; page++)
+                ASSERT_EQ(callback_counts[page], 1);
+            free(mem, base);
+        }
+
+        std::cout << thread_count << " threads, " << (shuffled ? "shuffled" : "same") << " order: "
+                  << page_count * iterations / total_ms * 1000 << " protected pages written/s" << std::endl;
+    }
+}
@@ -0,0 +1,111 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <gtest/gtest.h>
+
+#include <renderer/texture_layout.h>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace renderer::texture;
+
+// per-pixel tiled conversion
+static uint32_t reference_tiled_offset(uint32_t x, uint32_t y, uint32_t width) {
+    const uint32_t width_in_tiles = (width + 31) >> 5;
+    return (((x >> 5) + width_in_tiles * (y >> 5)) << 10) | (x & 31) | ((y & 31) << 5);
+}
+
+template <typename F>
+static void reference_to_linear(uint8_t *dest, const uint8_t *src, uint32_t width, uint32_t height, uint32_t bytes_per_pixel, F offset) {
+    for (uint32_t y = 0; y < height; y++)
+        for (uint32_t x = 0; x < width; x++)
+            memcpy(dest + (y * width + x) * bytes_per_pixel, src + offset(x, y) * bytes_per_pixel, bytes_per_pixel);
+}
+
+static std::vector<uint8_t> make_pattern(size_t size) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; i++)
+        data[i] = static_cast<uint8_t>(i * 7 + (i >> 8));
+    return data;
+}
+
+// the per-pixel conversion the kernels replaced
+static uint32_t compact_one_by_one(uint32_t x) {
+    x &= 0x55555555;
+    x = (x ^ (x >> 1)) & 0x33333333;
+    x = (x ^ (x >> 2)) & 0x0f0f0f0f;
+    x = (x ^ (x >> 4)) & 0x00ff00ff;
+    x = (x ^ (x >> 8)) & 0x0000ffff;
+    return x;
+}
+
+static void previous_swizzled_to_linear(uint8_t *dest, const uint8_t *src, uint32_t width, uint32_t height, uint32_t bytes_per_pixel) {
+    const uint32_t min = std::min(width, height);
+    const uint32_t k = std::bit_width(min) - 1;
+    for (uint32_t i = 0; i < width * height; i++) {
+        uint32_t x = compact_one_by_one(i >> 1) & (min - 1);
+        uint32_t y = compact_one_by_one(i) & (min - 1);
+        const uint32_t upper_bits = (i >> (2 * k)) << k;
+        if (width >= height)
+            x |= upper_bits;
+        else
+            y |= upper_bits;
+        memcpy(dest + (y * width + x) * bytes_per_pixel, src + i * bytes_per_pixel, bytes_per_pixel);
+    }
+}
+
+// throughput of the kernels against the previous per-pixel conversion, in MiB of texture per second
+TEST(texture_layout, throughput) {
+    for (const uint32_t bpp : { 8, 16, 32, 64, 128 }) {
+        for (const uint32_t size : { 256, 512, 1024, 2048 }) {
+            const uint32_t bytes_per_pixel = bpp / 8;
+            const size_t bytes = static_cast<size_t>(size) * size * bytes_per_pixel;
+            const auto src = make_pattern(bytes);
+            std::vector<uint8_t> dest(bytes);
+            const int iterations = std::max<int>(1, (64 << 20) / bytes);
+
+            auto measure = [&](auto &&convert) {
+                const auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < iterations; i++)
+                    convert();
+                const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                return bytes * iterations / seconds / (1 << 20);
+            };
+
+            const double swizzled_reference = measure([&] { previous_swizzled_to_linear(dest.data(), src.data(), size, size, bytes_per_pixel); });
+            const double swizzled = measure([&] { swizzled_texture_to_linear_texture(dest.data(), src.data(), size, size, bpp); });
+            const double swizzled_back = measure([&] { linear_texture_to_swizzled_texture(dest.data(), src.data(), size, size, bpp); });
+            const double tiled_reference = measure([&] {
+                reference_to_linear(dest.data(), src.data(), size, size, bytes_per_pixel, [&](uint32_t x, uint32_t y) {
+                    return reference_tiled_offset(x, y, size);
+                });
+            });
+            const double tiled = measure([&] { tiled_texture_to_linear_texture(dest.data(), src.data(), size, size, bpp); });
+            const double tiled_back = measure([&] { linear_texture_to_tiled_texture(dest.data(), src.data(), size, size, bpp); });
+
+            std::cout << bpp << "bpp " << size << "x" << size << ": swizzled " << static_cast<int>(swizzled_reference) << " -> "
+                      << static_cast<int>(swizzled) << " MiB/s (reverse " << static_cast<int>(swizzled_back) << "), tiled "
+                      << static_cast<int>(tiled_reference) << " -> " << static_cast<int>(tiled) << " MiB/s (reverse "
+                      << static_cast<int>(tiled_back) << ")" << std::endl;
+        }
+    }
+}
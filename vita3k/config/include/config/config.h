@@ -80,6 +80,10 @@ enum ScreenshotFormat {
     code(bool, "v-sync", true, v_sync)                                                                  \
     code(int, "anisotropic-filtering", 1, anisotropic_filtering)                                        \
     code(bool, "texture-cache", true, texture_cache)                                                    \
+    code(int, "vram-budget", 0, vram_budget)                                                            \
+    code(bool, "disk-texture-cache", false, disk_texture_cache)                                         \
+    code(int, "disk-texture-cache-size", 2048, disk_texture_cache_size)                                 \
+    code(bool, "compute-texture-decode", false, compute_texture_decode)                                 \
     code(bool, "async-pipeline-compilation", true, async_pipeline_compilation)                          \
     code(bool, "show-compile-shaders", true, show_compile_shaders)                                      \
     code(bool, "hashless-texture-cache", false, hashless_texture_cache)                                 \
@@ -102,6 +106,12 @@ enum ScreenshotFormat {
     code(int, "log-level", 0 /*SPDLOG_LEVEL_TRACE*/, log_level)                                         \
     code(std::string, "cpu-backend", "Dynarmic", cpu_backend)                                           \
     code(bool, "cpu-opt", true, cpu_opt)                                                                \
+    code(bool, "jit-cache", false, jit_cache)                                                           \
+    code(bool, "perf-map", false, perf_map)                                                             \
+    code(int, "guest-profiler-interval", 0, guest_profiler_interval)                                    \
+    code(bool, "thread-scheduler", false, thread_scheduler)                                             \
+    code(bool, "lwmutex-fast-path", false, lwmutex_fast_path)                                           \
+    code(bool, "huge-pages", false, huge_pages)                                                         \
     code(std::string, "pref-path", std::string{}, pref_path)                                            \
     code(bool, "discord-rich-presence", true, discord_rich_presence)                                    \
     code(bool, "wait-for-debugger", false, wait_for_debugger)                                           \
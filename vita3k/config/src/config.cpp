@@ -74,6 +74,8 @@ static void check_members(Config &self, const Config &rhs) {
         self.run_app_path = rhs.run_app_path;
     if (rhs.recompile_shader_path.has_value())
         self.recompile_shader_path = rhs.recompile_shader_path;
+    if (rhs.pack_textures_path.has_value())
+        self.pack_textures_path = rhs.pack_textures_path;
     if (rhs.delete_title_id.has_value())
         self.delete_title_id = rhs.delete_title_id;
     if (rhs.pkg_path.has_value())
@@ -261,6 +263,8 @@ ExitCode init_config(Config &cfg, int argc, char **argv, const Root &root_paths)
         ->default_str({})->check(CLI::IsMember(get_file_set(cfg.get_pref_path() / "ux0/app")))->group("Input");
     input->add_option("--recompile-shader,-s", command_line.recompile_shader_path, "Recompile the given PS Vita shader (GXP format) to SPIR_V / GLSL and quit")
         ->default_str({})->group("Input");
+    input->add_option("--pack-textures", command_line.pack_textures_path, "Pack the replacement textures of the given folder (textures/import/<TITLE_ID>) into a single <folder>.vtp file and quit")
+        ->default_str({})->group("Input");
     input->add_option("--deleted-id,-d", command_line.delete_title_id, "Title ID of installed app to delete")
         ->default_str({})->check(CLI::IsMember(get_file_set(cfg.get_pref_path() / "ux0/app")))->group("Input");
     input->add_option("--firmware", command_line.pup_path, "Path to the firmware file (.pup extension) to install");
@@ -296,6 +300,8 @@ ExitCode init_config(Config &cfg, int argc, char **argv, const Root &root_paths)
         ->group("Logging");
     config->add_flag("--log-uniforms,-U", command_line.log_uniforms, "Log Uniforms")
         ->group("Logging");
+    config->add_option("--guest-profiler-interval", command_line.guest_profiler_interval, "Sample the guest code every given number of microseconds and write a flat profile and a call graph in the profiles folder of the logs when the app exits, 0 disables it.\nSamples are taken when the thread reaches the end of its current JIT block, so they are skewed towards the blocks which follow long ones.\nTime spent in HLE functions is counted as [HLE] instead of being given to the guest code.")
+        ->check(CLI::NonNegativeNumber)->group("Profiling");
     // clang-format on
 
     // Parse the inputs
@@ -321,6 +327,10 @@ ExitCode init_config(Config &cfg, int argc, char **argv, const Root &root_paths)
         cfg.recompile_shader_path = std::move(command_line.recompile_shader_path);
         return QuitRequested;
     }
+    if (command_line.pack_textures_path.has_value()) {
+        cfg.pack_textures_path = std::move(command_line.pack_textures_path);
+        return QuitRequested;
+    }
     if (command_line.delete_title_id.has_value()) {
         cfg.delete_title_id = std::move(command_line.delete_title_id);
         return QuitRequested;
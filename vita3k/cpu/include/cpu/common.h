@@ -31,6 +31,7 @@ struct CPUState;
 struct CPUContext;
 struct CPUInterface;
 struct ThreadState;
+class JitCache;
 
 typedef std::function<void(CPUState &cpu, uint32_t, Address)> CallSVC;
 
@@ -43,6 +44,7 @@ struct CPUProtocolBase {
     virtual void call_svc(CPUState &cpu, uint32_t svc, Address pc, ThreadState &thread) = 0;
     virtual Address get_watch_memory_addr(Address addr) = 0;
     virtual ExclusiveMonitorPtr get_exclusive_monitor() = 0;
+    virtual JitCache *get_jit_cache() = 0;
     virtual ~CPUProtocolBase() = default;
 };
 
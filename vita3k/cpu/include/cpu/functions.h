@@ -49,6 +49,10 @@ CPUContext save_context(CPUState &state);
 void load_context(CPUState &state, const CPUContext &ctx);
 std::size_t get_processor_id(CPUState &state);
 void invalidate_jit_cache(CPUState &state, Address start, size_t length);
+void prewarm_jit_cache(CPUState &state, Address entry);
+void request_halt(CPUState &state);
+void request_sample(CPUState &state);
+bool consume_sample(CPUState &state);
 
 uint32_t read_fpscr(CPUState &state);
 void write_fpscr(CPUState &state, uint32_t value);
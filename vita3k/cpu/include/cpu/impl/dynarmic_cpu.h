@@ -46,6 +46,8 @@ class DynarmicCPU : public CPUInterface {
     bool log_mem = false;
     bool log_code = false;
     bool cpu_opt;
+    // set while translating the blocks from the jit cache, nothing is executed then
+    bool prewarming = false;
 
     std::unique_ptr<Dynarmic::A32::Jit> make_jit();
 
@@ -94,4 +96,6 @@ public:
 
     std::size_t processor_id() const override;
     void invalidate_jit_cache(Address start, size_t length) override;
+    void prewarm_jit_cache(const std::vector<Address> &blocks) override;
+    void request_halt() override;
 };
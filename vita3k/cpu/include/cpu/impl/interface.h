@@ -20,6 +20,7 @@
 #include <cpu/common.h>
 
 #include <cstdint>
+#include <vector>
 
 /*! \brief Base class for all CPU backend implementation */
 struct CPUInterface {
@@ -55,6 +56,10 @@ struct CPUInterface {
     virtual CPUContext save_context() = 0;
     virtual void load_context(const CPUContext &ctx) = 0;
     virtual void invalidate_jit_cache(Address start, size_t length) = 0;
+    // translate the given blocks ahead of time, without executing them
+    virtual void prewarm_jit_cache(const std::vector<Address> &blocks) {}
+    // make run() return at the next block boundary, can be called from any thread
+    virtual void request_halt() {}
 
     virtual bool is_thumb_mode() = 0;
     virtual int step() = 0;
@@ -0,0 +1,87 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <mem/util.h>
+#include <util/fs.h>
+#include <util/hash.h>
+
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * \brief Persistent per-title record of the guest code translated by the JIT.
+ *
+ * Dynarmic cannot serialize the host code it emits, so what is persisted is the list of
+ * guest blocks each thread entry point ended up translating. On the next boot, a thread
+ * starting from the same entry point translates these blocks up-front instead of
+ * stalling on each of them the first time they are reached.
+ *
+ * Blocks are stored relative to their module segment and modules are identified by the
+ * hash of their content (patches included), so a changed or patched module does not reuse
+ * stale entries. The file itself is keyed by the JIT configuration.
+ */
+class JitCache {
+public:
+    JitCache() = default;
+    JitCache(const JitCache &) = delete;
+    JitCache &operator=(const JitCache &) = delete;
+
+    void init(const fs::path &cache_path, const std::string &title_id, bool cpu_opt, bool use_page_table);
+    bool is_enabled() const {
+        return enabled;
+    }
+
+    void register_module(const Sha256Hash &hash, const std::string &name, const std::vector<std::pair<Address, uint32_t>> &segments);
+    void unregister_module(Address first_segment);
+
+    // entry and pc have their lowest bit set when in thumb mode
+    void record(Address entry, Address pc);
+    std::vector<Address> get_blocks(Address entry);
+    void invalidate(Address start, size_t length);
+
+    void save();
+
+private:
+    struct LoadedModule {
+        uint16_t index;
+        std::vector<std::pair<Address, uint32_t>> segments;
+    };
+
+    std::optional<uint64_t> to_key(Address address) const;
+    std::optional<Address> from_key(uint64_t key) const;
+    void load();
+
+    std::mutex mutex;
+    bool enabled = false;
+    bool dirty = false;
+    fs::path path;
+
+    // modules ever seen for this title, their position in this list is their index in the keys
+    std::vector<Sha256Hash> known_modules;
+    std::vector<std::string> known_module_names;
+    std::map<Sha256Hash, uint16_t> module_index;
+    std::vector<LoadedModule> loaded_modules;
+
+    // thread entry key -> keys of the blocks translated from it
+    std::map<uint64_t, std::set<uint64_t>> profiles;
+};
@@ -23,12 +23,19 @@
 #include <mem/state.h>
 #include <util/types.h>
 
+#include <atomic>
+
 struct CPUState {
     CPUState() = default;
 
     SceUID thread_id = 0;
     MemState *mem = nullptr;
     CPUProtocolBase *protocol = nullptr;
+    JitCache *jit_cache = nullptr;
+    // entry point of the guest function the blocks translated by the JIT are attributed to
+    Address jit_cache_entry = 0;
+    // set by the guest profiler, the pc is recorded the next time the cpu stops
+    std::atomic<bool> sample_requested = false;
     DisasmState disasm;
 
     Block halt_instruction;
@@ -20,6 +20,7 @@
 #include <cpu/impl/dynarmic_cpu.h>
 #include <cpu/impl/interface.h>
 #include <cpu/impl/unicorn_cpu.h>
+#include <cpu/jit_cache.h>
 #include <cpu/state.h>
 #include <mem/ptr.h>
 #include <util/types.h>
@@ -43,6 +44,7 @@ CPUStatePtr init_cpu(CPUBackend backend, bool cpu_opt, SceUID thread_id, std::si
     CPUStatePtr state(new CPUState(), delete_cpu_state);
     state->mem = &mem;
     state->protocol = protocol;
+    state->jit_cache = backend == CPUBackend::Dynarmic ? protocol->get_jit_cache() : nullptr;
     state->thread_id = thread_id;
 
     // TODO: we can move this to kernel after we drop unicorn
@@ -186,6 +188,29 @@ void invalidate_jit_cache(CPUState &state, Address start, size_t length) {
     state.cpu->invalidate_jit_cache(start, length);
 }
 
+void prewarm_jit_cache(CPUState &state, Address entry) {
+    state.jit_cache_entry = entry;
+    if (!state.jit_cache)
+        return;
+
+    const std::vector<Address> blocks = state.jit_cache->get_blocks(entry);
+    if (!blocks.empty())
+        state.cpu->prewarm_jit_cache(blocks);
+}
+
+void request_halt(CPUState &state) {
+    state.cpu->request_halt();
+}
+
+void request_sample(CPUState &state) {
+    state.sample_requested = true;
+    state.cpu->request_halt();
+}
+
+bool consume_sample(CPUState &state) {
+    return state.sample_requested.exchange(false);
+}
+
 std::string disassemble(CPUState &state, uint64_t at, bool thumb, uint16_t *insn_size) {
     MemState &mem = *state.mem;
     const uint8_t *const code = Ptr<const uint8_t>(static_cast<Address>(at)).get(mem);
@@ -17,6 +17,7 @@
 
 #include "cpu/common.h"
 #include <cpu/impl/dynarmic_cpu.h>
+#include <cpu/jit_cache.h>
 #include <cpu/state.h>
 #include <util/bit_cast.h>
 #include <util/log.h>
@@ -24,6 +25,7 @@
 #include <mem/ptr.h>
 
 #include <dynarmic/frontend/A32/a32_ir_emitter.h>
+#include <dynarmic/frontend/A32/a32_location_descriptor.h>
 #include <dynarmic/interface/A32/coprocessor.h>
 #include <dynarmic/interface/exclusive_monitor.h>
 
@@ -125,6 +127,12 @@ public:
         if (cpu->log_code) {
             ir.CallHostFunction(&TraceInstruction, ir.Imm64((uint64_t)this), ir.Imm64(pc), ir.Imm64(is_thumb));
         }
+
+        if (parent->jit_cache && !cpu->prewarming) {
+            // the block being translated starts at the location dynarmic looked it up with
+            if (pc == Dynarmic::A32::LocationDescriptor{ ir.block.Location() }.PC())
+                parent->jit_cache->record(parent->jit_cache_entry, pc | static_cast<Address>(is_thumb));
+        }
     }
 
     template <typename T>
@@ -484,6 +492,30 @@ void DynarmicCPU::invalidate_jit_cache(Address start, size_t length) {
     jit->InvalidateCacheRange(start, length);
 }
 
+void DynarmicCPU::prewarm_jit_cache(const std::vector<Address> &blocks) {
+    // Run() always looks up (and translates if needed) the block at pc before checking
+    // for a pending halt, so halting beforehand translates the block without running it
+    constexpr auto prewarm_halt = Dynarmic::HaltReason::UserDefined7;
+
+    const CPUContext ctx = save_context();
+    prewarming = true;
+    for (const Address block : blocks) {
+        set_pc(block);
+        jit->HaltExecution(prewarm_halt);
+        jit->Run();
+        jit->ClearHalt(prewarm_halt);
+    }
+    prewarming = false;
+    load_context(ctx);
+
+    LOG_DEBUG("Pre-translated {} blocks for thread {}", blocks.size(), parent->thread_id);
+}
+
+void DynarmicCPU::request_halt() {
+    // the halt reason is cleared when Run() returns, so nothing else needs to be done
+    jit->HaltExecution(Dynarmic::HaltReason::UserDefined6);
+}
+
 // TODO: proper abstraction
 ExclusiveMonitorPtr new_exclusive_monitor(int max_num_cores) {
     return new Dynarmic::ExclusiveMonitor(max_num_cores);
@@ -0,0 +1,264 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <cpu/jit_cache.h>
+
+#include <util/log.h>
+
+// magic number put at the beginning of the jit cache file
+constexpr uint32_t jit_cache_magic = 0x4A495443;
+// increase this if the file layout changes
+constexpr uint32_t jit_cache_version = 1;
+
+// a key is made of the module index (16 bits), the segment index (8 bits)
+// and the offset in the segment (32 bits, the lowest bit being the thumb bit)
+static uint64_t make_key(uint16_t module, uint8_t segment, uint32_t offset) {
+    return (static_cast<uint64_t>(module) << 40) | (static_cast<uint64_t>(segment) << 32) | offset;
+}
+
+void JitCache::init(const fs::path &cache_path, const std::string &title_id, bool cpu_opt, bool use_page_table) {
+    const std::lock_guard<std::mutex> guard(mutex);
+    known_modules.clear();
+    known_module_names.clear();
+    module_index.clear();
+    loaded_modules.clear();
+    profiles.clear();
+    dirty = false;
+
+    const fs::path folder = cache_path / "jit" / title_id;
+    fs::create_directories(folder);
+    path = folder / fmt::format("jit-cache-{}{}.dat", cpu_opt ? "opt" : "noopt", use_page_table ? "-pt" : "");
+    enabled = true;
+
+    load();
+}
+
+void JitCache::load() {
+    fs::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return;
+
+    auto read_integer = [&]<typename T>(T &val) {
+        file.read(reinterpret_cast<char *>(&val), sizeof(T));
+    };
+
+    uint32_t magic_number = 0;
+    uint32_t version = 0;
+    read_integer(magic_number);
+    read_integer(version);
+    if (magic_number != jit_cache_magic || version != jit_cache_version) {
+        LOG_WARN("JIT cache {} is outdated or corrupted, ignoring it.", path);
+        return;
+    }
+
+    uint32_t nb_modules = 0;
+    read_integer(nb_modules);
+    for (uint32_t i = 0; i < nb_modules && file.good(); i++) {
+        Sha256Hash hash;
+        file.read(reinterpret_cast<char *>(hash.data()), hash.size());
+        uint32_t name_size = 0;
+        read_integer(name_size);
+        std::string name(name_size, '\0');
+        file.read(name.data(), name_size);
+
+        module_index[hash] = static_cast<uint16_t>(known_modules.size());
+        known_modules.push_back(hash);
+        known_module_names.push_back(std::move(name));
+    }
+
+    uint32_t nb_profiles = 0;
+    read_integer(nb_profiles);
+    size_t nb_blocks_total = 0;
+    for (uint32_t i = 0; i < nb_profiles && file.good(); i++) {
+        uint64_t entry;
+        uint32_t nb_blocks = 0;
+        read_integer(entry);
+        read_integer(nb_blocks);
+
+        auto &blocks = profiles[entry];
+        for (uint32_t j = 0; j < nb_blocks && file.good(); j++) {
+            uint64_t block;
+            read_integer(block);
+            blocks.insert(block);
+        }
+        nb_blocks_total += nb_blocks;
+    }
+
+    if (!file.good()) {
+        LOG_WARN("JIT cache {} is corrupted, ignoring it.", path);
+        known_modules.clear();
+        known_module_names.clear();
+        module_index.clear();
+        profiles.clear();
+        return;
+    }
+
+    LOG_INFO("JIT cache loaded: {} modules, {} thread entries, {} blocks", known_modules.size(), profiles.size(), nb_blocks_total);
+}
+
+void JitCache::save() {
+    const std::lock_guard<std::mutex> guard(mutex);
+    if (!enabled || !dirty)
+        return;
+
+    fs::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        LOG_ERROR("Failed to open JIT cache {} for writing", path);
+        return;
+    }
+
+    auto write_integer = [&]<typename T>(T val) {
+        file.write(reinterpret_cast<const char *>(&val), sizeof(T));
+    };
+
+    write_integer(jit_cache_magic);
+    write_integer(jit_cache_version);
+
+    write_integer(static_cast<uint32_t>(known_modules.size()));
+    for (size_t i = 0; i < known_modules.size(); i++) {
+        file.write(reinterpret_cast<const char *>(known_modules[i].data()), known_modules[i].size());
+        write_integer(static_cast<uint32_t>(known_module_names[i].size()));
+        file.write(known_module_names[i].data(), known_module_names[i].size());
+    }
+
+    write_integer(static_cast<uint32_t>(profiles.size()));
+    for (const auto &[entry, blocks] : profiles) {
+        write_integer(entry);
+        write_integer(static_cast<uint32_t>(blocks.size()));
+        for (const uint64_t block : blocks)
+            write_integer(block);
+    }
+
+    dirty = false;
+    LOG_INFO("JIT cache saved");
+}
+
+void JitCache::register_module(const Sha256Hash &hash, const std::string &name, const std::vector<std::pair<Address, uint32_t>> &segments) {
+    const std::lock_guard<std::mutex> guard(mutex);
+    if (!enabled)
+        return;
+
+    auto it = module_index.find(hash);
+    if (it == module_index.end()) {
+        if (known_modules.size() > UINT16_MAX) {
+            LOG_WARN("Too many modules in the JIT cache, {} will not be cached", name);
+            return;
+        }
+        it = module_index.emplace(hash, static_cast<uint16_t>(known_modules.size())).first;
+        known_modules.push_back(hash);
+        known_module_names.push_back(name);
+        dirty = true;
+    }
+
+    loaded_modules.push_back({ it->second, segments });
+}
+
+void JitCache::unregister_module(Address first_segment) {
+    const std::lock_guard<std::mutex> guard(mutex);
+    std::erase_if(loaded_modules, [&](const LoadedModule &module) {
+        return !module.segments.empty() && module.segments.front().first == first_segment;
+    });
+}
+
+std::optional<uint64_t> JitCache::to_key(Address address) const {
+    const Address aligned = address & ~1;
+    for (const auto &module : loaded_modules) {
+        for (size_t seg = 0; seg < module.segments.size(); seg++) {
+            const auto [base, size] = module.segments[seg];
+            if (base <= aligned && aligned < base + size)
+                return make_key(module.index, static_cast<uint8_t>(seg), address - base);
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::optional<Address> JitCache::from_key(uint64_t key) const {
+    const uint16_t index = static_cast<uint16_t>(key >> 40);
+    const uint8_t seg = static_cast<uint8_t>(key >> 32);
+    const uint32_t offset = static_cast<uint32_t>(key);
+    for (const auto &module : loaded_modules) {
+        if (module.index != index || seg >= module.segments.size())
+            continue;
+
+        const auto [base, size] = module.segments[seg];
+        if ((offset & ~1) >= size)
+            return std::nullopt;
+        return base + offset;
+    }
+
+    return std::nullopt;
+}
+
+void JitCache::record(Address entry, Address pc) {
+    const std::lock_guard<std::mutex> guard(mutex);
+    if (!enabled)
+        return;
+
+    const auto entry_key = to_key(entry);
+    const auto block_key = to_key(pc);
+    if (!entry_key || !block_key)
+        return;
+
+    if (profiles[*entry_key].insert(*block_key).second)
+        dirty = true;
+}
+
+std::vector<Address> JitCache::get_blocks(Address entry) {
+    const std::lock_guard<std::mutex> guard(mutex);
+    std::vector<Address> blocks;
+    if (!enabled)
+        return blocks;
+
+    const auto entry_key = to_key(entry);
+    if (!entry_key)
+        return blocks;
+
+    const auto it = profiles.find(*entry_key);
+    if (it == profiles.end())
+        return blocks;
+
+    blocks.reserve(it->second.size());
+    for (const uint64_t block : it->second) {
+        // blocks from modules which are not loaded (yet) are skipped
+        if (const auto address = from_key(block))
+            blocks.push_back(*address);
+    }
+
+    return blocks;
+}
+
+void JitCache::invalidate(Address start, size_t length) {
+    const std::lock_guard<std::mutex> guard(mutex);
+    if (!enabled || profiles.empty())
+        return;
+
+    const auto first = to_key(start);
+    if (!first)
+        return;
+
+    // ranges given to invalidate never cross a segment boundary
+    const uint64_t last = *first + length;
+    for (auto &[_, blocks] : profiles) {
+        const auto begin = blocks.lower_bound(*first & ~1ULL);
+        const auto end = blocks.lower_bound(last);
+        if (begin != end) {
+            blocks.erase(begin, end);
+            dirty = true;
+        }
+    }
+}
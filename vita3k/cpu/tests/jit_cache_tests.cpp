@@ -0,0 +1,146 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <gtest/gtest.h>
+
+#include <cpu/jit_cache.h>
+
+#include <vector>
+
+class jit_cache : public ::testing::Test {
+protected:
+    fs::path folder;
+
+    void SetUp() override {
+        folder = fs::temp_directory_path() / fs::unique_path("vita3k-jit-cache-%%%%-%%%%");
+    }
+
+    void TearDown() override {
+        fs::remove_all(folder);
+    }
+
+    fs::path file_path() const {
+        return folder / "jit" / "PCSA00000" / "jit-cache-opt.dat";
+    }
+
+    // a cache of a thread started at 0x81000100 of a module with two segments, saved to the disk
+    void save_cache() {
+        JitCache cache;
+        cache.init(folder, "PCSA00000", true, false);
+        cache.register_module(make_hash(1), "eboot.bin", { { 0x81000000, 0x10000 }, { 0x82000000, 0x1000 } });
+        cache.record(0x81000101, 0x81000101);
+        cache.record(0x81000101, 0x81000200);
+        cache.record(0x81000101, 0x82000010);
+        cache.save();
+    }
+
+    static Sha256Hash make_hash(uint8_t value) {
+        Sha256Hash hash{};
+        hash.fill(value);
+        return hash;
+    }
+};
+
+TEST_F(jit_cache, save_and_load) {
+    save_cache();
+    ASSERT_TRUE(fs::exists(file_path()));
+
+    // the blocks follow the module when it is loaded somewhere else
+    JitCache cache;
+    cache.init(folder, "PCSA00000", true, false);
+    cache.register_module(make_hash(1), "eboot.bin", { { 0x83000000, 0x10000 }, { 0x84000000, 0x1000 } });
+    ASSERT_EQ(cache.get_blocks(0x83000101), (std::vector<Address>{ 0x83000101, 0x83000200, 0x84000010 }));
+    ASSERT_TRUE(cache.get_blocks(0x83000201).empty());
+}
+
+TEST_F(jit_cache, changed_module_is_not_reused) {
+    save_cache();
+
+    JitCache cache;
+    cache.init(folder, "PCSA00000", true, false);
+    cache.register_module(make_hash(2), "eboot.bin", { { 0x81000000, 0x10000 }, { 0x82000000, 0x1000 } });
+    ASSERT_TRUE(cache.get_blocks(0x81000101).empty());
+}
+
+TEST_F(jit_cache, other_config_uses_other_file) {
+    save_cache();
+
+    JitCache cache;
+    cache.init(folder, "PCSA00000", false, false);
+    cache.register_module(make_hash(1), "eboot.bin", { { 0x81000000, 0x10000 }, { 0x82000000, 0x1000 } });
+    ASSERT_TRUE(cache.get_blocks(0x81000101).empty());
+}
+
+TEST_F(jit_cache, invalidated_blocks_are_dropped) {
+    save_cache();
+    {
+        JitCache cache;
+        cache.init(folder, "PCSA00000", true, false);
+        cache.register_module(make_hash(1), "eboot.bin", { { 0x81000000, 0x10000 }, { 0x82000000, 0x1000 } });
+        cache.invalidate(0x81000180, 0x100);
+        ASSERT_EQ(cache.get_blocks(0x81000101), (std::vector<Address>{ 0x81000101, 0x82000010 }));
+        cache.save();
+    }
+
+    JitCache cache;
+    cache.init(folder, "PCSA00000", true, false);
+    cache.register_module(make_hash(1), "eboot.bin", { { 0x81000000, 0x10000 }, { 0x82000000, 0x1000 } });
+    ASSERT_EQ(cache.get_blocks(0x81000101), (std::vector<Address>{ 0x81000101, 0x82000010 }));
+}
+
+TEST_F(jit_cache, unloaded_module_blocks_are_skipped) {
+    JitCache cache;
+    cache.init(folder, "PCSA00000", true, false);
+    cache.register_module(make_hash(1), "eboot.bin", { { 0x81000000, 0x10000 } });
+    cache.register_module(make_hash(2), "libfoo.suprx", { { 0x85000000, 0x1000 } });
+    cache.record(0x81000000, 0x85000100);
+    cache.unregister_module(0x85000000);
+    ASSERT_TRUE(cache.get_blocks(0x81000000).empty());
+}
+
+TEST_F(jit_cache, bad_files_are_ignored) {
+    save_cache();
+    std::vector<char> content(fs::file_size(file_path()));
+    {
+        fs::ifstream file(file_path(), std::ios::binary);
+        file.read(content.data(), content.size());
+    }
+
+    const auto check_rejected = [&](const std::vector<char> &data) {
+        {
+            fs::ofstream file(file_path(), std::ios::binary | std::ios::trunc);
+            file.write(data.data(), data.size());
+        }
+        JitCache cache;
+        cache.init(folder, "PCSA00000", true, false);
+        cache.register_module(make_hash(1), "eboot.bin", { { 0x81000000, 0x10000 }, { 0x82000000, 0x1000 } });
+        return cache.get_blocks(0x81000101).empty();
+    };
+
+    std::vector<char> bad_magic = content;
+    bad_magic[0] ^= 0xFF;
+    ASSERT_TRUE(check_rejected(bad_magic));
+
+    std::vector<char> bad_version = content;
+    bad_version[4]++;
+    ASSERT_TRUE(check_rejected(bad_version));
+
+    const std::vector<char> truncated(content.begin(), content.end() - 4);
+    ASSERT_TRUE(check_rejected(truncated));
+
+    ASSERT_FALSE(check_rejected(content));
+}
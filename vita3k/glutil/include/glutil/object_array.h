@@ -48,6 +48,7 @@ public:
     bool init(renderer::Generator *generator, renderer::Deleter *deleter) {
         assert(generator != nullptr);
         assert(deleter != nullptr);
+        this->generator = generator;
         this->deleter = deleter;
         generator(static_cast<GLsizei>(names.size()), &names[0]);
 
@@ -64,9 +65,17 @@ public:
         return names.size();
     }
 
+    // replace an object with a new one, freeing everything the previous one held
+    void recreate(size_t i) {
+        assert(i < names.size());
+        deleter(1, &names[i]);
+        generator(1, &names[i]);
+    }
+
 private:
     typedef std::array<GLuint, Size> Names;
 
     Names names;
+    renderer::Generator *generator = nullptr;
     renderer::Deleter *deleter = nullptr;
 };
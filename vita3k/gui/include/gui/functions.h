@@ -125,7 +125,7 @@ void draw_ime(Ime &ime, EmuEnvState &emuenv);
 void draw_info_message(GuiState &gui, EmuEnvState &emuenv);
 void draw_initial_setup(GuiState &gui, EmuEnvState &emuenv);
 void draw_reinstall_dialog(GenericDialogState *status, GuiState &gui, EmuEnvState &emuenv);
-void draw_pre_compiling_shaders_progress(GuiState &gui, EmuEnvState &emuenv, const uint32_t &total);
+void draw_pre_compiling_shaders_progress(GuiState &gui, EmuEnvState &emuenv, const uint32_t &count, const uint32_t &total, const bool pipelines = false);
 void draw_shaders_count_compiled(GuiState &gui, EmuEnvState &emuenv);
 void draw_trophies_unlocked(GuiState &gui, EmuEnvState &emuenv);
 void draw_touchpad_cursor(EmuEnvState &emuenv);
@@ -26,7 +26,7 @@ namespace gui {
 static std::vector<std::string> points = { ".", "..", "..." };
 static int pos = 2;
 static auto time = std::time(nullptr);
-void draw_pre_compiling_shaders_progress(GuiState &gui, EmuEnvState &emuenv, const uint32_t &total) {
+void draw_pre_compiling_shaders_progress(GuiState &gui, EmuEnvState &emuenv, const uint32_t &count, const uint32_t &total, const bool pipelines) {
     const auto display_size = ImGui::GetIO().DisplaySize;
     const auto RES_SCALE = ImVec2(emuenv.gui_scale.x, emuenv.gui_scale.y);
     const auto SCALE = ImVec2(RES_SCALE.x * emuenv.manual_dpi_scale, RES_SCALE.y * emuenv.manual_dpi_scale);
@@ -55,17 +55,17 @@ void draw_pre_compiling_shaders_progress(GuiState &gui, EmuEnvState &emuenv, con
     ImGui::SetCursorPos(ImVec2((176.f * SCALE.x), (52.f * SCALE.y)));
     ImGui::TextColored(GUI_COLOR_TEXT, "%s", emuenv.current_app_title.c_str());
     ImGui::SetCursorPos(ImVec2((176.f * SCALE.x), ImGui::GetCursorPosY() + (30.f * SCALE.y)));
-    ImGui::TextColored(GUI_COLOR_TEXT, "%s%s", gui.lang.compile_shaders["compiling_shaders"].c_str(), points[pos].c_str());
+    ImGui::TextColored(GUI_COLOR_TEXT, "%s%s", gui.lang.compile_shaders[pipelines ? "compiling_pipelines" : "compiling_shaders"].c_str(), points[pos].c_str());
     const float PROGRESS_BAR_WIDTH = 508.f * SCALE.x;
     ImGui::SetCursorPos(ImVec2((ImGui::GetWindowWidth() / 2) - (PROGRESS_BAR_WIDTH / 2.f), ImGui::GetCursorPosY() + 30.f * emuenv.manual_dpi_scale));
     ImGui::PushStyleColor(ImGuiCol_PlotHistogram, GUI_PROGRESS_BAR);
     ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 12.f);
-    const auto progress_programs = (emuenv.renderer->programs_count_pre_compiled * 100) / total;
+    const auto progress_programs = (count * 100) / total;
     ImGui::ProgressBar(progress_programs / 100.f, ImVec2(PROGRESS_BAR_WIDTH, 15.f * emuenv.manual_dpi_scale), "");
     ImGui::PopStyleColor();
     ImGui::PopStyleVar();
     ImGui::SetCursorPosY(ImGui::GetCursorPosY() + (6.f * emuenv.manual_dpi_scale));
-    TextColoredCentered(GUI_COLOR_TEXT, fmt::format("{}/{}", emuenv.renderer->programs_count_pre_compiled, total).c_str());
+    TextColoredCentered(GUI_COLOR_TEXT, fmt::format("{}/{}", count, total).c_str());
     ImGui::End();
     ImGui::PopStyleVar();
     ImGui::PopFont();
@@ -25,9 +25,7 @@ void draw_condvars_dialog(GuiState &gui, EmuEnvState &emuenv) {
     ImGui::Begin("Condition Variables", &gui.debug_menu.condvars_dialog);
     ImGui::TextColored(GUI_COLOR_TEXT_TITLE, "%-16s %-32s   %-16s %-16s", "ID", "Name", "Attributes", "Waiting Threads");
 
-    const std::lock_guard<std::mutex> lock(emuenv.kernel.mutex);
-
-    for (const auto &[id, sema_state] : emuenv.kernel.condvars) {
+    for (const auto &[id, sema_state] : emuenv.kernel.condvars.snapshot()) {
         ImGui::TextColored(GUI_COLOR_TEXT, "0x%08X       %-32s   %02d             %02zu",
             id,
             sema_state->name,
@@ -41,9 +39,7 @@ void draw_lw_condvars_dialog(GuiState &gui, EmuEnvState &emuenv) {
     ImGui::Begin("Lightweight Condition Variables", &gui.debug_menu.lwcondvars_dialog);
     ImGui::TextColored(GUI_COLOR_TEXT_TITLE, "%-16s %-32s   %-16s %-16s", "ID", "Name", "Attributes", "Waiting Threads");
 
-    const std::lock_guard<std::mutex> lock(emuenv.kernel.mutex);
-
-    for (const auto &[id, sema_state] : emuenv.kernel.lwcondvars) {
+    for (const auto &[id, sema_state] : emuenv.kernel.lwcondvars.snapshot()) {
         ImGui::TextColored(GUI_COLOR_TEXT, "0x%08X       %-32s   %02d             %02zu",
             id,
             sema_state->name,
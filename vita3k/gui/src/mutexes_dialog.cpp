@@ -28,9 +28,7 @@ void draw_mutexes_dialog(GuiState &gui, EmuEnvState &emuenv) {
     ImGui::Begin("Mutexes", &gui.debug_menu.mutexes_dialog);
     ImGui::TextColored(GUI_COLOR_TEXT_TITLE, "%-16s %-32s   %-7s   %-8s   %-16s   %-16s", "ID", "Mutex Name", "Status", "Attributes", "Waiting Threads", "Owner");
 
-    const std::lock_guard<std::mutex> lock(emuenv.kernel.mutex);
-
-    for (const auto &[id, mutex_state] : emuenv.kernel.mutexes) {
+    for (const auto &[id, mutex_state] : emuenv.kernel.mutexes.snapshot()) {
         ImGui::TextColored(GUI_COLOR_TEXT, "0x%08X       %-32s   %02d        %01d            %02zu                 %s",
             id,
             mutex_state->name,
@@ -46,9 +44,7 @@ void draw_lw_mutexes_dialog(GuiState &gui, EmuEnvState &emuenv) {
     ImGui::Begin("Lightweight Mutexes", &gui.debug_menu.lwmutexes_dialog);
     ImGui::TextColored(GUI_COLOR_TEXT_TITLE, "%-16s %-32s   %-7s   %-8s  %-16s   %-16s", "ID", "LwMutex Name", "Status", "Attributes", "Waiting Threads", "Owner");
 
-    const std::lock_guard<std::mutex> lock(emuenv.kernel.mutex);
-
-    for (const auto &[id, mutex_state] : emuenv.kernel.lwmutexes) {
+    for (const auto &[id, mutex_state] : emuenv.kernel.lwmutexes.snapshot()) {
         ImGui::TextColored(GUI_COLOR_TEXT, "0x%08X       %-32s   %02d        %01d           %02zu                 %s",
             id,
             mutex_state->name,
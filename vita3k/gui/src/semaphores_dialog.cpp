@@ -25,9 +25,7 @@ void draw_semaphores_dialog(GuiState &gui, EmuEnvState &emuenv) {
     ImGui::Begin("Semaphores", &gui.debug_menu.semaphores_dialog);
     ImGui::TextColored(GUI_COLOR_TEXT_TITLE, "%-16s %-32s   %-16s   %-16s", "ID", "Semaphore Name", "Status", "Locked Threads");
 
-    const std::lock_guard<std::mutex> lock(emuenv.kernel.mutex);
-
-    for (const auto &[id, sema_state] : emuenv.kernel.semaphores) {
+    for (const auto &[id, sema_state] : emuenv.kernel.semaphores.snapshot()) {
         ImGui::TextColored(GUI_COLOR_TEXT, "0x%08X       %-32s   %02d/%02d              %02zu",
             id,
             sema_state->name,
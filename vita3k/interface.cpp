@@ -47,7 +47,9 @@
 
 #include <gui/imgui_impl_sdl.h>
 
+#include <algorithm>
 #include <regex>
+#include <thread>
 
 #include <SDL.h>
 #include <fmt/chrono.h>
@@ -392,6 +394,25 @@ static ExitCode load_app_impl(SceUID &main_module_id, EmuEnvState &emuenv) {
         LOG_WARN("Failed to init kernel!");
         return KernelInitFailed;
     }
+    if (emuenv.cfg.jit_cache && (emuenv.kernel.cpu_backend == CPUBackend::Dynarmic))
+        emuenv.kernel.jit_cache.init(emuenv.cache_path, emuenv.io.title_id, emuenv.kernel.cpu_opt, emuenv.mem.use_page_table);
+    if (emuenv.cfg.thread_scheduler) {
+        // the Vita has 4 cores, and there is no point in having more than the host can run at once
+        // each guest thread still runs on its own host thread, so this limits how many of them run
+        // guest code at once but does not reduce host context switches
+        const uint32_t core_count = std::clamp(std::thread::hardware_concurrency(), 1U, 4U);
+        emuenv.kernel.scheduler = std::make_unique<ThreadScheduler>(core_count);
+        LOG_INFO("Guest threads are scheduled on {} cores, each keeping its own host thread", core_count);
+    }
+    if (emuenv.kernel.cpu_backend == CPUBackend::Dynarmic) {
+        // must be set before any module is loaded, as it changes the import stubs
+        emuenv.kernel.lwmutex_fast_path.enabled = emuenv.cfg.lwmutex_fast_path;
+        if (emuenv.cfg.perf_map)
+            enable_perf_map(emuenv.cache_path / "jit");
+        // in microseconds, 0 disables the profiler
+        if (emuenv.cfg.guest_profiler_interval > 0)
+            emuenv.kernel.profiler.start(emuenv.kernel, emuenv.cfg.guest_profiler_interval);
+    }
 
     if (emuenv.cfg.archive_log) {
         const fs::path log_directory{ emuenv.log_path / "logs" };
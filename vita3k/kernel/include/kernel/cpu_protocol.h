@@ -18,11 +18,54 @@
 #pragma once
 
 #include <cpu/common.h>
+#include <util/containers.h>
 
+#include <optional>
+#include <vector>
+
+struct EmuEnvState;
 struct MemState;
 struct KernelState;
 typedef int SceUID;
 typedef std::function<void(CPUState &cpu, uint32_t nid, SceUID thread_id)> CallImportFunc;
+typedef void (*HleImportFunc)(EmuEnvState &emuenv, CPUState &cpu, SceUID thread_id);
+
+// svc immediates with this bit set call the HLE import whose index is given by the lower bits
+constexpr uint32_t HLE_IMPORT_SVC_FLAG = 0x800000;
+
+/**
+ * \brief Dense table of the HLE imports.
+ *
+ * Import stubs are resolved once at load time to an index in this table, encoded in their svc
+ * immediate, so calling an import does not require reading and looking up its NID.
+ */
+struct HleImportTable {
+    EmuEnvState *emuenv = nullptr;
+    std::vector<HleImportFunc> functions;
+    std::vector<uint32_t> nids;
+    unordered_map_fast<uint32_t, uint32_t> index_by_nid;
+
+    void add(uint32_t nid, HleImportFunc function) {
+        index_by_nid.emplace(nid, static_cast<uint32_t>(functions.size()));
+        functions.push_back(function);
+        nids.push_back(nid);
+    }
+
+    // the svc immediate comes from guest code, so it may not be one of our stubs
+    std::optional<uint32_t> index_from_svc(uint32_t svc) const {
+        const uint32_t index = svc & ~HLE_IMPORT_SVC_FLAG;
+        if (index >= functions.size())
+            return std::nullopt;
+        return index;
+    }
+
+    std::optional<uint32_t> find(uint32_t nid) const {
+        const auto it = index_by_nid.find(nid);
+        if (it == index_by_nid.end())
+            return std::nullopt;
+        return it->second;
+    }
+};
 
 struct CPUProtocol : public CPUProtocolBase {
     CPUProtocol(KernelState &kernel, MemState &mem, const CallImportFunc &func);
@@ -30,6 +73,7 @@ struct CPUProtocol : public CPUProtocolBase {
     void call_svc(CPUState &cpu, uint32_t svc, Address pc, ThreadState &thread) override;
     Address get_watch_memory_addr(Address addr) override;
     ExclusiveMonitorPtr get_exclusive_monitor() override;
+    JitCache *get_jit_cache() override;
 
 private:
     CallImportFunc call_import;
@@ -0,0 +1,228 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#pragma once
+
+#include <kernel/types.h>
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// identifies the table a uid belongs to, so a uid is never valid in two tables
+enum class HandleTag : uint32_t {
+    thread = 1,
+    simple_event,
+    timer,
+    semaphore,
+    mutex,
+    lwmutex,
+    rwlock,
+    eventflag,
+    condvar,
+    lwcondvar,
+    msgpipe,
+};
+
+/**
+ * \brief Table of kernel objects indexed directly by their uid.
+ *
+ * A uid is made of a marker bit, the table tag, a generation and a slot index. Finding an
+ * object is a direct array access, and a uid stays invalid once its object has been erased,
+ * even after the slot got reused. Freed slots are reused in FIFO order to make a generation
+ * wrap around take as long as possible.
+ *
+ * Lookups are not lock-free, but they do not take the table mutex: each slot has its own spin
+ * lock, held only while its shared_ptr is copied, so lookups only wait for a lookup or an
+ * erase of the same object. Reserving, emplacing and erasing take the table mutex.
+ */
+template <typename T>
+class HandleTable {
+public:
+    typedef std::shared_ptr<T> ObjectPtr;
+
+    explicit HandleTable(HandleTag tag)
+        : uid_prefix(UID_MARKER | (static_cast<uint32_t>(tag) << TAG_SHIFT)) {
+    }
+
+    HandleTable(const HandleTable &) = delete;
+    HandleTable &operator=(const HandleTable &) = delete;
+
+    ~HandleTable() {
+        for (auto &page : pages)
+            delete page.load();
+    }
+
+    // allocate a uid, lookups return nullptr for it until an object is emplaced
+    SceUID reserve() {
+        const std::lock_guard<std::mutex> guard(mutex);
+        uint32_t index;
+        if (!free_slots.empty()) {
+            index = free_slots.front();
+            free_slots.pop_front();
+        } else if (slot_count < MAX_SLOTS) {
+            index = slot_count++;
+            if ((index % PAGE_SIZE) == 0)
+                pages[index / PAGE_SIZE].store(new Page(), std::memory_order_release);
+        } else {
+            return SCE_KERNEL_ERROR_UID_MAX_OPEN;
+        }
+
+        return make_uid(slot(index).generation, index);
+    }
+
+    void emplace(SceUID uid, ObjectPtr object) {
+        const std::lock_guard<std::mutex> guard(mutex);
+        Slot *const entry = find_slot(uid);
+        if (!entry || entry->generation != generation_of(uid))
+            return;
+
+        SlotLock lock(*entry);
+        entry->object = std::move(object);
+        entry->uid.store(uid, std::memory_order_release);
+        count++;
+    }
+
+    ObjectPtr get(SceUID uid) const {
+        Slot *const entry = find_slot(uid);
+        if (!entry || entry->uid.load(std::memory_order_acquire) != uid)
+            return nullptr;
+
+        SlotLock lock(*entry);
+        if (entry->uid.load(std::memory_order_relaxed) != uid)
+            return nullptr;
+        return entry->object;
+    }
+
+    // also releases a uid which was reserved but never emplaced
+    bool erase(SceUID uid) {
+        ObjectPtr object;
+        const std::lock_guard<std::mutex> guard(mutex);
+        Slot *const entry = find_slot(uid);
+        if (!entry || entry->generation != generation_of(uid))
+            return false;
+
+        {
+            SlotLock lock(*entry);
+            if (entry->uid.load(std::memory_order_relaxed) == uid) {
+                count--;
+                object = std::move(entry->object);
+            }
+            entry->uid.store(0, std::memory_order_release);
+        }
+        entry->generation = (entry->generation + 1) & GENERATION_MASK;
+        free_slots.push_back(uid & SLOT_MASK);
+
+        return object != nullptr;
+    }
+
+    size_t size() const {
+        const std::lock_guard<std::mutex> guard(mutex);
+        return count;
+    }
+
+    // return the uid of the first object matching pred, or 0
+    template <typename Pred>
+    SceUID find_if(Pred pred) const {
+        const std::lock_guard<std::mutex> guard(mutex);
+        for (uint32_t index = 0; index < slot_count; index++) {
+            const Slot &entry = slot(index);
+            const SceUID uid = entry.uid.load(std::memory_order_relaxed);
+            if (uid && pred(entry.object))
+                return uid;
+        }
+        return 0;
+    }
+
+    // copy of the content of the table, ordered by slot
+    std::vector<std::pair<SceUID, ObjectPtr>> snapshot() const {
+        const std::lock_guard<std::mutex> guard(mutex);
+        std::vector<std::pair<SceUID, ObjectPtr>> objects;
+        objects.reserve(count);
+        for (uint32_t index = 0; index < slot_count; index++) {
+            const Slot &entry = slot(index);
+            if (const SceUID uid = entry.uid.load(std::memory_order_relaxed))
+                objects.emplace_back(uid, entry.object);
+        }
+        return objects;
+    }
+
+private:
+    static constexpr uint32_t UID_MARKER = 1U << 30;
+    static constexpr uint32_t TAG_SHIFT = 26;
+    static constexpr uint32_t GENERATION_SHIFT = 16;
+    static constexpr uint32_t GENERATION_MASK = (1U << (TAG_SHIFT - GENERATION_SHIFT)) - 1;
+    static constexpr uint32_t SLOT_MASK = (1U << GENERATION_SHIFT) - 1;
+    static constexpr uint32_t MAX_SLOTS = SLOT_MASK + 1;
+    static constexpr uint32_t PAGE_SIZE = 1024;
+
+    struct Slot {
+        // uid of the object in the slot, 0 if there is none
+        std::atomic<SceUID> uid = 0;
+        std::atomic_flag busy = ATOMIC_FLAG_INIT;
+        // only modified with the table mutex held
+        uint32_t generation = 0;
+        ObjectPtr object;
+    };
+
+    struct SlotLock {
+        explicit SlotLock(Slot &slot)
+            : slot(slot) {
+            while (slot.busy.test_and_set(std::memory_order_acquire)) {
+            }
+        }
+        ~SlotLock() {
+            slot.busy.clear(std::memory_order_release);
+        }
+
+        Slot &slot;
+    };
+
+    typedef std::array<Slot, PAGE_SIZE> Page;
+
+    SceUID make_uid(uint32_t generation, uint32_t index) const {
+        return static_cast<SceUID>(uid_prefix | (generation << GENERATION_SHIFT) | index);
+    }
+
+    static uint32_t generation_of(SceUID uid) {
+        return (static_cast<uint32_t>(uid) >> GENERATION_SHIFT) & GENERATION_MASK;
+    }
+
+    Slot &slot(uint32_t index) const {
+        return (*pages[index / PAGE_SIZE].load(std::memory_order_acquire))[index % PAGE_SIZE];
+    }
+
+    Slot *find_slot(SceUID uid) const {
+        if ((static_cast<uint32_t>(uid) & ~((1U << TAG_SHIFT) - 1)) != uid_prefix)
+            return nullptr;
+
+        const uint32_t index = uid & SLOT_MASK;
+        Page *const page = pages[index / PAGE_SIZE].load(std::memory_order_acquire);
+        return page ? &(*page)[index % PAGE_SIZE] : nullptr;
+    }
+
+    const uint32_t uid_prefix;
+
+    mutable std::mutex mutex;
+    std::array<std::atomic<Page *>, MAX_SLOTS / PAGE_SIZE> pages{};
+    uint32_t slot_count = 0;
+    size_t count = 0;
+    std::deque<uint32_t> free_slots;
+};
@@ -0,0 +1,56 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <mem/block.h>
+#include <mem/util.h>
+
+#include <map>
+
+struct HleImportTable;
+struct MemState;
+
+/**
+ * \brief Guest code locking and unlocking lightweight mutexes without leaving the JIT.
+ *
+ * The HLE import stubs of the lwmutex lock, trylock and unlock functions jump to guest
+ * trampolines which update the owner word of the work area with LDREX/STREX when the mutex
+ * is free (or owned by the caller without waiters, for the unlock). Anything else, recursion
+ * and contention included, falls back to the HLE implementation through its svc.
+ *
+ * The trampolines are only used with Dynarmic, whose exclusive accesses are atomic on the
+ * host and can thus be mixed with the atomics of the HLE side. When the bypass word is set,
+ * while import calls are watched, every call goes through the svc so that it is logged.
+ */
+struct LwMutexFastPath {
+    bool enabled = false;
+
+    // the members below must be accessed by first locking KernelState::export_nids_mutex
+    Block code;
+    uint32_t code_used = 0;
+    // nid -> trampoline address
+    std::map<uint32_t, Address> trampolines;
+    // first word of code, read by the trampolines
+    uint32_t *bypass_word = nullptr;
+    bool bypass = false;
+
+    // returns the address of the trampoline to use for this import, 0 if it has none
+    Address get_trampoline(MemState &mem, const HleImportTable &imports, uint32_t nid);
+    // make the trampolines always call the HLE implementation
+    void set_bypass(bool value);
+};
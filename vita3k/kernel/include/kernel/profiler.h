@@ -0,0 +1,77 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#pragma once
+
+#include <mem/util.h>
+#include <util/fs.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+struct KernelState;
+
+/**
+ * \brief Statistical profiler of the guest code.
+ *
+ * A sampling thread periodically asks every running guest thread to leave the JIT. The
+ * thread then records its pc and lr before resuming, so samples are taken at block
+ * boundaries where the guest registers are up to date. The time spent in a long block is
+ * therefore given to the block after it.
+ * Threads running a HLE function have the run status too, these samples are counted apart
+ * as [HLE] instead of being given to the guest code which called the function.
+ * The pc gives a flat profile and the (lr, pc) pairs a one level call graph, both
+ * symbolized with the loaded modules and their exports when the profile is written.
+ */
+class GuestProfiler {
+public:
+    GuestProfiler() = default;
+    GuestProfiler(const GuestProfiler &) = delete;
+    GuestProfiler &operator=(const GuestProfiler &) = delete;
+    ~GuestProfiler();
+
+    void start(KernelState &kernel, uint32_t interval_us);
+    void stop();
+    bool is_running() const {
+        return sampler.joinable();
+    }
+
+    void record(Address pc, Address lr);
+    void record_hle();
+    // write <title_id>-flat.txt and <title_id>-callgraph.folded (flamegraph.pl format) in folder
+    void save(KernelState &kernel, const fs::path &folder, const std::string &title_id);
+
+private:
+    std::thread sampler;
+    std::mutex sampler_mutex;
+    std::condition_variable sampler_cond;
+    bool stop_requested = false;
+
+    std::mutex mutex;
+    uint64_t total_samples = 0;
+    uint64_t hle_samples = 0;
+    std::map<Address, uint64_t> pc_samples;
+    std::map<std::pair<Address, Address>, uint64_t> call_samples;
+};
+
+// Dynarmic writes the host code range of each block in a perf map when PERF_BUILDID_DIR is set,
+// these functions redirect it to jit_folder and rewrite it with the guest symbols as /tmp/perf-<pid>.map
+void enable_perf_map(const fs::path &jit_folder);
+void save_perf_map(KernelState &kernel, const fs::path &jit_folder);
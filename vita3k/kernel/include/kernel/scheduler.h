@@ -0,0 +1,82 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+struct ThreadState;
+
+/**
+ * \brief Multiplexes the guest threads on a fixed number of emulated cores.
+ *
+ * Each guest thread keeps its own host thread, as HLE calls block on the host stack, but it
+ * must own a core to run guest code. This bounds the number of host threads competing for the
+ * host cpu no matter how many guest threads a title creates, but it does not reduce the number of
+ * host threads nor the host context switches: handing a core over still switches host threads.
+ *
+ * Cores are given by guest priority among the threads allowed on them by their affinity mask.
+ * They are handed over directly: a thread releasing its core gives it to the best thread waiting
+ * for it, and a thread woken up by an unlock or a signal takes a free core right away.
+ * A running thread is preempted when a thread with a higher priority waits for its core, or at
+ * the end of its time slice when a thread with the same priority is waiting.
+ */
+class ThreadScheduler {
+public:
+    explicit ThreadScheduler(uint32_t core_count);
+
+    uint32_t core_count() const {
+        return static_cast<uint32_t>(cores.size());
+    }
+
+    // called by the thread itself before running guest code, blocks until it owns a core
+    void acquire(ThreadState &thread);
+    // called by the thread itself when it stops running guest code (waiting, dormant, suspended or preempted)
+    void release(ThreadState &thread);
+    // called from any thread when the thread stops being runnable, the core is released right away
+    // when called by the thread itself, otherwise the next time the thread leaves the cpu
+    void unschedule(ThreadState &thread);
+    // called from any thread when the thread becomes runnable again
+    void wake(ThreadState &thread);
+    // checked by the thread each time it leaves the cpu
+    bool should_yield(ThreadState &thread);
+
+private:
+    struct Core {
+        ThreadState *owner = nullptr;
+        std::chrono::steady_clock::time_point since;
+    };
+
+    struct Waiter {
+        ThreadState *thread;
+        uint64_t ticket;
+        std::condition_variable cond;
+    };
+
+    bool can_run_on(const ThreadState &thread, uint32_t core) const;
+    void assign(ThreadState &thread, uint32_t core);
+    Waiter *best_waiter(uint32_t core) const;
+    void preempt_for(const ThreadState &thread, bool time_slice_over);
+
+    std::mutex mutex;
+    std::vector<Core> cores;
+    std::vector<Waiter *> waiters;
+    uint64_t next_ticket = 0;
+};
@@ -17,11 +17,16 @@
 
 #pragma once
 
+#include <cpu/jit_cache.h>
 #include <kernel/callback.h>
 #include <kernel/cpu_protocol.h>
 #include <kernel/debugger.h>
+#include <kernel/lwmutex_fast_path.h>
 #include <kernel/object_store.h>
+#include <kernel/profiler.h>
+#include <kernel/scheduler.h>
 #include <kernel/sync_primitives.h>
+#include <kernel/timer_wheel.h>
 #include <kernel/types.h>
 #include <mem/allocator.h>
 #include <mem/ptr.h>
@@ -105,19 +110,21 @@ struct KernelState {
     Ptr<const void> thread_event_end = Ptr<const void>(0);
     Address thread_event_end_arg = 0;
 
-    SimpleEventPtrs simple_events;
-    TimerPtrs timers;
-    SemaphorePtrs semaphores;
-    CondvarPtrs condvars;
-    CondvarPtrs lwcondvars;
-    MutexPtrs mutexes;
-    MutexPtrs lwmutexes; // also Mutexes for now
-    RWLockPtrs rwlocks;
-    EventFlagPtrs eventflags;
-    MsgPipePtrs msgpipes;
+    SimpleEventPtrs simple_events{ HandleTag::simple_event };
+    TimerPtrs timers{ HandleTag::timer };
+    SemaphorePtrs semaphores{ HandleTag::semaphore };
+    CondvarPtrs condvars{ HandleTag::condvar };
+    CondvarPtrs lwcondvars{ HandleTag::lwcondvar };
+    MutexPtrs mutexes{ HandleTag::mutex };
+    MutexPtrs lwmutexes{ HandleTag::lwmutex }; // also Mutexes for now
+    RWLockPtrs rwlocks{ HandleTag::rwlock };
+    EventFlagPtrs eventflags{ HandleTag::eventflag };
+    MsgPipePtrs msgpipes{ HandleTag::msgpipe };
     CallbackPtrs callbacks;
 
+    // threads must be accessed by first locking mutex, thread_handles is used for lookups by uid
     ThreadStatePtrs threads;
+    HandleTable<ThreadState> thread_handles{ HandleTag::thread };
 
     SceKernelModuleInfoPtrs loaded_modules;
     LoadedSysmodules loaded_sysmodules;
@@ -135,6 +142,14 @@ struct KernelState {
     CorenumAllocator corenum_allocator;
     CPUProtocolPtr cpu_protocol;
     ExclusiveMonitorPtr exclusive_monitor;
+    HleImportTable hle_imports;
+    LwMutexFastPath lwmutex_fast_path;
+    JitCache jit_cache;
+    GuestProfiler profiler;
+    // only set when guest threads are multiplexed on a fixed number of cores
+    std::unique_ptr<ThreadScheduler> scheduler;
+    // wakes up the threads waiting with a timeout or delayed
+    TimerWheel timer_wheel;
 
     ObjectStore obj_store;
 
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <kernel/handle_table.h>
 #include <kernel/thread/thread_data_queue.h>
 #include <kernel/types.h>
 #include <util/byte_ring_buffer.h>
@@ -94,7 +95,7 @@ struct SimpleEvent : SyncPrimitive {
 };
 
 typedef std::shared_ptr<SimpleEvent> SimpleEventPtr;
-typedef std::map<SceUID, SimpleEventPtr> SimpleEventPtrs;
+typedef HandleTable<SimpleEvent> SimpleEventPtrs;
 
 struct Timer : SyncPrimitive {
     WaitingThreadQueuePtr waiting_threads;
@@ -110,7 +111,7 @@ struct Timer : SyncPrimitive {
 };
 
 typedef std::shared_ptr<Timer> TimerPtr;
-typedef std::map<SceUID, TimerPtr> TimerPtrs;
+typedef HandleTable<Timer> TimerPtrs;
 
 struct Semaphore : SyncPrimitive {
     WaitingThreadQueuePtr waiting_threads;
@@ -120,10 +121,18 @@ struct Semaphore : SyncPrimitive {
 };
 
 typedef std::shared_ptr<Semaphore> SemaphorePtr;
-typedef std::map<SceUID, SemaphorePtr> SemaphorePtrs;
+typedef HandleTable<Semaphore> SemaphorePtrs;
+
+// Set in the owner word of a lightweight mutex work area when threads are waiting on it.
+// The owner word is shared with the guest fast path: it is 0 when the mutex is free and the
+// id of the owner thread otherwise, so the owner can only unlock it without going through the
+// kernel as long as this bit is clear.
+constexpr uint32_t LW_MUTEX_WAITERS = 0x80000000;
 
 struct Mutex : SyncPrimitive {
     int init_count;
+    // for lightweight mutexes, the work area is authoritative and these are only kept up to
+    // date when the kernel is involved
     int lock_count;
     ThreadStatePtr owner;
     WaitingThreadQueuePtr waiting_threads;
@@ -131,7 +140,7 @@ struct Mutex : SyncPrimitive {
 };
 
 typedef std::shared_ptr<Mutex> MutexPtr;
-typedef std::map<SceUID, MutexPtr> MutexPtrs;
+typedef HandleTable<Mutex> MutexPtrs;
 
 enum class RWLockState {
     Unlocked,
@@ -149,7 +158,7 @@ struct RWLock : SyncPrimitive {
 };
 
 typedef std::shared_ptr<RWLock> RWLockPtr;
-typedef std::map<SceUID, RWLockPtr> RWLockPtrs;
+typedef HandleTable<RWLock> RWLockPtrs;
 
 struct EventFlag : SyncPrimitive {
     WaitingThreadQueuePtr waiting_threads;
@@ -157,7 +166,7 @@ struct EventFlag : SyncPrimitive {
 };
 
 typedef std::shared_ptr<EventFlag> EventFlagPtr;
-typedef std::map<SceUID, EventFlagPtr> EventFlagPtrs;
+typedef HandleTable<EventFlag> EventFlagPtrs;
 
 struct Condvar : SyncPrimitive {
     struct SignalTarget {
@@ -181,7 +190,7 @@ struct Condvar : SyncPrimitive {
     MutexPtr associated_mutex;
 };
 typedef std::shared_ptr<Condvar> CondvarPtr;
-typedef std::map<SceUID, CondvarPtr> CondvarPtrs;
+typedef HandleTable<Condvar> CondvarPtrs;
 
 struct MsgPipe : SyncPrimitive {
     MsgPipe(std::size_t bufSize)
@@ -196,7 +205,7 @@ struct MsgPipe : SyncPrimitive {
 };
 
 typedef std::shared_ptr<MsgPipe> MsgPipePtr;
-typedef std::map<SceUID, MsgPipePtr> MsgPipePtrs;
+typedef HandleTable<MsgPipe> MsgPipePtrs;
 
 enum class SyncWeight {
     Light, // lightweight
@@ -224,7 +233,7 @@ SceUID mutex_create(SceUID *uid_out, KernelState &kernel, MemState &mem, const c
 SceUID mutex_find(KernelState &kernel, const char *export_name, const char *pName);
 int mutex_lock(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, SceUID mutexid, int lock_count, unsigned int *timeout, SyncWeight weight);
 int mutex_try_lock(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, SceUID mutexid, int lock_count, SyncWeight weight);
-int mutex_unlock(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID mutexid, int unlock_count, SyncWeight weight);
+int mutex_unlock(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, SceUID mutexid, int unlock_count, SyncWeight weight);
 int mutex_delete(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID mutexid, SyncWeight weight);
 MutexPtr mutex_get(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID mutexid, SyncWeight weight);
 
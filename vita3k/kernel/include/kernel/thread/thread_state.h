@@ -23,10 +23,12 @@
 #include <mem/block.h>
 #include <mem/ptr.h>
 
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
 
 struct CPUContext;
 
@@ -93,6 +95,20 @@ struct ThreadState {
     std::vector<std::shared_ptr<ThreadState>> waiting_threads;
     uint32_t returned_value = 0;
 
+    // core owned in the thread scheduler, only accessed with the scheduler lock held
+    static constexpr int NO_CORE = -1;
+    static constexpr int BORROWED_CORE = -2;
+    int scheduler_core = NO_CORE;
+    // set by the scheduler when the thread must give its core to another one
+    std::atomic<bool> yield_requested = false;
+    // set by the scheduler when another host thread takes the thread out of the run status, the
+    // core can only be released by the host thread running the guest thread once it leaves the cpu
+    std::atomic<bool> release_requested = false;
+    // host thread running run_loop for this guest thread
+    std::atomic<std::thread::id> host_thread;
+    // set while the thread runs the HLE function of a svc, which the profiler must not count as guest code
+    std::atomic<bool> in_hle_call = false;
+
     ThreadState() = delete;
     explicit ThreadState(SceUID id, KernelState &kernel, MemState &mem);
 
@@ -137,6 +153,8 @@ private:
 
     // when calling sceKernelStartThread
     bool run_start_callback = false;
+    // translate the blocks recorded in the jit cache for the entry point before running it
+    bool prewarm_jit_cache_pending = false;
     // when calling sceKernelExitThread or sceKernelExitDeleteThread
     bool run_end_callback = false;
 
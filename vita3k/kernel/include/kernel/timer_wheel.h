@@ -0,0 +1,146 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \brief Hierarchical timer wheel owning the guest timeouts, timers and delays.
+ *
+ * Instead of each waiting host thread relying on its own timed wait, a single service thread
+ * keeps every deadline in a 4 level wheel of 64 slots (32us, 2ms, 131ms and 8.4s per slot)
+ * and calls the expiry callback of each timer. Scheduling and cancelling are O(1), and the
+ * service thread only wakes up for the earliest deadline or to cascade a slot.
+ *
+ * The service thread sleeps until shortly before the deadline and spins for the rest, as the
+ * sleep of the host OS is not precise enough for audio and frame pacing threads.
+ */
+class TimerWheel {
+public:
+    typedef uint64_t TimerId;
+    // returns false to be called again on the next tick, for example when a lock it needs is busy
+    typedef std::function<bool()> Callback;
+    typedef uint64_t (*Clock)();
+
+    // with a clock given there is no service thread, the timers only expire when poll is called
+    explicit TimerWheel(Clock clock = nullptr);
+    TimerWheel(const TimerWheel &) = delete;
+    TimerWheel &operator=(const TimerWheel &) = delete;
+    ~TimerWheel();
+
+    // current time in microseconds, the time base of the deadlines
+    uint64_t now() const;
+
+    // the callback is called from the service thread and must not block
+    TimerId schedule(uint64_t deadline_us, Callback callback);
+    // returns false if the timer already expired, in which case its callback has returned
+    bool cancel(TimerId id);
+    // expire the timers which are due and call their callbacks on the calling thread
+    void poll();
+    void stop();
+
+    /**
+     * \brief Same as std::condition_variable::wait_for, with the timeout handled by the wheel.
+     *
+     * lock must be held on the mutex cond is waited with. The timer only tries to lock it to
+     * wake the waiting thread up, and tries again on the next tick if it is busy, so a contended
+     * mutex only delays this wait and not the other timers.
+     */
+    template <typename Predicate>
+    bool wait_for(std::condition_variable &cond, std::unique_lock<std::mutex> &lock, uint64_t timeout_us, Predicate pred) {
+        if (pred())
+            return true;
+
+        bool timed_out = false;
+        std::mutex &mutex = *lock.mutex();
+        const uint64_t current = now();
+        const uint64_t deadline = timeout_us < UINT64_MAX - current ? current + timeout_us : UINT64_MAX;
+        const TimerId id = schedule(deadline, [&] {
+            const std::unique_lock<std::mutex> guard(mutex, std::try_to_lock);
+            if (!guard.owns_lock())
+                return false;
+
+            timed_out = true;
+            cond.notify_all();
+            return true;
+        });
+
+        cond.wait(lock, [&] { return timed_out || pred(); });
+        if (!timed_out)
+            // the callback never waits for the mutex, it can be cancelled with the lock held
+            cancel(id);
+
+        return pred();
+    }
+
+private:
+    static constexpr uint32_t LEVEL_COUNT = 4;
+    static constexpr uint32_t SLOT_BITS = 6;
+    static constexpr uint32_t SLOT_COUNT = 1 << SLOT_BITS;
+
+    struct Entry {
+        TimerId id;
+        uint64_t deadline;
+        Callback callback;
+        // slot index in the wheel, LEVEL_COUNT * SLOT_COUNT for the overflow list
+        uint32_t slot;
+    };
+    typedef std::list<Entry> EntryList;
+
+    void add(Entry entry);
+    void insert(EntryList &from, EntryList::iterator entry);
+    void cascade(uint32_t level);
+    void expire_slot(uint32_t slot, uint64_t now_us);
+    void advance(uint64_t now_us);
+    uint64_t next_wakeup() const;
+    void run_expired(std::unique_lock<std::mutex> &lock);
+    void run();
+
+    Clock clock;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::condition_variable callback_done;
+    std::thread thread;
+    bool stop_requested = false;
+
+    // slots of every level, then the timers too far away for the wheel
+    std::array<EntryList, LEVEL_COUNT * SLOT_COUNT + 1> slots;
+    std::array<uint64_t, LEVEL_COUNT> occupied = {};
+    std::unordered_map<TimerId, EntryList::iterator> entries;
+    // expired timers whose callback has not been called yet
+    std::deque<Entry> expired;
+    TimerId next_id = 1;
+    // every tick before this one has expired
+    uint64_t current_tick = 0;
+    // deadline the service thread is currently waiting for
+    uint64_t planned_wakeup = UINT64_MAX;
+    // incremented when a timer earlier than planned_wakeup is scheduled, ends the spin
+    std::atomic<uint32_t> wakeup_changed = 0;
+    TimerId running = 0;
+};
@@ -548,6 +548,9 @@ enum SceSysmoduleInternalModuleId : uint32_t {
     SCE_SYSMODULE_INTERNAL_LOCATION_FACTORY = 0x80000029 //!< Location Factory module
 };
 
+// Size of the system part of the thread local storage, the user TLS (tpidruro) starts right after it
+constexpr size_t KERNEL_TLS_SIZE = 0x800;
+
 // Indexes in thread local storage (TLS) for system data. It is used mostly by libkernel.
 enum TlsItems {
     TLS_PROCESS_ID = 0,
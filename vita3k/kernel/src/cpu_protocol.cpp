@@ -19,6 +19,7 @@
 
 #include <cpu/functions.h>
 #include <kernel/state.h>
+#include <util/log.h>
 
 CPUProtocol::CPUProtocol(KernelState &kernel, MemState &mem, const CallImportFunc &func)
     : call_import(func)
@@ -49,6 +50,25 @@ void CPUProtocol::call_svc(CPUState &cpu, uint32_t svc, Address pc, ThreadState
         return;
     }
 
+    // Import resolved at load time, call it directly
+    if (svc & HLE_IMPORT_SVC_FLAG) {
+        const HleImportTable &imports = kernel->hle_imports;
+        const auto index = imports.index_from_svc(svc);
+        if (index) {
+            if (kernel->debugger.watch_import_calls)
+                // call_import takes care of logging the call
+                call_import(cpu, imports.nids[*index], thread.id);
+            else
+                imports.functions[*index](*imports.emuenv, cpu, thread.id);
+
+            clear_exclusive(kernel->exclusive_monitor, get_processor_id(cpu));
+            return;
+        }
+
+        // not written by us, handle it like the stub of an unresolved import
+        LOG_ERROR("Invalid HLE import index {} in svc at {}", log_hex(svc & ~HLE_IMPORT_SVC_FLAG), log_hex(pc));
+    }
+
     // This is usual service call
     uint32_t nid = *Ptr<uint32_t>(pc + 4).get(*mem);
     // TODO: just supply ThreadStatePtr to call_import
@@ -66,3 +86,7 @@ Address CPUProtocol::get_watch_memory_addr(Address addr) {
 ExclusiveMonitorPtr CPUProtocol::get_exclusive_monitor() {
     return kernel->exclusive_monitor;
 }
+
+JitCache *CPUProtocol::get_jit_cache() {
+    return kernel->jit_cache.is_enabled() ? &kernel->jit_cache : nullptr;
+}
@@ -145,4 +145,8 @@ Address Debugger::get_watch_memory_addr(Address addr) {
 
 void Debugger::update_watches() {
     parent.set_memory_watch(watch_memory);
+
+    // the lwmutex fast path does not go through call_import, which logs the calls
+    const std::lock_guard<std::mutex> guard(parent.export_nids_mutex);
+    parent.lwmutex_fast_path.set_bypass(watch_import_calls);
 }
@@ -25,7 +25,6 @@
 
 #include <cpu/functions.h>
 #include <mem/ptr.h>
-#include <util/lock_and_find.h>
 #include <util/log.h>
 
 #include <SDL_thread.h>
@@ -73,6 +72,7 @@ static int SDLCALL thread_function(void *data) {
 
     std::lock_guard<std::mutex> lock(params.kernel->mutex);
     params.kernel->threads.erase(thread->id);
+    params.kernel->thread_handles.erase(thread->id);
     params.kernel->corenum_allocator.free_corenum(get_processor_id(*thread->cpu));
 
     return r0;
@@ -123,6 +123,8 @@ void KernelState::set_memory_watch(bool enabled) {
 }
 
 void KernelState::invalidate_jit_cache(Address start, size_t length) {
+    jit_cache.invalidate(start, length);
+
     std::lock_guard<std::mutex> lock(mutex);
     for (const auto &[_, thread] : threads) {
         ::invalidate_jit_cache(*thread->cpu, start, length);
@@ -130,7 +132,7 @@ void KernelState::invalidate_jit_cache(Address start, size_t length) {
 }
 
 ThreadStatePtr KernelState::get_thread(SceUID thread_id) {
-    return lock_and_find(thread_id, threads, mutex);
+    return thread_handles.get(thread_id);
 }
 
 ThreadStatePtr KernelState::create_thread(MemState &mem, const char *name, Ptr<const void> entry_point) {
@@ -138,11 +140,17 @@ ThreadStatePtr KernelState::create_thread(MemState &mem, const char *name, Ptr<c
 }
 
 ThreadStatePtr KernelState::create_thread(MemState &mem, const char *name, Ptr<const void> entry_point, int init_priority, SceInt32 affinity_mask, int stack_size, const SceKernelThreadOptParam *option) {
-    ThreadStatePtr thread = std::make_shared<ThreadState>(get_next_uid(), *this, mem);
-    if (thread->init(name, entry_point, init_priority, affinity_mask, stack_size, option) < 0)
+    const SceUID uid = thread_handles.reserve();
+    if (uid < 0)
+        return nullptr;
+    ThreadStatePtr thread = std::make_shared<ThreadState>(uid, *this, mem);
+    if (thread->init(name, entry_point, init_priority, affinity_mask, stack_size, option) < 0) {
+        thread_handles.erase(uid);
         return nullptr;
+    }
     const auto lock = std::lock_guard(mutex);
     threads.emplace(thread->id, thread);
+    thread_handles.emplace(thread->id, thread);
 
     ThreadParams params;
     params.kernel = this;
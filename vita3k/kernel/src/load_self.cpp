@@ -24,6 +24,7 @@
 #include <nids/functions.h>
 #include <util/arm.h>
 #include <util/fs.h>
+#include <util/hash.h>
 #include <util/log.h>
 
 #include <util/elf.h>
@@ -57,6 +58,26 @@ struct VarImportsHeader {
 };
 static_assert(sizeof(VarImportsHeader) == sizeof(uint32_t));
 
+// stub calling the HLE implementation of nid, directly by index if the import is implemented,
+// or through its guest fast path if it has one
+static void write_hle_import_stub(uint32_t *stub, uint32_t nid, KernelState &kernel, MemState &mem) {
+    const Address fast_path = kernel.lwmutex_fast_path.get_trampoline(mem, kernel.hle_imports, nid);
+    if (fast_path) {
+        stub[0] = 0xe51ff004; // ldr pc, [pc, #-4] - Jump to the guest fast path, which calls the import itself if needed.
+        stub[1] = fast_path;
+        stub[2] = nid;
+        return;
+    }
+
+    const auto index = kernel.hle_imports.find(nid);
+    if (index)
+        stub[0] = 0xef000000 | HLE_IMPORT_SVC_FLAG | *index; // svc #index - Call the import from the dispatch table.
+    else
+        stub[0] = 0xef000000; // svc #0 - Call our interrupt hook.
+    stub[1] = 0xe1a0f00e; // mov pc, lr - Return to the caller.
+    stub[2] = nid; // Our interrupt hook will read this.
+}
+
 static bool load_var_imports(const uint32_t *nids, const Ptr<uint32_t> *entries, size_t count, const SegmentInfosForReloc &segments, KernelState &kernel, MemState &mem, uint32_t module_id) {
     const std::lock_guard<std::mutex> guard(kernel.export_nids_mutex);
     for (size_t i = 0; i < count; ++i) {
@@ -125,7 +146,7 @@ static bool unload_var_imports(const uint32_t *nids, const Ptr<uint32_t> *entrie
     return true;
 }
 
-static bool load_func_imports(const uint32_t *nids, const Ptr<uint32_t> *entries, size_t count, const SegmentInfosForReloc &segments, KernelState &kernel, const MemState &mem) {
+static bool load_func_imports(const uint32_t *nids, const Ptr<uint32_t> *entries, size_t count, const SegmentInfosForReloc &segments, KernelState &kernel, MemState &mem) {
     const std::lock_guard<std::mutex> guard(kernel.export_nids_mutex);
     for (size_t i = 0; i < count; ++i) {
         const uint32_t nid = nids[i];
@@ -141,9 +162,7 @@ static bool load_func_imports(const uint32_t *nids, const Ptr<uint32_t> *entries
 
         kernel.func_binding_infos.emplace(nid, entry.address());
         if (export_address == kernel.export_nids.end()) {
-            stub[0] = 0xef000000; // svc #0 - Call our interrupt hook.
-            stub[1] = 0xe1a0f00e; // mov pc, lr - Return to the caller.
-            stub[2] = nid; // Our interrupt hook will read this.
+            write_hle_import_stub(stub, nid, kernel, mem);
         } else {
             Address func_address = export_address->second;
             stub[0] = encode_arm_inst(INSTRUCTION_MOVW, (uint16_t)func_address, 12);
@@ -301,9 +320,7 @@ static bool unload_func_exports(SceKernelModuleInfo *kernel_module_info, const u
             Address entry = it->second;
             uint32_t *stub = Ptr<uint32_t>(entry).get(mem);
 
-            stub[0] = 0xef000000; // svc #0 - Call our interrupt hook.
-            stub[1] = 0xe1a0f00e; // mov pc, lr - Return to the caller.
-            stub[2] = nid; // Our interrupt hook will read this.
+            write_hle_import_stub(stub, nid, kernel, mem);
             kernel.invalidate_jit_cache(entry, 3 * sizeof(uint32_t));
         }
     }
@@ -469,6 +486,21 @@ static bool load_exports(SceKernelModuleInfo *kernel_module_info, const sce_modu
     return true;
 }
 
+// identifies the module content for the jit cache, the applied patches are part of it
+static Sha256Hash hash_module(const uint8_t *self_bytes, const SCE_header &self_header, const std::string &self_path, const std::vector<Patch> &patches) {
+    const Sha256Hash self_hash = sha256(self_bytes, self_header.self_filesize);
+    if (patches.empty() || self_path.find("eboot.bin") == std::string::npos)
+        return self_hash;
+
+    std::vector<uint8_t> data(self_hash.begin(), self_hash.end());
+    for (const auto &patch : patches) {
+        data.push_back(patch.seg);
+        data.insert(data.end(), reinterpret_cast<const uint8_t *>(&patch.offset), reinterpret_cast<const uint8_t *>(&patch.offset) + sizeof(patch.offset));
+        data.insert(data.end(), patch.values.begin(), patch.values.end());
+    }
+    return sha256(data.data(), data.size());
+}
+
 /**
  * \return Negative on failure
  */
@@ -756,6 +788,13 @@ SceUID load_self(KernelState &kernel, MemState &mem, const void *self, const std
     if (!load_imports(*module_info, module_info_segment_address, segment_reloc_info, kernel, mem)) {
         return -1;
     }
+    if (kernel.jit_cache.is_enabled()) {
+        std::vector<std::pair<Address, uint32_t>> jit_segments;
+        for (const auto &[_, infos] : segment_reloc_info)
+            jit_segments.emplace_back(infos.addr, static_cast<uint32_t>(infos.size));
+        kernel.jit_cache.register_module(hash_module(self_bytes, self_header, self_path, patches), sceKernelModuleInfo->module_name, jit_segments);
+    }
+
     const SceUID uid = kernel.get_next_uid();
     sceKernelModuleInfo->modid = uid;
     {
@@ -792,6 +831,13 @@ int unload_self(KernelState &kernel, MemState &mem, KernelModule &module) {
 
     SceUID mod_nid = module_info->module_nid;
 
+    for (int i = 0; i < MODULE_INFO_NUM_SEGMENTS; i++) {
+        if (module.info.segments[i].size != 0) {
+            kernel.jit_cache.unregister_module(module.info.segments[i].vaddr.address());
+            break;
+        }
+    }
+
     // last step: free the memory
     for (int i = 0; i < MODULE_INFO_NUM_SEGMENTS; i++) {
         const auto &segment = module.info.segments[i];
@@ -0,0 +1,169 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <kernel/lwmutex_fast_path.h>
+
+#include <kernel/cpu_protocol.h>
+#include <kernel/types.h>
+#include <mem/functions.h>
+#include <mem/ptr.h>
+
+#include <util/log.h>
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+
+// the thread id in the kernel TLS, relative to the user TLS pointed by tpidruro
+constexpr uint32_t THREAD_ID_TLS_OFFSET = KERNEL_TLS_SIZE - TLS_THREAD_ID * sizeof(uint32_t);
+static_assert(THREAD_ID_TLS_OFFSET < 0x1000, "thread id can't be loaded with a single ldr");
+
+constexpr uint32_t LDR_THREAD_ID = 0xe51cc000 | THREAD_ID_TLS_OFFSET; // ldr r12, [r12, #-THREAD_ID_TLS_OFFSET]
+constexpr uint32_t MRC_TPIDRURO = 0xee1dcf70; // mrc p15, 0, r12, c13, c0, 3
+constexpr uint32_t SVC_PLACEHOLDER = 0xef000000; // svc #(HLE_IMPORT_SVC_FLAG | index), filled at generation time
+constexpr uint32_t LDR_BYPASS = 0xe51fc000; // ldr r12, [pc, #-offset] - the bypass word, offset filled at generation time
+
+// both trampolines start by going to the kernel when the bypass word is set
+
+// int lock(SceKernelLwMutexWork *workarea, int lock_count, ...)
+// only a lock count of 1 on a free mutex is handled, the rest goes to the kernel
+static constexpr std::array<uint32_t, 20> lock_code = {
+    LDR_BYPASS,
+    0xe35c0000, // cmp r12, #0
+    0x1a00000e, // bne slow
+    0xe3510001, // cmp r1, #1
+    0x1a00000c, // bne slow
+    MRC_TPIDRURO,
+    LDR_THREAD_ID,
+    // retry:
+    0xe1903f9f, // ldrex r3, [r0]
+    0xe3530000, // cmp r3, #0
+    0x1a000006, // bne contended
+    0xe1803f9c, // strex r3, r12, [r0]
+    0xe3530000, // cmp r3, #0
+    0x1afffff9, // bne retry
+    0xf57ff05b, // dmb ish
+    0xe5801008, // str r1, [r0, #8] - lockCount is only written by the owner
+    0xe3a00000, // mov r0, #0
+    0xe12fff1e, // bx lr
+    // contended:
+    0xf57ff01f, // clrex
+    // slow:
+    SVC_PLACEHOLDER,
+    0xe12fff1e, // bx lr
+};
+
+// int unlock(SceKernelLwMutexWork *workarea, int unlock_count)
+// only a full unlock by the owner, without waiters, is handled, the rest goes to the kernel
+static constexpr std::array<uint32_t, 26> unlock_code = {
+    LDR_BYPASS,
+    0xe35c0000, // cmp r12, #0
+    0x1a000014, // bne slow
+    MRC_TPIDRURO,
+    LDR_THREAD_ID,
+    0xe5903000, // ldr r3, [r0]
+    0xe153000c, // cmp r3, r12
+    0x1a00000f, // bne slow
+    0xe5903008, // ldr r3, [r0, #8]
+    0xe1530001, // cmp r3, r1
+    0x1a00000c, // bne slow
+    0xe3a02000, // mov r2, #0
+    0xe5802008, // str r2, [r0, #8] - must be done before releasing the owner word
+    0xf57ff05b, // dmb ish
+    // retry:
+    0xe1903f9f, // ldrex r3, [r0]
+    0xe153000c, // cmp r3, r12
+    0x1a000004, // bne restore - a thread started waiting in the meantime
+    0xe1803f92, // strex r3, r2, [r0]
+    0xe3530000, // cmp r3, #0
+    0x1afffff9, // bne retry
+    0xe3a00000, // mov r0, #0
+    0xe12fff1e, // bx lr
+    // restore:
+    0xf57ff01f, // clrex
+    0xe5801008, // str r1, [r0, #8]
+    // slow:
+    SVC_PLACEHOLDER,
+    0xe12fff1e, // bx lr
+};
+
+// sceKernelLockLwMutexCB is left out as it has to process callbacks
+static const std::map<uint32_t, bool> fast_path_nids = {
+    { 0x46E7BE7B, true }, // sceKernelLockLwMutex
+    { 0xA7819967, true }, // sceKernelLockLwMutex_0
+    { 0xA6A2C915, true }, // sceKernelTryLockLwMutex
+    { 0x9EF798C1, true }, // sceKernelTryLockLwMutex_16XX
+    { 0x91FA6614, false }, // sceKernelUnlockLwMutex
+    { 0x499EA781, false }, // sceKernelUnlockLwMutex_0
+    { 0x120AFC8C, false }, // sceKernelUnlockLwMutex2
+};
+
+constexpr uint32_t CODE_SIZE = KiB(4);
+
+Address LwMutexFastPath::get_trampoline(MemState &mem, const HleImportTable &imports, uint32_t nid) {
+    if (!enabled)
+        return 0;
+
+    const auto nid_it = fast_path_nids.find(nid);
+    if (nid_it == fast_path_nids.end())
+        return 0;
+
+    const auto it = trampolines.find(nid);
+    if (it != trampolines.end())
+        return it->second;
+
+    const auto index = imports.find(nid);
+    if (!index)
+        return 0;
+
+    const bool is_lock = nid_it->second;
+    const uint32_t *const code_src = is_lock ? lock_code.data() : unlock_code.data();
+    const size_t code_count = is_lock ? lock_code.size() : unlock_code.size();
+
+    if (!code) {
+        code = alloc_block(mem, CODE_SIZE, "LwMutex fast path");
+        if (!code) {
+            LOG_ERROR("Failed to allocate the lwmutex fast path, using the kernel instead");
+            enabled = false;
+            return 0;
+        }
+        // the bypass word comes first, followed by the trampolines
+        bypass_word = Ptr<uint32_t>(code.get()).get(mem);
+        *bypass_word = bypass;
+        code_used = sizeof(uint32_t);
+    }
+    assert(code_used + code_count * sizeof(uint32_t) <= CODE_SIZE);
+
+    const Address address = code.get() + code_used;
+    uint32_t *const dest = Ptr<uint32_t>(address).get(mem);
+    memcpy(dest, code_src, code_count * sizeof(uint32_t));
+    // pc reads as the address of the instruction + 8
+    dest[0] = LDR_BYPASS | (address + 8 - code.get());
+    // the slow path is always the second to last instruction
+    dest[code_count - 2] = SVC_PLACEHOLDER | HLE_IMPORT_SVC_FLAG | *index;
+
+    code_used += code_count * sizeof(uint32_t);
+    trampolines.emplace(nid, address);
+    return address;
+}
+
+void LwMutexFastPath::set_bypass(bool value) {
+    bypass = value;
+    if (bypass_word)
+        std::atomic_ref<uint32_t>(*bypass_word).store(value);
+}
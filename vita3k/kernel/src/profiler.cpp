@@ -0,0 +1,224 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#include <kernel/profiler.h>
+
+#include <cpu/functions.h>
+#include <kernel/state.h>
+#include <kernel/thread/thread_state.h>
+#include <nids/functions.h>
+#include <util/log.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace {
+
+// resolves guest addresses to the module containing them and the closest export before them
+class Symbolizer {
+public:
+    explicit Symbolizer(KernelState &kernel)
+        : kernel(kernel) {
+        const std::lock_guard<std::mutex> guard(kernel.export_nids_mutex);
+        for (const auto &[nid, address] : kernel.export_nids)
+            symbols.emplace(address & ~1, import_name(nid));
+    }
+
+    // function name used to aggregate samples: module!export when known, module+offset otherwise
+    std::string function(Address address) {
+        std::string name;
+        Address offset;
+        resolve(address, name, offset);
+        return name.find('!') != std::string::npos ? name : with_offset(name, offset);
+    }
+
+    std::string full_name(Address address) {
+        std::string name;
+        Address offset;
+        resolve(address, name, offset);
+        return with_offset(name, offset);
+    }
+
+private:
+    static std::string with_offset(const std::string &name, Address offset) {
+        return offset ? fmt::format("{}+0x{:X}", name, offset) : name;
+    }
+
+    void resolve(Address address, std::string &name, Address &offset) {
+        address &= ~1;
+        const SceKernelModuleInfo *module = kernel.find_module_by_addr(address);
+        if (!module) {
+            name = fmt::format("0x{:08X}", address);
+            offset = 0;
+            return;
+        }
+
+        const std::string module_name(module->module_name, strnlen(module->module_name, sizeof(module->module_name)));
+        auto it = symbols.upper_bound(address);
+        if (it != symbols.begin()) {
+            --it;
+            if (kernel.find_module_by_addr(it->first) == module) {
+                name = fmt::format("{}!{}", module_name, it->second);
+                offset = address - it->first;
+                return;
+            }
+        }
+
+        name = module_name;
+        offset = address - module->segments[0].vaddr.address();
+    }
+
+    KernelState &kernel;
+    std::map<Address, std::string> symbols;
+};
+
+} // namespace
+
+GuestProfiler::~GuestProfiler() {
+    stop();
+}
+
+void GuestProfiler::start(KernelState &kernel, uint32_t interval_us) {
+    stop();
+    stop_requested = false;
+    sampler = std::thread([this, &kernel, interval = std::chrono::microseconds(interval_us)]() {
+        std::unique_lock<std::mutex> lock(sampler_mutex);
+        while (!sampler_cond.wait_for(lock, interval, [&] { return stop_requested; })) {
+            const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
+            for (const auto &[_, thread] : kernel.threads) {
+                // threads waiting in a HLE call or in the kernel are not using the cpu
+                if (thread->status != ThreadStatus::run)
+                    continue;
+
+                if (thread->in_hle_call)
+                    record_hle();
+                else
+                    request_sample(*thread->cpu);
+            }
+        }
+    });
+
+    LOG_INFO("Guest profiler started, sampling every {} us", interval_us);
+}
+
+void GuestProfiler::stop() {
+    if (!sampler.joinable())
+        return;
+
+    {
+        const std::lock_guard<std::mutex> lock(sampler_mutex);
+        stop_requested = true;
+    }
+    sampler_cond.notify_one();
+    sampler.join();
+}
+
+void GuestProfiler::record(Address pc, Address lr) {
+    const std::lock_guard<std::mutex> guard(mutex);
+    total_samples++;
+    pc_samples[pc]++;
+    call_samples[{ lr, pc }]++;
+}
+
+void GuestProfiler::record_hle() {
+    const std::lock_guard<std::mutex> guard(mutex);
+    total_samples++;
+    hle_samples++;
+}
+
+void GuestProfiler::save(KernelState &kernel, const fs::path &folder, const std::string &title_id) {
+    stop();
+
+    const std::lock_guard<std::mutex> guard(mutex);
+    if (total_samples == 0)
+        return;
+
+    fs::create_directories(folder);
+    Symbolizer symbolizer(kernel);
+
+    std::map<std::string, uint64_t> functions;
+    for (const auto &[pc, count] : pc_samples)
+        functions[symbolizer.function(pc)] += count;
+    if (hle_samples)
+        functions["[HLE]"] = hle_samples;
+
+    std::vector<std::pair<std::string, uint64_t>> flat(functions.begin(), functions.end());
+    std::sort(flat.begin(), flat.end(), [](const auto &a, const auto &b) { return a.second > b.second; });
+
+    const fs::path flat_path = folder / fmt::format("{}-flat.txt", title_id);
+    fs::ofstream flat_file(flat_path, std::ios::out | std::ios::trunc);
+    flat_file << fmt::format("{} samples\n\n{:>10} {:>7}  function\n", total_samples, "samples", "%");
+    for (const auto &[function, count] : flat)
+        flat_file << fmt::format("{:>10} {:>6.2f}%  {}\n", count, count * 100.0 / total_samples, function);
+
+    std::map<std::string, uint64_t> stacks;
+    for (const auto &[call, count] : call_samples)
+        stacks[fmt::format("{};{}", symbolizer.function(call.first), symbolizer.function(call.second))] += count;
+    if (hle_samples)
+        stacks["[HLE]"] = hle_samples;
+
+    const fs::path graph_path = folder / fmt::format("{}-callgraph.folded", title_id);
+    fs::ofstream graph_file(graph_path, std::ios::out | std::ios::trunc);
+    for (const auto &[stack, count] : stacks)
+        graph_file << fmt::format("{} {}\n", stack, count);
+
+    LOG_INFO("Guest profile ({} samples) written to {}", total_samples, folder);
+}
+
+void enable_perf_map(const fs::path &jit_folder) {
+#ifdef __linux__
+    fs::create_directories(jit_folder);
+    setenv("PERF_BUILDID_DIR", jit_folder.string().c_str(), 1);
+#else
+    LOG_WARN("The JIT perf map is only supported on Linux");
+#endif
+}
+
+void save_perf_map(KernelState &kernel, const fs::path &jit_folder) {
+#ifdef __linux__
+    const std::string map_name = fmt::format("perf-{}.map", getpid());
+    fs::ifstream jit_map(jit_folder / map_name);
+    if (!jit_map.is_open()) {
+        LOG_WARN("No JIT perf map was written by dynarmic in {}", jit_folder);
+        return;
+    }
+
+    fs::ofstream perf_map(fs::path("/tmp") / map_name, std::ios::out | std::ios::trunc);
+    Symbolizer symbolizer(kernel);
+    std::string line;
+    size_t nb_blocks = 0;
+    while (std::getline(jit_map, line)) {
+        // blocks are named a32_<a|t><pc>_..., keep the dynarmic name at the end for reference
+        const size_t pos = line.find(" a32_");
+        if (pos != std::string::npos && line.size() >= pos + 14) {
+            const Address pc = static_cast<Address>(std::strtoul(line.substr(pos + 6, 8).c_str(), nullptr, 16));
+            perf_map << fmt::format("{} {} [{}]\n", line.substr(0, pos), symbolizer.full_name(pc), line.substr(pos + 1));
+            nb_blocks++;
+        } else {
+            perf_map << line << '\n';
+        }
+    }
+
+    LOG_INFO("Wrote {} guest symbols to /tmp/{}", nb_blocks, map_name);
+#endif
+}
@@ -0,0 +1,159 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#include <kernel/scheduler.h>
+
+#include <cpu/functions.h>
+#include <kernel/thread/thread_state.h>
+
+#include <algorithm>
+#include <thread>
+
+// time a thread can run before yielding its core to a waiting thread of the same priority
+constexpr auto time_slice = std::chrono::milliseconds(2);
+// a thread can block in a HLE call while owning its core (for example on a host lock held by
+// another guest thread), so a thread which cannot get a core for this long runs anyway
+constexpr auto starvation_timeout = std::chrono::milliseconds(50);
+
+ThreadScheduler::ThreadScheduler(uint32_t core_count)
+    : cores(core_count) {
+}
+
+bool ThreadScheduler::can_run_on(const ThreadState &thread, uint32_t core) const {
+    // user core bits start at SCE_KERNEL_CPU_MASK_USER_0, no bit for our cores means any core
+    const uint32_t mask = (static_cast<uint32_t>(thread.affinity_mask) >> 16) & ((1U << cores.size()) - 1);
+    return mask == 0 || (mask & (1U << core));
+}
+
+void ThreadScheduler::assign(ThreadState &thread, uint32_t core) {
+    cores[core].owner = &thread;
+    cores[core].since = std::chrono::steady_clock::now();
+    thread.scheduler_core = static_cast<int>(core);
+}
+
+ThreadScheduler::Waiter *ThreadScheduler::best_waiter(uint32_t core) const {
+    Waiter *best = nullptr;
+    for (Waiter *waiter : waiters) {
+        if (!can_run_on(*waiter->thread, core))
+            continue;
+        // lower value means higher priority, first come first served for the same priority
+        if (!best || waiter->thread->priority < best->thread->priority
+            || (waiter->thread->priority == best->thread->priority && waiter->ticket < best->ticket))
+            best = waiter;
+    }
+    return best;
+}
+
+void ThreadScheduler::preempt_for(const ThreadState &thread, bool time_slice_over) {
+    const auto now = std::chrono::steady_clock::now();
+    ThreadState *victim = nullptr;
+    for (uint32_t core = 0; core < cores.size(); core++) {
+        ThreadState *owner = cores[core].owner;
+        if (!owner || !can_run_on(thread, core) || owner->yield_requested)
+            continue;
+
+        const bool lower_priority = owner->priority > thread.priority;
+        const bool same_priority_expired = time_slice_over && owner->priority == thread.priority && now - cores[core].since >= time_slice;
+        if ((lower_priority || same_priority_expired) && (!victim || owner->priority > victim->priority))
+            victim = owner;
+    }
+
+    if (victim) {
+        // the victim gives its core back the next time it leaves the cpu
+        victim->yield_requested = true;
+        request_halt(*victim->cpu);
+    }
+}
+
+void ThreadScheduler::acquire(ThreadState &thread) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (thread.scheduler_core != ThreadState::NO_CORE)
+        return;
+
+    for (uint32_t core = 0; core < cores.size(); core++) {
+        if (!cores[core].owner && can_run_on(thread, core)) {
+            assign(thread, core);
+            return;
+        }
+    }
+
+    Waiter waiter{ &thread, next_ticket++ };
+    waiters.push_back(&waiter);
+    preempt_for(thread, false);
+
+    const auto start = std::chrono::steady_clock::now();
+    while (thread.scheduler_core == ThreadState::NO_CORE) {
+        if (waiter.cond.wait_for(lock, time_slice) == std::cv_status::no_timeout)
+            continue;
+
+        if (std::chrono::steady_clock::now() - start >= starvation_timeout) {
+            thread.scheduler_core = ThreadState::BORROWED_CORE;
+            std::erase(waiters, &waiter);
+            break;
+        }
+        preempt_for(thread, true);
+    }
+}
+
+void ThreadScheduler::release(ThreadState &thread) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    const int core = thread.scheduler_core;
+    thread.scheduler_core = ThreadState::NO_CORE;
+    thread.yield_requested = false;
+    thread.release_requested = false;
+    if (core < 0)
+        return;
+
+    cores[core].owner = nullptr;
+    // direct handoff, the waiter does not have to compete for the core once woken up
+    if (Waiter *waiter = best_waiter(core)) {
+        std::erase(waiters, waiter);
+        assign(*waiter->thread, core);
+        waiter->cond.notify_one();
+    }
+}
+
+void ThreadScheduler::unschedule(ThreadState &thread) {
+    if (std::this_thread::get_id() == thread.host_thread) {
+        release(thread);
+        return;
+    }
+
+    // releasing here would free the core while the thread may still be running guest code
+    const std::lock_guard<std::mutex> lock(mutex);
+    if (thread.scheduler_core != ThreadState::NO_CORE)
+        thread.release_requested = true;
+}
+
+void ThreadScheduler::wake(ThreadState &thread) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    // runnable again before its owner left the cpu, it keeps its core
+    thread.release_requested = false;
+    if (thread.scheduler_core != ThreadState::NO_CORE)
+        return;
+
+    // free cores have no waiter able to use them, so the woken thread can take one now
+    for (uint32_t core = 0; core < cores.size(); core++) {
+        if (!cores[core].owner && can_run_on(thread, core)) {
+            assign(thread, core);
+            return;
+        }
+    }
+}
+
+bool ThreadScheduler::should_yield(ThreadState &thread) {
+    return thread.yield_requested || thread.release_requested;
+}
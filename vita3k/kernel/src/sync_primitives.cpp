@@ -20,9 +20,10 @@
 #include <kernel/sync_primitives.h>
 
 #include <kernel/types.h>
-#include <util/lock_and_find.h>
 #include <util/log.h>
 
+#include <atomic>
+
 static constexpr bool LOG_SYNC_PRIMITIVES = false;
 
 // ***********
@@ -51,7 +52,7 @@ inline static CondvarPtrs &get_condvars(KernelState &kernel, SyncWeight weight)
 
 inline static int find_mutex(MutexPtr &mutex_out, MutexPtrs **mutexes_out, KernelState &kernel, const char *export_name, SceUID mutexid, SyncWeight weight) {
     MutexPtrs &mutexes = get_mutexes(kernel, weight);
-    mutex_out = lock_and_find(mutexid, mutexes, kernel.mutex);
+    mutex_out = mutexes.get(mutexid);
     if (!mutex_out) {
         return unknown_mutex_id(export_name, weight);
     }
@@ -64,7 +65,7 @@ inline static int find_mutex(MutexPtr &mutex_out, MutexPtrs **mutexes_out, Kerne
 
 inline static int find_condvar(CondvarPtr &condvar_out, CondvarPtrs **condvars_out, KernelState &kernel, const char *export_name, SceUID condid, SyncWeight weight) {
     CondvarPtrs &condvars = get_condvars(kernel, weight);
-    condvar_out = lock_and_find(condid, condvars, kernel.mutex);
+    condvar_out = condvars.get(condid);
     if (!condvar_out) {
         return unknown_cond_id(export_name, weight);
     }
@@ -77,7 +78,7 @@ inline static int find_condvar(CondvarPtr &condvar_out, CondvarPtrs **condvars_o
 
 // TODO: Write remaining time to timeout ptr when it's successfully signaled
 // Assumes primitive_lock is locked and thread_lock is unlocked
-inline static int handle_timeout(const ThreadStatePtr &thread, std::unique_lock<std::mutex> &thread_lock,
+inline static int handle_timeout(KernelState &kernel, const ThreadStatePtr &thread, std::unique_lock<std::mutex> &thread_lock,
     std::unique_lock<std::mutex> &primitive_lock, WaitingThreadQueuePtr &queue,
     const ThreadDataQueueInterator<WaitingThreadData> &data_it, const char *export_name,
     SceUInt *const timeout) {
@@ -85,7 +86,7 @@ inline static int handle_timeout(const ThreadStatePtr &thread, std::unique_lock<
         bool status = false;
         auto start = std::chrono::steady_clock::now();
         if (*timeout > 0) {
-            status = thread->status_cond.wait_for(primitive_lock, std::chrono::microseconds{ *timeout }, [&] { return thread->status == ThreadStatus::run; });
+            status = kernel.timer_wheel.wait_for(thread->status_cond, primitive_lock, *timeout, [&] { return thread->status == ThreadStatus::run; });
         }
 
         if (!status) {
@@ -123,7 +124,9 @@ SceUID simple_event_create(KernelState &kernel, MemState &mem, const char *expor
         return RET_ERROR(SCE_KERNEL_ERROR_UID_NAME_TOO_LONG);
     }
 
-    const SceUID uid = kernel.get_next_uid();
+    const SceUID uid = kernel.simple_events.reserve();
+    if (uid < 0)
+        return RET_ERROR(SCE_KERNEL_ERROR_UID_MAX_OPEN);
 
     if (LOG_SYNC_PRIMITIVES) {
         LOG_DEBUG("{}: uid: {} thread_id: {} name: \"{}\" attr: {} pattern: {:#b}",
@@ -145,14 +148,13 @@ SceUID simple_event_create(KernelState &kernel, MemState &mem, const char *expor
     event->auto_reset = (event->attr & SCE_KERNEL_EVENT_ATTR_AUTO_RESET);
     event->cb_wakeup_only = (event->attr & SCE_KERNEL_ATTR_NOTIFY_CB_WAKEUP_ONLY);
 
-    const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
     kernel.simple_events.emplace(uid, event);
 
     return uid;
 }
 
 SceInt32 simple_event_waitorpoll(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID event_id, SceUInt32 wait_pattern, SceUInt32 *result_pattern, SceUInt64 *user_data, SceUInt32 *timeout, bool is_wait) {
-    const SimpleEventPtr event = lock_and_find(event_id, kernel.simple_events, kernel.mutex);
+    const SimpleEventPtr event = kernel.simple_events.get(event_id);
     if (!event) {
         // this may also be a timer event
         return timer_waitorpoll(kernel, export_name, thread_id, event_id, wait_pattern, result_pattern, user_data, timeout, is_wait);
@@ -195,7 +197,7 @@ SceInt32 simple_event_waitorpoll(KernelState &kernel, const char *export_name, S
         const auto data_it = event->waiting_threads->push(data);
         thread_lock.unlock();
 
-        const int err = handle_timeout(thread, thread_lock, event_lock, event->waiting_threads, data_it, export_name, timeout);
+        const int err = handle_timeout(kernel, thread, thread_lock, event_lock, event->waiting_threads, data_it, export_name, timeout);
         if (err < 0) {
             // set it only if a timeout occurs
             // otherwise set in simple_event_setorpulse
@@ -211,7 +213,7 @@ SceInt32 simple_event_waitorpoll(KernelState &kernel, const char *export_name, S
 }
 
 SceInt32 simple_event_setorpulse(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID event_id, SceUInt32 pattern, SceUInt64 user_data, bool is_set) {
-    const SimpleEventPtr event = lock_and_find(event_id, kernel.simple_events, kernel.mutex);
+    const SimpleEventPtr event = kernel.simple_events.get(event_id);
     if (!event) {
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_EVENT_ID);
     }
@@ -266,7 +268,7 @@ SceInt32 simple_event_setorpulse(KernelState &kernel, const char *export_name, S
 }
 
 SceInt32 simple_event_clear(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID event_id, SceUInt32 clear_pattern) {
-    const SimpleEventPtr event = lock_and_find(event_id, kernel.simple_events, kernel.mutex);
+    const SimpleEventPtr event = kernel.simple_events.get(event_id);
     if (!event) {
         // this may also be a timer event
         return timer_clear(kernel, export_name, thread_id, event_id, clear_pattern);
@@ -285,7 +287,7 @@ SceInt32 simple_event_clear(KernelState &kernel, const char *export_name, SceUID
 }
 
 SceInt32 simple_event_delete(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID event_id) {
-    const SimpleEventPtr event = lock_and_find(event_id, kernel.simple_events, kernel.mutex);
+    const SimpleEventPtr event = kernel.simple_events.get(event_id);
     if (!event) {
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_EVENT_ID);
     }
@@ -296,8 +298,7 @@ SceInt32 simple_event_delete(KernelState &kernel, const char *export_name, SceUI
     }
 
     if (event->waiting_threads->empty()) {
-        const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
-        kernel.eventflags.erase(event_id);
+        kernel.simple_events.erase(event_id);
     } else {
         // TODO:
         LOG_WARN("Can't delete sync object, it has waiting threads.");
@@ -321,7 +322,9 @@ SceUID timer_create(KernelState &kernel, MemState &mem, const char *export_name,
         return RET_ERROR(SCE_KERNEL_ERROR_UID_NAME_TOO_LONG);
     }
 
-    const SceUID uid = kernel.get_next_uid();
+    const SceUID uid = kernel.timers.reserve();
+    if (uid < 0)
+        return RET_ERROR(SCE_KERNEL_ERROR_UID_MAX_OPEN);
 
     if (LOG_SYNC_PRIMITIVES) {
         LOG_DEBUG("{}: uid: {} thread_id: {} name: \"{}\" attr: {}",
@@ -339,7 +342,6 @@ SceUID timer_create(KernelState &kernel, MemState &mem, const char *export_name,
         timer->waiting_threads = std::make_unique<FIFOThreadDataQueue<WaitingThreadData>>();
     }
 
-    const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
     kernel.timers.emplace(uid, timer);
 
     return uid;
@@ -352,14 +354,12 @@ SceUID timer_find(KernelState &kernel, const char *export_name, const char *pNam
     if (LOG_SYNC_PRIMITIVES)
         LOG_DEBUG("{}: name: \"{}\"", export_name, pName);
 
-    const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
-
-    const auto it = std::find_if(kernel.timers.begin(), kernel.timers.end(), [=](const auto &timer) {
-        return strncmp(timer.second->name, pName, KERNELOBJECT_MAX_NAME_LENGTH) == 0;
+    const SceUID uid = kernel.timers.find_if([=](const auto &timer) {
+        return strncmp(timer->name, pName, KERNELOBJECT_MAX_NAME_LENGTH) == 0;
     });
 
-    if (it != kernel.timers.end())
-        return it->first;
+    if (uid)
+        return uid;
 
     return RET_ERROR(SCE_KERNEL_ERROR_UID_CANNOT_FIND_BY_NAME);
 }
@@ -372,7 +372,7 @@ static void timer_schedule_event(TimerPtr &timer) {
 }
 
 SceInt32 timer_set(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID timer_handle, SceUID type, SceKernelSysClock *interval, SceInt32 repeats) {
-    TimerPtr timer = lock_and_find(timer_handle, kernel.timers, kernel.mutex);
+    TimerPtr timer = kernel.timers.get(timer_handle);
     if (!timer)
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_TIMER_ID);
 
@@ -400,7 +400,7 @@ SceInt32 timer_set(KernelState &kernel, const char *export_name, SceUID thread_i
 // this function is actually only called by simple_event_waitorpoll
 // as the only way to wait for a timer is using the event function (a timer is an event)
 SceInt32 timer_waitorpoll(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID event_id, SceUInt32 bit_pattern, SceUInt32 *result_pattern, SceUInt64 *user_data, SceUInt32 *timeout, bool is_wait) {
-    TimerPtr timer = lock_and_find(event_id, kernel.timers, kernel.mutex);
+    TimerPtr timer = kernel.timers.get(event_id);
     if (!timer) {
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_EVENT_ID);
     }
@@ -464,7 +464,7 @@ SceInt32 timer_waitorpoll(KernelState &kernel, const char *export_name, SceUID t
         while (!got_event) {
             uint64_t wait_time = timer->next_event - current_time;
             // wait before we got an event and we are the first thread in the waiting list
-            timer->condvar.wait_for(lock, std::chrono::microseconds(wait_time), [&] {
+            kernel.timer_wheel.wait_for(timer->condvar, lock, wait_time, [&] {
                 return (*timer->waiting_threads->begin()).thread->id == thread_id;
             });
             current_time = get_current_time();
@@ -487,7 +487,7 @@ SceInt32 timer_waitorpoll(KernelState &kernel, const char *export_name, SceUID t
 
 // this function is actually only called by simple_event_clear
 SceInt32 timer_clear(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID event_id, SceUInt32 clear_pattern) {
-    TimerPtr timer = lock_and_find(event_id, kernel.timers, kernel.mutex);
+    TimerPtr timer = kernel.timers.get(event_id);
     if (!timer) {
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_EVENT_ID);
     }
@@ -503,7 +503,7 @@ SceInt32 timer_clear(KernelState &kernel, const char *export_name, SceUID thread
 }
 
 SceInt32 timer_start(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID timer_handle) {
-    TimerPtr timer = lock_and_find(timer_handle, kernel.timers, kernel.mutex);
+    TimerPtr timer = kernel.timers.get(timer_handle);
     if (!timer)
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_TIMER_ID);
 
@@ -521,7 +521,7 @@ SceInt32 timer_start(KernelState &kernel, const char *export_name, SceUID thread
 }
 
 SceInt32 timer_stop(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID timer_handle) {
-    const TimerPtr timer = lock_and_find(timer_handle, kernel.timers, kernel.mutex);
+    const TimerPtr timer = kernel.timers.get(timer_handle);
     if (!timer)
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_TIMER_ID);
 
@@ -550,7 +550,9 @@ SceUID mutex_create(SceUID *uid_out, KernelState &kernel, MemState &mem, const c
     }
 
     const MutexPtr mutex = std::make_shared<Mutex>();
-    const SceUID uid = kernel.get_next_uid();
+    const SceUID uid = get_mutexes(kernel, weight).reserve();
+    if (uid < 0)
+        return RET_ERROR(SCE_KERNEL_ERROR_UID_MAX_OPEN);
     mutex->uid = uid;
     mutex->init_count = init_count;
     mutex->lock_count = init_count;
@@ -571,14 +573,11 @@ SceUID mutex_create(SceUID *uid_out, KernelState &kernel, MemState &mem, const c
     if (weight == SyncWeight::Light) {
         SceKernelLwMutexWork *workarea_mem = workarea.get(mem);
         workarea_mem->lockCount = init_count;
-        if (workarea_mem->lockCount)
-            workarea_mem->owner = thread_id;
+        workarea_mem->owner = init_count ? thread_id : 0;
         workarea_mem->attr = attr;
     }
 
-    const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
-    auto &mutexes = get_mutexes(kernel, weight);
-    mutexes.emplace(uid, mutex);
+    get_mutexes(kernel, weight).emplace(uid, mutex);
 
     if (LOG_SYNC_PRIMITIVES) {
         LOG_DEBUG("{}: uid: {} thread_id: {} name: \"{}\" attr: {} init_count: {}",
@@ -599,18 +598,75 @@ SceUID mutex_find(KernelState &kernel, const char *export_name, const char *pNam
     if (LOG_SYNC_PRIMITIVES)
         LOG_DEBUG("{}: name: \"{}\"", export_name, pName);
 
-    const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
-
-    const auto it = std::find_if(kernel.mutexes.begin(), kernel.mutexes.end(), [=](const auto &mutex) {
-        return strncmp(mutex.second->name, pName, KERNELOBJECT_MAX_NAME_LENGTH) == 0;
+    const SceUID uid = kernel.mutexes.find_if([=](const auto &mutex) {
+        return strncmp(mutex->name, pName, KERNELOBJECT_MAX_NAME_LENGTH) == 0;
     });
 
-    if (it != kernel.mutexes.end())
-        return it->first;
+    if (uid)
+        return uid;
 
     return RET_ERROR(SCE_KERNEL_ERROR_UID_CANNOT_FIND_BY_NAME);
 }
 
+// Lightweight mutexes are owned through the owner word of their work area, which the guest
+// fast path also updates atomically, so it is the only reliable source for ownership.
+inline static int lw_mutex_lock_impl(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, int lock_count, MutexPtr &mutex, SceUInt *timeout, bool only_try) {
+    const ThreadStatePtr thread = kernel.get_thread(thread_id);
+    SceKernelLwMutexWork *workarea = mutex->workarea.get(mem);
+    std::atomic_ref<uint32_t> owner(workarea->owner);
+
+    std::unique_lock<std::mutex> mutex_lock(mutex->mutex);
+
+    uint32_t current = owner.load();
+    while (true) {
+        // Not owned
+        if (current == 0) {
+            if (!owner.compare_exchange_weak(current, thread_id))
+                continue;
+
+            // Take ownership!
+            workarea->lockCount = lock_count;
+            mutex->lock_count = lock_count;
+            mutex->owner = thread;
+            return SCE_KERNEL_OK;
+        }
+
+        // Owned by ourselves
+        if ((current & ~LW_MUTEX_WAITERS) == static_cast<uint32_t>(thread_id)) {
+            if (!(mutex->attr & SCE_KERNEL_MUTEX_ATTR_RECURSIVE))
+                return RET_ERROR(SCE_KERNEL_ERROR_LW_MUTEX_RECURSIVE);
+
+            workarea->lockCount += lock_count;
+            mutex->lock_count = workarea->lockCount;
+            return SCE_KERNEL_OK;
+        }
+
+        // Owned by someone else
+        if (only_try)
+            return RET_ERROR(SCE_KERNEL_ERROR_LW_MUTEX_FAILED_TO_OWN);
+
+        // From now on the owner has to unlock it through the kernel, which will wake us up.
+        // This bit is only set with mutex->mutex held, so the unlock can't be missed.
+        if ((current & LW_MUTEX_WAITERS) || owner.compare_exchange_weak(current, current | LW_MUTEX_WAITERS))
+            break;
+    }
+
+    // Sleep thread!
+    std::unique_lock<std::mutex> thread_lock(thread->mutex);
+    thread->update_status(ThreadStatus::wait, ThreadStatus::run);
+
+    WaitingThreadData data;
+    data.thread = thread;
+    data.lock_count = lock_count;
+    data.priority = thread->priority;
+
+    const auto data_it = mutex->waiting_threads->push(data);
+    thread_lock.unlock();
+
+    // on wake up, the ownership has already been handed over to us by the unlock
+    return handle_timeout(kernel, thread, thread_lock, mutex_lock, mutex->waiting_threads, data_it, export_name, timeout);
+}
+
 inline static int mutex_lock_impl(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, int lock_count, MutexPtr &mutex, SyncWeight weight, SceUInt *timeout, bool only_try) {
     if (LOG_SYNC_PRIMITIVES) {
         LOG_DEBUG("{}: uid: {} thread_id: {} name: \"{}\" attr: {} lock_count: {} timeout: {} waiting_threads: {}",
@@ -618,6 +674,9 @@ inline static int mutex_lock_impl(KernelState &kernel, MemState &mem, const char
             mutex->waiting_threads->size());
     }
 
+    if (weight == SyncWeight::Light && kernel.lwmutex_fast_path.enabled)
+        return lw_mutex_lock_impl(kernel, mem, export_name, thread_id, lock_count, mutex, timeout, only_try);
+
     const ThreadStatePtr thread = kernel.get_thread(thread_id);
 
     std::unique_lock<std::mutex> mutex_lock(mutex->mutex);
@@ -662,7 +721,7 @@ inline static int mutex_lock_impl(KernelState &kernel, MemState &mem, const char
         const auto data_it = mutex->waiting_threads->push(data);
         thread_lock.unlock();
 
-        int res = handle_timeout(thread, thread_lock, mutex_lock, mutex->waiting_threads, data_it, export_name, timeout);
+        int res = handle_timeout(kernel, thread, thread_lock, mutex_lock, mutex->waiting_threads, data_it, export_name, timeout);
 
         if (weight == SyncWeight::Light) {
             mutex->workarea.get(mem)->lockCount = mutex->lock_count;
@@ -709,7 +768,53 @@ int mutex_try_lock(KernelState &kernel, MemState &mem, const char *export_name,
     return mutex_lock_impl(kernel, mem, export_name, thread_id, lock_count, mutex, weight, nullptr, true);
 }
 
-inline static int mutex_unlock_impl(KernelState &kernel, const char *export_name, SceUID thread_id, int unlock_count, MutexPtr &mutex) {
+inline static int lw_mutex_unlock_impl(MemState &mem, const char *export_name, SceUID thread_id, int unlock_count, MutexPtr &mutex) {
+    SceKernelLwMutexWork *workarea = mutex->workarea.get(mem);
+    std::atomic_ref<uint32_t> owner(workarea->owner);
+
+    const std::lock_guard<std::mutex> mutex_lock(mutex->mutex);
+
+    if ((owner.load() & ~LW_MUTEX_WAITERS) != static_cast<uint32_t>(thread_id))
+        return SCE_KERNEL_OK;
+
+    if (static_cast<uint32_t>(unlock_count) > workarea->lockCount)
+        return RET_ERROR(SCE_KERNEL_ERROR_LW_MUTEX_UNLOCK_UDF);
+
+    workarea->lockCount -= unlock_count;
+    mutex->lock_count = workarea->lockCount;
+    if (workarea->lockCount > 0)
+        return SCE_KERNEL_OK;
+
+    mutex->owner = nullptr;
+
+    // Nobody else can modify the owner word while it is not 0, as the waiters bit is only
+    // set with mutex->mutex held
+    if (mutex->waiting_threads->empty()) {
+        owner.store(0);
+        return SCE_KERNEL_OK;
+    }
+
+    // Hand the mutex over to the first waiting thread
+    const auto waiting_thread_data = *mutex->waiting_threads->begin();
+    const auto waiting_thread = waiting_thread_data.thread;
+
+    const std::lock_guard<std::mutex> waiting_thread_lock(waiting_thread->mutex);
+    waiting_thread->update_status(ThreadStatus::run, ThreadStatus::wait);
+
+    mutex->waiting_threads->pop();
+    mutex->lock_count = waiting_thread_data.lock_count;
+    mutex->owner = waiting_thread;
+
+    workarea->lockCount = waiting_thread_data.lock_count;
+    owner.store(waiting_thread->id | (mutex->waiting_threads->empty() ? 0 : LW_MUTEX_WAITERS));
+
+    return SCE_KERNEL_OK;
+}
+
+inline static int mutex_unlock_impl(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, int unlock_count, MutexPtr &mutex, SyncWeight weight) {
+    if (weight == SyncWeight::Light && kernel.lwmutex_fast_path.enabled)
+        return lw_mutex_unlock_impl(mem, export_name, thread_id, unlock_count, mutex);
+
     const ThreadStatePtr current_thread = kernel.get_thread(thread_id);
 
     const std::lock_guard<std::mutex> mutex_lock(mutex->mutex);
@@ -742,7 +847,7 @@ inline static int mutex_unlock_impl(KernelState &kernel, const char *export_name
     return SCE_KERNEL_OK;
 }
 
-int mutex_unlock(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID mutexid, int unlock_count, SyncWeight weight) {
+int mutex_unlock(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, SceUID mutexid, int unlock_count, SyncWeight weight) {
     assert(mutexid >= 0);
 
     MutexPtr mutex;
@@ -755,7 +860,7 @@ int mutex_unlock(KernelState &kernel, const char *export_name, SceUID thread_id,
             mutex->waiting_threads->size());
     }
 
-    return mutex_unlock_impl(kernel, export_name, thread_id, unlock_count, mutex);
+    return mutex_unlock_impl(kernel, mem, export_name, thread_id, unlock_count, mutex, weight);
 }
 
 int mutex_delete(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID mutexid, SyncWeight weight) {
@@ -773,7 +878,6 @@ int mutex_delete(KernelState &kernel, const char *export_name, SceUID thread_id,
     }
 
     if (mutex->waiting_threads->empty()) {
-        const std::lock_guard<std::mutex> kernel_guard(kernel.mutex);
         mutexes->erase(mutexid);
     } else {
         // TODO:
@@ -809,7 +913,9 @@ SceUID rwlock_create(KernelState &kernel, MemState &mem, const char *export_name
     }
 
     const RWLockPtr rwlock = std::make_shared<RWLock>();
-    const SceUID uid = kernel.get_next_uid();
+    const SceUID uid = kernel.rwlocks.reserve();
+    if (uid < 0)
+        return RET_ERROR(SCE_KERNEL_ERROR_UID_MAX_OPEN);
     rwlock->uid = uid;
     strncpy(rwlock->name, name, KERNELOBJECT_MAX_NAME_LENGTH);
     rwlock->attr = attr;
@@ -820,7 +926,6 @@ SceUID rwlock_create(KernelState &kernel, MemState &mem, const char *export_name
         rwlock->waiting_threads = std::make_unique<FIFOThreadDataQueue<WaitingThreadData>>();
     }
 
-    const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
     kernel.rwlocks.emplace(uid, rwlock);
 
     if (LOG_SYNC_PRIMITIVES) {
@@ -833,7 +938,7 @@ SceUID rwlock_create(KernelState &kernel, MemState &mem, const char *export_name
 
 SceInt32 rwlock_lock(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, SceUID lock_id, uint32_t *timeout, bool is_write) {
     const ThreadStatePtr thread = kernel.get_thread(thread_id);
-    const RWLockPtr rwlock = lock_and_find(lock_id, kernel.rwlocks, kernel.mutex);
+    const RWLockPtr rwlock = kernel.rwlocks.get(lock_id);
 
     if (!rwlock)
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_RW_LOCK_ID);
@@ -881,13 +986,13 @@ SceInt32 rwlock_lock(KernelState &kernel, MemState &mem, const char *export_name
         const auto data_it = rwlock->waiting_threads->push(data);
         thread_lock.unlock();
 
-        return handle_timeout(thread, thread_lock, rwlock_lock, rwlock->waiting_threads, data_it, export_name, timeout);
+        return handle_timeout(kernel, thread, thread_lock, rwlock_lock, rwlock->waiting_threads, data_it, export_name, timeout);
     }
 }
 
 SceInt32 rwlock_unlock(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, SceUID lock_id, bool is_write) {
     const ThreadStatePtr current_thread = kernel.get_thread(thread_id);
-    const RWLockPtr rwlock = lock_and_find(lock_id, kernel.rwlocks, kernel.mutex);
+    const RWLockPtr rwlock = kernel.rwlocks.get(lock_id);
 
     if (!rwlock)
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_RW_LOCK_ID);
@@ -949,7 +1054,7 @@ SceInt32 rwlock_unlock(KernelState &kernel, MemState &mem, const char *export_na
 
 SceInt32 rwlock_delete(KernelState &kernel, MemState &mem, const char *export_name, SceUID thread_id, SceUID lock_id) {
     const ThreadStatePtr thread = kernel.get_thread(thread_id);
-    const RWLockPtr rwlock = lock_and_find(lock_id, kernel.rwlocks, kernel.mutex);
+    const RWLockPtr rwlock = kernel.rwlocks.get(lock_id);
 
     if (!rwlock)
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_RW_LOCK_ID);
@@ -961,7 +1066,6 @@ SceInt32 rwlock_delete(KernelState &kernel, MemState &mem, const char *export_na
     }
 
     if (rwlock->waiting_threads->empty()) {
-        const std::lock_guard<std::mutex> kernel_guard(kernel.mutex);
         kernel.rwlocks.erase(lock_id);
     } else {
         // TODO:
@@ -981,7 +1085,9 @@ SceUID semaphore_create(KernelState &kernel, const char *export_name, const char
     }
 
     const SemaphorePtr semaphore = std::make_shared<Semaphore>();
-    const SceUID uid = kernel.get_next_uid();
+    const SceUID uid = kernel.semaphores.reserve();
+    if (uid < 0)
+        return RET_ERROR(SCE_KERNEL_ERROR_UID_MAX_OPEN);
     semaphore->uid = uid;
     semaphore->init_val = init_val;
     semaphore->val = init_val;
@@ -1000,7 +1106,6 @@ SceUID semaphore_create(KernelState &kernel, const char *export_name, const char
             export_name, uid, thread_id, name, attr, init_val, max_val);
     }
 
-    const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
     kernel.semaphores.emplace(uid, semaphore);
 
     return uid;
@@ -1013,14 +1118,12 @@ SceUID semaphore_find(KernelState &kernel, const char *export_name, const char *
     if (LOG_SYNC_PRIMITIVES)
         LOG_DEBUG("{}: name: \"{}\"", export_name, pName);
 
-    const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
-
-    const auto it = std::find_if(kernel.semaphores.begin(), kernel.semaphores.end(), [=](const auto &sema) {
-        return strncmp(sema.second->name, pName, KERNELOBJECT_MAX_NAME_LENGTH) == 0;
+    const SceUID uid = kernel.semaphores.find_if([=](const auto &sema) {
+        return strncmp(sema->name, pName, KERNELOBJECT_MAX_NAME_LENGTH) == 0;
     });
 
-    if (it != kernel.semaphores.end())
-        return it->first;
+    if (uid)
+        return uid;
 
     return RET_ERROR(SCE_KERNEL_ERROR_UID_CANNOT_FIND_BY_NAME);
 }
@@ -1029,7 +1132,7 @@ SceInt32 semaphore_wait(KernelState &kernel, const char *export_name, SceUID thr
     assert(semaId >= 0);
 
     // TODO Don't lock twice.
-    const SemaphorePtr semaphore = lock_and_find(semaId, kernel.semaphores, kernel.mutex);
+    const SemaphorePtr semaphore = kernel.semaphores.get(semaId);
     if (!semaphore) {
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_SEMA_ID);
     }
@@ -1059,7 +1162,7 @@ SceInt32 semaphore_wait(KernelState &kernel, const char *export_name, SceUID thr
         const auto data_it = semaphore->waiting_threads->push(data);
         thread_lock.unlock();
 
-        auto res = handle_timeout(thread, thread_lock, semaphore_lock, semaphore->waiting_threads, data_it, export_name, pTimeout);
+        auto res = handle_timeout(kernel, thread, thread_lock, semaphore_lock, semaphore->waiting_threads, data_it, export_name, pTimeout);
         if (was_canceled)
             res = SCE_KERNEL_ERROR_WAIT_CANCEL;
         return res;
@@ -1074,7 +1177,7 @@ int semaphore_signal(KernelState &kernel, const char *export_name, SceUID thread
     assert(semaid >= 0);
 
     // TODO Don't lock twice.
-    const SemaphorePtr semaphore = lock_and_find(semaid, kernel.semaphores, kernel.mutex);
+    const SemaphorePtr semaphore = kernel.semaphores.get(semaid);
     if (!semaphore) {
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_SEMA_ID);
     }
@@ -1115,7 +1218,7 @@ int semaphore_delete(KernelState &kernel, const char *export_name, SceUID thread
     assert(semaid >= 0);
 
     // TODO: Don't lock twice
-    const SemaphorePtr semaphore = lock_and_find(semaid, kernel.semaphores, kernel.mutex);
+    const SemaphorePtr semaphore = kernel.semaphores.get(semaid);
     if (!semaphore) {
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_SEMA_ID);
     }
@@ -1127,7 +1230,6 @@ int semaphore_delete(KernelState &kernel, const char *export_name, SceUID thread
     }
 
     if (semaphore->waiting_threads->empty()) {
-        const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
         kernel.semaphores.erase(semaid);
     } else {
         // TODO:
@@ -1141,7 +1243,7 @@ int semaphore_cancel(KernelState &kernel, const char *export_name, SceUID thread
     assert(semaid >= 0);
 
     // TODO: Don't lock twice
-    const SemaphorePtr semaphore = lock_and_find(semaid, kernel.semaphores, kernel.mutex);
+    const SemaphorePtr semaphore = kernel.semaphores.get(semaid);
     if (!semaphore) {
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_SEMA_ID);
     }
@@ -1195,7 +1297,9 @@ SceUID condvar_create(SceUID *uid_out, KernelState &kernel, const char *export_n
     if (auto error = find_mutex(assoc_mutex, nullptr, kernel, export_name, assoc_mutexid, weight))
         return error;
 
-    const SceUID uid = kernel.get_next_uid();
+    const SceUID uid = get_condvars(kernel, weight).reserve();
+    if (uid < 0)
+        return RET_ERROR(SCE_KERNEL_ERROR_UID_MAX_OPEN);
 
     if (LOG_SYNC_PRIMITIVES) {
         LOG_DEBUG("{}: uid: {} thread_id: {} name: \"{}\" attr: {} assoc_mutexid: {}",
@@ -1213,9 +1317,7 @@ SceUID condvar_create(SceUID *uid_out, KernelState &kernel, const char *export_n
         condvar->waiting_threads = std::make_unique<FIFOThreadDataQueue<WaitingThreadData>>();
     }
 
-    const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
-    auto &condvars = get_condvars(kernel, weight);
-    condvars.emplace(uid, condvar);
+    get_condvars(kernel, weight).emplace(uid, condvar);
 
     if (uid_out)
         *uid_out = uid;
@@ -1240,7 +1342,7 @@ int condvar_wait(KernelState &kernel, MemState &mem, const char *export_name, Sc
 
     std::unique_lock<std::mutex> condition_variable_lock(condvar->mutex);
 
-    if (auto error = mutex_unlock_impl(kernel, export_name, thread_id, 1, condvar->associated_mutex))
+    if (auto error = mutex_unlock_impl(kernel, mem, export_name, thread_id, 1, condvar->associated_mutex, weight))
         return error;
 
     std::unique_lock<std::mutex> thread_lock(thread->mutex);
@@ -1253,7 +1355,7 @@ int condvar_wait(KernelState &kernel, MemState &mem, const char *export_name, Sc
     const auto data_it = condvar->waiting_threads->push(data);
     thread_lock.unlock();
 
-    if (auto error = handle_timeout(thread, thread_lock, condition_variable_lock, condvar->waiting_threads, data_it, export_name, timeout))
+    if (auto error = handle_timeout(kernel, thread, thread_lock, condition_variable_lock, condvar->waiting_threads, data_it, export_name, timeout))
         return error;
 
     condition_variable_lock.unlock();
@@ -1280,7 +1382,7 @@ int condvar_signal(KernelState &kernel, const char *export_name, SceUID thread_i
     auto &waiting_threads = condvar->waiting_threads;
 
     if (target_type == Condvar::SignalTarget::Type::Specific) {
-        ThreadStatePtr waiting_thread = lock_and_find(signal_target.thread_id, kernel.threads, kernel.mutex);
+        ThreadStatePtr waiting_thread = kernel.get_thread(signal_target.thread_id);
         // Search for specified waiting thread
         auto waiting_thread_iter = waiting_threads->find(waiting_thread);
         if (waiting_thread_iter != waiting_threads->end()) {
@@ -1322,7 +1424,6 @@ int condvar_delete(KernelState &kernel, const char *export_name, SceUID thread_i
     }
 
     if (condvar->waiting_threads->empty()) {
-        const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
         condvars->erase(condid);
     } else {
         // TODO:
@@ -1337,7 +1438,7 @@ int condvar_delete(KernelState &kernel, const char *export_name, SceUID thread_i
 // **************
 
 SceUID eventflag_clear(KernelState &kernel, const char *export_name, SceUID evfId, SceUInt32 bitPattern) {
-    const EventFlagPtr event = lock_and_find(evfId, kernel.eventflags, kernel.mutex);
+    const EventFlagPtr event = kernel.eventflags.get(evfId);
     if (!event) {
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_EVF_ID);
     }
@@ -1359,7 +1460,9 @@ SceUID eventflag_create(KernelState &kernel, const char *export_name, SceUID thr
         return RET_ERROR(SCE_KERNEL_ERROR_UID_NAME_TOO_LONG);
     }
 
-    const SceUID uid = kernel.get_next_uid();
+    const SceUID uid = kernel.eventflags.reserve();
+    if (uid < 0)
+        return RET_ERROR(SCE_KERNEL_ERROR_UID_MAX_OPEN);
 
     if (LOG_SYNC_PRIMITIVES) {
         LOG_DEBUG("{}: uid: {} thread_id: {} name: \"{}\" attr: {} bitPattern: {:#b}",
@@ -1377,7 +1480,6 @@ SceUID eventflag_create(KernelState &kernel, const char *export_name, SceUID thr
         event->waiting_threads = std::make_unique<FIFOThreadDataQueue<WaitingThreadData>>();
     }
 
-    const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
     kernel.eventflags.emplace(uid, event);
 
     return uid;
@@ -1390,14 +1492,12 @@ SceUID eventflag_find(KernelState &kernel, const char *export_name, const char *
     if (LOG_SYNC_PRIMITIVES)
         LOG_DEBUG("{}: name: \"{}\"", export_name, pName);
 
-    const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
-
-    const auto it = std::find_if(kernel.eventflags.begin(), kernel.eventflags.end(), [=](const auto &evf) {
-        return strncmp(evf.second->name, pName, KERNELOBJECT_MAX_NAME_LENGTH) == 0;
+    const SceUID uid = kernel.eventflags.find_if([=](const auto &evf) {
+        return strncmp(evf->name, pName, KERNELOBJECT_MAX_NAME_LENGTH) == 0;
     });
 
-    if (it != kernel.eventflags.end())
-        return it->first;
+    if (uid)
+        return uid;
 
     return RET_ERROR(SCE_KERNEL_ERROR_UID_CANNOT_FIND_BY_NAME);
 }
@@ -1406,7 +1506,7 @@ static int eventflag_waitorpoll(KernelState &kernel, const char *export_name, Sc
     assert(event_id >= 0);
 
     // TODO Don't lock twice.
-    const EventFlagPtr event = lock_and_find(event_id, kernel.eventflags, kernel.mutex);
+    const EventFlagPtr event = kernel.eventflags.get(event_id);
     if (!event) {
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_EVF_ID);
     }
@@ -1464,7 +1564,7 @@ static int eventflag_waitorpoll(KernelState &kernel, const char *export_name, Sc
         const auto data_it = event->waiting_threads->push(data);
         thread_lock.unlock();
 
-        int err = handle_timeout(thread, thread_lock, event_lock, event->waiting_threads, data_it, export_name, timeout);
+        int err = handle_timeout(kernel, thread, thread_lock, event_lock, event->waiting_threads, data_it, export_name, timeout);
         if (err < 0 && outBits) {
             // set it only if a timeout occurs
             // otherwise set in eventflag_set
@@ -1491,7 +1591,7 @@ SceInt32 eventflag_set(KernelState &kernel, const char *export_name, SceUID thre
     assert(evfId >= 0);
 
     // TODO Don't lock twice.
-    const EventFlagPtr event = lock_and_find(evfId, kernel.eventflags, kernel.mutex);
+    const EventFlagPtr event = kernel.eventflags.get(evfId);
     if (!event) {
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_EVF_ID);
     }
@@ -1547,7 +1647,7 @@ SceInt32 eventflag_set(KernelState &kernel, const char *export_name, SceUID thre
 SceInt32 eventflag_cancel(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID event_id, SceUInt32 pattern, SceUInt32 *num_wait_threads) {
     assert(event_id >= 0);
 
-    const EventFlagPtr event = lock_and_find(event_id, kernel.eventflags, kernel.mutex);
+    const EventFlagPtr event = kernel.eventflags.get(event_id);
     if (!event) {
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_EVF_ID);
     }
@@ -1588,7 +1688,7 @@ SceInt32 eventflag_cancel(KernelState &kernel, const char *export_name, SceUID t
 int eventflag_delete(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID event_id) {
     assert(event_id >= 0);
 
-    const EventFlagPtr event = lock_and_find(event_id, kernel.eventflags, kernel.mutex);
+    const EventFlagPtr event = kernel.eventflags.get(event_id);
     if (!event) {
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_EVF_ID);
     }
@@ -1599,7 +1699,6 @@ int eventflag_delete(KernelState &kernel, const char *export_name, SceUID thread
     }
 
     if (event->waiting_threads->empty()) {
-        const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
         kernel.eventflags.erase(event_id);
     } else {
         // TODO:
@@ -1618,7 +1717,9 @@ SceUID msgpipe_create(KernelState &kernel, const char *export_name, const char *
         return RET_ERROR(SCE_KERNEL_ERROR_UID_NAME_TOO_LONG);
     }
 
-    const SceUID uid = kernel.get_next_uid();
+    const SceUID uid = kernel.msgpipes.reserve();
+    if (uid < 0)
+        return RET_ERROR(SCE_KERNEL_ERROR_UID_MAX_OPEN);
 
     if (LOG_SYNC_PRIMITIVES) {
         LOG_DEBUG("{}: uid: {} thread_id: {} name: \"{}\" attr: {}",
@@ -1640,7 +1741,6 @@ SceUID msgpipe_create(KernelState &kernel, const char *export_name, const char *
     // TODO do senders respect priority?
     msgpipe->senders = std::make_unique<FIFOThreadDataQueue<WaitingThreadData>>();
 
-    const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
     kernel.msgpipes.emplace(uid, msgpipe);
 
     return uid;
@@ -1653,14 +1753,12 @@ SceUID msgpipe_find(KernelState &kernel, const char *export_name, const char *pN
     if (LOG_SYNC_PRIMITIVES)
         LOG_DEBUG("{}: name: \"{}\"", export_name, pName);
 
-    const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
-
-    const auto it = std::find_if(kernel.msgpipes.begin(), kernel.msgpipes.end(), [=](const auto &msg_pipe) {
-        return strncmp(msg_pipe.second->name, pName, KERNELOBJECT_MAX_NAME_LENGTH) == 0;
+    const SceUID uid = kernel.msgpipes.find_if([=](const auto &msg_pipe) {
+        return strncmp(msg_pipe->name, pName, KERNELOBJECT_MAX_NAME_LENGTH) == 0;
     });
 
-    if (it != kernel.msgpipes.end())
-        return it->first;
+    if (uid)
+        return uid;
 
     return RET_ERROR(SCE_KERNEL_ERROR_UID_CANNOT_FIND_BY_NAME);
 }
@@ -1670,7 +1768,7 @@ SceSize msgpipe_recv(KernelState &kernel, const char *export_name, SceUID thread
 
     const bool ASAP = !(waitMode & SCE_KERNEL_MSG_PIPE_MODE_FULL);
 
-    const MsgPipePtr msgpipe = lock_and_find(msgPipeId, kernel.msgpipes, kernel.mutex);
+    const MsgPipePtr msgpipe = kernel.msgpipes.get(msgPipeId);
     if (!msgpipe) {
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_MSG_PIPE_ID);
     }
@@ -1758,7 +1856,7 @@ SceSize msgpipe_recv(KernelState &kernel, const char *export_name, SceUID thread
             return finish();
         } else { // There's a timeout - wait until we can fill buffer or timeout
             msgpipe_lock.unlock(); // Unlock message pipe object, else we'll deadlock
-            auto status = thread->status_cond.wait_for(thread_lock, std::chrono::microseconds{ *pTimeout }, [&] { return thread->status == ThreadStatus::run; });
+            auto status = kernel.timer_wheel.wait_for(thread->status_cond, thread_lock, *pTimeout, [&] { return thread->status == ThreadStatus::run; });
             if (msgpipe->beingDeleted) {
                 std::atomic_fetch_add(&msgpipe->remainingThreads, -1);
                 return SCE_KERNEL_ERROR_WAIT_DELETE;
@@ -1780,7 +1878,7 @@ SceSize msgpipe_send(KernelState &kernel, const char *export_name, SceUID thread
 
     const bool ASAP = !(waitMode & SCE_KERNEL_MSG_PIPE_MODE_FULL);
 
-    const MsgPipePtr msgpipe = lock_and_find(msgPipeId, kernel.msgpipes, kernel.mutex);
+    const MsgPipePtr msgpipe = kernel.msgpipes.get(msgPipeId);
     if (!msgpipe) {
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_MSG_PIPE_ID);
     }
@@ -1862,7 +1960,7 @@ SceSize msgpipe_send(KernelState &kernel, const char *export_name, SceUID thread
             return finish();
         } else { // There's a timeout - wait until we can fill buffer or timeout
             msgpipe_lock.unlock(); // Unlock message pipe object, else we'll deadlock
-            auto status = thread->status_cond.wait_for(thread_lock, std::chrono::microseconds{ *pTimeout }, [&] { return thread->status == ThreadStatus::run; });
+            auto status = kernel.timer_wheel.wait_for(thread->status_cond, thread_lock, *pTimeout, [&] { return thread->status == ThreadStatus::run; });
             if (msgpipe->beingDeleted) {
                 std::atomic_fetch_add(&msgpipe->remainingThreads, -1);
                 return SCE_KERNEL_ERROR_WAIT_DELETE;
@@ -1881,7 +1979,7 @@ SceSize msgpipe_send(KernelState &kernel, const char *export_name, SceUID thread
 SceInt32 msgpipe_delete(KernelState &kernel, const char *export_name, SceUID thread_id, SceUID msgpipe_id) {
     assert(msgpipe_id >= 0);
 
-    const MsgPipePtr msgpipe = lock_and_find(msgpipe_id, kernel.msgpipes, kernel.mutex);
+    const MsgPipePtr msgpipe = kernel.msgpipes.get(msgpipe_id);
     if (!msgpipe) {
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_MSG_PIPE_ID);
     }
@@ -1908,7 +2006,6 @@ SceInt32 msgpipe_delete(KernelState &kernel, const char *export_name, SceUID thr
             std::this_thread::yield();
     }
 
-    const std::lock_guard<std::mutex> kernel_lock(kernel.mutex);
     kernel.msgpipes.erase(msgpipe->uid);
 
     return SCE_KERNEL_OK;
@@ -46,8 +46,6 @@ bool ThreadSignal::send() {
 }
 
 int ThreadState::init(const char *name, Ptr<const void> entry_point, int init_priority, SceInt32 affinity_mask, int stack_size, const SceKernelThreadOptParam *option = nullptr) {
-    constexpr size_t KERNEL_TLS_SIZE = 0x800;
-
     // the stack size should be page-aligned
     stack_size = align(stack_size, KiB(4));
 
@@ -135,6 +133,7 @@ int ThreadState::start(SceSize arglen, const Ptr<void> argp, bool run_entry_call
     std::unique_lock<std::mutex> thread_lock(mutex);
 
     run_start_callback = run_entry_callback;
+    prewarm_jit_cache_pending = true;
     call_level = 1;
     load_context(*cpu, init_cpu_ctx);
     write_pc(*cpu, entry_point);
@@ -187,6 +186,7 @@ void ThreadState::exit_delete(bool exit) {
 bool ThreadState::run_loop() {
     int res = 0;
     int run_level = std::max(call_level, 1);
+    host_thread = std::this_thread::get_id();
 
     std::unique_lock<std::mutex> lock(mutex);
 
@@ -222,6 +222,8 @@ bool ThreadState::run_loop() {
                 run_thread_end_callback();
                 update_status(ThreadStatus::dormant);
             }
+            if (kernel.scheduler)
+                kernel.scheduler->release(*this);
 
             return true;
         case ThreadToDo::run:
@@ -240,6 +242,11 @@ bool ThreadState::run_loop() {
 
             lock.unlock();
 
+            if (prewarm_jit_cache_pending) {
+                prewarm_jit_cache_pending = false;
+                prewarm_jit_cache(*cpu, entry_point);
+            }
+
             if (run_start_callback) {
                 run_start_callback = false;
 
@@ -250,6 +257,9 @@ bool ThreadState::run_loop() {
                 }
             }
 
+            if (kernel.scheduler)
+                kernel.scheduler->acquire(*this);
+
             // Run the cpu
             if (to_do == ThreadToDo::step) {
                 res = step(*cpu);
@@ -258,11 +268,22 @@ bool ThreadState::run_loop() {
             } else
                 res = run(*cpu);
 
+            if (consume_sample(*cpu))
+                kernel.profiler.record(read_pc(*cpu), read_lr(*cpu));
+
             // handle svc call if this was what stopped the cpu
             if (cpu->svc_called) {
-                cpu->protocol->call_svc(*cpu, cpu->svc_called, read_pc(*cpu), *this);
+                in_hle_call = true;
+                cpu->protocol->call_svc(*cpu, cpu->svc, read_pc(*cpu), *this);
+                in_hle_call = false;
+                // a sample requested as the call started would otherwise be given to the code after the svc
+                if (consume_sample(*cpu))
+                    kernel.profiler.record_hle();
             }
 
+            if (kernel.scheduler && kernel.scheduler->should_yield(*this))
+                kernel.scheduler->release(*this);
+
             lock.lock();
 
             // Handle errors
@@ -297,6 +318,8 @@ bool ThreadState::run_loop() {
             }
             break;
         case ThreadToDo::wait:
+            if (kernel.scheduler && kernel.scheduler->should_yield(*this))
+                kernel.scheduler->release(*this);
             something_to_do.wait(lock);
             break;
         case ThreadToDo::suspend:
@@ -388,6 +411,13 @@ void ThreadState::update_status(ThreadStatus status, std::optional<ThreadStatus>
     this->status = status;
     status_cond.notify_all();
 
+    if (kernel.scheduler) {
+        if (status == ThreadStatus::run)
+            kernel.scheduler->wake(*this);
+        else
+            kernel.scheduler->unschedule(*this);
+    }
+
     if (status == ThreadStatus::dormant) {
         raise_waiting_threads();
     }
@@ -0,0 +1,271 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <kernel/timer_wheel.h>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+
+// duration of a slot of the first level, in microseconds
+constexpr uint64_t TICK_US = 32;
+// the service thread spins instead of sleeping when the deadline is closer than this
+constexpr uint64_t SPIN_US = 50;
+
+TimerWheel::TimerWheel(Clock clock)
+    : clock(clock) {
+}
+
+TimerWheel::~TimerWheel() {
+    stop();
+}
+
+uint64_t TimerWheel::now() const {
+    if (clock)
+        return clock();
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void TimerWheel::add(Entry entry) {
+    // nothing can expire while the wheel is empty, so it can skip the time it spent idle
+    if (entries.empty())
+        current_tick = std::max(current_tick, now() / TICK_US);
+
+    const TimerId id = entry.id;
+    const uint64_t deadline = entry.deadline;
+    EntryList new_entry;
+    new_entry.push_back(std::move(entry));
+    const auto it = new_entry.begin();
+    insert(new_entry, it);
+    entries.emplace(id, it);
+
+    if (deadline < planned_wakeup) {
+        wakeup_changed++;
+        cond.notify_one();
+    }
+}
+
+TimerWheel::TimerId TimerWheel::schedule(uint64_t deadline_us, Callback callback) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    if (!clock && !thread.joinable() && !stop_requested)
+        thread = std::thread(&TimerWheel::run, this);
+
+    const TimerId id = next_id++;
+    add({ id, deadline_us, std::move(callback), 0 });
+    return id;
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    std::unique_lock<std::mutex> lock(mutex);
+    // a running callback can ask to be called again, it is only known once it returns
+    callback_done.wait(lock, [&] { return running != id; });
+
+    const auto it = entries.find(id);
+    if (it != entries.end()) {
+        const uint32_t slot = it->second->slot;
+        slots[slot].erase(it->second);
+        if (slot < LEVEL_COUNT * SLOT_COUNT && slots[slot].empty())
+            occupied[slot / SLOT_COUNT] &= ~(1ULL << (slot % SLOT_COUNT));
+        entries.erase(it);
+        return true;
+    }
+
+    const auto expired_it = std::find_if(expired.begin(), expired.end(), [&](const Entry &entry) { return entry.id == id; });
+    if (expired_it != expired.end()) {
+        expired.erase(expired_it);
+        return true;
+    }
+
+    return false;
+}
+
+void TimerWheel::poll() {
+    std::unique_lock<std::mutex> lock(mutex);
+    advance(now());
+    run_expired(lock);
+}
+
+void TimerWheel::stop() {
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        stop_requested = true;
+    }
+    cond.notify_one();
+    if (thread.joinable())
+        thread.join();
+}
+
+// a timer is put in the lowest level whose current window contains its tick
+void TimerWheel::insert(EntryList &from, EntryList::iterator entry) {
+    const uint64_t tick = std::max(entry->deadline / TICK_US, current_tick);
+    uint32_t slot = LEVEL_COUNT * SLOT_COUNT;
+    for (uint32_t level = 0; level < LEVEL_COUNT; level++) {
+        const uint32_t shift = SLOT_BITS * level;
+        if ((tick >> (shift + SLOT_BITS)) == (current_tick >> (shift + SLOT_BITS))) {
+            const uint32_t index = (tick >> shift) % SLOT_COUNT;
+            occupied[level] |= 1ULL << index;
+            slot = level * SLOT_COUNT + index;
+            break;
+        }
+    }
+
+    entry->slot = slot;
+    slots[slot].splice(slots[slot].end(), from, entry);
+}
+
+// move the timers of the slot of the level now reached by current_tick to the lower levels
+void TimerWheel::cascade(uint32_t level) {
+    EntryList list;
+    if (level == LEVEL_COUNT) {
+        list.swap(slots[LEVEL_COUNT * SLOT_COUNT]);
+    } else {
+        const uint32_t index = (current_tick >> (SLOT_BITS * level)) % SLOT_COUNT;
+        list.swap(slots[level * SLOT_COUNT + index]);
+        occupied[level] &= ~(1ULL << index);
+    }
+
+    while (!list.empty())
+        insert(list, list.begin());
+}
+
+void TimerWheel::expire_slot(uint32_t index, uint64_t now_us) {
+    EntryList &list = slots[index];
+    for (auto it = list.begin(); it != list.end();) {
+        if (it->deadline > now_us) {
+            ++it;
+            continue;
+        }
+        entries.erase(it->id);
+        expired.push_back(std::move(*it));
+        it = list.erase(it);
+    }
+
+    if (list.empty())
+        occupied[0] &= ~(1ULL << index);
+}
+
+void TimerWheel::advance(uint64_t now_us) {
+    const uint64_t now_tick = now_us / TICK_US;
+    if (entries.empty()) {
+        current_tick = std::max(current_tick, now_tick);
+        return;
+    }
+
+    while (current_tick < now_tick) {
+        const uint64_t window = current_tick & ~static_cast<uint64_t>(SLOT_COUNT - 1);
+        const uint64_t pending = occupied[0] & (~0ULL << (current_tick % SLOT_COUNT));
+        if (pending) {
+            const uint64_t next_tick = window | std::countr_zero(pending);
+            if (next_tick >= now_tick) {
+                current_tick = now_tick;
+                break;
+            }
+
+            // every timer of a slot before now_tick has expired
+            expire_slot(static_cast<uint32_t>(next_tick % SLOT_COUNT), UINT64_MAX);
+            current_tick = next_tick + 1;
+        } else {
+            current_tick = std::min(window + SLOT_COUNT, now_tick);
+        }
+
+        if (current_tick % SLOT_COUNT == 0) {
+            for (uint32_t level = LEVEL_COUNT; level > 0; level--) {
+                if (current_tick % (1ULL << (SLOT_BITS * level)) == 0)
+                    cascade(level);
+            }
+        }
+    }
+
+    // the timers of the current tick which are due
+    const uint32_t index = current_tick % SLOT_COUNT;
+    if (occupied[0] & (1ULL << index))
+        expire_slot(index, now_us);
+}
+
+uint64_t TimerWheel::next_wakeup() const {
+    if (entries.empty())
+        return UINT64_MAX;
+
+    const uint64_t pending = occupied[0] & (~0ULL << (current_tick % SLOT_COUNT));
+    if (pending) {
+        uint64_t deadline = UINT64_MAX;
+        for (const Entry &entry : slots[std::countr_zero(pending)])
+            deadline = std::min(deadline, entry.deadline);
+        return deadline;
+    }
+
+    // wake up when the first non-empty slot of an upper level has to be cascaded
+    for (uint32_t level = 1; level < LEVEL_COUNT; level++) {
+        const uint32_t shift = SLOT_BITS * level;
+        const uint64_t level_pending = occupied[level] & (~0ULL << ((current_tick >> shift) % SLOT_COUNT));
+        if (level_pending) {
+            const uint64_t window = (current_tick >> (shift + SLOT_BITS)) << (shift + SLOT_BITS);
+            return (window | (static_cast<uint64_t>(std::countr_zero(level_pending)) << shift)) * TICK_US;
+        }
+    }
+
+    const uint32_t shift = SLOT_BITS * LEVEL_COUNT;
+    return (((current_tick >> shift) + 1) << shift) * TICK_US;
+}
+
+void TimerWheel::run_expired(std::unique_lock<std::mutex> &lock) {
+    while (!expired.empty()) {
+        Entry entry = std::move(expired.front());
+        expired.pop_front();
+        running = entry.id;
+        lock.unlock();
+        const bool done = entry.callback();
+        lock.lock();
+        running = 0;
+        if (!done && !stop_requested) {
+            entry.deadline = now() + TICK_US;
+            add(std::move(entry));
+        }
+        callback_done.notify_all();
+    }
+}
+
+void TimerWheel::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stop_requested) {
+        advance(now());
+        if (!expired.empty()) {
+            run_expired(lock);
+            continue;
+        }
+
+        const uint64_t wakeup = next_wakeup();
+        const uint64_t current = now();
+        planned_wakeup = wakeup;
+        if (wakeup == UINT64_MAX) {
+            cond.wait(lock);
+        } else if (wakeup > current + SPIN_US) {
+            cond.wait_for(lock, std::chrono::microseconds(wakeup - current - SPIN_US));
+        } else {
+            // the last microseconds, a timer scheduled earlier in the meantime ends the spin
+            const uint32_t generation = wakeup_changed;
+            lock.unlock();
+            while (now() < wakeup && wakeup_changed == generation)
+                std::this_thread::yield();
+            lock.lock();
+        }
+        planned_wakeup = UINT64_MAX;
+    }
+}
@@ -0,0 +1,140 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <kernel/handle_table.h>
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <thread>
+
+struct Object {
+    SceUID uid;
+};
+
+static SceUID create(HandleTable<Object> &table) {
+    const SceUID uid = table.reserve();
+    table.emplace(uid, std::make_shared<Object>(Object{ uid }));
+    return uid;
+}
+
+TEST(handle_table, get_after_emplace) {
+    HandleTable<Object> table(HandleTag::mutex);
+    const SceUID uid = table.reserve();
+    ASSERT_GT(uid, 0);
+    // reserved but not emplaced yet
+    ASSERT_EQ(table.get(uid), nullptr);
+
+    table.emplace(uid, std::make_shared<Object>(Object{ uid }));
+    ASSERT_NE(table.get(uid), nullptr);
+    ASSERT_EQ(table.get(uid)->uid, uid);
+    ASSERT_EQ(table.size(), 1);
+
+    ASSERT_TRUE(table.erase(uid));
+    ASSERT_EQ(table.get(uid), nullptr);
+    ASSERT_FALSE(table.erase(uid));
+    ASSERT_EQ(table.size(), 0);
+}
+
+TEST(handle_table, stale_uid_is_rejected_after_reuse) {
+    HandleTable<Object> table(HandleTag::mutex);
+    const SceUID old_uid = create(table);
+    ASSERT_TRUE(table.erase(old_uid));
+
+    // the only free slot is reused with another generation
+    const SceUID new_uid = create(table);
+    ASSERT_NE(new_uid, old_uid);
+    ASSERT_EQ(new_uid & 0xFFFF, old_uid & 0xFFFF);
+    ASSERT_EQ(table.get(old_uid), nullptr);
+    ASSERT_FALSE(table.erase(old_uid));
+    ASSERT_EQ(table.get(new_uid)->uid, new_uid);
+}
+
+TEST(handle_table, uid_of_other_table_is_rejected) {
+    HandleTable<Object> mutexes(HandleTag::mutex);
+    HandleTable<Object> semaphores(HandleTag::semaphore);
+    const SceUID mutex_uid = create(mutexes);
+    const SceUID semaphore_uid = create(semaphores);
+    ASSERT_NE(mutex_uid, semaphore_uid);
+    ASSERT_EQ(semaphores.get(mutex_uid), nullptr);
+    ASSERT_EQ(mutexes.get(semaphore_uid), nullptr);
+    ASSERT_FALSE(semaphores.erase(mutex_uid));
+    ASSERT_NE(mutexes.get(mutex_uid), nullptr);
+}
+
+TEST(handle_table, generation_wraps_around) {
+    HandleTable<Object> table(HandleTag::mutex);
+    const SceUID first_uid = create(table);
+    ASSERT_TRUE(table.erase(first_uid));
+
+    // every generation of the slot gives a different uid until the generation wraps around
+    std::set<SceUID> uids = { first_uid };
+    SceUID uid;
+    while (true) {
+        uid = create(table);
+        if (uid == first_uid)
+            break;
+        ASSERT_TRUE(uids.insert(uid).second);
+        ASSERT_EQ(table.get(first_uid), nullptr);
+        ASSERT_TRUE(table.erase(uid));
+    }
+
+    ASSERT_EQ(uids.size(), 1024);
+    ASSERT_EQ(table.get(uid)->uid, uid);
+}
+
+TEST(handle_table, concurrent_lookup_and_close) {
+    constexpr int OBJECT_COUNT = 64;
+    constexpr int ROUNDS = 2000;
+    HandleTable<Object> table(HandleTag::mutex);
+
+    std::vector<std::atomic<SceUID>> uids(OBJECT_COUNT);
+    for (auto &uid : uids)
+        uid = create(table);
+
+    std::atomic<bool> done = false;
+    std::atomic<int> bad_lookups = 0;
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; i++) {
+        readers.emplace_back([&] {
+            while (!done) {
+                for (const auto &uid_slot : uids) {
+                    const SceUID uid = uid_slot;
+                    // the object may have been closed in the meantime, but never replaced by another one
+                    const auto object = table.get(uid);
+                    if (object && object->uid != uid)
+                        bad_lookups++;
+                }
+            }
+        });
+    }
+
+    for (int round = 0; round < ROUNDS; round++) {
+        for (auto &uid : uids) {
+            ASSERT_TRUE(table.erase(uid));
+            uid = create(table);
+        }
+    }
+    done = true;
+    for (auto &reader : readers)
+        reader.join();
+
+    ASSERT_EQ(bad_lookups, 0);
+    ASSERT_EQ(table.size(), OBJECT_COUNT);
+    for (const auto &uid : uids)
+        ASSERT_EQ(table.get(uid)->uid, uid);
+}
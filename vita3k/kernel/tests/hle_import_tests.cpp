@@ -0,0 +1,38 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <kernel/cpu_protocol.h>
+
+#include <gtest/gtest.h>
+
+static void dummy_import(EmuEnvState &, CPUState &, SceUID) {
+}
+
+TEST(hle_imports, svc_index_is_checked) {
+    HleImportTable imports;
+    imports.add(0x12345678, dummy_import);
+    imports.add(0x9ABCDEF0, dummy_import);
+
+    EXPECT_EQ(imports.index_from_svc(HLE_IMPORT_SVC_FLAG | 0), 0);
+    EXPECT_EQ(imports.index_from_svc(HLE_IMPORT_SVC_FLAG | 1), 1);
+    EXPECT_EQ(imports.find(0x9ABCDEF0), 1);
+
+    // any svc immediate can be used by the guest
+    EXPECT_EQ(imports.index_from_svc(HLE_IMPORT_SVC_FLAG | 2), std::nullopt);
+    EXPECT_EQ(imports.index_from_svc(HLE_IMPORT_SVC_FLAG | 0x7FFFFF), std::nullopt);
+    EXPECT_EQ(HleImportTable().index_from_svc(HLE_IMPORT_SVC_FLAG), std::nullopt);
+}
@@ -0,0 +1,83 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <kernel/scheduler.h>
+#include <kernel/state.h>
+#include <kernel/thread/thread_state.h>
+#include <mem/state.h>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+
+class thread_scheduler : public ::testing::Test {
+protected:
+    // a guest thread run by the test thread
+    std::unique_ptr<ThreadState> create_thread(SceUID id) {
+        auto thread = std::make_unique<ThreadState>(id, kernel, mem);
+        thread->priority = 160;
+        thread->affinity_mask = 0;
+        thread->host_thread = std::this_thread::get_id();
+        return thread;
+    }
+
+    KernelState kernel;
+    MemState mem;
+    ThreadScheduler scheduler{ 1 };
+};
+
+TEST_F(thread_scheduler, owner_releases_core_right_away) {
+    const auto thread = create_thread(1);
+    scheduler.acquire(*thread);
+    ASSERT_EQ(thread->scheduler_core, 0);
+
+    scheduler.unschedule(*thread);
+    ASSERT_EQ(thread->scheduler_core, ThreadState::NO_CORE);
+
+    // the core is free again
+    const auto other = create_thread(2);
+    scheduler.acquire(*other);
+    ASSERT_EQ(other->scheduler_core, 0);
+}
+
+TEST_F(thread_scheduler, other_thread_only_requests_release) {
+    const auto thread = create_thread(1);
+    scheduler.acquire(*thread);
+
+    // for example a thread suspending or deleting another one
+    std::thread([&] { scheduler.unschedule(*thread); }).join();
+    ASSERT_EQ(thread->scheduler_core, 0);
+    ASSERT_TRUE(scheduler.should_yield(*thread));
+
+    // done by run_loop once the thread leaves the cpu
+    scheduler.release(*thread);
+    ASSERT_EQ(thread->scheduler_core, ThreadState::NO_CORE);
+    ASSERT_FALSE(scheduler.should_yield(*thread));
+}
+
+TEST_F(thread_scheduler, wake_cancels_release_request) {
+    const auto thread = create_thread(1);
+    scheduler.acquire(*thread);
+
+    std::thread([&] {
+        scheduler.unschedule(*thread);
+        scheduler.wake(*thread);
+    }).join();
+    ASSERT_EQ(thread->scheduler_core, 0);
+    ASSERT_FALSE(scheduler.should_yield(*thread));
+}
@@ -0,0 +1,196 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <kernel/timer_wheel.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <vector>
+
+static uint64_t fake_time = 0;
+
+static uint64_t fake_clock() {
+    return fake_time;
+}
+
+class timer_wheel : public ::testing::Test {
+protected:
+    void SetUp() override {
+        fake_time = 1'000'000;
+    }
+
+    TimerWheel::TimerId add(uint64_t delay) {
+        const uint64_t deadline = fake_time + delay;
+        return wheel.schedule(deadline, [this, deadline] {
+            EXPECT_GE(fake_time, deadline);
+            fired.push_back(deadline);
+            return true;
+        });
+    }
+
+    TimerWheel wheel{ fake_clock };
+    std::vector<uint64_t> fired;
+};
+
+TEST_F(timer_wheel, cancelled_timer_does_not_fire) {
+    const TimerWheel::TimerId id = add(1000);
+    EXPECT_TRUE(wheel.cancel(id));
+
+    fake_time += 2000;
+    wheel.poll();
+    EXPECT_TRUE(fired.empty());
+    EXPECT_FALSE(wheel.cancel(id));
+}
+
+TEST_F(timer_wheel, cancel_after_expiry_fails) {
+    const TimerWheel::TimerId id = add(1000);
+    fake_time += 1000;
+    wheel.poll();
+    ASSERT_EQ(fired.size(), 1);
+    EXPECT_FALSE(wheel.cancel(id));
+}
+
+TEST_F(timer_wheel, expires_in_order_across_levels) {
+    // one timer for each level of the wheel and one in the overflow list
+    const uint64_t start = fake_time;
+    const std::vector<uint64_t> delays = { 100, 5'000, 200'000, 10'000'000, 600'000'000 };
+    for (auto it = delays.rbegin(); it != delays.rend(); ++it)
+        add(*it);
+
+    for (const uint64_t delay : delays) {
+        const size_t count = fired.size();
+        fake_time = start + delay - 1;
+        wheel.poll();
+        EXPECT_EQ(fired.size(), count);
+
+        fake_time = start + delay;
+        wheel.poll();
+        ASSERT_EQ(fired.size(), count + 1);
+        EXPECT_EQ(fired.back(), start + delay);
+    }
+}
+
+TEST_F(timer_wheel, expires_after_many_small_steps) {
+    // the cascades happen one tick at a time instead of in one jump
+    const uint64_t start = fake_time;
+    add(3'000);
+    add(150'000);
+    while (fake_time < start + 150'000) {
+        fake_time += 997;
+        wheel.poll();
+    }
+    EXPECT_EQ(fired, (std::vector<uint64_t>{ start + 3'000, start + 150'000 }));
+}
+
+TEST_F(timer_wheel, failed_callback_is_retried) {
+    int calls = 0;
+    const TimerWheel::TimerId id = wheel.schedule(fake_time + 100, [&] {
+        calls++;
+        return calls == 2;
+    });
+
+    fake_time += 100;
+    wheel.poll();
+    EXPECT_EQ(calls, 1);
+    wheel.poll();
+    EXPECT_EQ(calls, 1);
+
+    fake_time += 100;
+    wheel.poll();
+    EXPECT_EQ(calls, 2);
+
+    fake_time += 100;
+    wheel.poll();
+    EXPECT_EQ(calls, 2);
+    EXPECT_FALSE(wheel.cancel(id));
+}
+
+TEST_F(timer_wheel, retried_callback_can_be_cancelled) {
+    int calls = 0;
+    const TimerWheel::TimerId id = wheel.schedule(fake_time + 100, [&] {
+        calls++;
+        return false;
+    });
+
+    fake_time += 100;
+    wheel.poll();
+    EXPECT_TRUE(wheel.cancel(id));
+
+    fake_time += 100;
+    wheel.poll();
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(timer_wheel_wait, times_out) {
+    TimerWheel wheel;
+    std::mutex mutex;
+    std::condition_variable cond;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    EXPECT_FALSE(wheel.wait_for(cond, lock, 2'000, [] { return false; }));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::microseconds(2'000));
+    EXPECT_TRUE(lock.owns_lock());
+}
+
+TEST(timer_wheel_wait, wakes_up_on_predicate) {
+    TimerWheel wheel;
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool ready = false;
+
+    std::thread signaler([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const std::lock_guard<std::mutex> guard(mutex);
+        ready = true;
+        cond.notify_all();
+    });
+
+    const auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    EXPECT_TRUE(wheel.wait_for(cond, lock, 60'000'000, [&] { return ready; }));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(30));
+    lock.unlock();
+    signaler.join();
+}
+
+TEST(timer_wheel_wait, busy_mutex_does_not_block_other_timers) {
+    TimerWheel wheel;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::atomic<bool> other_fired = false;
+
+    std::thread waiter([&] {
+        std::unique_lock<std::mutex> lock(mutex);
+        wheel.wait_for(cond, lock, 1'000, [] { return false; });
+    });
+
+    // hold the mutex of the waiter while its timeout expires
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::unique_lock<std::mutex> lock(mutex);
+    wheel.schedule(wheel.now() + 2'000, [&] {
+        other_fired = true;
+        return true;
+    });
+    const auto start = std::chrono::steady_clock::now();
+    while (!other_fired && std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_TRUE(other_fired);
+    lock.unlock();
+    waiter.join();
+}
@@ -232,6 +232,7 @@ struct LangState {
     };
     std::map<std::string, std::string> compile_shaders = {
         { "compiling_shaders", "Compiling Shaders" },
+        { "compiling_pipelines", "Compiling Pipelines" },
         { "pipelines_compiled", "{} pipelines compiled" },
         { "shaders_compiled", "{} shaders compiled" }
     };
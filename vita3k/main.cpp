@@ -37,6 +37,7 @@
 #include <renderer/functions.h>
 #include <renderer/shaders.h>
 #include <renderer/state.h>
+#include <renderer/texture_pack.h>
 #include <shader/spirv_recompiler.h>
 #include <util/log.h>
 #include <util/string_utils.h>
@@ -139,6 +140,16 @@ int main(int argc, char *argv[]) {
                 LOG_INFO("Recompiling {}", *cfg.recompile_shader_path);
                 shader::convert_gxp_to_glsl_from_filepath(*cfg.recompile_shader_path);
             }
+            if (cfg.pack_textures_path.has_value()) {
+                // a separator at the end would put the pack inside the folder
+                std::string folder_path = *cfg.pack_textures_path;
+                while (folder_path.size() > 1 && (folder_path.back() == '/' || folder_path.back() == '\\'))
+                    folder_path.pop_back();
+
+                const fs::path folder = fs_utils::utf8_to_path(folder_path);
+                LOG_INFO("Packing the textures of {}", folder);
+                renderer::create_texture_pack(folder, fs_utils::path_concat(folder, ".vtp"));
+            }
             if (cfg.delete_title_id.has_value()) {
                 LOG_INFO("Deleting title id {}", *cfg.delete_title_id);
                 fs::remove_all(cfg.get_pref_path() / "ux0/app" / *cfg.delete_title_id);
@@ -389,15 +400,33 @@ int main(int argc, char *argv[]) {
 
     // Pre-Compile Shaders
     emuenv.renderer->set_app(emuenv.io.title_id.c_str(), emuenv.self_name.c_str());
-    if (renderer::get_shaders_cache_hashs(*emuenv.renderer) && cfg.shader_cache) {
+    if (renderer::get_shaders_cache_hashs(*emuenv.renderer, cfg.shader_cache) && cfg.shader_cache) {
         SDL_SetWindowTitle(emuenv.window.get(), fmt::format("{} | {} ({}) | Please wait, compiling shaders...", window_title, emuenv.current_app_title, emuenv.io.title_id).c_str());
-        for (const auto &hash : emuenv.renderer->shaders_cache_hashs) {
+        const uint32_t programs_count = static_cast<uint32_t>(emuenv.renderer->shaders_cache_hashs.size());
+        // backends able to do so load all the shaders on worker threads, the other ones load them one by one here
+        const bool precompiling_async = emuenv.renderer->precompile_shaders_async();
+        size_t next_program = 0;
+        while (precompiling_async ? (emuenv.renderer->programs_count_pre_compiled < programs_count) : (next_program < programs_count)) {
+            handle_events(emuenv, gui);
+            gui::draw_begin(gui, emuenv);
+            draw_app_background(gui, emuenv);
+
+            if (!precompiling_async)
+                emuenv.renderer->precompile_shader(emuenv.renderer->shaders_cache_hashs[next_program++]);
+            gui::draw_pre_compiling_shaders_progress(gui, emuenv, emuenv.renderer->programs_count_pre_compiled, programs_count);
+
+            gui::draw_end(gui);
+            emuenv.renderer->swap_window(emuenv.window.get());
+        }
+
+        // Compile the pipelines used during the previous boots before the first frame
+        const uint32_t pipelines_count = emuenv.renderer->warm_up_pipelines();
+        while (emuenv.renderer->get_warmed_up_pipelines_count() < pipelines_count) {
             handle_events(emuenv, gui);
             gui::draw_begin(gui, emuenv);
             draw_app_background(gui, emuenv);
 
-            emuenv.renderer->precompile_shader(hash);
-            gui::draw_pre_compiling_shaders_progress(gui, emuenv, static_cast<uint32_t>(emuenv.renderer->shaders_cache_hashs.size()));
+            gui::draw_pre_compiling_shaders_progress(gui, emuenv, emuenv.renderer->get_warmed_up_pipelines_count(), pipelines_count, true);
 
             gui::draw_end(gui);
             emuenv.renderer->swap_window(emuenv.window.get());
@@ -470,6 +499,11 @@ int main(int argc, char *argv[]) {
 #endif
 
     emuenv.renderer->preclose_action();
+    emuenv.kernel.jit_cache.save();
+    if (emuenv.kernel.profiler.is_running())
+        emuenv.kernel.profiler.save(emuenv.kernel, emuenv.log_path / "profiles", emuenv.io.title_id);
+    if (emuenv.cfg.perf_map)
+        save_perf_map(emuenv.kernel, emuenv.cache_path / "jit");
     app::destroy(emuenv, gui.imgui_state.get());
 
     if (emuenv.load_exec)
@@ -17,15 +17,35 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <vector>
 
+// Bits set to 1 are free, offset 0 being the most significant bit of the first word.
 struct BitmapAllocator {
     std::vector<std::uint32_t> words;
     std::size_t max_offset;
 
 protected:
+    // One bit per word, set if the word may have free bits, so that the search can skip
+    // allocated regions 64 words at a time. It is exact for every word written by the
+    // allocator, words only written directly (in tests) are checked and fixed when reached.
+    std::vector<std::uint64_t> summary;
+
+    // Free-run-length hints: no run of at least n free bits starts before run_hints[n - 1],
+    // the last one being used for all the longer runs. The search starts from there, which
+    // skips the fragmented regions whose holes are too small.
+    static constexpr std::uint32_t RUN_HINT_COUNT = 64;
+    std::array<std::uint32_t, RUN_HINT_COUNT> run_hints = {};
+
     int force_fill(const std::uint32_t offset, const std::uint32_t size, const bool or_mode = false);
+    void update_summary(const std::size_t word_index);
+    void rebuild_summary();
+    void update_run_hints(const std::uint32_t hint_index, const std::uint32_t offset);
+    // first free bit at or after offset, words.size() * 32 if there is none
+    std::uint32_t find_free(const std::uint32_t offset);
+    // first used bit at or after offset, stops at any offset past limit when the run is longer
+    std::uint32_t find_used(const std::uint32_t offset, const std::uint32_t limit) const;
 
 public:
     BitmapAllocator() = default;
@@ -37,12 +37,21 @@ enum struct MemPerm {
     ReadWrite = ReadOnly | WriteOnly
 };
 
-bool init(MemState &state, const bool use_page_table);
+bool init(MemState &state, const bool use_page_table, const bool use_huge_pages = false);
 Address alloc(MemState &state, uint32_t size, const char *name, Address start_addr = user_main_memory_start);
 Address alloc_aligned(MemState &state, uint32_t size, const char *name, unsigned int alignment, Address start_addr = user_main_memory_start);
 void protect_inner(MemState &state, Address addr, uint32_t size, const MemPerm perm);
 void unprotect_inner(MemState &state, Address addr, uint32_t size);
 bool add_protect(MemState &state, Address addr, const uint32_t size, const MemPerm perm, const ProtectCallback &callback);
+// write protect a range page by page: a write fault only unprotects the faulting page, the block stays registered
+// and its callback is called again for the next page written to. The block is dropped if the callback returns false
+bool add_page_protect(MemState &state, Address addr, const uint32_t size, const ProtectCallback &callback);
+// protect again pages of a range registered with add_page_protect
+void reprotect_pages(MemState &state, Address addr, const uint32_t size);
+// each 4 KiB page has a generation which is increased every time the page is written to by the HLE
+// or stops being protected, so it only reflects guest writes for pages kept protected
+void mark_pages_written(MemState &state, Address addr, uint32_t size);
+uint32_t get_page_generation(const MemState &state, Address addr);
 void open_access_parent_protect_segment(MemState &state, Address addr);
 void close_access_parent_protect_segment(MemState &state, Address addr);
 void add_external_mapping(MemState &mem, Address addr, uint32_t size, uint8_t *addr_ptr);
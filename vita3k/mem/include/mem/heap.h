@@ -0,0 +1,118 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <mem/util.h>
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+struct MemState;
+struct GuestHeapThreadCache;
+
+/**
+ * \brief Sub-page heap living in guest memory, backing the HLE malloc family.
+ *
+ * Requests of up to MAX_SMALL_SIZE bytes are served from size-class slabs: page-aligned
+ * arenas of ARENA_SIZE bytes split into equally-sized slots. Each host thread keeps a small
+ * cache of free slots per size class, so most malloc/free pairs never take the heap lock.
+ * Larger requests get pages of their own from the page allocator.
+ *
+ * All the bookkeeping is kept on the host side, so a guest writing to a freed block can not
+ * corrupt the heap itself. Each slot also has a host-side bit telling if the guest owns it, so
+ * invalid and double frees are rejected before the slot reaches a thread cache.
+ */
+class GuestHeap {
+public:
+    static constexpr uint32_t ARENA_SIZE = KiB(64);
+    static constexpr uint32_t MIN_ALIGNMENT = 16;
+    static constexpr uint32_t MAX_SMALL_SIZE = 2048;
+    static constexpr uint32_t MAX_ARENAS = GiB(4) / ARENA_SIZE;
+    static constexpr std::array<uint32_t, 24> CLASS_SIZES = {
+        16, 32, 48, 64, 80, 96, 112, 128,
+        160, 192, 224, 256, 320, 384, 448, 512,
+        640, 768, 896, 1024, 1280, 1536, 1792, 2048
+    };
+
+    explicit GuestHeap(MemState &mem);
+    ~GuestHeap();
+    GuestHeap(const GuestHeap &) = delete;
+    GuestHeap &operator=(const GuestHeap &) = delete;
+
+    // alignment is rounded up to a power of two, returns 0 when out of memory or when the
+    // alignment is above 2^31
+    Address alloc(uint32_t size, uint32_t alignment = 0);
+    void free(Address address);
+    Address realloc(Address address, uint32_t size, uint32_t alignment = 0);
+    // 0 if the address was not returned by this heap
+    uint32_t usable_size(Address address);
+
+    uint32_t arena_count();
+
+private:
+    friend struct GuestHeapThreadCache;
+
+    struct Arena {
+        uint16_t id;
+        uint8_t size_class;
+        uint16_t used = 0;
+        // slot indices, popped from the back
+        std::vector<uint16_t> free_slots;
+    };
+
+    // What is needed to check a slot without the heap lock, indexed by arena id
+    struct ArenaSlots {
+        Address base = 0;
+        uint8_t size_class = 0;
+        // one bit per slot, set while the guest owns the slot
+        std::unique_ptr<std::atomic<uint64_t>[]> owned;
+    };
+
+    static int find_class(uint32_t size, uint32_t alignment);
+    // nullptr for addresses which are not in an arena
+    ArenaSlots *arena_of(Address address) const;
+    // index of the slot starting at address, -1 if no slot starts there
+    static int slot_of(const ArenaSlots &slots, Address address);
+    GuestHeapThreadCache &get_cache();
+
+    // Functions below must be called with the heap mutex held
+    bool add_arena(int size_class);
+    void refill(int size_class, std::vector<Address> &slots, size_t count);
+    void release(Address address);
+
+    MemState &mem;
+    const uint64_t generation;
+
+    std::mutex mutex;
+    std::map<Address, Arena> arenas;
+    // arenas with at least one free slot, per size class
+    std::array<std::set<Address>, CLASS_SIZES.size()> partial_arenas;
+    // arena id of each guest page, 0 for pages which are not an arena
+    std::unique_ptr<std::atomic<uint16_t>[]> page_arenas;
+    std::unique_ptr<ArenaSlots[]> arena_slots;
+    // ids of the released arenas, the next arena gets one of them if any
+    std::vector<uint16_t> free_arena_ids;
+    uint16_t next_arena_id = 1;
+    // page allocations, with their usable size
+    std::map<Address, uint32_t> large_blocks;
+};
@@ -19,11 +19,14 @@
 
 #include <mem/allocator.h>
 #include <mem/functions.h>
+#include <mem/heap.h>
 #include <mem/util.h>
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 struct AllocMemPage {
     uint32_t allocated : 4;
@@ -41,6 +44,8 @@ typedef std::map<int, std::string> PageNameMap;
 struct ProtectBlockInfo {
     uint32_t size = 0;
     ProtectCallback callback;
+    // registered by add_page_protect: a fault only unprotects the page it happened in
+    bool per_page = false;
 };
 
 struct ProtectSegmentInfo {
@@ -78,4 +83,21 @@ struct MemState {
     bool use_page_table = false;
     PageTable page_table;
     std::map<uint64_t, MemExternalMapping, std::greater<>> external_mapping;
+
+    // Protection state of each guest page (PROTECT_PAGE_* in mem.cpp), kept up to date by
+    // protect_inner/unprotect_inner and readable without holding protect_mutex
+    std::unique_ptr<std::atomic<uint32_t>[]> protect_pages;
+    // held while changing the protection of pages and their protect_pages entries, so that
+    // concurrent changes of the same pages can not leave them out of sync
+    std::mutex protect_pages_mutex;
+    // Write generation of each guest page, see mark_pages_written
+    std::unique_ptr<std::atomic<uint32_t>[]> page_generations;
+
+    // Guest memory is backed by transparent huge pages, except for the huge pages
+    // containing protected guest pages which are kept split
+    bool use_huge_pages = false;
+    std::mutex huge_page_mutex;
+    std::vector<uint16_t> huge_page_protect_count;
+
+    GuestHeap heap{ *this };
 };
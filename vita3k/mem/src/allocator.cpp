@@ -17,9 +17,13 @@
 
 #include <mem/allocator.h>
 
+#include <algorithm>
+#include <bit>
+
 BitmapAllocator::BitmapAllocator(const std::size_t total_bits)
     : words((total_bits >> 5) + ((total_bits % 32 != 0) ? 1 : 0), 0xFFFFFFFF)
     , max_offset(total_bits) {
+    rebuild_summary();
 }
 
 void BitmapAllocator::set_maximum(const std::size_t total_bits) {
@@ -35,10 +39,28 @@ void BitmapAllocator::set_maximum(const std::size_t total_bits) {
     }
 
     max_offset = total_bits;
+    rebuild_summary();
 }
 
 void BitmapAllocator::reset() {
     words.clear();
+    summary.clear();
+}
+
+void BitmapAllocator::update_summary(const std::size_t word_index) {
+    const std::uint64_t bit = 1ULL << (word_index & 63);
+    if (words[word_index] != 0)
+        summary[word_index >> 6] |= bit;
+    else
+        summary[word_index >> 6] &= ~bit;
+}
+
+void BitmapAllocator::rebuild_summary() {
+    summary.assign((words.size() + 63) >> 6, 0);
+    for (std::size_t i = 0; i < words.size(); i++)
+        update_summary(i);
+
+    run_hints.fill(0);
 }
 
 int BitmapAllocator::force_fill(const std::uint32_t offset, const std::uint32_t size, const bool or_mode) {
@@ -57,6 +79,7 @@ int BitmapAllocator::force_fill(const std::uint32_t offset, const std::uint32_t
         } else {
             *word = wval & (~mask);
         }
+        update_summary(word - words.data());
 
         return std::min<int>(size, (words.size() << 5) - set_bit);
     }
@@ -72,6 +95,7 @@ int BitmapAllocator::force_fill(const std::uint32_t offset, const std::uint32_t
         } else {
             *word = wval & (~mask);
         }
+        update_summary(word - words.data());
 
         word += 1;
         if (end_bit < 32)
@@ -95,6 +119,87 @@ void BitmapAllocator::free(const std::uint32_t offset, const std::uint32_t size)
     }
 
     force_fill(offset, size, true);
+
+    // the new free run may have merged with a shorter one ending right before offset
+    for (std::uint32_t i = 0; i < RUN_HINT_COUNT; i++)
+        run_hints[i] = std::min(run_hints[i], offset - std::min(offset, i));
+}
+
+std::uint32_t BitmapAllocator::find_free(const std::uint32_t offset) {
+    const std::size_t word_count = words.size();
+    const std::uint32_t end = static_cast<std::uint32_t>(word_count << 5);
+    std::size_t index = offset >> 5;
+    if (index >= word_count)
+        return end;
+
+    const std::uint32_t first = words[index] & (0xFFFFFFFFU >> (offset & 31));
+    if (first != 0)
+        return static_cast<std::uint32_t>((index << 5) + std::countl_zero(first));
+
+    index++;
+    while (index < word_count) {
+        // skip the words without free bits using the summary
+        std::size_t summary_index = index >> 6;
+        std::uint64_t candidates = summary[summary_index] & (~0ULL << (index & 63));
+        while (candidates == 0) {
+            summary_index++;
+            // whole allocated regions are skipped 256 words at a time
+            while (summary_index + 4 <= summary.size() && (summary[summary_index] | summary[summary_index + 1] | summary[summary_index + 2] | summary[summary_index + 3]) == 0)
+                summary_index += 4;
+            if (summary_index >= summary.size())
+                return end;
+            candidates = summary[summary_index];
+        }
+
+        index = (summary_index << 6) + std::countr_zero(candidates);
+        if (index >= word_count)
+            return end;
+        if (words[index] != 0)
+            return static_cast<std::uint32_t>((index << 5) + std::countl_zero(words[index]));
+
+        // the word was filled without going through the allocator
+        summary[summary_index] &= ~(1ULL << (index & 63));
+        index++;
+    }
+
+    return end;
+}
+
+std::uint32_t BitmapAllocator::find_used(const std::uint32_t offset, const std::uint32_t limit) const {
+    const std::size_t word_count = words.size();
+    std::size_t index = offset >> 5;
+
+    const std::uint32_t first = ~words[index] & (0xFFFFFFFFU >> (offset & 31));
+    if (first != 0)
+        return static_cast<std::uint32_t>((index << 5) + std::countl_zero(first));
+
+    // the run continues in the next words, skip the fully free ones 8 at a time
+    // (this loop is vectorized by the compiler)
+    index++;
+    const std::size_t limit_index = std::min<std::size_t>((static_cast<std::size_t>(limit) + 31) >> 5, word_count);
+    while (index + 8 <= limit_index) {
+        std::uint32_t all = 0xFFFFFFFFU;
+        for (int i = 0; i < 8; i++)
+            all &= words[index + i];
+        if (all != 0xFFFFFFFFU)
+            break;
+        index += 8;
+    }
+    while (index < limit_index && words[index] == 0xFFFFFFFFU)
+        index++;
+
+    if (index >= word_count)
+        return static_cast<std::uint32_t>(word_count << 5);
+    if (index >= limit_index)
+        return static_cast<std::uint32_t>(index << 5);
+    return static_cast<std::uint32_t>((index << 5) + std::countl_zero(~words[index]));
+}
+
+// a first fit search for hint_index + 1 bits found no run long enough before offset,
+// so there is none for the longer runs either
+void BitmapAllocator::update_run_hints(const std::uint32_t hint_index, const std::uint32_t offset) {
+    for (std::uint32_t i = hint_index; i < RUN_HINT_COUNT; i++)
+        run_hints[i] = std::max(run_hints[i], offset);
 }
 
 int BitmapAllocator::allocate_from(const std::uint32_t start_offset, std::uint32_t &size, const bool best_fit) {
@@ -102,75 +207,60 @@ int BitmapAllocator::allocate_from(const std::uint32_t start_offset, std::uint32
         return -1;
     }
 
-    std::uint32_t *word = &words[0] + (start_offset >> 5);
-
-    // We have arrived at le word that still have free position (bit 1)
-    std::uint32_t *word_end = &words[words.size() - 1];
-
-    int bflmin = 0xFFFFFF;
-    int bofmin = -1;
-    std::uint32_t *wordmin = nullptr;
-
-    // Keep finding
-    while (word <= word_end) {
-        std::uint32_t wv = *word;
-
-        if (wv != 0) {
-            // Still have free stuff
-            int bflen = 0;
-            int boff = 0;
-            std::uint32_t *bword = nullptr;
-
-            int cursor = 31;
-
-            while (cursor >= 0) {
-                if (((wv >> cursor) & 1) == 1) {
-                    boff = cursor;
-                    bflen = 0;
-                    bword = word;
-
-                    while (cursor >= 0 && (((wv >> cursor) & 1) == 1)) {
-                        bflen++;
-                        cursor--;
-
-                        if (cursor < 0 && (word + 1 <= word_end)) {
-                            cursor = 31;
-                            word++;
-                            wv = *word;
-                        }
-                    }
-
-                    if (bflen >= size) {
-                        if (!best_fit) {
-                            // Force allocate and then return
-                            const int offset = static_cast<int>(31 - boff + ((bword - &words[0]) << 5));
-                            if ((static_cast<std::size_t>(offset) + size) <= max_offset) {
-                                size = force_fill(static_cast<const std::uint32_t>(offset), size, false);
-                                return offset;
-                            }
-                        } else {
-                            if (bflen < bflmin) {
-                                bflmin = bflen;
-                                bofmin = boff;
-                                wordmin = bword;
-                            }
-                        }
-                    }
-                }
-
-                cursor--;
+    // The search starts from the beginning of the word containing start_offset
+    // runs before the hint can't be long enough, for first fit as for best fit
+    const std::uint32_t end = static_cast<std::uint32_t>(words.size() << 5);
+    const std::uint32_t hint_index = std::clamp<std::uint32_t>(size, 1, RUN_HINT_COUNT) - 1;
+    std::uint32_t offset = std::max(start_offset & ~31U, run_hints[hint_index]);
+    // the hints can only be raised when this search scans everything from them
+    const bool can_update_hints = !best_fit && size > 0 && size <= RUN_HINT_COUNT && (start_offset & ~31U) <= run_hints[hint_index];
+
+    std::uint32_t best_length = 0xFFFFFF;
+    std::uint32_t best_offset = end;
+
+    while (true) {
+        offset = find_free(offset);
+        if (offset >= end) {
+            if (can_update_hints)
+                update_run_hints(hint_index, end);
+            break;
+        }
+
+        // the exact length of the run only matters for best fit
+        const std::uint32_t limit = best_fit ? end : offset + size;
+        const std::uint32_t run_end = find_used(offset, limit);
+        const std::uint32_t length = run_end - offset;
+
+        if (length >= size) {
+            if (!best_fit) {
+                // Force allocate and then return
+                // (the runs after this one can't end before max_offset either)
+                if ((static_cast<std::size_t>(offset) + size) > max_offset)
+                    return -1;
+
+                if (can_update_hints)
+                    update_run_hints(hint_index, offset + size);
+                size = force_fill(offset, size, false);
+                return static_cast<int>(offset);
+            }
+
+            if (length < best_length) {
+                best_length = length;
+                best_offset = offset;
+                // nothing can fit better, and the first of the best runs is the one used
+                if (length == size)
+                    break;
             }
         }
 
-        word++;
+        offset = run_end;
     }
 
-    if (best_fit && bofmin != -1) {
+    if (best_fit && best_offset != end) {
         // Force allocate and then return
-        const int offset = static_cast<int>(31 - bofmin + ((wordmin - &words[0]) << 5));
-        if ((static_cast<std::size_t>(offset) + size) <= max_offset) {
-            size = force_fill(static_cast<std::uint32_t>(offset), size, false);
-            return offset;
+        if ((static_cast<std::size_t>(best_offset) + size) <= max_offset) {
+            size = force_fill(best_offset, size, false);
+            return static_cast<int>(best_offset);
         }
     }
 
@@ -0,0 +1,373 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <mem/heap.h>
+
+#include <mem/ptr.h>
+#include <util/align.h>
+#include <util/log.h>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstring>
+
+constexpr uint32_t HEAP_PAGE_SIZE = KiB(4);
+constexpr size_t HEAP_PAGE_COUNT = GiB(4) / HEAP_PAGE_SIZE;
+constexpr size_t CLASS_COUNT = GuestHeap::CLASS_SIZES.size();
+
+constexpr size_t OWNED_WORDS = GuestHeap::ARENA_SIZE / GuestHeap::CLASS_SIZES.front() / 64;
+
+static_assert(GuestHeap::ARENA_SIZE / GuestHeap::CLASS_SIZES.front() <= UINT16_MAX);
+static_assert(GuestHeap::MAX_ARENAS - 1 <= UINT16_MAX);
+static_assert(GuestHeap::CLASS_SIZES.back() == GuestHeap::MAX_SMALL_SIZE);
+
+// smallest size class fitting each multiple of MIN_ALIGNMENT
+static constexpr auto size_to_class = [] {
+    std::array<uint8_t, GuestHeap::MAX_SMALL_SIZE / GuestHeap::MIN_ALIGNMENT + 1> table{};
+    size_t size_class = 0;
+    for (size_t i = 0; i < table.size(); i++) {
+        while (GuestHeap::CLASS_SIZES[size_class] < i * GuestHeap::MIN_ALIGNMENT)
+            size_class++;
+        table[i] = static_cast<uint8_t>(size_class);
+    }
+    return table;
+}();
+
+// how many free slots a thread keeps for a size class before giving half of them back
+static size_t cache_limit(int size_class) {
+    return std::clamp<size_t>(KiB(32) / GuestHeap::CLASS_SIZES[size_class], 8, 256);
+}
+
+// Heaps which are still alive, so a thread exiting after its heap got destroyed does not
+// give its cached slots back to it
+static std::mutex live_heaps_mutex;
+static std::map<uint64_t, GuestHeap *> live_heaps;
+static uint64_t next_generation = 1;
+
+struct GuestHeapThreadCache {
+    uint64_t generation = 0;
+    std::array<std::vector<Address>, CLASS_COUNT> bins;
+
+    void flush() {
+        if (generation != 0) {
+            const std::lock_guard<std::mutex> guard(live_heaps_mutex);
+            const auto it = live_heaps.find(generation);
+            if (it != live_heaps.end()) {
+                GuestHeap &heap = *it->second;
+                const std::lock_guard<std::mutex> heap_guard(heap.mutex);
+                for (const auto &bin : bins) {
+                    for (const Address slot : bin)
+                        heap.release(slot);
+                }
+            }
+        }
+
+        for (auto &bin : bins)
+            bin.clear();
+        generation = 0;
+    }
+
+    ~GuestHeapThreadCache() {
+        flush();
+    }
+};
+
+static thread_local GuestHeapThreadCache thread_cache;
+
+static uint64_t register_heap(GuestHeap *heap) {
+    const std::lock_guard<std::mutex> guard(live_heaps_mutex);
+    const uint64_t generation = next_generation++;
+    live_heaps.emplace(generation, heap);
+    return generation;
+}
+
+GuestHeap::GuestHeap(MemState &mem)
+    : mem(mem)
+    , generation(register_heap(this))
+    , page_arenas(std::make_unique<std::atomic<uint16_t>[]>(HEAP_PAGE_COUNT))
+    , arena_slots(std::make_unique<ArenaSlots[]>(MAX_ARENAS)) {
+}
+
+GuestHeap::~GuestHeap() {
+    // the guest memory is going away with the heap, nothing to give back
+    const std::lock_guard<std::mutex> guard(live_heaps_mutex);
+    live_heaps.erase(generation);
+}
+
+// rounded up to a power of two, 0 when it is too large to be one
+static uint32_t normalize_alignment(uint32_t alignment) {
+    if (alignment > (1U << 31))
+        return 0;
+    return std::bit_ceil(std::max(alignment, GuestHeap::MIN_ALIGNMENT));
+}
+
+int GuestHeap::find_class(uint32_t size, uint32_t alignment) {
+    if (size > MAX_SMALL_SIZE || alignment > MAX_SMALL_SIZE)
+        return -1;
+
+    // slots are at a multiple of their size from a page-aligned arena base, so a slot is
+    // aligned on the alignment as long as its size is a multiple of it
+    for (size_t size_class = size_to_class[align(size, MIN_ALIGNMENT) / MIN_ALIGNMENT]; size_class < CLASS_COUNT; size_class++) {
+        if (CLASS_SIZES[size_class] % alignment == 0)
+            return static_cast<int>(size_class);
+    }
+
+    return -1;
+}
+
+GuestHeap::ArenaSlots *GuestHeap::arena_of(Address address) const {
+    const uint16_t id = page_arenas[address / HEAP_PAGE_SIZE].load(std::memory_order_acquire);
+    return id == 0 ? nullptr : &arena_slots[id];
+}
+
+int GuestHeap::slot_of(const ArenaSlots &slots, Address address) {
+    const uint32_t slot_size = CLASS_SIZES[slots.size_class];
+    if (address < slots.base || (address - slots.base) % slot_size != 0)
+        return -1;
+    return static_cast<int>((address - slots.base) / slot_size);
+}
+
+GuestHeapThreadCache &GuestHeap::get_cache() {
+    if (thread_cache.generation != generation) {
+        thread_cache.flush();
+        thread_cache.generation = generation;
+    }
+    return thread_cache;
+}
+
+bool GuestHeap::add_arena(int size_class) {
+    if (free_arena_ids.empty() && next_arena_id == 0)
+        return false;
+
+    const Address base = ::alloc(mem, ARENA_SIZE, "heap arena");
+    if (!base)
+        return false;
+
+    uint16_t id;
+    if (free_arena_ids.empty()) {
+        id = next_arena_id++;
+    } else {
+        id = free_arena_ids.back();
+        free_arena_ids.pop_back();
+    }
+
+    // the slot bits of a released arena are all clear and are kept for the next arena with its id
+    ArenaSlots &slots = arena_slots[id];
+    slots.base = base;
+    slots.size_class = static_cast<uint8_t>(size_class);
+    if (!slots.owned)
+        slots.owned = std::make_unique<std::atomic<uint64_t>[]>(OWNED_WORDS);
+
+    const uint32_t slot_count = ARENA_SIZE / CLASS_SIZES[size_class];
+    Arena &arena = arenas[base];
+    arena.id = id;
+    arena.size_class = static_cast<uint8_t>(size_class);
+    arena.free_slots.resize(slot_count);
+    // lowest slots are handed out first
+    for (uint32_t i = 0; i < slot_count; i++)
+        arena.free_slots[i] = static_cast<uint16_t>(slot_count - 1 - i);
+
+    for (Address page = base; page < base + ARENA_SIZE; page += HEAP_PAGE_SIZE)
+        page_arenas[page / HEAP_PAGE_SIZE].store(id, std::memory_order_release);
+
+    partial_arenas[size_class].insert(base);
+    return true;
+}
+
+void GuestHeap::refill(int size_class, std::vector<Address> &slots, size_t count) {
+    auto &partial = partial_arenas[size_class];
+    const uint32_t slot_size = CLASS_SIZES[size_class];
+    while (slots.size() < count) {
+        if (partial.empty() && !add_arena(size_class))
+            return;
+
+        const Address base = *partial.begin();
+        Arena &arena = arenas.at(base);
+        while (!arena.free_slots.empty() && slots.size() < count) {
+            slots.push_back(base + arena.free_slots.back() * slot_size);
+            arena.free_slots.pop_back();
+            arena.used++;
+        }
+
+        if (arena.free_slots.empty())
+            partial.erase(partial.begin());
+    }
+}
+
+void GuestHeap::release(Address address) {
+    auto it = arenas.upper_bound(address);
+    assert(it != arenas.begin());
+    --it;
+
+    const Address base = it->first;
+    Arena &arena = it->second;
+    const uint32_t slot_size = CLASS_SIZES[arena.size_class];
+    const uint32_t slot_count = ARENA_SIZE / slot_size;
+    auto &partial = partial_arenas[arena.size_class];
+    // the slots in the thread caches have been checked when freed
+    assert((address - base) % slot_size == 0);
+
+    if (arena.free_slots.empty())
+        partial.insert(base);
+    arena.free_slots.push_back(static_cast<uint16_t>((address - base) / slot_size));
+    arena.used--;
+
+    // keep one arena around per size class so a single malloc/free loop does not keep
+    // allocating and freeing pages
+    if (arena.used == 0 && partial.size() > 1) {
+        assert(arena.free_slots.size() == slot_count);
+        for (Address page = base; page < base + ARENA_SIZE; page += HEAP_PAGE_SIZE)
+            page_arenas[page / HEAP_PAGE_SIZE].store(0, std::memory_order_relaxed);
+        free_arena_ids.push_back(arena.id);
+        partial.erase(base);
+        arenas.erase(it);
+        ::free(mem, base);
+    }
+}
+
+Address GuestHeap::alloc(uint32_t size, uint32_t alignment) {
+    const uint32_t normalized = normalize_alignment(alignment);
+    // the page allocator gets size + alignment bytes to align the block
+    if (normalized == 0 || (normalized > HEAP_PAGE_SIZE && size > UINT32_MAX - normalized)) {
+        LOG_ERROR("Invalid alignment {} for a {} bytes allocation", log_hex(alignment), size);
+        return 0;
+    }
+
+    const int size_class = find_class(size, normalized);
+    if (size_class < 0) {
+        const Address address = normalized <= HEAP_PAGE_SIZE ? ::alloc(mem, size, "malloc") : alloc_aligned(mem, size, "malloc", normalized);
+        if (address) {
+            const std::lock_guard<std::mutex> guard(mutex);
+            large_blocks.emplace(address, align(std::max(size, 1U), HEAP_PAGE_SIZE));
+        }
+        return address;
+    }
+
+    auto &bin = get_cache().bins[size_class];
+    if (bin.empty()) {
+        const std::lock_guard<std::mutex> guard(mutex);
+        refill(size_class, bin, cache_limit(size_class) / 2);
+        if (bin.empty()) {
+            LOG_ERROR("Guest heap is out of memory for a {} bytes allocation", size);
+            return 0;
+        }
+    }
+
+    const Address address = bin.back();
+    bin.pop_back();
+
+    const ArenaSlots &slots = *arena_of(address);
+    const int slot = slot_of(slots, address);
+    slots.owned[slot / 64].fetch_or(1ULL << (slot % 64), std::memory_order_relaxed);
+    return address;
+}
+
+void GuestHeap::free(Address address) {
+    if (!address)
+        return;
+
+    ArenaSlots *slots = arena_of(address);
+    if (!slots) {
+        {
+            const std::lock_guard<std::mutex> guard(mutex);
+            if (large_blocks.erase(address) == 0) {
+                LOG_ERROR("Freeing address {} which was not allocated by the heap", log_hex(address));
+                return;
+            }
+        }
+        ::free(mem, address);
+        return;
+    }
+
+    // an invalid slot given to a thread cache would be handed out again, possibly twice
+    const int slot = slot_of(*slots, address);
+    if (slot < 0) {
+        LOG_ERROR("Freeing address {} which is not the start of a heap block", log_hex(address));
+        return;
+    }
+    const uint64_t bit = 1ULL << (slot % 64);
+    if ((slots->owned[slot / 64].fetch_and(~bit, std::memory_order_relaxed) & bit) == 0) {
+        LOG_ERROR("Freeing address {} which is already free", log_hex(address));
+        return;
+    }
+
+    const int size_class = slots->size_class;
+    auto &bin = get_cache().bins[size_class];
+    bin.push_back(address);
+
+    const size_t limit = cache_limit(size_class);
+    if (bin.size() > limit) {
+        const std::lock_guard<std::mutex> guard(mutex);
+        while (bin.size() > limit / 2) {
+            release(bin.back());
+            bin.pop_back();
+        }
+    }
+}
+
+Address GuestHeap::realloc(Address address, uint32_t size, uint32_t alignment) {
+    if (!address)
+        return alloc(size, alignment);
+
+    const uint32_t old_size = usable_size(address);
+    if (old_size == 0) {
+        LOG_ERROR("Reallocating address {} which was not allocated by the heap", log_hex(address));
+        return 0;
+    }
+
+    const uint32_t normalized = normalize_alignment(alignment);
+    if (normalized == 0) {
+        LOG_ERROR("Invalid alignment {} for reallocating address {}", log_hex(alignment), log_hex(address));
+        return 0;
+    }
+
+    // shrink in place unless it would leave most of the block unused
+    const bool aligned = address % normalized == 0;
+    if (aligned && size <= old_size && size >= old_size / 2)
+        return address;
+
+    const Address new_address = alloc(size, alignment);
+    if (!new_address)
+        return 0;
+
+    std::memcpy(Ptr<uint8_t>(new_address).get(mem), Ptr<uint8_t>(address).get(mem), std::min(old_size, size));
+    free(address);
+    return new_address;
+}
+
+uint32_t GuestHeap::usable_size(Address address) {
+    if (!address)
+        return 0;
+
+    if (const ArenaSlots *slots = arena_of(address)) {
+        // interior pointers and free slots are not blocks of the heap
+        const int slot = slot_of(*slots, address);
+        if (slot < 0 || (slots->owned[slot / 64].load(std::memory_order_relaxed) & (1ULL << (slot % 64))) == 0)
+            return 0;
+        return CLASS_SIZES[slots->size_class];
+    }
+
+    const std::lock_guard<std::mutex> guard(mutex);
+    const auto it = large_blocks.find(address);
+    return it == large_blocks.end() ? 0 : it->second;
+}
+
+uint32_t GuestHeap::arena_count() {
+    const std::lock_guard<std::mutex> guard(mutex);
+    return static_cast<uint32_t>(arenas.size());
+}
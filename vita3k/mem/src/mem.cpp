@@ -38,7 +38,13 @@
 
 constexpr uint32_t STANDARD_PAGE_SIZE = KiB(4);
 constexpr size_t TOTAL_MEM_SIZE = GiB(4);
+constexpr size_t HUGE_PAGE_SIZE = MiB(2);
 constexpr bool LOG_PROTECT = false;
+
+// protect_pages entries: a page which went through protect_inner or unprotect_inner since its
+// allocation is known, a known page which is not protected can not fault because of us
+constexpr uint32_t PROTECT_PAGE_KNOWN = 1 << 0;
+constexpr uint32_t PROTECT_PAGE_PROTECTED = 1 << 1;
 constexpr bool PAGE_NAME_TRACKING = false;
 
 // TODO: support multiple handlers
@@ -47,6 +53,8 @@ static void register_access_violation_handler(const AccessViolationHandler &hand
 
 static Address alloc_inner(MemState &state, uint32_t start_page, uint32_t page_count, const char *name, const bool force);
 static void delete_memory(uint8_t *memory);
+static void init_huge_pages(MemState &state);
+static void set_page_protection(MemState &state, Address addr, uint32_t size, uint32_t value);
 
 #ifdef _WIN32
 static std::string get_error_msg() {
@@ -58,7 +66,7 @@ static std::string get_error_msg() {
 }
 #endif
 
-bool init(MemState &state, const bool use_page_table) {
+bool init(MemState &state, const bool use_page_table, const bool use_huge_pages) {
 #ifdef _WIN32
     SYSTEM_INFO system_info = {};
     GetSystemInfo(&system_info);
@@ -91,18 +99,36 @@ bool init(MemState &state, const bool use_page_table) {
     const int fd = 0;
     const off_t offset = 0;
     // preferred_address is only a hint for mmap, if it can't use it, the kernel will choose itself the address
-    state.memory = Memory(static_cast<uint8_t *>(mmap(preferred_address, TOTAL_MEM_SIZE, prot, flags, fd, offset)), delete_memory);
+    uint8_t *memory = static_cast<uint8_t *>(mmap(preferred_address, TOTAL_MEM_SIZE, prot, flags, fd, offset));
+    if (memory != MAP_FAILED && use_huge_pages && reinterpret_cast<uintptr_t>(memory) % HUGE_PAGE_SIZE != 0) {
+        // huge pages need the memory to be aligned on them, reserve more and trim the excess
+        munmap(memory, TOTAL_MEM_SIZE);
+        memory = static_cast<uint8_t *>(mmap(nullptr, TOTAL_MEM_SIZE + HUGE_PAGE_SIZE, prot, flags, fd, offset));
+        if (memory != MAP_FAILED) {
+            uint8_t *const aligned_memory = reinterpret_cast<uint8_t *>(align(reinterpret_cast<uintptr_t>(memory), HUGE_PAGE_SIZE));
+            if (aligned_memory != memory)
+                munmap(memory, aligned_memory - memory);
+            munmap(aligned_memory + TOTAL_MEM_SIZE, memory + HUGE_PAGE_SIZE - aligned_memory);
+            memory = aligned_memory;
+        }
+    }
+    state.memory = Memory(memory, delete_memory);
     if (state.memory.get() == MAP_FAILED) {
         LOG_CRITICAL("mmap failed {}", get_error_msg());
         return false;
     }
 #endif
 
+    if (use_huge_pages)
+        init_huge_pages(state);
+
     const size_t table_length = TOTAL_MEM_SIZE / state.page_size;
     state.alloc_table = AllocPageTable(new AllocMemPage[table_length]);
     memset(state.alloc_table.get(), 0, sizeof(AllocMemPage) * table_length);
 
     state.allocator.set_maximum(table_length);
+    state.protect_pages = std::make_unique<std::atomic<uint32_t>[]>(TOTAL_MEM_SIZE / KiB(4));
+    state.page_generations = std::make_unique<std::atomic<uint32_t>[]>(TOTAL_MEM_SIZE / KiB(4));
 
     const auto handler = [&state](uint8_t *addr, bool write) noexcept {
         return handle_access_violation(state, addr, write);
@@ -130,6 +156,56 @@ bool init(MemState &state, const bool use_page_table) {
     return true;
 }
 
+static void init_huge_pages(MemState &state) {
+#ifdef MADV_HUGEPAGE
+    if (madvise(state.memory.get(), TOTAL_MEM_SIZE, MADV_HUGEPAGE) == -1) {
+        LOG_WARN("Failed to enable huge pages for the guest memory: {}", get_error_msg());
+        return;
+    }
+
+    state.huge_page_protect_count.assign(TOTAL_MEM_SIZE / HUGE_PAGE_SIZE, 0);
+    state.use_huge_pages = true;
+    LOG_INFO("Guest memory is backed by transparent huge pages");
+#else
+    LOG_WARN("Huge pages are not supported on this platform");
+#endif
+}
+
+// Huge pages containing a protected page get split by the kernel when the protection is applied.
+// Mark them as not eligible while a page in them is protected so khugepaged does not keep
+// collapsing them back, and make them eligible again once the last protection is gone.
+static void update_huge_page(MemState &state, uint32_t huge_page, bool is_protected) {
+#ifdef MADV_HUGEPAGE
+    const std::lock_guard<std::mutex> lock(state.huge_page_mutex);
+    uint16_t &count = state.huge_page_protect_count[huge_page];
+    const bool transition = is_protected ? count++ == 0 : --count == 0;
+    if (transition) {
+        uint8_t *const huge_page_ptr = &state.memory[static_cast<size_t>(huge_page) * HUGE_PAGE_SIZE];
+        const int ret = madvise(huge_page_ptr, HUGE_PAGE_SIZE, is_protected ? MADV_NOHUGEPAGE : MADV_HUGEPAGE);
+        LOG_ERROR_IF(ret == -1, "madvise failed: {}", get_error_msg());
+    }
+#endif
+}
+
+static void set_page_protection(MemState &state, Address addr, uint32_t size, uint32_t value) {
+    if (size == 0)
+        return;
+
+    constexpr uint32_t pages_per_huge_page = HUGE_PAGE_SIZE / KiB(4);
+    const uint32_t first_page = addr / KiB(4);
+    const uint32_t last_page = static_cast<uint32_t>((static_cast<uint64_t>(addr) + size - 1) / KiB(4));
+    for (uint32_t page = first_page; page <= last_page; page++) {
+        const uint32_t previous = state.protect_pages[page].exchange(value, std::memory_order_acq_rel);
+        if (state.use_huge_pages && ((previous ^ value) & PROTECT_PAGE_PROTECTED))
+            update_huge_page(state, page / pages_per_huge_page, value & PROTECT_PAGE_PROTECTED);
+    }
+}
+
+// true if the page was unprotected since the fault happened, the access only needs to be retried
+static bool is_unprotected_page(const MemState &state, Address addr) {
+    return state.protect_pages[addr / KiB(4)].load(std::memory_order_acquire) == PROTECT_PAGE_KNOWN;
+}
+
 static void delete_memory(uint8_t *memory) {
     if (memory != nullptr) {
 #ifdef _WIN32
@@ -221,23 +297,17 @@ static void align_to_page(MemState &state, Address &addr, Address &size) {
     size = end - addr;
 }
 
-void unprotect_inner(MemState &state, Address addr, uint32_t size) {
+static void apply_protection(MemState &state, Address addr, uint32_t size, const MemPerm perm) {
     if (LOG_PROTECT) {
-        fmt::print("Unprotect: {} {}\n", log_hex(addr), size);
+        fmt::print("Protect: {} {} {}\n", log_hex(addr), size, static_cast<int>(perm));
     }
-    uint8_t *addr_ptr = state.use_page_table ? state.page_table[addr / KiB(4)] : state.memory.get();
 
-#ifdef _WIN32
-    DWORD old_protect = 0;
-    const BOOL ret = VirtualProtect(&addr_ptr[addr], size - 1, PAGE_READWRITE, &old_protect);
-    LOG_CRITICAL_IF(!ret, "VirtualAlloc failed: {}", get_error_msg());
-#else
-    const int ret = mprotect(&addr_ptr[addr], size, PROT_READ | PROT_WRITE);
-    LOG_CRITICAL_IF(ret == -1, "mprotect failed: {}", get_error_msg());
-#endif
-}
+    const std::lock_guard<std::mutex> lock(state.protect_pages_mutex);
+
+    // set before the pages get protected, so a fault on them never finds them unprotected
+    if (perm != MemPerm::ReadWrite)
+        set_page_protection(state, addr, size, PROTECT_PAGE_KNOWN | PROTECT_PAGE_PROTECTED);
 
-void protect_inner(MemState &state, Address addr, uint32_t size, const MemPerm perm) {
     uint8_t *addr_ptr = state.use_page_table ? state.page_table[addr / KiB(4)] : state.memory.get();
 
 #ifdef _WIN32
@@ -248,12 +318,65 @@ void protect_inner(MemState &state, Address addr, uint32_t size, const MemPerm p
     const int ret = mprotect(&addr_ptr[addr], size, (perm == MemPerm::None) ? PROT_NONE : ((perm == MemPerm::ReadOnly) ? PROT_READ : (PROT_READ | PROT_WRITE)));
     LOG_CRITICAL_IF(ret == -1, "mprotect failed: {}", get_error_msg());
 #endif
+
+    // only once the pages are accessible, so a concurrent fault on them does not spin
+    if (perm == MemPerm::ReadWrite)
+        set_page_protection(state, addr, size, PROTECT_PAGE_KNOWN);
+}
+
+// true if a page of the range is protected
+static bool has_protected_page(const MemState &state, Address addr, uint64_t end) {
+    for (uint64_t page = addr / KiB(4); page < align(end, KiB(4)) / KiB(4); page++) {
+        if (state.protect_pages[page].load(std::memory_order_relaxed) & PROTECT_PAGE_PROTECTED)
+            return true;
+    }
+    return false;
+}
+
+// Same as apply_protection, for a range which may cross an external mapping
+static void apply_protection_runs(MemState &state, uint64_t start, uint64_t end, const MemPerm perm) {
+    if (!state.use_page_table) {
+        apply_protection(state, static_cast<Address>(start), static_cast<uint32_t>(end - start), perm);
+        return;
+    }
+
+    // an external mapping needs its own call
+    uint64_t run_start = start;
+    for (uint64_t page = start / KiB(4) + 1; page <= (end - 1) / KiB(4) + 1; page++) {
+        const uint64_t page_addr = page * KiB(4);
+        if (page_addr >= end || state.page_table[page] != state.page_table[run_start / KiB(4)]) {
+            const uint64_t run_end = std::min(page_addr, end);
+            apply_protection(state, static_cast<Address>(run_start), static_cast<uint32_t>(run_end - run_start), perm);
+            run_start = run_end;
+        }
+    }
+}
+
+// Gives the range back to the guest, several blocks of a fault can cover the same pages
+static void unprotect_range(MemState &state, Address addr, uint32_t size) {
+    const uint64_t end = static_cast<uint64_t>(addr) + size;
+    if (has_protected_page(state, addr, end))
+        apply_protection_runs(state, addr, end, MemPerm::ReadWrite);
+}
+
+void unprotect_inner(MemState &state, Address addr, uint32_t size) {
+    apply_protection(state, addr, size, MemPerm::ReadWrite);
+}
+
+void protect_inner(MemState &state, Address addr, uint32_t size, const MemPerm perm) {
+    apply_protection(state, addr, size, perm);
 }
 
 bool handle_access_violation(MemState &state, uint8_t *addr, bool write) noexcept {
     const uintptr_t memory_addr = reinterpret_cast<uintptr_t>(state.memory.get());
     const uintptr_t fault_addr = reinterpret_cast<uintptr_t>(addr);
 
+    // Several threads can fault on the same page before the first one unprotects it,
+    // the other ones do not need to wait for the lock to find out. The page only reads as known
+    // and unprotected once the last protection change of the page is done and made it accessible
+    if (fault_addr >= memory_addr && fault_addr < memory_addr + TOTAL_MEM_SIZE && is_unprotected_page(state, static_cast<Address>(fault_addr - memory_addr)))
+        return true;
+
     Address vaddr = 0;
     const std::unique_lock<std::mutex> lock(state.protect_mutex);
     if (fault_addr < memory_addr || fault_addr >= memory_addr + TOTAL_MEM_SIZE) {
@@ -276,6 +399,9 @@ bool handle_access_violation(MemState &state, uint8_t *addr, bool write) noexcep
     if (!is_valid_addr(state, vaddr)) {
         return false;
     }
+    if (is_unprotected_page(state, vaddr)) {
+        return true;
+    }
     if (LOG_PROTECT) {
         fmt::print("Access: {}\n", log_hex(vaddr));
     }
@@ -297,11 +423,26 @@ bool handle_access_violation(MemState &state, uint8_t *addr, bool write) noexcep
     }
 
     Address previous_beg = it->first;
+    const Address fault_page = align_down(vaddr, state.page_size);
+    bool is_covered = false;
     for (auto ite = info.blocks.begin(); ite != info.blocks.end();) {
-        if (vaddr >= ite->first && vaddr < ite->first + ite->second.size && ite->second.callback(vaddr, write)) {
+        if (vaddr < ite->first || vaddr >= ite->first + ite->second.size) {
+            ++ite;
+            continue;
+        }
+
+        is_covered = true;
+        const bool callback_result = ite->second.callback(vaddr, write);
+        if (ite->second.per_page && callback_result) {
+            // the block keeps tracking its other pages
+            unprotect_range(state, fault_page, state.page_size);
+            mark_pages_written(state, fault_page, state.page_size);
+            ++ite;
+        } else if (callback_result || ite->second.per_page) {
             Address beg_unpr = align_down(ite->first, state.page_size);
             Address end_unpr = align(ite->first + ite->second.size, state.page_size);
-            unprotect_inner(state, beg_unpr, end_unpr - beg_unpr);
+            unprotect_range(state, beg_unpr, end_unpr - beg_unpr);
+            mark_pages_written(state, beg_unpr, end_unpr - beg_unpr);
 
             ite = info.blocks.erase(ite);
         } else {
@@ -309,8 +450,14 @@ bool handle_access_violation(MemState &state, uint8_t *addr, bool write) noexcep
         }
     }
 
+    if (!is_covered) {
+        // the page is only protected because it lies between the blocks of the segment, nobody is tracking it
+        unprotect_range(state, fault_page, state.page_size);
+        mark_pages_written(state, fault_page, state.page_size);
+    }
+
     if (info.blocks.empty() && info.ref_count == 0) {
-        unprotect_inner(state, it->first, info.size);
+        unprotect_range(state, it->first, info.size);
         state.protect_tree.erase(it);
     } else {
         Address beg_region = info.blocks.begin()->first;
@@ -333,7 +480,7 @@ bool handle_access_violation(MemState &state, uint8_t *addr, bool write) noexcep
     return true;
 }
 
-bool add_protect(MemState &state, Address addr, const uint32_t size, const MemPerm perm, const ProtectCallback &callback) {
+static bool add_protect_block(MemState &state, Address addr, const uint32_t size, const MemPerm perm, const ProtectCallback &callback, const bool per_page) {
     const std::lock_guard<std::mutex> lock(state.protect_mutex);
     ProtectSegmentInfo protect(size, perm);
     align_to_page(state, addr, protect.size);
@@ -341,6 +488,7 @@ bool add_protect(MemState &state, Address addr, const uint32_t size, const MemPe
     ProtectBlockInfo block;
     block.size = size;
     block.callback = callback;
+    block.per_page = per_page;
 
     protect.blocks.emplace(addr, std::move(block));
 
@@ -369,13 +517,46 @@ bool add_protect(MemState &state, Address addr, const uint32_t size, const MemPe
     }
 
     if (protect.ref_count == 0) {
-        protect_inner(state, addr, protect.size, perm);
+        apply_protection_runs(state, addr, static_cast<uint64_t>(addr) + protect.size, perm);
     }
 
     state.protect_tree.emplace(addr, std::move(protect));
     return true;
 }
 
+bool add_protect(MemState &state, Address addr, const uint32_t size, const MemPerm perm, const ProtectCallback &callback) {
+    return add_protect_block(state, addr, size, perm, callback, false);
+}
+
+bool add_page_protect(MemState &state, Address addr, const uint32_t size, const ProtectCallback &callback) {
+    return add_protect_block(state, addr, size, MemPerm::ReadOnly, callback, true);
+}
+
+void reprotect_pages(MemState &state, Address addr, const uint32_t size) {
+    const std::lock_guard<std::mutex> lock(state.protect_mutex);
+    auto it = state.protect_tree.lower_bound(addr);
+    if (it == state.protect_tree.end() || addr + size > it->first + it->second.size)
+        return;
+
+    // an opened segment gets protected again when it is closed
+    if (it->second.ref_count == 0)
+        apply_protection_runs(state, addr, static_cast<uint64_t>(addr) + size, it->second.perm);
+}
+
+void mark_pages_written(MemState &state, Address addr, uint32_t size) {
+    if (size == 0)
+        return;
+
+    const uint32_t first_page = addr / KiB(4);
+    const uint32_t last_page = static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(addr) + size - 1, TOTAL_MEM_SIZE - 1) / KiB(4));
+    for (uint32_t page = first_page; page <= last_page; page++)
+        state.page_generations[page].fetch_add(1, std::memory_order_release);
+}
+
+uint32_t get_page_generation(const MemState &state, Address addr) {
+    return state.page_generations[addr / KiB(4)].load(std::memory_order_acquire);
+}
+
 bool is_protecting(MemState &state, Address addr, MemPerm *perm) {
     const std::lock_guard<std::mutex> lock(state.protect_mutex);
     auto ite = state.protect_tree.lower_bound(addr);
@@ -539,6 +720,9 @@ void free(MemState &state, Address address) {
     if (PAGE_NAME_TRACKING) {
         state.page_name_map.erase(page_num);
     }
+    // the pages are not accessible anymore, whatever their protection was
+    const std::lock_guard<std::mutex> protect_lock(state.protect_pages_mutex);
+    set_page_protection(state, page_num * state.page_size, page.size * state.page_size, 0);
 
     assert(!state.use_page_table || state.page_table[address / KiB(4)] == state.memory.get());
     uint8_t *const memory = &state.memory[page_num * state.page_size];
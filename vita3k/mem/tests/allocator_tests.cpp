@@ -21,6 +21,8 @@
 
 #include <gtest/gtest.h>
 
+#include <random>
+
 TEST(bitmap_allocator, one_bit_allocation) {
     BitmapAllocator allocator(KiB(5));
 
@@ -151,6 +153,133 @@ TEST(bitmap_allocator, battle_test) {
     }
 }
 
+// Linear scan used by BitmapAllocator before the summary bitmap and the run hints were added,
+// kept to check that they do not change which offset is returned.
+struct ReferenceAllocator {
+    std::vector<uint32_t> words;
+    size_t max_offset;
+
+    explicit ReferenceAllocator(size_t total_bits)
+        : words((total_bits + 31) / 32, 0xFFFFFFFF)
+        , max_offset(total_bits) {
+    }
+
+    bool is_free(uint32_t offset) const {
+        return (words[offset >> 5] >> (31 - (offset & 31))) & 1;
+    }
+
+    int fill(uint32_t offset, uint32_t size, bool free) {
+        for (uint32_t i = offset; i < offset + size && i < words.size() * 32; i++) {
+            const uint32_t bit = 1U << (31 - (i & 31));
+            words[i >> 5] = free ? (words[i >> 5] | bit) : (words[i >> 5] & ~bit);
+        }
+        return std::min<int>(size, words.size() * 32 - (offset & 31));
+    }
+
+    void free(uint32_t offset, uint32_t size) {
+        if (offset < max_offset)
+            fill(offset, size, true);
+    }
+
+    // like free_slot_count, only a range ending past the last word is cut at max_offset
+    int allocate_at(uint32_t offset, uint32_t size) {
+        const uint32_t end = ((offset + size) >> 5) >= words.size() ? max_offset : offset + size;
+        if (end < offset + size)
+            return -1;
+        for (uint32_t i = offset; i < end; i++) {
+            if (!is_free(i))
+                return -1;
+        }
+        fill(offset, size, false);
+        return 0;
+    }
+
+    // the search starts from the beginning of the word containing start_offset
+    int allocate_from(uint32_t start_offset, uint32_t &size, bool best_fit) {
+        const uint32_t end = static_cast<uint32_t>(words.size() * 32);
+        uint32_t best_length = 0xFFFFFF;
+        int best_offset = -1;
+        uint32_t offset = start_offset & ~31U;
+        while (offset < end) {
+            if (!is_free(offset)) {
+                offset++;
+                continue;
+            }
+
+            uint32_t run_end = offset;
+            while (run_end < end && is_free(run_end))
+                run_end++;
+
+            const uint32_t length = run_end - offset;
+            if (length >= size) {
+                if (!best_fit) {
+                    if (offset + size <= max_offset) {
+                        size = fill(offset, size, false);
+                        return static_cast<int>(offset);
+                    }
+                } else if (length < best_length) {
+                    best_length = length;
+                    best_offset = static_cast<int>(offset);
+                }
+            }
+            offset = run_end;
+        }
+
+        if (best_offset >= 0 && best_offset + size <= max_offset) {
+            size = fill(best_offset, size, false);
+            return best_offset;
+        }
+
+        return -1;
+    }
+};
+
+TEST(bitmap_allocator, matches_previous_implementation) {
+    // not a multiple of 32, so that runs can go past max_offset
+    constexpr uint32_t BIT_COUNT = 20000 + 13;
+    BitmapAllocator allocator(BIT_COUNT);
+    ReferenceAllocator reference(BIT_COUNT);
+    std::mt19937 rng(42);
+
+    struct Block {
+        uint32_t offset;
+        uint32_t size;
+    };
+    std::vector<Block> blocks;
+
+    for (int i = 0; i < 50000; i++) {
+        const uint32_t op = rng() % 8;
+        if (op < 3 && !blocks.empty()) {
+            const size_t index = rng() % blocks.size();
+            allocator.free(blocks[index].offset, blocks[index].size);
+            reference.free(blocks[index].offset, blocks[index].size);
+            blocks[index] = blocks.back();
+            blocks.pop_back();
+        } else if (op == 3) {
+            const uint32_t offset = rng() % BIT_COUNT;
+            const uint32_t size = rng() % 40 + 1;
+            const int result = allocator.allocate_at(offset, size);
+            ASSERT_EQ(result, reference.allocate_at(offset, size)) << "iteration " << i;
+            if (result == 0)
+                blocks.push_back({ offset, size });
+        } else {
+            // mostly sizes covered by the run hints, sometimes longer ones
+            const uint32_t size = (rng() % 16 == 0) ? rng() % 400 + 65 : rng() % 64 + 1;
+            const uint32_t start = (rng() % 4 == 0) ? rng() % BIT_COUNT : 0;
+            const bool best_fit = rng() % 3 == 0;
+            uint32_t size_allocated = size;
+            uint32_t size_reference = size;
+            const int result = allocator.allocate_from(start, size_allocated, best_fit);
+            ASSERT_EQ(result, reference.allocate_from(start, size_reference, best_fit)) << "iteration " << i;
+            ASSERT_EQ(size_allocated, size_reference);
+            if (result >= 0)
+                blocks.push_back({ static_cast<uint32_t>(result), size_allocated });
+        }
+
+        ASSERT_EQ(allocator.words, reference.words) << "iteration " << i;
+    }
+}
+
 // These tests are from EKA2L1 (https://github.com/EKA2L1/EKA2L1/blob/4fbd057da2a0c4f66a5c0f9dfc406c5d90f7531f/src/tests/common/allocator.cpp)
 TEST(bitmap_allocator, no_best_fit_only_one_fit) {
     BitmapAllocator alloc(32);
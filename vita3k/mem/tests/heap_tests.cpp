@@ -0,0 +1,136 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <mem/functions.h>
+#include <mem/ptr.h>
+#include <mem/state.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+class guest_heap : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(init(mem, false));
+    }
+
+    MemState mem;
+};
+
+TEST_F(guest_heap, small_blocks_share_pages) {
+    std::vector<Address> blocks;
+    for (int i = 0; i < 4096; i++)
+        blocks.push_back(mem.heap.alloc(24));
+
+    // 4096 * 32 bytes fit in two arenas instead of 4096 pages
+    ASSERT_EQ(mem.heap.arena_count(), 2);
+    for (const Address block : blocks) {
+        ASSERT_NE(block, 0);
+        ASSERT_EQ(block % GuestHeap::MIN_ALIGNMENT, 0);
+        ASSERT_EQ(mem.heap.usable_size(block), 32);
+    }
+
+    std::sort(blocks.begin(), blocks.end());
+    ASSERT_EQ(std::adjacent_find(blocks.begin(), blocks.end()), blocks.end());
+
+    for (const Address block : blocks)
+        mem.heap.free(block);
+}
+
+TEST_F(guest_heap, alignment) {
+    for (uint32_t alignment = 1; alignment <= KiB(64); alignment <<= 1) {
+        const Address block = mem.heap.alloc(100, alignment);
+        ASSERT_NE(block, 0);
+        ASSERT_EQ(block % alignment, 0);
+        mem.heap.free(block);
+    }
+}
+
+TEST_F(guest_heap, invalid_alignment_is_rejected) {
+    ASSERT_EQ(mem.heap.alloc(100, (1U << 31) + 1), 0);
+    ASSERT_EQ(mem.heap.alloc(100, UINT32_MAX), 0);
+    // no room left for aligning the block
+    ASSERT_EQ(mem.heap.alloc(UINT32_MAX - KiB(32), KiB(64)), 0);
+
+    const Address block = mem.heap.alloc(128);
+    ASSERT_EQ(mem.heap.realloc(block, 80, UINT32_MAX), 0);
+    ASSERT_EQ(mem.heap.usable_size(block), 128);
+
+    // a non power of two alignment is rounded up, the 128 bytes block is already aligned on it
+    ASSERT_EQ(mem.heap.realloc(block, 80, 96), block);
+    mem.heap.free(block);
+}
+
+TEST_F(guest_heap, large_blocks) {
+    const Address block = mem.heap.alloc(KiB(100) + 1);
+    ASSERT_NE(block, 0);
+    ASSERT_EQ(mem.heap.usable_size(block), KiB(104));
+    ASSERT_EQ(mem.heap.arena_count(), 0);
+    mem.heap.free(block);
+    ASSERT_EQ(mem.heap.usable_size(block), 0);
+}
+
+TEST_F(guest_heap, realloc_keeps_content) {
+    Address block = mem.heap.alloc(16);
+    std::fill_n(Ptr<uint8_t>(block).get(mem), 16, 0x5A);
+
+    block = mem.heap.realloc(block, 1000);
+    ASSERT_EQ(mem.heap.usable_size(block), 1024);
+    block = mem.heap.realloc(block, KiB(10));
+    ASSERT_EQ(mem.heap.usable_size(block), KiB(12));
+
+    const uint8_t *data = Ptr<uint8_t>(block).get(mem);
+    ASSERT_TRUE(std::all_of(data, data + 16, [](uint8_t byte) { return byte == 0x5A; }));
+    mem.heap.free(block);
+}
+
+TEST_F(guest_heap, empty_arenas_are_released) {
+    std::vector<Address> blocks;
+    for (int i = 0; i < 20000; i++)
+        blocks.push_back(mem.heap.alloc(200));
+    const uint32_t peak = mem.heap.arena_count();
+
+    for (const Address block : blocks)
+        mem.heap.free(block);
+    // slots cached by this thread keep at most one more arena alive
+    ASSERT_LT(mem.heap.arena_count(), peak);
+    ASSERT_LE(mem.heap.arena_count(), 2);
+}
+
+TEST_F(guest_heap, invalid_frees_are_rejected) {
+    const Address block = mem.heap.alloc(64);
+    ASSERT_NE(block, 0);
+
+    // an interior pointer is neither a block nor freed
+    ASSERT_EQ(mem.heap.usable_size(block + 16), 0);
+    ASSERT_EQ(mem.heap.realloc(block + 16, 128), 0);
+    mem.heap.free(block + 16);
+    ASSERT_EQ(mem.heap.usable_size(block), 64);
+
+    mem.heap.free(block);
+    ASSERT_EQ(mem.heap.usable_size(block), 0);
+    // a double free must not put the slot twice in the cache
+    mem.heap.free(block);
+
+    const Address first = mem.heap.alloc(64);
+    const Address second = mem.heap.alloc(64);
+    ASSERT_NE(first, second);
+    mem.heap.free(first);
+    mem.heap.free(second);
+}
@@ -0,0 +1,56 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <mem/functions.h>
+#include <mem/ptr.h>
+#include <mem/state.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+TEST(huge_pages, protection_inside_huge_page) {
+    MemState mem;
+    ASSERT_TRUE(init(mem, false, true));
+    if (!mem.use_huge_pages)
+        GTEST_SKIP() << "huge pages are not available";
+
+    const Address base = alloc_aligned(mem, MiB(8), "huge", MiB(2));
+    ASSERT_NE(base, 0);
+    // the callback runs from the signal handler, volatile keeps the faulting write and the
+    // checks around it in order
+    volatile uint8_t *data = Ptr<uint8_t>(base).get(mem);
+    std::fill_n(data, MiB(8), 1);
+
+    const Address protected_page = base + MiB(3) + KiB(12);
+    volatile bool triggered = false;
+    add_protect(mem, protected_page, KiB(4), MemPerm::ReadOnly, [&](Address, bool) {
+        triggered = true;
+        return true;
+    });
+    ASSERT_EQ(mem.huge_page_protect_count[protected_page / MiB(2)], 1);
+
+    // pages around the protected one are still writable
+    data[MiB(3) + KiB(8)] = 2;
+    data[MiB(3) + KiB(16)] = 2;
+    ASSERT_FALSE(triggered);
+
+    data[MiB(3) + KiB(12)] = 2;
+    ASSERT_TRUE(triggered);
+    ASSERT_EQ(mem.huge_page_protect_count[protected_page / MiB(2)], 0);
+    ASSERT_EQ(data[MiB(3) + KiB(12)], 2);
+}
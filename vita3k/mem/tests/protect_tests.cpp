@@ -0,0 +1,209 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <mem/functions.h>
+#include <mem/ptr.h>
+#include <mem/state.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+class protect : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(init(mem, false));
+    }
+
+    // one protected block per page, each one counting its callbacks
+    Address protect_pages(uint32_t page_count) {
+        const Address base = alloc(mem, page_count * KiB(4), "protect");
+        callback_counts = std::vector<std::atomic<int>>(page_count);
+        for (uint32_t i = 0; i < page_count; i++) {
+            add_protect(mem, base + i * KiB(4), KiB(4), MemPerm::ReadOnly, [this, base](Address addr, bool) {
+                callback_counts[(addr - base) / KiB(4)]++;
+                return true;
+            });
+        }
+        return base;
+    }
+
+    MemState mem;
+    std::vector<std::atomic<int>> callback_counts;
+};
+
+TEST_F(protect, write_unprotects_page) {
+    const Address base = protect_pages(4);
+    volatile uint8_t *data = Ptr<uint8_t>(base).get(mem);
+    ASSERT_TRUE(is_protecting(mem, base + KiB(4)));
+
+    data[KiB(4) + 12] = 1;
+    data[KiB(4) + 13] = 2;
+    ASSERT_EQ(callback_counts[0], 0);
+    ASSERT_EQ(callback_counts[1], 1);
+    ASSERT_EQ(data[KiB(4) + 12], 1);
+    ASSERT_FALSE(is_protecting(mem, base + KiB(4)));
+    ASSERT_TRUE(is_protecting(mem, base));
+
+    // protecting the page again arms the callback again
+    add_protect(mem, base + KiB(4), KiB(4), MemPerm::ReadOnly, [this](Address, bool) {
+        callback_counts[1]++;
+        return true;
+    });
+    // the first write after add_protect returns is seen
+    data[KiB(4)] = 3;
+    ASSERT_EQ(callback_counts[1], 2);
+    ASSERT_EQ(data[KiB(4)], 3);
+}
+
+TEST_F(protect, protection_is_applied_right_away) {
+    const Address base = alloc(mem, KiB(64), "protect");
+    volatile uint8_t *data = Ptr<uint8_t>(base).get(mem);
+    std::atomic<int> callback_count = 0;
+    for (uint32_t i = 0; i < 16; i++) {
+        add_protect(mem, base + i * KiB(4), KiB(4), MemPerm::ReadOnly, [&](Address, bool) {
+            callback_count++;
+            return true;
+        });
+    }
+
+    data[KiB(20)] = 1;
+    ASSERT_EQ(callback_count, 1);
+
+    // re-arming a page of a block registered with add_page_protect is also immediate
+    const Address page_base = alloc(mem, KiB(16), "protect");
+    volatile uint8_t *page_data = Ptr<uint8_t>(page_base).get(mem);
+    add_page_protect(mem, page_base, KiB(16), [&](Address, bool) {
+        callback_count++;
+        return true;
+    });
+    page_data[KiB(8)] = 1;
+    ASSERT_EQ(callback_count, 2);
+    reprotect_pages(mem, page_base + KiB(8), KiB(4));
+    page_data[KiB(8)] = 2;
+    ASSERT_EQ(callback_count, 3);
+}
+
+TEST_F(protect, concurrent_faults_on_same_pages) {
+    constexpr uint32_t page_count = 1024;
+    const Address base = protect_pages(page_count);
+    volatile uint32_t *data = Ptr<uint32_t>(base).get(mem);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&, t] {
+            for (uint32_t page = 0; page < page_count; page++)
+                data[page * KiB(4) / sizeof(uint32_t) + t] = page;
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    for (uint32_t page = 0; page < page_count; page++) {
+        ASSERT_EQ(callback_counts[page], 1);
+        for (int t = 0; t < 4; t++)
+            ASSERT_EQ(data[page * KiB(4) / sizeof(uint32_t) + t], page);
+    }
+}
+
+TEST_F(protect, concurrent_protection_changes) {
+    constexpr uint32_t page_count = 4;
+    const Address base = alloc(mem, page_count * KiB(4), "protect");
+    volatile uint8_t *data = Ptr<uint8_t>(base).get(mem);
+
+    // the renderer protects and unprotects pages without protect_mutex, whatever the order the
+    // changes end up in, a page which reads as unprotected must be accessible
+    std::thread protect_thread([&] {
+        for (int i = 0; i < 20000; i++)
+            protect_inner(mem, base + (i % page_count) * KiB(4), KiB(4), MemPerm::ReadOnly);
+    });
+    std::thread unprotect_thread([&] {
+        for (int i = 0; i < 20000; i++)
+            unprotect_inner(mem, base + (i % page_count) * KiB(4), KiB(4));
+    });
+    protect_thread.join();
+    unprotect_thread.join();
+
+    // with an untracked protected page, the fault handler gives the page back
+    for (uint32_t page = 0; page < page_count; page++)
+        data[page * KiB(4)] = 1;
+    for (uint32_t page = 0; page < page_count; page++)
+        ASSERT_EQ(data[page * KiB(4)], 1);
+}
+
+TEST_F(protect, page_protect_keeps_tracking) {
+    const Address base = alloc(mem, KiB(16), "protect");
+    volatile uint8_t *data = Ptr<uint8_t>(base).get(mem);
+    int callback_count = 0;
+    add_page_protect(mem, base, KiB(16), [&](Address, bool) {
+        callback_count++;
+        return true;
+    });
+    const uint32_t first_generation = get_page_generation(mem, base);
+    const uint32_t third_generation = get_page_generation(mem, base + KiB(8));
+
+    // only the written page is given back
+    data[KiB(8)] = 1;
+    data[KiB(8) + 1] = 2;
+    ASSERT_EQ(callback_count, 1);
+    ASSERT_EQ(get_page_generation(mem, base), first_generation);
+    ASSERT_NE(get_page_generation(mem, base + KiB(8)), third_generation);
+
+    data[0] = 3;
+    ASSERT_EQ(callback_count, 2);
+    ASSERT_NE(get_page_generation(mem, base), first_generation);
+
+    // the block is still registered, protecting a page again is enough to track it
+    reprotect_pages(mem, base + KiB(8), KiB(4));
+    data[KiB(8)] = 4;
+    ASSERT_EQ(callback_count, 3);
+    ASSERT_EQ(data[KiB(8)], 4);
+}
+
+TEST_F(protect, page_protect_dropped_by_callback) {
+    const Address base = alloc(mem, KiB(16), "protect");
+    volatile uint8_t *data = Ptr<uint8_t>(base).get(mem);
+    int callback_count = 0;
+    add_page_protect(mem, base, KiB(16), [&](Address, bool) {
+        callback_count++;
+        return false;
+    });
+    const uint32_t last_generation = get_page_generation(mem, base + KiB(12));
+
+    // all the pages are unprotected at once and nobody tracks them anymore
+    data[0] = 1;
+    data[KiB(12)] = 2;
+    ASSERT_EQ(callback_count, 1);
+    ASSERT_NE(get_page_generation(mem, base + KiB(12)), last_generation);
+    ASSERT_FALSE(is_protecting(mem, base));
+}
+
+TEST_F(protect, mark_pages_written) {
+    const Address base = alloc(mem, KiB(16), "protect");
+    std::vector<uint32_t> generations(4);
+    for (uint32_t i = 0; i < 4; i++)
+        generations[i] = get_page_generation(mem, base + i * KiB(4));
+
+    // from the end of the first page to the start of the third one
+    mark_pages_written(mem, base + KiB(4) - 1, KiB(4) + 2);
+    ASSERT_NE(get_page_generation(mem, base), generations[0]);
+    ASSERT_NE(get_page_generation(mem, base + KiB(4)), generations[1]);
+    ASSERT_NE(get_page_generation(mem, base + KiB(8)), generations[2]);
+    ASSERT_EQ(get_page_generation(mem, base + KiB(12)), generations[3]);
+}
@@ -28,7 +28,8 @@
 #include <config/state.h>
 #include <emuenv/state.h>
 
-using ImportFn = std::function<void(EmuEnvState &emuenv, CPUState &cpu, SceUID thread_id)>;
+// plain function pointer, so the kernel can call imports straight from its dispatch table
+using ImportFn = void (*)(EmuEnvState &emuenv, CPUState &cpu, SceUID thread_id);
 using ImportVarFactory = std::function<Address(EmuEnvState &emuenv)>;
 using LibraryInitFn = std::function<void(EmuEnvState &emuenv)>;
 
@@ -46,16 +47,14 @@ void call(void (*export_fn)(EmuEnvState &, SceUID, const char *, Args...), const
 }
 
 template <typename Ret, typename... Args>
-ImportFn bridge(Ret (*export_fn)(EmuEnvState &, SceUID, const char *, Args...), const char *export_name) {
+void bridge(Ret (*export_fn)(EmuEnvState &, SceUID, const char *, Args...), const char *export_name, EmuEnvState &emuenv, CPUState &cpu, SceUID thread_id) {
     constexpr std::tuple<ArgsLayout<Args...>, LayoutArgsState> args_layout = lay_out<typename BridgeTypes<Args>::ArmType...>();
 
-    return [export_fn, export_name, args_layout](EmuEnvState &emuenv, CPUState &cpu, SceUID thread_id) {
 #ifdef TRACY_ENABLE
-        ZoneNamedC(___tracy_scoped_zone, 0xFFF34C, emuenv.cfg.tracy_primitive_impl); // Tracy - Track function scope and set color to yellow
-        ZoneNameV(___tracy_scoped_zone, export_name, strlen(export_name)); // Tracy - Edit scope name based on export_name
+    ZoneNamedC(___tracy_scoped_zone, 0xFFF34C, emuenv.cfg.tracy_primitive_impl); // Tracy - Track function scope and set color to yellow
+    ZoneNameV(___tracy_scoped_zone, export_name, strlen(export_name)); // Tracy - Edit scope name based on export_name
 #endif
 
-        using Indices = std::index_sequence_for<Args...>;
-        call(export_fn, export_name, std::get<0>(args_layout), std::get<1>(args_layout), Indices(), thread_id, cpu, emuenv);
-    };
+    using Indices = std::index_sequence_for<Args...>;
+    call(export_fn, export_name, std::get<0>(args_layout), std::get<1>(args_layout), Indices(), thread_id, cpu, emuenv);
 }
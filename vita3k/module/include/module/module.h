@@ -36,9 +36,11 @@
 #define CALL_EXPORT(name, ...) export_##name(emuenv, thread_id, #name, ##__VA_ARGS__)
 
 #define DECL_EXPORT(ret, name, ...) ret export_##name(EmuEnvState &emuenv, SceUID thread_id, const char *export_name, ##__VA_ARGS__)
-#define EXPORT(ret, name, ...)                                           \
-    DECL_EXPORT(ret, name, ##__VA_ARGS__);                               \
-    extern const ImportFn import_##name = bridge(&export_##name, #name); \
+#define EXPORT(ret, name, ...)                                                                       \
+    DECL_EXPORT(ret, name, ##__VA_ARGS__);                                                           \
+    extern const ImportFn import_##name = [](EmuEnvState &emuenv, CPUState &cpu, SceUID thread_id) { \
+        bridge(&export_##name, #name, emuenv, cpu, thread_id);                                       \
+    };                                                                                               \
     DECL_EXPORT(ret, name, ##__VA_ARGS__)
 
 #define DECL_VAR_EXPORT(name) Address export_##name(EmuEnvState &emuenv)
@@ -4566,6 +4566,11 @@ EXPORT(int, sceGxmShaderPatcherRegisterProgram, SceGxmShaderPatcher *shaderPatch
     SceGxmRegisteredProgram *const rp = programId->get(emuenv.mem);
     rp->program = programHeader;
 
+    // vertex programs are translated once their attributes are known, when they are created
+    const SceGxmProgram &program = *programHeader.get(emuenv.mem);
+    if (program.is_fragment())
+        renderer::translate_shader_speculatively(*emuenv.renderer, program, nullptr);
+
     return 0;
 }
 
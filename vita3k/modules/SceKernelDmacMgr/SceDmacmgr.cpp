@@ -17,10 +17,16 @@
 
 #include <module/module.h>
 
-EXPORT(int, sceDmacMemcpy) {
-    return UNIMPLEMENTED();
+#include <mem/functions.h>
+
+EXPORT(Ptr<void>, sceDmacMemcpy, Ptr<void> dst, const void *src, SceSize len) {
+    memcpy(dst.get(emuenv.mem), src, len);
+    mark_pages_written(emuenv.mem, dst.address(), len);
+    return dst;
 }
 
-EXPORT(int, sceDmacMemset) {
-    return UNIMPLEMENTED();
+EXPORT(Ptr<void>, sceDmacMemset, Ptr<void> dst, int ch, SceSize len) {
+    memset(dst.get(emuenv.mem), ch, len);
+    mark_pages_written(emuenv.mem, dst.address(), len);
+    return dst;
 }
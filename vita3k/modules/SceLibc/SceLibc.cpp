@@ -19,6 +19,7 @@
 
 #include <io/functions.h>
 #include <kernel/state.h>
+#include <mem/functions.h>
 #include <util/lock_and_find.h>
 #include <util/log.h>
 #include <util/tracy.h>
@@ -334,9 +335,16 @@ EXPORT(int, c32rtomb) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, calloc) {
-    TRACY_FUNC(calloc);
-    return UNIMPLEMENTED();
+EXPORT(Ptr<void>, calloc, SceSize num, SceSize size) {
+    TRACY_FUNC(calloc, num, size);
+    const uint64_t total = static_cast<uint64_t>(num) * size;
+    if (total > UINT32_MAX)
+        return Ptr<void>();
+
+    const Ptr<void> address(emuenv.mem.heap.alloc(static_cast<uint32_t>(total)));
+    if (address)
+        memset(address.get(emuenv.mem), 0, total);
+    return address;
 }
 
 EXPORT(int, clearerr) {
@@ -477,7 +485,7 @@ EXPORT(int, fread) {
 
 EXPORT(void, free, Address mem) {
     TRACY_FUNC(free, mem);
-    free(emuenv.mem, mem);
+    emuenv.mem.heap.free(mem);
 }
 
 EXPORT(int, freopen) {
@@ -760,9 +768,9 @@ EXPORT(int, longjmp) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, malloc, SceSize size) {
+EXPORT(Ptr<void>, malloc, SceSize size) {
     TRACY_FUNC(malloc, size);
-    return alloc(emuenv.mem, size, __FUNCTION__);
+    return Ptr<void>(emuenv.mem.heap.alloc(size));
 }
 
 EXPORT(int, malloc_stats) {
@@ -775,9 +783,9 @@ EXPORT(int, malloc_stats_fast) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, malloc_usable_size) {
-    TRACY_FUNC(malloc_usable_size);
-    return UNIMPLEMENTED();
+EXPORT(SceSize, malloc_usable_size, Address mem) {
+    TRACY_FUNC(malloc_usable_size, mem);
+    return emuenv.mem.heap.usable_size(mem);
 }
 
 EXPORT(int, mblen) {
@@ -837,9 +845,7 @@ EXPORT(int, mbtowc) {
 
 EXPORT(Ptr<void>, memalign, uint32_t alignment, uint32_t size) {
     TRACY_FUNC(memalign, alignment, size);
-    Address address = alloc_aligned(emuenv.mem, size, "memalign", alignment);
-
-    return Ptr<void>(address);
+    return Ptr<void>(emuenv.mem.heap.alloc(size, alignment));
 }
 
 EXPORT(int, memchr) {
@@ -855,6 +861,7 @@ EXPORT(int, memcmp) {
 EXPORT(void, memcpy, void *destination, const void *source, uint32_t num) {
     TRACY_FUNC(memcpy, destination, source, num);
     memcpy(destination, source, num);
+    mark_pages_written(emuenv.mem, Ptr<void>(destination, emuenv.mem).address(), num);
 }
 
 EXPORT(int, memcpy_s) {
@@ -865,6 +872,7 @@ EXPORT(int, memcpy_s) {
 EXPORT(void, memmove, void *destination, const void *source, uint32_t num) {
     TRACY_FUNC(memmove, destination, source, num);
     memmove(destination, source, num);
+    mark_pages_written(emuenv.mem, Ptr<void>(destination, emuenv.mem).address(), num);
 }
 
 EXPORT(int, memmove_s) {
@@ -875,6 +883,7 @@ EXPORT(int, memmove_s) {
 EXPORT(void, memset, Ptr<void> str, int c, uint32_t n) {
     TRACY_FUNC(memset, str, c, n);
     memset(str.get(emuenv.mem), c, n);
+    mark_pages_written(emuenv.mem, str.address(), n);
 }
 
 EXPORT(int, mktime) {
@@ -882,14 +891,20 @@ EXPORT(int, mktime) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, mspace_calloc) {
-    TRACY_FUNC(mspace_calloc);
-    return UNIMPLEMENTED();
+EXPORT(Ptr<void>, mspace_calloc, Ptr<void> space, SceSize num, SceSize size) {
+    TRACY_FUNC(mspace_calloc, space, num, size);
+    const std::lock_guard<std::mutex> guard(emuenv.kernel.mutex);
+
+    void *address = mspace_calloc(space.get(emuenv.mem), num, size);
+    return Ptr<void>(address, emuenv.mem);
 }
 
-EXPORT(int, mspace_create) {
-    TRACY_FUNC(mspace_create);
-    return UNIMPLEMENTED();
+EXPORT(Ptr<void>, mspace_create, Ptr<void> base, SceSize capacity) {
+    TRACY_FUNC(mspace_create, base, capacity);
+    const std::lock_guard<std::mutex> guard(emuenv.kernel.mutex);
+
+    mspace space = create_mspace_with_base(base.get(emuenv.mem), capacity, 0);
+    return Ptr<void>(space, emuenv.mem);
 }
 
 EXPORT(int, mspace_create_internal) {
@@ -897,19 +912,27 @@ EXPORT(int, mspace_create_internal) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, mspace_create_with_flag) {
-    TRACY_FUNC(mspace_create_with_flag);
-    return UNIMPLEMENTED();
+EXPORT(Ptr<void>, mspace_create_with_flag, Ptr<void> base, SceSize capacity, int flag) {
+    TRACY_FUNC(mspace_create_with_flag, base, capacity, flag);
+    const std::lock_guard<std::mutex> guard(emuenv.kernel.mutex);
+
+    // the flags only select thread-safety and debug checks, accesses are always serialized here
+    mspace space = create_mspace_with_base(base.get(emuenv.mem), capacity, 0);
+    return Ptr<void>(space, emuenv.mem);
 }
 
-EXPORT(int, mspace_destroy) {
-    TRACY_FUNC(mspace_destroy);
-    return UNIMPLEMENTED();
+EXPORT(uint32_t, mspace_destroy, Ptr<void> space) {
+    TRACY_FUNC(mspace_destroy, space);
+    const std::lock_guard<std::mutex> guard(emuenv.kernel.mutex);
+
+    return static_cast<uint32_t>(destroy_mspace(space.get(emuenv.mem)));
 }
 
-EXPORT(int, mspace_free) {
-    TRACY_FUNC(mspace_free);
-    return UNIMPLEMENTED();
+EXPORT(void, mspace_free, Ptr<void> space, Ptr<void> address) {
+    TRACY_FUNC(mspace_free, space, address);
+    const std::lock_guard<std::mutex> guard(emuenv.kernel.mutex);
+
+    mspace_free(space.get(emuenv.mem), address.get(emuenv.mem));
 }
 
 EXPORT(int, mspace_is_heap_empty) {
@@ -917,9 +940,12 @@ EXPORT(int, mspace_is_heap_empty) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, mspace_malloc) {
-    TRACY_FUNC(mspace_malloc);
-    return UNIMPLEMENTED();
+EXPORT(Ptr<void>, mspace_malloc, Ptr<void> space, SceSize size) {
+    TRACY_FUNC(mspace_malloc, space, size);
+    const std::lock_guard<std::mutex> guard(emuenv.kernel.mutex);
+
+    void *address = mspace_malloc(space.get(emuenv.mem), size);
+    return Ptr<void>(address, emuenv.mem);
 }
 
 EXPORT(int, mspace_malloc_stats) {
@@ -932,24 +958,46 @@ EXPORT(int, mspace_malloc_stats_fast) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, mspace_malloc_usable_size) {
-    TRACY_FUNC(mspace_malloc_usable_size);
-    return UNIMPLEMENTED();
+EXPORT(SceSize, mspace_malloc_usable_size, Ptr<void> address) {
+    TRACY_FUNC(mspace_malloc_usable_size, address);
+    const std::lock_guard<std::mutex> guard(emuenv.kernel.mutex);
+
+    return static_cast<SceSize>(mspace_usable_size(address.get(emuenv.mem)));
 }
 
-EXPORT(int, mspace_memalign) {
-    TRACY_FUNC(mspace_memalign);
-    return UNIMPLEMENTED();
+EXPORT(Ptr<void>, mspace_memalign, Ptr<void> space, SceSize alignment, SceSize size) {
+    TRACY_FUNC(mspace_memalign, space, alignment, size);
+    const std::lock_guard<std::mutex> guard(emuenv.kernel.mutex);
+
+    void *address = mspace_memalign(space.get(emuenv.mem), alignment, size);
+    return Ptr<void>(address, emuenv.mem);
 }
 
-EXPORT(int, mspace_realloc) {
-    TRACY_FUNC(mspace_realloc);
-    return UNIMPLEMENTED();
+EXPORT(Ptr<void>, mspace_realloc, Ptr<void> space, Ptr<void> address, SceSize size) {
+    TRACY_FUNC(mspace_realloc, space, address, size);
+    const std::lock_guard<std::mutex> guard(emuenv.kernel.mutex);
+
+    void *new_address = mspace_realloc(space.get(emuenv.mem), address.get(emuenv.mem), size);
+    return Ptr<void>(new_address, emuenv.mem);
 }
 
-EXPORT(int, mspace_reallocalign) {
-    TRACY_FUNC(mspace_reallocalign);
-    return UNIMPLEMENTED();
+EXPORT(Ptr<void>, mspace_reallocalign, Ptr<void> space, Ptr<void> address, SceSize size, SceSize alignment) {
+    TRACY_FUNC(mspace_reallocalign, space, address, size, alignment);
+    const std::lock_guard<std::mutex> guard(emuenv.kernel.mutex);
+
+    // 0 means no alignment requirement
+    alignment = std::max<SceSize>(alignment, 1);
+    void *old_address = address.get(emuenv.mem);
+    if (old_address && reinterpret_cast<uintptr_t>(old_address) % alignment == 0 && mspace_usable_size(old_address) >= size)
+        return address;
+
+    // dlmalloc has no aligned realloc, move the block by hand
+    void *new_address = mspace_memalign(space.get(emuenv.mem), alignment, size);
+    if (new_address && old_address) {
+        memcpy(new_address, old_address, std::min<size_t>(mspace_usable_size(old_address), size));
+        mspace_free(space.get(emuenv.mem), old_address);
+    }
+    return Ptr<void>(new_address, emuenv.mem);
 }
 
 EXPORT(int, perror) {
@@ -1034,14 +1082,14 @@ EXPORT(int, rand_r) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, realloc) {
-    TRACY_FUNC(realloc);
-    return UNIMPLEMENTED();
+EXPORT(Ptr<void>, realloc, Address mem, SceSize size) {
+    TRACY_FUNC(realloc, mem, size);
+    return Ptr<void>(emuenv.mem.heap.realloc(mem, size));
 }
 
-EXPORT(int, reallocalign) {
-    TRACY_FUNC(reallocalign);
-    return UNIMPLEMENTED();
+EXPORT(Ptr<void>, reallocalign, Address mem, SceSize size, SceSize alignment) {
+    TRACY_FUNC(reallocalign, mem, size, alignment);
+    return Ptr<void>(emuenv.mem.heap.realloc(mem, size, alignment));
 }
 
 EXPORT(int, remove) {
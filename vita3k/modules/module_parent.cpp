@@ -54,18 +54,30 @@ static constexpr bool LOG_UNK_NIDS_ALWAYS = false;
 
 struct EmuEnvState;
 
-static const ImportFn *resolve_import(uint32_t nid) {
-    switch (nid) {
+struct FuncExport {
+    uint32_t nid;
+    const ImportFn *function;
+};
+
+static void init_import_table(EmuEnvState &emuenv) {
+    static const FuncExport func_exports[] = {
 #define VAR_NID(name, nid)
 #define NID(name, nid) \
-    case nid:          \
-        return &import_##name;
+    {                  \
+        nid,           \
+        &import_##name \
+    },
 #include <nids/nids.inc>
 #undef NID
 #undef VAR_NID
-    default:
-        return nullptr;
-    }
+    };
+
+    HleImportTable &imports = emuenv.kernel.hle_imports;
+    imports.emuenv = &emuenv;
+    imports.functions.reserve(std::size(func_exports));
+    imports.nids.reserve(std::size(func_exports));
+    for (const auto &func : func_exports)
+        imports.add(func.nid, *func.function);
 }
 
 struct VarExport {
@@ -123,7 +135,7 @@ static void log_import_call(char emulation_level, uint32_t nid, SceUID thread_id
 void call_import(EmuEnvState &emuenv, CPUState &cpu, uint32_t nid, SceUID thread_id) {
     // HLE - call our C++ function
     if (emuenv.kernel.debugger.watch_import_calls) {
-        const std::unordered_set<uint32_t> hle_nid_blacklist = {
+        static const std::unordered_set<uint32_t> hle_nid_blacklist = {
             0xB295EB61, // sceKernelGetTLSAddr
             0x46E7BE7B, // sceKernelLockLwMutex
             0x91FA6614, // sceKernelUnlockLwMutex
@@ -131,9 +143,9 @@ void call_import(EmuEnvState &emuenv, CPUState &cpu, uint32_t nid, SceUID thread
         auto lr = read_lr(cpu);
         log_import_call('H', nid, thread_id, hle_nid_blacklist, lr);
     }
-    const ImportFn *fn = resolve_import(nid);
-    if (fn) {
-        (*fn)(emuenv, cpu, thread_id);
+    const auto index = emuenv.kernel.hle_imports.find(nid);
+    if (index) {
+        emuenv.kernel.hle_imports.functions[*index](emuenv, cpu, thread_id);
     } else {
         const ThreadStatePtr thread = emuenv.kernel.get_thread(thread_id);
         // make the function return 0
@@ -371,6 +383,8 @@ bool load_sys_module_internal_with_arg(EmuEnvState &emuenv, SceUID thread_id, Sc
 }
 
 void init_libraries(EmuEnvState &emuenv) {
+    init_import_table(emuenv);
+
 #define LIBRARY(name) import_library_init_##name(emuenv);
 #include <modules/library_init_list.inc>
 #undef LIBRARY
@@ -18,6 +18,8 @@
 #pragma once
 
 #include <renderer/commands.h>
+#include <renderer/texture_bcn.h>
+#include <renderer/texture_layout.h>
 #include <renderer/types.h>
 
 struct MemState;
@@ -30,11 +32,15 @@ struct Context;
 struct FragmentProgram;
 struct RenderTarget;
 struct State;
+struct TextureDecodeJob;
 struct VertexProgram;
 
 bool create(std::unique_ptr<FragmentProgram> &fp, State &state, const SceGxmProgram &program, const SceGxmBlendInfo *blend, GXPPtrMap &gxp_ptr_map);
 bool create(std::unique_ptr<VertexProgram> &vp, State &state, const SceGxmProgram &program, GXPPtrMap &gxp_ptr_map, const std::vector<SceGxmVertexAttribute> &attributes);
 void create(SceGxmSyncObject *sync, State &state);
+// translate the program ahead of its first draw with the most common hints, on the shader job threads
+// attributes must be given for vertex programs
+void translate_shader_speculatively(State &state, const SceGxmProgram &program, const std::vector<SceGxmVertexAttribute> *attributes);
 void destroy(SceGxmSyncObject *sync, State &state);
 void finish(State &state, Context *context);
 
@@ -169,28 +175,22 @@ void resolve_z_order_compressed_texture(SceGxmTextureBaseFormat fmt, void *dest,
 /**
  * \brief Try to decompress texture to 32-bit RGBA.
  *
- * \param fmt    Texture base format.
- * \param dest   Destination texture data. Size must be sufficient enough of align(width, 4) * align(height,4) * 4 (bytes).
- * \param data   Source data to decompress.
- * \param width  Texture width.
- * \param height Texture height.
+ * \param fmt         Texture base format.
+ * \param dest        Destination texture data. Size must be sufficient enough of align(width, 4) * align(height,4) * 4 (bytes).
+ * \param data        Source data to decompress.
+ * \param width       Texture width.
+ * \param height      Texture height.
+ * \param is_swizzled Are the BC blocks in Z-order? They are then unswizzled while being decompressed. PVRT textures are always unswizzled.
  *
  * \return Size of source taken.
  */
-uint32_t decompress_compressed_texture(SceGxmTextureBaseFormat fmt, void *dest, const void *data, const uint32_t width, const uint32_t height);
+uint32_t decompress_compressed_texture(SceGxmTextureBaseFormat fmt, void *dest, const void *data, const uint32_t width, const uint32_t height, const bool is_swizzled = false);
 
-/**
- * \brief Decompresses all the blocks of a block compressed texture and stores the resulting pixels in 'image'.
- *
- * Output results is in format RGBA, with each channel being 8 bits.
- *
- * \param width             Texture width.
- * \param height            Texture height.
- * \param block_storage     Pointer to compressed blocks.
- * \param image             Pointer to the image where the decompressed pixels will be stored.
- * \param format_id         Id of the compressed format, in order: BC1 (DXT1), BC2 (DXT3), BC3 (DXT5), BC4U (RGTC1), BC4S (RGTC1), BC5U (RGTC2) or BC5S (RGTC2).
- */
-void decompress_bc_image(uint32_t width, uint32_t height, const uint8_t *block_storage, uint32_t *image, const uint8_t format_id);
+// format of a BC texture once decompressed by decompress_compressed_texture, the format itself if it can't be decompressed
+SceGxmTextureBaseFormat get_bcn_decompressed_format(SceGxmTextureBaseFormat fmt);
+
+// formats which can be uploaded as is and decoded by a backend supporting it, instead of being decoded on the CPU
+bool is_backend_decodable_format(SceGxmTextureBaseFormat fmt, bool support_bcn);
 
 /**
  * \brief Try to decompress texture to 16-bit RGB floating point color.
@@ -226,11 +226,11 @@ void convert_x8u24_to_u24x8(void *dest, const void *data, const uint32_t width,
 void convert_f32m_to_f32(void *dest, const void *data, const uint32_t width, const uint32_t height);
 void convert_u2f10f10f10_to_f16f16f16f16(void *dest, const void *data, const uint32_t width, const uint32_t height, const SceGxmTextureFormat format);
 
-void swizzled_texture_to_linear_texture(uint8_t *dest, const uint8_t *src, uint16_t width, uint16_t height, uint8_t bits_per_pixel);
-void tiled_texture_to_linear_texture(uint8_t *dest, const uint8_t *src, uint16_t width, uint16_t height, uint8_t bits_per_pixel);
-
 uint16_t get_upload_mip(const uint16_t true_mip, const uint16_t width, const uint16_t height);
 
+// perform all the format conversions and layout changes needed to upload a face / mip, can be called from any thread
+void decode_texture(TextureDecodeJob &job);
+
 uint32_t decode_morton2_x(uint32_t code);
 uint32_t decode_morton2_y(uint32_t code);
 uint32_t encode_morton(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
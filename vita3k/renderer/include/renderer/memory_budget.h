@@ -0,0 +1,81 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace renderer {
+
+enum class CacheType : uint32_t {
+    Texture,
+    Surface,
+    Count
+};
+
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    // device memory held by the entries of the cache
+    uint64_t bytes = 0;
+};
+
+// Keeps track of the device memory used by the texture and surface caches against a single budget.
+// Caches report the size of their entries, textures are the ones evicted when the budget is exceeded
+// as they can always be uploaded again from guest memory
+class MemoryBudget {
+public:
+    // 0 means there is no budget
+    void set_budget(uint64_t new_budget) {
+        budget = new_budget;
+    }
+    uint64_t get_budget() const {
+        return budget;
+    }
+
+    // an entry of the cache now holds new_size bytes instead of previous_size
+    void resize_entry(CacheType type, uint64_t previous_size, uint64_t new_size);
+
+    void record_hit(CacheType type) {
+        stats[static_cast<size_t>(type)].hits++;
+    }
+    void record_miss(CacheType type) {
+        stats[static_cast<size_t>(type)].misses++;
+    }
+    void record_eviction(CacheType type) {
+        stats[static_cast<size_t>(type)].evictions++;
+    }
+
+    const CacheStats &get_stats(CacheType type) const {
+        return stats[static_cast<size_t>(type)];
+    }
+    // total device memory held by all caches
+    uint64_t get_used() const;
+    // number of bytes which must be released to get back under the budget
+    uint64_t get_excess() const;
+
+    void log_stats() const;
+
+private:
+    uint64_t budget = 0;
+    std::array<CacheStats, static_cast<size_t>(CacheType::Count)> stats;
+};
+
+} // namespace renderer
@@ -0,0 +1,136 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#pragma once
+
+#include <util/fs.h>
+#include <util/hash.h>
+#include <util/mapped_file.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace renderer {
+
+// a fragment and a vertex shader used together by the app
+struct ShadersHash {
+    Sha256Hash frag;
+    Sha256Hash vert;
+};
+
+enum class ShaderCacheType : uint32_t {
+    Glsl = 0,
+    Spirv = 1,
+};
+
+struct ShaderCacheKey {
+    Sha256Hash hash;
+    // hash of the hints the shader was translated with, ANY_HINTS matches the most recent shader with this hash
+    uint64_t hints_hash = 0;
+    ShaderCacheType type = ShaderCacheType::Spirv;
+
+    static constexpr uint64_t ANY_HINTS = 0;
+
+    auto operator<=>(const ShaderCacheKey &) const = default;
+};
+
+/**
+ * \brief All the translated shaders of an app for a backend, stored in a single append-only file.
+ *
+ * The file is memory-mapped when it is opened and an index of its entries is built from it, the shaders
+ * translated afterwards are appended to the file and kept in memory. The program hashes used to precompile
+ * the shaders at boot are stored in the same file.
+ * Entries which are not reachable anymore are only removed when the file is compacted, which is done when
+ * it is opened, before the app starts.
+ */
+class ShaderCacheFile {
+    struct Entry {
+        const uint8_t *data;
+        uint32_t size;
+        // translated ahead of time with guessed hints, not used by lookups done without hints
+        bool speculative;
+    };
+
+    std::mutex mutex;
+    fs::path path;
+    MappedFile mapping;
+    fs::ofstream output;
+    uint32_t version = 0;
+    uint32_t features_mask = 0;
+
+    std::map<ShaderCacheKey, Entry> shaders;
+    // most recent entry for a given hash and type, whatever hints were used
+    std::map<std::pair<Sha256Hash, ShaderCacheType>, Entry> latest_shaders;
+    std::vector<ShadersHash> programs;
+    std::set<std::pair<Sha256Hash, Sha256Hash>> known_programs;
+    // speculative translations which were started but not stored yet
+    std::set<ShaderCacheKey> claimed_shaders;
+    // content of the entries appended since the file was mapped
+    std::vector<std::unique_ptr<uint8_t[]>> appended;
+    // bytes taken by entries which were replaced by a more recent one
+    uint64_t wasted_size = 0;
+    // the end of the file could not be read, it must be compacted before anything is appended
+    bool damaged = false;
+
+    // return false if the file does not exist or was made by another shader version or with other features
+    bool map_file();
+    void clear_index();
+    void add_entry(uint32_t kind, const uint8_t *payload, uint32_t size);
+    const Entry *find(const ShaderCacheKey &key);
+    void append_shader(const ShaderCacheKey &key, const void *data, size_t size, bool speculative);
+
+public:
+    ShaderCacheFile() = default;
+    ~ShaderCacheFile();
+
+    ShaderCacheFile(const ShaderCacheFile &) = delete;
+    ShaderCacheFile &operator=(const ShaderCacheFile &) = delete;
+
+    // return false if the file does not exist, is damaged or was made by another shader version or with other features
+    bool open(const fs::path &path, uint32_t version, uint32_t features_mask);
+    // create an empty cache file, replacing the existing one
+    bool create(const fs::path &path, uint32_t version, uint32_t features_mask);
+    void close();
+    bool is_open() const {
+        return mapping.is_open();
+    }
+
+    // a speculative shader found with its exact key is stored again as a regular one
+    bool load(const ShaderCacheKey &key, std::string &source);
+    bool load(const ShaderCacheKey &key, std::vector<uint32_t> &source);
+    void store(const ShaderCacheKey &key, const void *data, size_t size, bool speculative = false);
+    // return false if the shader is already in the cache or is being translated speculatively by someone else
+    bool claim_speculative(const ShaderCacheKey &key);
+
+    std::vector<ShadersHash> get_programs();
+    // append the programs which are not in the file yet
+    void store_programs(const std::vector<ShadersHash> &new_programs);
+
+    // rewrite the file with only the entries which can still be looked up
+    // this is done by open when there is enough to gain, as the file must not be in use
+    bool compact();
+
+    uint64_t get_wasted_size() const {
+        return wasted_size;
+    }
+};
+
+} // namespace renderer
@@ -0,0 +1,50 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <blockingconcurrentqueue.h>
+
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace renderer {
+
+/**
+ * \brief Worker threads translating shaders and creating their backend objects.
+ *
+ * At boot, they load all the shaders of the app at once. While the app runs, they translate the programs
+ * it creates before they are used in a draw. Idle threads take the jobs from a single queue, so a thread
+ * busy with a large shader does not hold back the other ones.
+ */
+class ShaderJobPool {
+    // an empty job makes the thread receiving it exit
+    moodycamel::BlockingConcurrentQueue<std::function<void()>> queue;
+    std::vector<std::thread> threads;
+
+    void worker_thread();
+
+public:
+    ShaderJobPool();
+    // the jobs which were not started yet may be dropped
+    ~ShaderJobPool();
+
+    void submit(std::function<void()> job);
+};
+
+} // namespace renderer
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <util/fs.h>
+#include <util/hash.h>
 
 #include <cstdint>
 #include <string>
@@ -32,15 +33,17 @@ struct FeatureState;
 
 namespace renderer {
 
+class ShaderCacheFile;
 struct ShadersHash;
 struct State;
 
 // Shaders.
-bool get_shaders_cache_hashs(State &renderer);
+bool get_shaders_cache_hashs(State &renderer, bool shader_cache);
 void save_shaders_cache_hashs(State &renderer, std::vector<ShadersHash> &shaders_cache_hashs);
-std::string load_glsl_shader(const SceGxmProgram &program, const FeatureState &features, const shader::Hints &hints, bool maskupdate, const fs::path &shader_cache_path, const fs::path &shader_log_path, const std::string &shader_version, bool shader_cache);
-std::vector<uint32_t> load_spirv_shader(const SceGxmProgram &program, const FeatureState &features, bool is_vulkan, const shader::Hints &hints, bool maskupdate, const fs::path &shader_cache_path, const fs::path &shader_log_path, const std::string &shader_version, bool shader_cache);
-std::string pre_load_shader_glsl(const fs::path &shader_path);
-std::vector<uint32_t> pre_load_shader_spirv(const fs::path &shader_path);
+std::string load_glsl_shader(const SceGxmProgram &program, const FeatureState &features, const shader::Hints &hints, bool maskupdate, ShaderCacheFile &shader_cache_file, const fs::path &shader_log_path, const std::string &shader_version, bool shader_cache);
+std::vector<uint32_t> load_spirv_shader(const SceGxmProgram &program, const FeatureState &features, bool is_vulkan, const shader::Hints &hints, bool maskupdate, ShaderCacheFile &shader_cache_file, const fs::path &shader_log_path, const std::string &shader_version, bool shader_cache);
+// return the most recent shader in the cache with this hash, empty if there is none
+std::string pre_load_shader_glsl(ShaderCacheFile &shader_cache_file, const Sha256Hash &hash);
+std::vector<uint32_t> pre_load_shader_spirv(ShaderCacheFile &shader_cache_file, const Sha256Hash &hash);
 
 } // namespace renderer
@@ -19,10 +19,14 @@
 
 #include <features/state.h>
 #include <renderer/commands.h>
+#include <renderer/memory_budget.h>
+#include <renderer/shader_cache.h>
 #include <renderer/types.h>
 #include <threads/queue.h>
 
+#include <atomic>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <string_view>
 
@@ -33,6 +37,7 @@ struct Config;
 
 namespace renderer {
 
+class ShaderJobPool;
 class TextureCache;
 
 enum struct Filter : int {
@@ -50,6 +55,8 @@ struct State {
     fs::path static_assets;
     fs::path shaders_path;
     fs::path shaders_log_path;
+    // translated shaders of the current app, opened by get_shaders_cache_hashs
+    ShaderCacheFile shader_cache_file;
 
     Backend current_backend;
     FeatureState features;
@@ -61,6 +68,9 @@ struct State {
 
     Context *context;
 
+    // device memory used by the texture and surface caches
+    MemoryBudget memory_budget;
+
     GXPPtrMap gxp_ptr_map;
     Queue<CommandList> command_buffer_queue;
     std::condition_variable command_finish_one;
@@ -76,12 +86,17 @@ struct State {
 
     // on Vulkan, this is actually the number of pipelines compiled
     uint32_t shaders_count_compiled = 0;
-    uint32_t programs_count_pre_compiled = 0;
+    std::atomic<uint32_t> programs_count_pre_compiled = 0;
 
     bool should_display;
 
     bool need_page_table = false;
 
+    // translate and load shaders in the background, created by get_shaders_cache_hashs when the shader cache is
+    // enabled and stopped by preclose_action
+    // declared last so the jobs, which use the members above, are joined before any of them is destroyed
+    std::unique_ptr<ShaderJobPool> shader_jobs;
+
     virtual bool init() = 0;
     virtual void late_init(const Config &cfg, const std::string_view game_id, MemState &mem) = 0;
 
@@ -127,9 +142,23 @@ struct State {
     virtual std::string_view get_gpu_name() = 0;
 
     virtual void precompile_shader(const ShadersHash &hash) = 0;
+    // backends able to do so precompile all the shaders of shaders_cache_hashs on the shader job threads,
+    // programs_count_pre_compiled is increased as they are done. Return false to get precompile_shader called for each of them instead
+    virtual bool precompile_shaders_async() {
+        return false;
+    }
+    // start compiling the pipelines used during the previous boots, must be called once the shaders are precompiled
+    // return the number of pipelines being compiled
+    virtual uint32_t warm_up_pipelines() {
+        return 0;
+    }
+    // how many of the pipelines started by warm_up_pipelines are compiled
+    virtual uint32_t get_warmed_up_pipelines_count() {
+        return 0;
+    }
     virtual void preclose_action() = 0;
 
-    virtual ~State() = default;
+    virtual ~State();
 
     fs::path texture_folder() const {
         return shared_path / "textures";
@@ -0,0 +1,50 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <cstdint>
+
+namespace renderer::texture {
+
+// The format ids are, in order: BC1 (DXT1), BC2 (DXT3), BC3 (DXT5), BC4U (RGTC1), BC4S (RGTC1), BC5U (RGTC2) and BC5S (RGTC2).
+// Every texel is decompressed to 32 bits, BC4 and BC5 textures only fill the first one or two channels and leave the others at 0.
+// The image written has a width and height aligned to 4.
+
+/**
+ * \brief Decompresses all the blocks of a block compressed texture and stores the resulting pixels in 'image'.
+ *
+ * \param width             Texture width.
+ * \param height            Texture height.
+ * \param block_storage     Pointer to compressed blocks, in linear order.
+ * \param image             Pointer to the image where the decompressed pixels will be stored.
+ * \param format_id         Id of the compressed format.
+ */
+void decompress_bc_image(uint32_t width, uint32_t height, const uint8_t *block_storage, uint32_t *image, const uint8_t format_id);
+
+/**
+ * \brief Same as decompress_bc_image, for blocks in Z-order. The blocks are unswizzled while being decompressed.
+ *
+ * \param width             Texture width.
+ * \param height            Texture height.
+ * \param block_storage     Pointer to compressed blocks, in Z-order.
+ * \param image             Pointer to the image where the decompressed pixels will be stored.
+ * \param format_id         Id of the compressed format.
+ */
+void decompress_bc_swizzled_image(uint32_t width, uint32_t height, const uint8_t *block_storage, uint32_t *image, const uint8_t format_id);
+
+} // namespace renderer::texture
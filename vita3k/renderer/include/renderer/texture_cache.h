@@ -18,6 +18,7 @@
 #pragma once
 
 #include <gxm/types.h>
+#include <mem/util.h>
 #include <util/containers.h>
 #include <util/fs.h>
 
@@ -25,6 +26,7 @@
 #include <cstdint>
 #include <memory>
 #include <string_view>
+#include <vector>
 
 namespace ddspp {
 struct Descriptor;
@@ -38,6 +40,13 @@ namespace renderer {
 enum class Backend : uint32_t;
 static constexpr size_t TextureCacheSize = 1024;
 
+class MemoryBudget;
+class TextureDecoder;
+class TextureDiskCache;
+class TexturePack;
+struct TexturePackEntry;
+struct TextureDecodeTicket;
+
 typedef std::array<uint32_t, 4> TextureGxmDataRepr;
 struct TextureCacheInfo {
     uint64_t hash = 0;
@@ -48,11 +57,23 @@ struct TextureCacheInfo {
     bool dirty = false;
     // used for texture importation
     bool is_imported = false;
+    // the replacement texture is being streamed in from the texture pack, the original one is used until then
+    bool waiting_for_import = false;
+    // compressed formats the GPU can't sample are uploaded as is and decoded by the backend
+    bool backend_decode = false;
     bool is_srgb = false;
     uint16_t width = 0;
     uint16_t height = 0;
     uint16_t mip_count = 0;
     SceGxmTextureBaseFormat format;
+    // device memory taken by the texture, set by the backend when it is configured
+    uint64_t memory_size = 0;
+    // size in guest memory of all the faces and mips, set by upload_texture
+    uint32_t source_size = 0;
+    // when the texture is not hashed, its pages are write protected one by one from protect_begin on
+    // and this is their generation when they were last uploaded, empty if they are not protected yet
+    Address protect_begin = 0;
+    std::vector<uint32_t> page_generations;
 };
 
 struct SamplerCacheInfo {
@@ -64,6 +85,8 @@ struct SamplerCacheInfo {
 struct AvailableTexture {
     bool is_dds;
     std::shared_ptr<fs::path> folder_path;
+    // set if the texture comes from the texture pack instead of the folder
+    const TexturePackEntry *pack_entry = nullptr;
 };
 
 class TextureCache {
@@ -79,7 +102,7 @@ protected:
     // dds/png raw file
     std::vector<uint8_t> imported_texture_raw_data;
     // pointer to the decoded content
-    uint8_t *imported_texture_decoded = nullptr;
+    const uint8_t *imported_texture_decoded = nullptr;
     // Info about the texture currently loading
     AvailableTexture loading_texture;
     // contain the decrypted header when loading dds
@@ -94,11 +117,34 @@ protected:
     bool save_as_png = true;
     bool export_textures = false;
 
+    // only the faces / mips which were written to since the last upload are uploaded, the other ones must be kept as they are
+    bool partial_upload = false;
+
+    // evict the least recently used textures until the memory budget is respected again
+    void evict_textures(const TextureCacheInfo *current);
+
+    // uploads whose content is still being decoded, must be waited on before the GPU uses them
+    std::vector<std::unique_ptr<TextureDecodeTicket>> pending_decodes;
+    std::unique_ptr<TextureDecoder> decoder;
+
+    // decoded textures kept from one boot to the other, null if disabled
+    std::unique_ptr<TextureDiskCache> disk_cache;
+    fs::path disk_cache_folder;
+    // save the decoded content of the ticket to the disk cache if it was requested, the decoded buffers are moved out of the jobs
+    void store_in_disk_cache(TextureDecodeTicket &ticket);
+
 public:
     Backend backend;
     bool use_protect = false;
+    // can the host GPU sample BC textures? If not, they are decompressed on the CPU
+    bool support_bcn = true;
+    // can the backend decode PVRT and YUV420 textures (and BC textures when they are not supported) on the GPU?
+    // only with the compute-texture-decode option, otherwise YUV420 textures are converted with swscale
+    bool support_backend_decode = false;
     // use a separate sampler cache
     bool use_sampler_cache = false;
+    // shared with the surface cache, textures are evicted when it is exceeded
+    MemoryBudget *memory_budget = nullptr;
     int anisotropic_filtering = 1;
 
     // used to quickly get the info from a hash of a gxm_texture
@@ -114,24 +160,43 @@ public:
     fs::path import_folder;
     // key = hash, content = is the texture a dds (true) or a png (false)
     unordered_map_fast<uint64_t, AvailableTexture> available_textures_hash;
+    // import_folder + ".vtp", the textures in the folder take precedence over it
+    std::unique_ptr<TexturePack> texture_pack;
 
     // folder where the exported textures will be saved
     fs::path export_folder;
     // hash of the textures that have already been exported
     unordered_set_fast<uint64_t> exported_textures_hash;
 
+    TextureCache();
+    virtual ~TextureCache();
+
     bool init(const bool hashless_texture_cache, const fs::path &texture_folder, const std::string_view game_id, const size_t sampler_cache_size = 0);
     void set_replacement_state(bool import_textures, bool export_textures, bool export_as_png);
+    // a max size of 0 means the disk cache is not limited
+    void init_disk_cache(uint64_t max_size);
 
     virtual void select(size_t index, const SceGxmTexture &texture) = 0;
     virtual void configure_texture(const SceGxmTexture &texture) = 0;
     virtual void upload_texture_impl(SceGxmTextureBaseFormat base_format, uint32_t width, uint32_t height, uint32_t mip_index, const void *pixels, int face, uint32_t pixels_per_stride) = 0;
     virtual void upload_done() {}
+    // free the device memory of a texture evicted from the cache
+    virtual void release_texture(size_t index) {}
+
+    // backends able to do so record the upload of a face / mip right away and return where its content must be written to,
+    // the decoding and the write are then done by a decoder thread. Return nullptr to get upload_texture_impl called instead
+    virtual uint8_t *reserve_texture_upload(SceGxmTextureBaseFormat base_format, uint32_t width, uint32_t height, uint32_t mip_index, int face, uint32_t pixels_per_stride) {
+        return nullptr;
+    }
+    // called from a decoder thread, must only write to dest
+    virtual void write_texture_upload(uint8_t *dest, SceGxmTextureBaseFormat base_format, uint32_t height, const void *pixels, uint32_t pixels_per_stride) const {}
 
     virtual void configure_sampler(size_t index, const SceGxmTexture &texture) {}
 
     void upload_texture(const SceGxmTexture &gxm_texture, MemState &mem);
     void cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemState &mem);
+    // wait for all the decoding started by upload_texture, must be called before submitting the uploads to the GPU
+    void wait_pending_decodes();
 
     // is called by cache_and_bind_texture if use_sampler_cache is set to true
     int cache_and_bind_sampler(const SceGxmTexture &gxm_texture);
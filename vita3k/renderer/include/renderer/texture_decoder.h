@@ -0,0 +1,114 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <blockingconcurrentqueue.h>
+#include <gxm/types.h>
+#include <renderer/texture_disk_cache.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace renderer {
+
+class TextureCache;
+struct TextureDecodeTicket;
+
+// a single face or mip of a guest texture to convert to a format and layout the host GPU can upload
+struct TextureDecodeJob {
+    TextureDecodeTicket *ticket = nullptr;
+
+    SceGxmTexture texture;
+    // location of the face / mip in guest memory
+    const uint8_t *src = nullptr;
+    // only used by paletted textures, retrieved when the job is created
+    const uint32_t *palette = nullptr;
+    SceGxmTextureBaseFormat upload_format;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t memory_height = 0;
+    uint32_t pixels_per_stride = 0;
+    uint32_t layout_width = 0;
+    uint32_t layout_height = 0;
+    uint32_t mip_index = 0;
+    // 0 for 2D textures, 1 + face index for cube textures
+    int face = 0;
+    bool is_vulkan = false;
+
+    // decoding result, pixels points to one of these buffers or to src if no conversion was needed
+    std::vector<uint8_t> decompressed;
+    std::vector<uint8_t> lineared;
+    const void *pixels = nullptr;
+
+    // if not null, the backend has already recorded the upload and the decoded content must be written there
+    uint8_t *upload_dest = nullptr;
+};
+
+/**
+ * \brief Decoding of all the faces and mips of a texture upload.
+ *
+ * The jobs must not be moved or resized once the ticket has been submitted and
+ * the ticket must be kept alive until wait returns.
+ */
+struct TextureDecodeTicket {
+    const TextureCache *cache = nullptr;
+    std::vector<TextureDecodeJob> jobs;
+
+    std::mutex mutex;
+    std::condition_variable done;
+    uint32_t remaining = 0;
+
+    // content loaded from the disk cache, the pixels of the jobs then already point to it
+    std::vector<uint8_t> disk_cache_content;
+    // if set, the decoded content is saved to the disk cache once the decoding is done
+    bool store_in_disk_cache = false;
+    TextureDiskCacheKey disk_cache_key;
+
+    void wait();
+};
+
+/**
+ * \brief Worker threads running the conversions needed before a texture can be uploaded.
+ *
+ * Unswizzling, detiling, palette expansion and decompression of every face and mip of a texture
+ * are independent from each other, so they are dispatched as separate jobs.
+ */
+class TextureDecoder {
+    moodycamel::BlockingConcurrentQueue<TextureDecodeJob *> queue;
+    std::vector<std::thread> threads;
+
+    void worker_thread();
+
+public:
+    TextureDecoder();
+    ~TextureDecoder();
+
+    bool is_async() const {
+        return !threads.empty();
+    }
+
+    // decode the job and write it to its upload destination if there is one
+    static void run(TextureDecodeJob &job);
+
+    void submit(TextureDecodeTicket &ticket);
+};
+
+} // namespace renderer
@@ -0,0 +1,121 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <util/fs.h>
+
+#include <blockingconcurrentqueue.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace renderer {
+
+// what the decoded content of a texture depends on
+struct TextureDiskCacheKey {
+    // hash of the whole texture source (and of its palette), as computed by hash_texture_data
+    uint64_t hash = 0;
+    uint32_t format = 0;
+    uint32_t upload_format = 0;
+    uint32_t texture_type = 0;
+    uint16_t width = 0;
+    uint16_t height = 0;
+    uint16_t mip_count = 0;
+    // some conversions differ between backends
+    bool is_vulkan = false;
+};
+
+// a decoded face / mip of a cached texture
+struct TextureDiskCacheLevel {
+    uint32_t face = 0;
+    uint32_t mip_index = 0;
+    uint32_t pixels_per_stride = 0;
+    uint32_t memory_height = 0;
+    // size in bytes of the decoded content
+    uint32_t size = 0;
+    const uint8_t *data = nullptr;
+};
+
+/**
+ * \brief Decoded textures saved on disk so that they don't need to be decoded again on the next boot.
+ *
+ * Each texture is stored in its own file, named after its key and compressed with a fast codec.
+ * Once the size of the folder goes over the limit, the least recently used textures are removed.
+ * The compression and the writes are done by a thread of the cache, not by the caller of store.
+ */
+class TextureDiskCache {
+    struct PendingWrite {
+        std::string file_name;
+        std::vector<TextureDiskCacheLevel> levels;
+        std::vector<std::vector<uint8_t>> buffers;
+    };
+
+    fs::path folder;
+    uint64_t max_size = 0;
+
+    // guards everything below
+    mutable std::mutex mutex;
+    uint64_t total_size = 0;
+    // key = file name, content = file size
+    std::unordered_map<std::string, uint64_t> entries;
+    // files queued or being written, they are not in entries yet
+    std::unordered_set<std::string> pending_files;
+    std::condition_variable writes_done;
+
+    // an empty write makes the writer thread exit
+    moodycamel::BlockingConcurrentQueue<std::unique_ptr<PendingWrite>> write_queue;
+    std::thread writer;
+
+    void writer_thread();
+    void write(const PendingWrite &pending);
+    // returns the size of the file written, 0 on failure
+    uint64_t write_file(const PendingWrite &pending) const;
+    // remove the least recently used files until the cache is back under the limit, mutex must be held
+    void cleanup();
+
+public:
+    TextureDiskCache() = default;
+    ~TextureDiskCache();
+    TextureDiskCache(const TextureDiskCache &) = delete;
+    TextureDiskCache &operator=(const TextureDiskCache &) = delete;
+
+    // a max size of 0 means the cache is not limited
+    bool init(const fs::path &folder, uint64_t max_size);
+
+    // on success, content holds the decoded content of all the levels, whose data point to it
+    bool load(const TextureDiskCacheKey &key, std::vector<uint8_t> &content, std::vector<TextureDiskCacheLevel> &levels);
+    // queue the texture to be written, the data of the levels must point into buffers,
+    // which are kept until the write is done, or stay valid until flush returns
+    void store(const TextureDiskCacheKey &key, std::vector<TextureDiskCacheLevel> levels, std::vector<std::vector<uint8_t>> buffers = {});
+    // wait for all the queued textures to be written
+    void flush();
+
+    uint64_t get_size() const {
+        const std::lock_guard<std::mutex> guard(mutex);
+        return total_size;
+    }
+};
+
+} // namespace renderer
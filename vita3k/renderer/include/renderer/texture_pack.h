@@ -0,0 +1,96 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <util/fs.h>
+#include <util/mapped_file.h>
+
+#include <blockingconcurrentqueue.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace renderer {
+
+enum class TexturePackEntryType : uint32_t {
+    // content of a dds file, header included
+    Dds = 0,
+    // decoded png, always with 4 components
+    Rgba8 = 1,
+};
+
+// entry of the index located after the pack header, the index is sorted by hash
+struct TexturePackEntry {
+    uint64_t hash;
+    // location of the content in the pack
+    uint64_t offset;
+    uint64_t size;
+    TexturePackEntryType type;
+    uint32_t width;
+    uint32_t height;
+    // number of channels of the original png
+    uint32_t nb_channels;
+};
+static_assert(sizeof(TexturePackEntry) == 40);
+
+/**
+ * \brief Replacement textures packed in a single file which is mapped in memory.
+ *
+ * The content is ready to be uploaded, the first time a texture is requested it is streamed
+ * in by a background thread so that the render thread never waits for the disk.
+ */
+class TexturePack {
+    MappedFile file;
+    const TexturePackEntry *entries = nullptr;
+    uint32_t entry_count = 0;
+
+    // streaming state of each entry
+    std::unique_ptr<std::atomic<uint8_t>[]> entry_states;
+    // index of the entries to stream in, UINT32_MAX makes the thread exit
+    moodycamel::BlockingConcurrentQueue<uint32_t> stream_queue;
+    std::thread stream_thread;
+
+    void stream_thread_func();
+
+public:
+    ~TexturePack();
+
+    bool open(const fs::path &path);
+
+    // return nullptr if the pack does not contain this texture
+    const TexturePackEntry *find(uint64_t hash) const;
+
+    const uint8_t *get_data(const TexturePackEntry &entry) const {
+        return file.data() + entry.offset;
+    }
+
+    // return true if the content of the entry can be used right away, otherwise it starts being streamed in
+    bool request(const TexturePackEntry &entry);
+    bool is_ready(const TexturePackEntry &entry) const;
+
+    uint32_t size() const {
+        return entry_count;
+    }
+};
+
+// pack the png and dds files found in folder (with the layout used for texture replacement) into a single file
+bool create_texture_pack(const fs::path &folder, const fs::path &pack_path);
+
+} // namespace renderer
@@ -20,6 +20,7 @@
 #include <gxm/types.h>
 #include <renderer/commands.h>
 #include <renderer/gxm_types.h>
+#include <renderer/shader_cache.h>
 #include <shader/spirv_recompiler.h>
 #include <shader/usse_program_analyzer.h>
 #include <util/hash.h>
@@ -195,11 +196,6 @@ struct VertexProgram : ShaderProgram {
     shader::usse::AttributeInformationMap attribute_infos;
 };
 
-struct ShadersHash {
-    Sha256Hash frag;
-    Sha256Hash vert;
-};
-
 struct RenderTarget {
     int holder;
     SceGxmMultisampleMode multisample_mode;
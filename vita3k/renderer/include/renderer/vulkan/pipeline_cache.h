@@ -22,9 +22,11 @@
 #include <vkutil/vkutil.h>
 
 #include <array>
+#include <atomic>
 #include <limits>
 #include <map>
 #include <set>
+#include <vector>
 
 struct SceGxmProgram;
 struct SceGxmFragmentProgram;
@@ -49,6 +51,31 @@ struct CompileRequest;
 
 using PipelineCompileQueue = moodycamel::BlockingConcurrentQueue<CompileRequest *>;
 
+// everything needed to create a pipeline once its shaders are known, without looking at the guest programs
+// these are saved for each app so that the pipelines can be compiled again at the next boot
+struct PipelineDescription {
+    // key of the pipeline in the pipelines map
+    uint64_t key = 0;
+    Sha256Hash vertex_hash;
+    Sha256Hash fragment_hash;
+    SceGxmPrimitiveType type;
+    // format of the color attachment of the render pass
+    vk::Format color_format;
+    bool use_shader_interlock = false;
+    bool is_fragment_disabled = false;
+    // the fragment shader uses the gamma correction specialization constant
+    bool use_srgb_constant = false;
+    // the cull mode, depth and stencil state are dynamic, only for the fallback pipelines which are not saved
+    bool use_dynamic_state = false;
+    uint8_t vertex_texture_count = 0;
+    uint8_t fragment_texture_count = 0;
+    vk::PipelineColorBlendAttachmentState blending;
+    std::vector<vk::VertexInputBindingDescription> bindings;
+    std::vector<vk::VertexInputAttributeDescription> attributes;
+    // the content of the record useful for the pipeline creation
+    std::vector<uint8_t> record;
+};
+
 class PipelineCache {
 private:
     VKState &state;
@@ -79,9 +106,13 @@ private:
     // because of multithreading, we want the pointers to remain stable
     unordered_map_stable<Sha256Hash, vk::ShaderModule> shaders;
     unordered_map_stable<uint64_t, vk::Pipeline> pipelines;
+    // pipelines used while the one matching the state is compiling, the state they have in common with it
+    // which is set dynamically is left out of their key so that they can be shared by all the draws using the same programs
+    unordered_map_stable<uint64_t, vk::Pipeline> fallback_pipelines;
 
-    vk::PipelineShaderStageCreateInfo retrieve_shader(const SceGxmProgram *program, const Sha256Hash &hash, bool is_vertex, bool maskupdate, MemState &mem, const shader::Hints &hints, bool is_srgb = false);
-    vk::PipelineVertexInputStateCreateInfo get_vertex_input_state(const SceGxmVertexProgram &vertex_program, MemState &mem);
+    vk::ShaderModule retrieve_shader(const SceGxmProgram *program, const Sha256Hash &hash, bool is_vertex, bool maskupdate, MemState &mem, const shader::Hints &hints);
+    // fill the vertex bindings and attributes of the description
+    void get_vertex_input_state(const SceGxmVertexProgram &vertex_program, PipelineDescription &description);
 
     // queue containing request sent by the main thread to the compile threads
     PipelineCompileQueue pipeline_compile_queue;
@@ -90,12 +121,28 @@ private:
     // each pipeline compiler thread uses this function as its entrypoint
     void compiler_thread(MemState &mem);
 
-    vk::Pipeline compile_pipeline(SceGxmPrimitiveType type, vk::RenderPass render_pass, const SceGxmVertexProgram &vertex_program_gxm, const SceGxmFragmentProgram &fragment_program_gxm, const GxmRecordState &record, const shader::Hints &hints, MemState &mem);
+    vk::Pipeline compile_pipeline(uint64_t key, SceGxmPrimitiveType type, vk::RenderPass render_pass, vk::Format color_format, const SceGxmVertexProgram &vertex_program_gxm, const SceGxmFragmentProgram &fragment_program_gxm, const GxmRecordState &record, const shader::Hints &hints, MemState &mem, bool is_fallback = false);
+    // return the fallback pipeline for the current state if it is compiled, queue its compilation otherwise
+    vk::Pipeline retrieve_fallback_pipeline(VKContext &context, SceGxmPrimitiveType type, MemState &mem);
+    vk::Pipeline create_pipeline(const PipelineDescription &description, vk::ShaderModule vertex_module, vk::ShaderModule fragment_module, vk::RenderPass render_pass);
+
+    // pipelines used by the app so far, saved along the pipeline cache and compiled again at the next boot
+    std::mutex warmup_mutex;
+    std::vector<PipelineDescription> warmup_pipelines;
+    unordered_set_fast<uint64_t> warmup_keys;
+    // number of descriptions already in the file on disk
+    size_t warmup_saved_count = 0;
+    void record_warmup_pipeline(PipelineDescription &&description);
+    void read_warmup_pipelines();
+    void save_warmup_pipelines();
 
 public:
     // if not 0, next time the pipeline cache should be saved (in seconds since epoch)
     uint64_t next_pipeline_cache_save = std::numeric_limits<uint64_t>::max();
 
+    // VK_EXT_extended_dynamic_state, needed to draw with the fallback pipelines while pipelines compile
+    bool support_extended_dynamic_state = false;
+
     // modified by the surface cache, estimates if it is safe to use async pipeline compilation
     // (i.e that it does not causes permanent graphical issues)
     bool can_use_deferred_compilation;
@@ -116,8 +163,16 @@ public:
     void read_pipeline_cache();
     void save_pipeline_cache();
 
+    // queue the compilation of the pipelines recorded during the previous boots on the compiler threads
+    // their shaders must have been precompiled before, return the number of pipelines queued
+    uint32_t warm_up_pipelines();
+    // number of pipelines queued by warm_up_pipelines which are done compiling
+    std::atomic<uint32_t> warmup_compiled_count = 0;
+
     vk::RenderPass retrieve_render_pass(vk::Format format, bool force_load, bool force_store, bool no_color = false);
     vk::Pipeline retrieve_pipeline(VKContext &context, SceGxmPrimitiveType &type, bool consider_for_async, MemState &mem);
+    // must be called after a fallback pipeline is returned by retrieve_pipeline, even if it was already bound
+    void set_fallback_dynamic_state(VKContext &context);
 
     vk::ShaderModule precompile_shader(const Sha256Hash &hash, bool search_first = true);
 
@@ -100,6 +100,7 @@ struct VKState : public renderer::State {
     bool support_standard_layout = false;
 
     VKState(int gpu_idx);
+    ~VKState() override;
 
     bool init() override;
     bool create(SDL_Window *window, std::unique_ptr<renderer::State> &state, const Config &config);
@@ -133,6 +134,9 @@ struct VKState : public renderer::State {
     std::string_view get_gpu_name() override;
 
     void precompile_shader(const ShadersHash &hash) override;
+    bool precompile_shaders_async() override;
+    uint32_t warm_up_pipelines() override;
+    uint32_t get_warmed_up_pipelines_count() override;
     void preclose_action() override;
 
     inline FrameObject &frame() {
@@ -51,6 +51,8 @@ struct SurfaceCacheInfo {
     SurfaceTiling tiling;
     // for d32s8 surfaces, this is the size of the depth part
     uint32_t total_bytes;
+    // device memory taken by the image, reported to the memory budget
+    uint64_t memory_size = 0;
 };
 
 struct Framebuffer {
@@ -45,6 +45,8 @@ struct TextureCacheEntry {
     bool is_cube;
     uint16_t mip_count;
     uint32_t memory_needed;
+    // the content is decoded by a compute shader, the image is then written to as a storage image
+    bool use_compute_decode;
 };
 
 struct VKTextureCache : public TextureCache {
@@ -58,6 +60,13 @@ struct VKTextureCache : public TextureCache {
     std::array<TextureCacheEntry, TextureCacheSize> textures;
     std::vector<vk::Sampler> samplers;
 
+    // used to decode PVRT and YUV420 textures, and BC textures when the GPU does not support them
+    vk::DescriptorSetLayout decode_set_layout;
+    vk::PipelineLayout decode_pipeline_layout;
+    vk::Pipeline decode_bcn_pipeline;
+    vk::Pipeline decode_pvrtc_pipeline;
+    vk::Pipeline decode_yuv420_pipeline;
+
     TextureCacheEntry *current_texture = nullptr;
     const SceGxmTexture *gxm_texture = nullptr;
     vk::CommandBuffer cmd_buffer = nullptr;
@@ -66,11 +75,18 @@ struct VKTextureCache : public TextureCache {
     VKTextureCache(VKState &state);
     // get an available staging buffer, wait for one if all are busy
     void prepare_staging_buffer(bool is_configure = false);
+    // return false if the shaders could not be loaded
+    bool init_compute_decode();
+    void record_compute_decode(SceGxmTextureBaseFormat base_format, uint32_t width, uint32_t height, uint32_t mip_index, int face, uint32_t pixels_per_stride, vk::DeviceSize upload_size);
 
-    bool init(const bool hashless_texture_cache, const fs::path &texture_folder, const std::string_view game_id);
+    // compute_decode: decode PVRT, YUV420 and unsupported BC textures with compute shaders instead of on the CPU
+    bool init(const bool hashless_texture_cache, const fs::path &texture_folder, const std::string_view game_id, const bool compute_decode);
     void select(size_t index, const SceGxmTexture &texture) override;
     void configure_texture(const SceGxmTexture &texture) override;
     void upload_texture_impl(SceGxmTextureBaseFormat base_format, uint32_t width, uint32_t height, uint32_t mip_index, const void *pixels, int face, uint32_t pixels_per_stride) override;
+    uint8_t *reserve_texture_upload(SceGxmTextureBaseFormat base_format, uint32_t width, uint32_t height, uint32_t mip_index, int face, uint32_t pixels_per_stride) override;
+    void write_texture_upload(uint8_t *dest, SceGxmTextureBaseFormat base_format, uint32_t height, const void *pixels, uint32_t pixels_per_stride) const override;
+    void release_texture(size_t index) override;
     void upload_done() override;
 
     void configure_sampler(size_t index, const SceGxmTexture &texture) override;
@@ -105,6 +121,9 @@ struct FrameObject {
     // descriptor for the color surface
     FrameDescriptor color_descriptor;
 
+    // descriptors used to decode textures with a compute shader
+    FrameDescriptor decode_descriptor;
+
     // destroy gpu objects MAX_FRAMES_RENDERING frames later to make sure they are no longer being used
     vkutil::DestroyQueue destroy_queue;
 };
@@ -241,6 +260,8 @@ struct VKContext : public renderer::Context {
     vk::RenderPass current_render_pass;
     vk::RenderPass current_shader_interlock_pass = nullptr;
     vk::Pipeline current_pipeline;
+    // current_pipeline is a fallback pipeline, used until the one matching the state is compiled
+    bool is_fallback_pipeline = false;
 
     vk::Framebuffer current_framebuffer;
     vk::Framebuffer current_shader_interlock_framebuffer = nullptr;
@@ -236,6 +236,9 @@ bool create(std::unique_ptr<VertexProgram> &vp, State &state, const SceGxmProgra
         }
     }
 
+    // the attributes are needed to translate vertex programs, so this can't be done when the program is registered
+    translate_shader_speculatively(state, program, &attributes);
+
     return true;
 }
 
@@ -17,6 +17,7 @@
 
 #include <renderer/functions.h>
 #include <renderer/profile.h>
+#include <renderer/shader_jobs.h>
 #include <renderer/state.h>
 #include <renderer/types.h>
 
@@ -271,6 +272,14 @@ bool GLState::init() {
 
 void GLState::late_init(const Config &cfg, const std::string_view game_id, MemState &mem) {
     texture_cache.init(cfg.hashless_texture_cache, texture_folder(), game_id);
+
+    // in MiB, 0 means the caches are only limited by their number of entries
+    memory_budget.set_budget(static_cast<uint64_t>(std::max(cfg.vram_budget, 0)) * MiB(1));
+    texture_cache.memory_budget = &memory_budget;
+
+    // in MiB, 0 means the size of the folder is not limited
+    if (cfg.disk_texture_cache)
+        texture_cache.init_disk_cache(static_cast<uint64_t>(std::max(cfg.disk_texture_cache_size, 0)) * MiB(1));
 }
 
 bool create(std::unique_ptr<Context> &context) {
@@ -762,6 +771,11 @@ void GLState::precompile_shader(const ShadersHash &hash) {
     pre_compile_program(*this, hash);
 }
 
-void GLState::preclose_action() {}
+void GLState::preclose_action() {
+    // the jobs still running may add shaders to the cache
+    shader_jobs.reset();
+
+    memory_budget.log_stats();
+}
 
 } // namespace renderer::gl
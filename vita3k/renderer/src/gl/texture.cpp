@@ -61,6 +61,19 @@ void GLTextureCache::select(size_t index, const SceGxmTexture &texture) {
     glBindTexture(get_gl_texture_type(texture), gl_texture);
 }
 
+// GL can't tell how much memory a texture takes, estimate it from the format it is stored with
+static size_t get_level_memory_size(SceGxmTextureBaseFormat base_format, uint32_t width, uint32_t height) {
+    if (gxm::is_bcn_format(base_format))
+        return renderer::texture::get_compressed_size(base_format, width, height);
+
+    uint32_t bpp = gxm::bits_per_pixel(base_format);
+    // these formats are converted to rgba8 before being uploaded
+    if (gxm::is_paletted_format(base_format) || gxm::is_pvrt_format(base_format) || gxm::is_yuv_format(base_format))
+        bpp = 32;
+
+    return static_cast<size_t>(width) * height * ((bpp + 7) / 8);
+}
+
 void GLTextureCache::configure_texture(const SceGxmTexture &gxm_texture) {
     R_PROFILE(__func__);
 
@@ -105,6 +118,7 @@ void GLTextureCache::configure_texture(const SceGxmTexture &gxm_texture) {
         face_total_count = 6;
     }
 
+    current_info->memory_size = 0;
     while (face_iterated < face_total_count && width && height) {
         if (compressed) {
             size_t compressed_size = renderer::texture::get_compressed_size(base_fmt, width, height);
@@ -112,6 +126,7 @@ void GLTextureCache::configure_texture(const SceGxmTexture &gxm_texture) {
         } else {
             glTexImage2D(upload_type, mip_index, internal_format, width, height, 0, format, type, nullptr);
         }
+        current_info->memory_size += get_level_memory_size(base_fmt, width, height);
 
         mip_index++;
         width /= 2;
@@ -166,6 +181,10 @@ void GLTextureCache::upload_texture_impl(SceGxmTextureBaseFormat base_format, ui
     }
 }
 
+void GLTextureCache::release_texture(size_t index) {
+    textures.recreate(index);
+}
+
 void GLTextureCache::import_configure_impl(SceGxmTextureBaseFormat base_format, uint32_t width, uint32_t height, bool is_srgb, uint16_t nb_components, uint16_t mipcount, bool swap_rb) {
     SceGxmTexture &gxm_texture = current_info->texture;
     GLint default_swizzle[] = { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA };
@@ -196,6 +215,7 @@ void GLTextureCache::import_configure_impl(SceGxmTextureBaseFormat base_format,
     if (is_cube)
         upload_type = GL_TEXTURE_CUBE_MAP_POSITIVE_X;
 
+    current_info->memory_size = 0;
     for (uint32_t face = 0; face < (is_cube ? 6U : 1U); face++) {
         uint32_t mip_width = width;
         uint32_t mip_height = height;
@@ -206,6 +226,7 @@ void GLTextureCache::import_configure_impl(SceGxmTextureBaseFormat base_format,
             } else {
                 glTexImage2D(upload_type, mip, internal_format, mip_width, mip_height, 0, format, type, nullptr);
             }
+            current_info->memory_size += get_level_memory_size(base_format, mip_width, mip_height);
             mip_width /= 2;
             mip_height /= 2;
         }
@@ -0,0 +1,58 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <renderer/memory_budget.h>
+
+#include <util/log.h>
+
+#include <cassert>
+
+namespace renderer {
+
+static const char *const cache_names[] = { "texture", "surface" };
+
+void MemoryBudget::resize_entry(CacheType type, uint64_t previous_size, uint64_t new_size) {
+    CacheStats &cache_stats = stats[static_cast<size_t>(type)];
+    assert(cache_stats.bytes >= previous_size);
+    cache_stats.bytes = cache_stats.bytes - previous_size + new_size;
+}
+
+uint64_t MemoryBudget::get_used() const {
+    uint64_t used = 0;
+    for (const CacheStats &cache_stats : stats)
+        used += cache_stats.bytes;
+
+    return used;
+}
+
+uint64_t MemoryBudget::get_excess() const {
+    if (budget == 0)
+        return 0;
+
+    const uint64_t used = get_used();
+    return (used > budget) ? used - budget : 0;
+}
+
+void MemoryBudget::log_stats() const {
+    for (size_t i = 0; i < stats.size(); i++) {
+        const CacheStats &cache_stats = stats[i];
+        LOG_INFO("{} cache: {} hits, {} misses, {} evictions, {} MiB in use", cache_names[i], cache_stats.hits, cache_stats.misses,
+            cache_stats.evictions, cache_stats.bytes / (1024 * 1024));
+    }
+}
+
+} // namespace renderer
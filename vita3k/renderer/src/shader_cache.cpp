@@ -0,0 +1,384 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#include <renderer/shader_cache.h>
+
+#include <util/log.h>
+
+#include <cstring>
+
+namespace renderer {
+
+// 'VSHC'
+static constexpr uint32_t SHADER_CACHE_MAGIC = 0x43485356;
+// increase it when the layout of the file changes
+static constexpr uint32_t SHADER_CACHE_FORMAT = 1;
+
+// the file is compacted when it is opened if more than 1/COMPACT_RATIO of it is wasted
+static constexpr uint64_t COMPACT_RATIO = 4;
+
+struct ShaderCacheFileHeader {
+    uint32_t magic;
+    uint32_t format;
+    // shader::CURRENT_VERSION
+    uint32_t version;
+    uint32_t features_mask;
+};
+
+// kinds of entries, the shaders use the ShaderCacheType values
+enum : uint32_t {
+    // combined with the type of speculative shaders
+    ENTRY_SPECULATIVE = 0x80,
+    ENTRY_PROGRAM = 0x100,
+};
+
+struct ShaderCacheEntryHeader {
+    uint32_t kind;
+    // size of the payload following this header
+    uint32_t size;
+};
+
+// at the beginning of the payload of shader entries, followed by the shader itself
+struct ShaderCacheShaderHeader {
+    Sha256Hash hash;
+    uint64_t hints_hash;
+};
+
+static bool is_shader_kind(uint32_t kind) {
+    kind &= ~ENTRY_SPECULATIVE;
+    return kind == static_cast<uint32_t>(ShaderCacheType::Glsl) || kind == static_cast<uint32_t>(ShaderCacheType::Spirv);
+}
+
+static void write_entry(fs::ofstream &file, uint32_t kind, const uint8_t *payload, uint32_t size) {
+    const ShaderCacheEntryHeader header{ kind, size };
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(payload), size);
+}
+
+static bool write_file_header(fs::ofstream &file, uint32_t version, uint32_t features_mask) {
+    const ShaderCacheFileHeader header{ SHADER_CACHE_MAGIC, SHADER_CACHE_FORMAT, version, features_mask };
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    return static_cast<bool>(file);
+}
+
+ShaderCacheFile::~ShaderCacheFile() {
+    close();
+}
+
+void ShaderCacheFile::clear_index() {
+    shaders.clear();
+    latest_shaders.clear();
+    programs.clear();
+    known_programs.clear();
+    claimed_shaders.clear();
+    appended.clear();
+    wasted_size = 0;
+    damaged = false;
+}
+
+void ShaderCacheFile::close() {
+    output.close();
+    mapping.close();
+    clear_index();
+}
+
+void ShaderCacheFile::add_entry(uint32_t kind, const uint8_t *payload, uint32_t size) {
+    if (kind == ENTRY_PROGRAM) {
+        if (size != sizeof(ShadersHash)) {
+            wasted_size += sizeof(ShaderCacheEntryHeader) + size;
+            return;
+        }
+
+        ShadersHash program;
+        memcpy(&program, payload, sizeof(ShadersHash));
+        if (known_programs.emplace(program.frag, program.vert).second)
+            programs.push_back(program);
+        else
+            wasted_size += sizeof(ShaderCacheEntryHeader) + size;
+        return;
+    }
+
+    if (!is_shader_kind(kind) || size < sizeof(ShaderCacheShaderHeader)) {
+        wasted_size += sizeof(ShaderCacheEntryHeader) + size;
+        return;
+    }
+
+    ShaderCacheShaderHeader shader_header;
+    memcpy(&shader_header, payload, sizeof(ShaderCacheShaderHeader));
+    const bool speculative = (kind & ENTRY_SPECULATIVE) != 0;
+    const ShaderCacheType type = static_cast<ShaderCacheType>(kind & ~ENTRY_SPECULATIVE);
+    const ShaderCacheKey key{ shader_header.hash, shader_header.hints_hash, type };
+    const Entry entry{ payload + sizeof(ShaderCacheShaderHeader), static_cast<uint32_t>(size - sizeof(ShaderCacheShaderHeader)), speculative };
+
+    auto [it, inserted] = shaders.insert({ key, entry });
+    if (!inserted) {
+        if (speculative) {
+            // the shader was already there, the speculative one is of no use
+            wasted_size += sizeof(ShaderCacheEntryHeader) + size;
+            return;
+        }
+
+        // only the most recent one can be looked up
+        wasted_size += sizeof(ShaderCacheEntryHeader) + sizeof(ShaderCacheShaderHeader) + it->second.size;
+        it->second = entry;
+    }
+
+    // the hints of a speculative shader are only a guess, it must not be used when they are unknown
+    if (!speculative)
+        latest_shaders[{ key.hash, type }] = entry;
+}
+
+bool ShaderCacheFile::map_file() {
+    clear_index();
+
+    if (!fs::exists(path) || !mapping.open(path))
+        return false;
+
+    const uint8_t *data = mapping.data();
+    const size_t size = mapping.size();
+
+    ShaderCacheFileHeader header;
+    if (size < sizeof(header)) {
+        mapping.close();
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != SHADER_CACHE_MAGIC || header.format != SHADER_CACHE_FORMAT || header.version != version || header.features_mask != features_mask) {
+        mapping.close();
+        return false;
+    }
+
+    // the whole index is going to be read right away
+    mapping.prefetch(0, size);
+
+    size_t offset = sizeof(header);
+    while (offset < size) {
+        ShaderCacheEntryHeader entry_header;
+        // the app was most likely closed while this entry was being written
+        if (size - offset < sizeof(entry_header)) {
+            damaged = true;
+            break;
+        }
+        memcpy(&entry_header, data + offset, sizeof(entry_header));
+        if (size - offset - sizeof(entry_header) < entry_header.size) {
+            damaged = true;
+            break;
+        }
+
+        add_entry(entry_header.kind, data + offset + sizeof(entry_header), entry_header.size);
+        offset += sizeof(entry_header) + entry_header.size;
+    }
+
+    if (damaged)
+        LOG_WARN("The end of the shader cache {} is damaged, the last {} bytes are ignored", path, size - offset);
+
+    return true;
+}
+
+bool ShaderCacheFile::open(const fs::path &path, uint32_t version, uint32_t features_mask) {
+    close();
+    this->path = path;
+    this->version = version;
+    this->features_mask = features_mask;
+
+    if (!map_file())
+        return false;
+
+    if (damaged || wasted_size * COMPACT_RATIO > mapping.size()) {
+        LOG_INFO("Compacting the shader cache, {} bytes can be reclaimed", wasted_size);
+        if (!compact()) {
+            close();
+            return false;
+        }
+    }
+
+    output.open(path, std::ios::out | std::ios::binary | std::ios::app);
+    if (!output.is_open()) {
+        LOG_ERROR("Failed to open {} for writing", path);
+        close();
+        return false;
+    }
+
+    LOG_INFO("Shader cache loaded with {} shaders and {} programs", shaders.size(), programs.size());
+    return true;
+}
+
+bool ShaderCacheFile::create(const fs::path &path, uint32_t version, uint32_t features_mask) {
+    close();
+    this->path = path;
+    this->version = version;
+    this->features_mask = features_mask;
+
+    fs::create_directories(path.parent_path());
+    {
+        fs::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open() || !write_file_header(file, version, features_mask)) {
+            LOG_ERROR("Failed to create the shader cache {}", path);
+            return false;
+        }
+    }
+
+    return open(path, version, features_mask);
+}
+
+bool ShaderCacheFile::compact() {
+    const fs::path temp_path = fs::path(path).concat(".tmp");
+    {
+        fs::ofstream file(temp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open() || !write_file_header(file, version, features_mask))
+            return false;
+
+        // the most recent shader for each hash must be written last so that it is still the one looked up without hints
+        for (const bool write_latest : { false, true }) {
+            for (const auto &[key, entry] : shaders) {
+                const auto latest = latest_shaders.find({ key.hash, key.type });
+                const bool is_latest = latest != latest_shaders.end() && latest->second.data == entry.data;
+                if (is_latest != write_latest)
+                    continue;
+
+                std::vector<uint8_t> payload(sizeof(ShaderCacheShaderHeader) + entry.size);
+                const ShaderCacheShaderHeader shader_header{ key.hash, key.hints_hash };
+                memcpy(payload.data(), &shader_header, sizeof(shader_header));
+                memcpy(payload.data() + sizeof(shader_header), entry.data, entry.size);
+                const uint32_t kind = static_cast<uint32_t>(key.type) | (entry.speculative ? ENTRY_SPECULATIVE : 0);
+                write_entry(file, kind, payload.data(), static_cast<uint32_t>(payload.size()));
+            }
+        }
+
+        for (const ShadersHash &program : programs)
+            write_entry(file, ENTRY_PROGRAM, reinterpret_cast<const uint8_t *>(&program), sizeof(ShadersHash));
+
+        if (!file) {
+            file.close();
+            fs::remove(temp_path);
+            return false;
+        }
+    }
+
+    // the file can't be replaced while it is in use
+    const bool was_writing = output.is_open();
+    output.close();
+    mapping.close();
+
+    boost::system::error_code err;
+    fs::rename(temp_path, path, err);
+    if (err) {
+        LOG_ERROR("Failed to replace {}: {}", path, err.message());
+        fs::remove(temp_path, err);
+    }
+
+    if (!map_file() || damaged)
+        return false;
+
+    if (was_writing)
+        output.open(path, std::ios::out | std::ios::binary | std::ios::app);
+
+    return true;
+}
+
+const ShaderCacheFile::Entry *ShaderCacheFile::find(const ShaderCacheKey &key) {
+    if (key.hints_hash == ShaderCacheKey::ANY_HINTS) {
+        const auto it = latest_shaders.find({ key.hash, key.type });
+        return it == latest_shaders.end() ? nullptr : &it->second;
+    }
+
+    const auto it = shaders.find(key);
+    return it == shaders.end() ? nullptr : &it->second;
+}
+
+bool ShaderCacheFile::load(const ShaderCacheKey &key, std::string &source) {
+    std::lock_guard<std::mutex> guard(mutex);
+    const Entry *entry = find(key);
+    if (!entry || entry->size == 0)
+        return false;
+
+    source.assign(reinterpret_cast<const char *>(entry->data), entry->size);
+    if (entry->speculative)
+        append_shader(key, source.data(), source.size(), false);
+    return true;
+}
+
+bool ShaderCacheFile::load(const ShaderCacheKey &key, std::vector<uint32_t> &source) {
+    std::lock_guard<std::mutex> guard(mutex);
+    const Entry *entry = find(key);
+    if (!entry || entry->size == 0)
+        return false;
+
+    source.resize((entry->size + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+    memcpy(source.data(), entry->data, entry->size);
+    if (entry->speculative)
+        append_shader(key, source.data(), entry->size, false);
+    return true;
+}
+
+void ShaderCacheFile::append_shader(const ShaderCacheKey &key, const void *data, size_t size, bool speculative) {
+    if (!output.is_open())
+        return;
+
+    const uint32_t kind = static_cast<uint32_t>(key.type) | (speculative ? ENTRY_SPECULATIVE : 0);
+    const uint32_t payload_size = static_cast<uint32_t>(sizeof(ShaderCacheShaderHeader) + size);
+    std::unique_ptr<uint8_t[]> payload = std::make_unique<uint8_t[]>(payload_size);
+    const ShaderCacheShaderHeader shader_header{ key.hash, key.hints_hash };
+    memcpy(payload.get(), &shader_header, sizeof(shader_header));
+    memcpy(payload.get() + sizeof(shader_header), data, size);
+
+    write_entry(output, kind, payload.get(), payload_size);
+    output.flush();
+
+    add_entry(kind, payload.get(), payload_size);
+    appended.push_back(std::move(payload));
+}
+
+void ShaderCacheFile::store(const ShaderCacheKey &key, const void *data, size_t size, bool speculative) {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (speculative)
+        claimed_shaders.erase(key);
+    append_shader(key, data, size, speculative);
+}
+
+bool ShaderCacheFile::claim_speculative(const ShaderCacheKey &key) {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (!output.is_open() || shaders.contains(key))
+        return false;
+
+    return claimed_shaders.insert(key).second;
+}
+
+std::vector<ShadersHash> ShaderCacheFile::get_programs() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return programs;
+}
+
+void ShaderCacheFile::store_programs(const std::vector<ShadersHash> &new_programs) {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (!output.is_open())
+        return;
+
+    bool has_written = false;
+    for (const ShadersHash &program : new_programs) {
+        if (!known_programs.emplace(program.frag, program.vert).second)
+            continue;
+
+        programs.push_back(program);
+        write_entry(output, ENTRY_PROGRAM, reinterpret_cast<const uint8_t *>(&program), sizeof(ShadersHash));
+        has_written = true;
+    }
+
+    if (has_written)
+        output.flush();
+}
+
+} // namespace renderer
@@ -0,0 +1,62 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <renderer/shader_jobs.h>
+
+#include <util/log.h>
+
+#include <algorithm>
+
+namespace renderer {
+
+ShaderJobPool::ShaderJobPool() {
+    // the main thread only draws the progress at boot and the jobs are short lived once the app runs
+    const int nb_logical_threads = static_cast<int>(std::thread::hardware_concurrency());
+    const int nb_worker_threads = std::max(nb_logical_threads - 1, 1);
+
+    LOG_INFO("Using {} threads for shader translation", nb_worker_threads);
+    for (int i = 0; i < nb_worker_threads; i++)
+        threads.emplace_back(&ShaderJobPool::worker_thread, this);
+}
+
+ShaderJobPool::~ShaderJobPool() {
+    for (size_t i = 0; i < threads.size(); i++)
+        queue.enqueue(std::function<void()>());
+
+    for (auto &thread : threads)
+        thread.join();
+}
+
+void ShaderJobPool::submit(std::function<void()> job) {
+    queue.enqueue(std::move(job));
+}
+
+void ShaderJobPool::worker_thread() {
+    moodycamel::ConsumerToken consumer_token(queue);
+
+    std::function<void()> job;
+    while (true) {
+        queue.wait_dequeue(consumer_token, job);
+
+        if (!job)
+            break;
+
+        job();
+    }
+}
+
+} // namespace renderer
@@ -14,48 +14,63 @@
 // You should have received a copy of the GNU General Public License along
 // with this program; if not, write to the Free Software Foundation, Inc.,
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
-
 #include <renderer/shaders.h>
 
 #include <renderer/vulkan/state.h>
 
+#include <gxm/functions.h>
 #include <gxm/types.h>
+#include <renderer/functions.h>
+#include <renderer/shader_cache.h>
+#include <renderer/shader_jobs.h>
 #include <renderer/state.h>
 #include <renderer/types.h>
 #include <shader/spirv_recompiler.h>
 #include <util/fs.h>
 #include <util/log.h>
 
+// don't use the dispatch version, because we always hash a small amount
+// with a known size
+#define XXH_INLINE_ALL
+#include <xxhash.h>
+
+#include <algorithm>
 #include <string>
 #include <vector>
 
 namespace renderer {
 
-bool get_shaders_cache_hashs(State &renderer) {
-    const std::string hash_file_name = fmt::format("hashs-{}.dat", (renderer.current_backend == Backend::OpenGL) ? "gl" : "vk");
+State::~State() = default;
 
-    fs::ifstream shaders_hashs(renderer.shaders_path / hash_file_name, std::ios::in | std::ios::binary);
-    if (!shaders_hashs.is_open())
-        return false;
+static const char *get_backend_suffix(const State &renderer) {
+    return (renderer.current_backend == Backend::OpenGL) ? "gl" : "vk";
+}
 
+bool get_shaders_cache_hashs(State &renderer, bool shader_cache) {
     renderer.shaders_cache_hashs.clear();
-    // Read size of hashes list
-    size_t size;
-    shaders_hashs.read((char *)&size, sizeof(size));
-
-    // Check version of cache and device id
-    uint32_t versionInFile;
-    shaders_hashs.read((char *)&versionInFile, sizeof(uint32_t));
-    uint32_t features_mask;
-    shaders_hashs.read((char *)&features_mask, sizeof(uint32_t));
-    if (versionInFile != shader::CURRENT_VERSION || features_mask != renderer.get_features_mask()) {
-        shaders_hashs.close();
+
+    // without the pool, the shaders are neither precompiled nor translated ahead of time
+    if (!shader_cache)
+        renderer.shader_jobs.reset();
+    else if (!renderer.shader_jobs)
+        renderer.shader_jobs = std::make_unique<ShaderJobPool>();
+
+    // the cache used to be made of one file per shader along with a list of the hashes
+    if (fs::exists(renderer.shaders_path / fmt::format("hashs-{}.dat", get_backend_suffix(renderer)))) {
         fs::remove_all(renderer.shaders_path);
         fs::remove_all(renderer.shaders_log_path);
-        if (versionInFile != shader::CURRENT_VERSION)
-            LOG_WARN("Current version of cache: {}, is outdated, recreate it.", versionInFile);
-        else
-            LOG_WARN("Incompatible GPU features enabled, recreating shader cache");
+        LOG_WARN("Shader cache is in an outdated format, recreate it.");
+    }
+
+    const fs::path cache_file_path = renderer.shaders_path / fmt::format("shaders-{}.bin", get_backend_suffix(renderer));
+    if (!renderer.shader_cache_file.open(cache_file_path, shader::CURRENT_VERSION, renderer.get_features_mask())) {
+        if (fs::exists(cache_file_path)) {
+            fs::remove_all(renderer.shaders_path);
+            fs::remove_all(renderer.shaders_log_path);
+            LOG_WARN("Shader cache is outdated or was made with incompatible GPU features, recreate it.");
+        }
+
+        renderer.shader_cache_file.create(cache_file_path, shader::CURRENT_VERSION, renderer.get_features_mask());
         return false;
     }
 
@@ -64,77 +79,13 @@ bool get_shaders_cache_hashs(State &renderer) {
         dynamic_cast<vulkan::VKState &>(renderer).pipeline_cache.read_pipeline_cache();
     }
 
-    // Read Hashs info value
-    for (size_t a = 0; a < size; a++) {
-        auto read = [&shaders_hashs]() {
-            Sha256Hash hash;
-
-            shaders_hashs.read(reinterpret_cast<char *>(hash.data()), sizeof(Sha256Hash));
-
-            return hash;
-        };
-
-        ShadersHash hash;
-        hash.frag = read();
-        hash.vert = read();
-
-        renderer.shaders_cache_hashs.push_back({ hash.frag, hash.vert });
-    }
-
-    shaders_hashs.close();
+    renderer.shaders_cache_hashs = renderer.shader_cache_file.get_programs();
 
     return !renderer.shaders_cache_hashs.empty();
 }
 
 void save_shaders_cache_hashs(State &renderer, std::vector<ShadersHash> &shaders_cache_hashs) {
-    fs::create_directories(renderer.shaders_path);
-    std::string hash_file_name = fmt::format("hashs-{}.dat", (renderer.current_backend == Backend::OpenGL) ? "gl" : "vk");
-    fs::ofstream shaders_hashs(renderer.shaders_path / hash_file_name, std::ios::out | std::ios::binary);
-
-    if (shaders_hashs.is_open()) {
-        // Write Size of shaders cache hashes list
-        const auto size = shaders_cache_hashs.size();
-        shaders_hashs.write((const char *)&size, sizeof(size));
-
-        // Write version of cache
-        const uint32_t versionInFile = shader::CURRENT_VERSION;
-        shaders_hashs.write((const char *)&versionInFile, sizeof(uint32_t));
-        const uint32_t features_mask = renderer.get_features_mask();
-        shaders_hashs.write((const char *)&features_mask, sizeof(uint32_t));
-
-        // Write shader hash list
-        for (const auto &hash : shaders_cache_hashs) {
-            auto write = [&shaders_hashs](const Sha256Hash &hash) {
-                shaders_hashs.write(reinterpret_cast<const char *>(hash.data()), sizeof(Sha256Hash));
-            };
-
-            write(hash.frag);
-            write(hash.vert);
-        }
-        shaders_hashs.close();
-    }
-}
-
-static bool load_shader(const fs::path &shader_name, char **destination, std::size_t &size_read) {
-    fs::ifstream is(shader_name, fs::ifstream::binary);
-    if (!is) {
-        return false;
-    }
-
-    is.seekg(0, fs::ifstream::end);
-    size_read = is.tellg();
-    is.seekg(0);
-
-    if (size_read == 0) {
-        return false;
-    }
-
-    if (destination == nullptr) {
-        return true;
-    }
-
-    is.read(*destination, size_read);
-    return true;
+    renderer.shader_cache_file.store_programs(shaders_cache_hashs);
 }
 
 static Sha256Hash get_shader_hash(const SceGxmProgram &program) {
@@ -142,48 +93,63 @@ static Sha256Hash get_shader_hash(const SceGxmProgram &program) {
     return hash_bytes;
 }
 
-template <typename R>
-static R load_shader_generic(const fs::path &shader_path) {
-    std::size_t read_size = 0;
-    R source;
-
-    if (load_shader(shader_path, nullptr, read_size)) {
-        source.resize((read_size + sizeof(typename R::value_type) - 1) / sizeof(typename R::value_type));
+// hash of the hints which can change the translated shader
+// only the ones read when translating this kind of program are used, and only the formats of the texture slots
+// sampled by the program, the other slots keep the formats of the previous draws so they would make the same shader look different
+static uint64_t get_hints_hash(const SceGxmProgram &program, const shader::Hints &hints) {
+    const bool is_vertex = program.is_vertex();
+    const SceGxmTextureFormat *texture_formats = is_vertex ? hints.vertex_textures : hints.fragment_textures;
+
+    uint64_t hash = 0;
+    if (is_vertex) {
+        if (hints.attributes)
+            hash = XXH3_64bits_withSeed(hints.attributes->data(), hints.attributes->size() * sizeof(SceGxmVertexAttribute), hash);
+    } else {
+        hash = XXH3_64bits_withSeed(&hints.color_format, sizeof(hints.color_format), hash);
+    }
 
-        char *dest_pointer = reinterpret_cast<char *>(source.data());
-        load_shader(shader_path, &dest_pointer, read_size);
+    const gxp::TextureInfo textures_used = gxp::get_textures_used(program);
+    for (uint32_t i = 0; i < SCE_GXM_MAX_TEXTURE_UNITS; i++) {
+        if (textures_used[i])
+            hash = XXH3_64bits_withSeed(&texture_formats[i], sizeof(SceGxmTextureFormat), hash ^ i);
     }
 
-    return source;
+    // 0 is used to look for a shader whatever its hints are
+    return (hash == ShaderCacheKey::ANY_HINTS) ? 1 : hash;
 }
 
-static shader::GeneratedShader load_shader_generic(shader::Target target, const SceGxmProgram &program, const FeatureState &features, const shader::Hints &hints, bool maskupdate, const fs::path &shader_cache_path, const fs::path &shaderlog_path, const char *shader_type_str, const std::string &shader_version, bool shader_cache) {
+static shader::GeneratedShader load_shader_generic(shader::Target target, const SceGxmProgram &program, const FeatureState &features, const shader::Hints &hints, bool maskupdate, ShaderCacheFile &shader_cache_file, const fs::path &shaderlog_path, const char *shader_type_str, const std::string &shader_version, bool shader_cache, bool speculative = false) {
     // TODO: no need to recompute the hash here
-    const std::string hash_text = hex_string(get_shader_hash(program));
+    const Sha256Hash hash = get_shader_hash(program);
+    const std::string hash_text = hex_string(hash);
     // Set Shader Hash with Version
     const std::string hash_hex_ver = fmt::format("{}-{}", shader_version, hash_text);
-    const auto get_shader_path = [&](const char *ext) {
-        return shader_cache_path / fmt::format("{}.{}", hash_hex_ver, ext);
-    };
     const auto get_shaderlog_path = [&](const char *ext) {
         return shaderlog_path / fmt::format("{}.{}", hash_hex_ver, ext);
     };
 
-    const auto shader_path = get_shader_path(shader_type_str);
-    if (shader_cache) {
+    const ShaderCacheKey key{
+        .hash = hash,
+        .hints_hash = get_hints_hash(program, hints),
+        .type = (target == shader::Target::GLSLOpenGL) ? ShaderCacheType::Glsl : ShaderCacheType::Spirv
+    };
+    if (speculative) {
+        // the shader is already in the cache or another thread is translating it
+        if (!shader_cache_file.claim_speculative(key))
+            return {};
+    } else if (shader_cache) {
         if (target == shader::Target::GLSLOpenGL) {
-            std::string source = load_shader_generic<std::string>(shader_path);
-            if (!source.empty()) {
+            std::string source;
+            if (shader_cache_file.load(key, source))
                 return { source, std::vector<uint32_t>() };
-            }
         } else {
-            std::vector<uint32_t> source = load_shader_generic<std::vector<uint32_t>>(get_shader_path("spv"));
-            if (!source.empty())
+            std::vector<uint32_t> source;
+            if (shader_cache_file.load(key, source))
                 return { "", source };
         }
     }
 
-    LOG_INFO("Generating {} shader {}", shader_type_str, hash_text);
+    LOG_INFO("Generating {} shader {}{}", shader_type_str, hash_text, speculative ? " ahead of time" : "");
 
     fs::create_directories(shaderlog_path);
 
@@ -192,13 +158,8 @@ static shader::GeneratedShader load_shader_generic(shader::Target target, const
     // Dump gxp binary
     fs_utils::dump_data(shader_log_path, &program, program.size);
     const auto write_data_with_ext = [&](const std::string &ext, const std::string &data) {
-        fs::path out_path;
-        if (ext == shader_type_str) {
-            out_path = shader_path;
-        } else {
-            out_path = shader_log_path;
-            out_path.replace_extension(ext);
-        }
+        fs::path out_path = shader_log_path;
+        out_path.replace_extension(ext);
         fs_utils::dump_data(out_path, data.c_str(), data.size());
         return true;
     };
@@ -206,18 +167,15 @@ static shader::GeneratedShader load_shader_generic(shader::Target target, const
     shader::GeneratedShader source = shader::convert_gxp(program, hash_text, features, target, hints, maskupdate, false, write_data_with_ext);
 
     // Copy shader generate to shaders cache
-    const auto shaders_cache_path = fs::path(shader_cache_path);
-    fs::create_directories(shaders_cache_path);
-
-    if (target != shader::Target::GLSLOpenGL) {
-        const auto shader_dst_path = get_shader_path("spv");
-        fs_utils::dump_data(shader_dst_path, source.spirv.data(), sizeof(uint32_t) * source.spirv.size());
-    }
+    if (target == shader::Target::GLSLOpenGL)
+        shader_cache_file.store(key, source.glsl.data(), source.glsl.size(), speculative);
+    else
+        shader_cache_file.store(key, source.spirv.data(), sizeof(uint32_t) * source.spirv.size(), speculative);
 
     return source;
 }
 
-std::string load_glsl_shader(const SceGxmProgram &program, const FeatureState &features, const shader::Hints &hints, bool maskupdate, const fs::path &shader_cache_path, const fs::path &shader_log_path, const std::string &shader_version, bool shader_cache) {
+std::string load_glsl_shader(const SceGxmProgram &program, const FeatureState &features, const shader::Hints &hints, bool maskupdate, ShaderCacheFile &shader_cache_file, const fs::path &shader_log_path, const std::string &shader_version, bool shader_cache) {
     SceGxmProgramType program_type = program.get_type();
 
     auto shader_type_to_str = [](SceGxmProgramType type) {
@@ -226,25 +184,72 @@ std::string load_glsl_shader(const SceGxmProgram &program, const FeatureState &f
 
     const char *shader_type_str = shader_type_to_str(program_type);
 
-    return load_shader_generic(shader::Target::GLSLOpenGL, program, features, hints, maskupdate, shader_cache_path, shader_log_path, shader_type_str, shader_version, shader_cache).glsl;
+    return load_shader_generic(shader::Target::GLSLOpenGL, program, features, hints, maskupdate, shader_cache_file, shader_log_path, shader_type_str, shader_version, shader_cache).glsl;
 }
 
-std::vector<uint32_t> load_spirv_shader(const SceGxmProgram &program, const FeatureState &features, bool is_vulkan, const shader::Hints &hints, bool maskupdate, const fs::path &shader_cache_path, const fs::path &shader_log_path, const std::string &shader_version, bool shader_cache) {
+std::vector<uint32_t> load_spirv_shader(const SceGxmProgram &program, const FeatureState &features, bool is_vulkan, const shader::Hints &hints, bool maskupdate, ShaderCacheFile &shader_cache_file, const fs::path &shader_log_path, const std::string &shader_version, bool shader_cache) {
     const shader::Target target = is_vulkan ? shader::Target::SpirVVulkan : shader::Target::SpirVOpenGL;
     auto shader_type_to_str = [](SceGxmProgramType type) {
         return (type == SceGxmProgramType::Vertex) ? "vert.spv.txt" : ((type == SceGxmProgramType::Fragment) ? "frag.spv.txt" : "unknown.spv.txt");
     };
     const char *shader_type_str = shader_type_to_str(program.get_type());
 
-    return load_shader_generic(target, program, features, hints, maskupdate, shader_cache_path, shader_log_path, shader_type_str, shader_version, shader_cache).spirv;
+    return load_shader_generic(target, program, features, hints, maskupdate, shader_cache_file, shader_log_path, shader_type_str, shader_version, shader_cache).spirv;
+}
+
+void translate_shader_speculatively(State &state, const SceGxmProgram &program, const std::vector<SceGxmVertexAttribute> *attributes) {
+    if (!state.shader_jobs || !state.shader_cache_file.is_open())
+        return;
+
+    shader::Target target;
+    std::string shader_version;
+    if (state.current_backend == Backend::Vulkan) {
+        target = shader::Target::SpirVVulkan;
+        shader_version = fmt::format("vk{}", shader::CURRENT_VERSION);
+    } else if (!state.features.spirv_shader) {
+        target = shader::Target::GLSLOpenGL;
+        shader_version = state.shader_version;
+    } else {
+        // the OpenGL renderer picks between GLSL and SPIR-V with the config when drawing
+        return;
+    }
+
+    const bool is_vertex = program.is_vertex();
+    const char *shader_type_str;
+    if (target == shader::Target::GLSLOpenGL)
+        shader_type_str = is_vertex ? "vert" : "frag";
+    else
+        shader_type_str = is_vertex ? "vert.spv.txt" : "frag.spv.txt";
+
+    // the app may free the program before the job is run
+    const uint8_t *program_data = reinterpret_cast<const uint8_t *>(&program);
+    std::vector<uint8_t> program_copy(program_data, program_data + program.size);
+    std::vector<SceGxmVertexAttribute> attributes_copy = attributes ? *attributes : std::vector<SceGxmVertexAttribute>();
+
+    state.shader_jobs->submit([&state, target, shader_version, shader_type_str, is_vertex, program_copy = std::move(program_copy), attributes_copy = std::move(attributes_copy)]() {
+        // the same hints as the ones the context starts with, which most draws end up using
+        shader::Hints hints{
+            .attributes = is_vertex ? &attributes_copy : nullptr,
+            .color_format = SCE_GXM_COLOR_FORMAT_U8U8U8U8_ABGR,
+        };
+        std::fill_n(hints.vertex_textures, SCE_GXM_MAX_TEXTURE_UNITS, SCE_GXM_TEXTURE_FORMAT_U8U8U8U8_ABGR);
+        std::fill_n(hints.fragment_textures, SCE_GXM_MAX_TEXTURE_UNITS, SCE_GXM_TEXTURE_FORMAT_U8U8U8U8_ABGR);
+
+        const SceGxmProgram &program = *reinterpret_cast<const SceGxmProgram *>(program_copy.data());
+        load_shader_generic(target, program, state.features, hints, false, state.shader_cache_file, state.shaders_log_path, shader_type_str, shader_version, true, true);
+    });
 }
 
-std::string pre_load_shader_glsl(const fs::path &shader_path) {
-    return load_shader_generic<std::string>(shader_path);
+std::string pre_load_shader_glsl(ShaderCacheFile &shader_cache_file, const Sha256Hash &hash) {
+    std::string source;
+    shader_cache_file.load({ hash, ShaderCacheKey::ANY_HINTS, ShaderCacheType::Glsl }, source);
+    return source;
 }
 
-std::vector<uint32_t> pre_load_shader_spirv(const fs::path &shader_path) {
-    return load_shader_generic<std::vector<uint32_t>>(shader_path);
+std::vector<uint32_t> pre_load_shader_spirv(ShaderCacheFile &shader_cache_file, const Sha256Hash &hash) {
+    std::vector<uint32_t> source;
+    shader_cache_file.load({ hash, ShaderCacheKey::ANY_HINTS, ShaderCacheType::Spirv }, source);
+    return source;
 }
 
 } // namespace renderer
@@ -0,0 +1,773 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <renderer/texture_bcn.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <util/instrset_detect.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSSE3 __attribute__((__target__("ssse3")))
+#include <immintrin.h>
+#else
+#define TARGET_SSSE3
+#include <intrin.h>
+#endif
+#endif
+
+namespace renderer::texture {
+
+// =========================== COMPRESSION ============================
+// Some texture has block compression, when uncompressed will have swizzled layout. Since on some backend, no
+// option is provided to make the GPU driver not try to translate the layout to linear, we have to do uncompress
+// and unswizzled on the CPU.
+
+// This BC decompression code is based on code from AMD GPUOpen's Compressonator
+
+/**
+ * \brief Decompresses one block of a BC1 texture and stores the resulting pixels at the appropriate offset in 'image'.
+ *
+ * \param block_storage     pointer to the block to decompress.
+ * \param image             pointer to image where the decompressed pixel data should be stored.
+ **/
+static void decompress_block_bc1(const uint8_t *block_storage, uint32_t *image) {
+    std::uint16_t n0 = static_cast<std::uint16_t>((block_storage[1] << 8) | block_storage[0]);
+    std::uint16_t n1 = static_cast<std::uint16_t>((block_storage[3] << 8) | block_storage[2]);
+
+    block_storage += 4;
+
+    std::uint8_t r0 = (n0 & 0xF800) >> 8;
+    std::uint8_t g0 = (n0 & 0x07E0) >> 3;
+    std::uint8_t b0 = (n0 & 0x001F) << 3;
+
+    std::uint8_t r1 = (n1 & 0xF800) >> 8;
+    std::uint8_t g1 = (n1 & 0x07E0) >> 3;
+    std::uint8_t b1 = (n1 & 0x001F) << 3;
+
+    r0 |= r0 >> 5;
+    r1 |= r1 >> 5;
+    g0 |= g0 >> 6;
+    g1 |= g1 >> 6;
+    b0 |= b0 >> 5;
+    b1 |= b1 >> 5;
+
+    std::uint32_t c0 = 0xFF000000 | (b0 << 16) | (g0 << 8) | r0;
+    std::uint32_t c1 = 0xFF000000 | (b1 << 16) | (g1 << 8) | r1;
+
+    if (n0 > n1) {
+        std::uint8_t r2 = static_cast<uint8_t>((2 * r0 + r1 + 1) / 3);
+        std::uint8_t r3 = static_cast<uint8_t>((2 * r1 + r0 + 1) / 3);
+        std::uint8_t g2 = static_cast<uint8_t>((2 * g0 + g1 + 1) / 3);
+        std::uint8_t g3 = static_cast<uint8_t>((2 * g1 + g0 + 1) / 3);
+        std::uint8_t b2 = static_cast<uint8_t>((2 * b0 + b1 + 1) / 3);
+        std::uint8_t b3 = static_cast<uint8_t>((2 * b1 + b0 + 1) / 3);
+
+        std::uint32_t c2 = 0xFF000000 | (b2 << 16) | (g2 << 8) | r2;
+        std::uint32_t c3 = 0xFF000000 | (b3 << 16) | (g3 << 8) | r3;
+
+        for (int i = 0; i < 16; ++i) {
+            int index = (block_storage[i / 4] >> (i % 4 * 2)) & 0x03;
+            switch (index) {
+            case 0:
+                image[i] = c0;
+                break;
+            case 1:
+                image[i] = c1;
+                break;
+            case 2:
+                image[i] = c2;
+                break;
+            case 3:
+                image[i] = c3;
+                break;
+            }
+        }
+    } else {
+        // Transparent decode
+        std::uint8_t r2 = static_cast<uint8_t>((r0 + r1) / 2);
+        std::uint8_t g2 = static_cast<uint8_t>((g0 + g1) / 2);
+        std::uint8_t b2 = static_cast<uint8_t>((b0 + b1) / 2);
+
+        std::uint32_t c2 = 0xFF000000 | (b2 << 16) | (g2 << 8) | r2;
+
+        for (int i = 0; i < 16; ++i) {
+            int index = (block_storage[i / 4] >> (i % 4 * 2)) & 0x03;
+            switch (index) {
+            case 0:
+                image[i] = c0;
+                break;
+            case 1:
+                image[i] = c1;
+                break;
+            case 2:
+                image[i] = c2;
+                break;
+            case 3:
+                image[i] = 0x00000000;
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * \brief Decompresses one block of a alpha texture and stores the resulting pixels at the appropriate offset in 'image'.
+ *
+ * \param block_storage     pointer to the block to decompress.
+ * \param image             pointer to image where the decompressed pixel data should be stored.
+ * \param offset            offset to where data should be written.
+ * \param stride            stride between bytes to where data should be written.
+ **/
+static void decompress_block_alpha(const uint8_t *block_storage, uint8_t *image, const uint32_t offset, const uint32_t stride) {
+    uint8_t alpha[8];
+
+    alpha[0] = block_storage[0];
+    alpha[1] = block_storage[1];
+
+    if (alpha[0] > alpha[1]) {
+        // 8-alpha block:  derive the other six alphas.
+        // Bit code 000 = alpha_0, 001 = alpha_1, others are interpolated.
+        alpha[2] = static_cast<uint8_t>((6 * alpha[0] + 1 * alpha[1] + 3) / 7); // bit code 010
+        alpha[3] = static_cast<uint8_t>((5 * alpha[0] + 2 * alpha[1] + 3) / 7); // bit code 011
+        alpha[4] = static_cast<uint8_t>((4 * alpha[0] + 3 * alpha[1] + 3) / 7); // bit code 100
+        alpha[5] = static_cast<uint8_t>((3 * alpha[0] + 4 * alpha[1] + 3) / 7); // bit code 101
+        alpha[6] = static_cast<uint8_t>((2 * alpha[0] + 5 * alpha[1] + 3) / 7); // bit code 110
+        alpha[7] = static_cast<uint8_t>((1 * alpha[0] + 6 * alpha[1] + 3) / 7); // bit code 111
+    } else {
+        // 6-alpha block.
+        // Bit code 000 = alpha_0, 001 = alpha_1, others are interpolated.
+        alpha[2] = static_cast<uint8_t>((4 * alpha[0] + 1 * alpha[1] + 2) / 5); // Bit code 010
+        alpha[3] = static_cast<uint8_t>((3 * alpha[0] + 2 * alpha[1] + 2) / 5); // Bit code 011
+        alpha[4] = static_cast<uint8_t>((2 * alpha[0] + 3 * alpha[1] + 2) / 5); // Bit code 100
+        alpha[5] = static_cast<uint8_t>((1 * alpha[0] + 4 * alpha[1] + 2) / 5); // Bit code 101
+        alpha[6] = 0; // Bit code 110
+        alpha[7] = 255; // Bit code 111
+    }
+
+    image += offset;
+
+    image[stride * 0] = alpha[block_storage[2] & 0x07];
+    image[stride * 1] = alpha[(block_storage[2] >> 3) & 0x07];
+    image[stride * 2] = alpha[((block_storage[3] << 2) & 0x04) | ((block_storage[2] >> 6) & 0x03)];
+    image[stride * 3] = alpha[(block_storage[3] >> 1) & 0x07];
+    image[stride * 4] = alpha[(block_storage[3] >> 4) & 0x07];
+    image[stride * 5] = alpha[((block_storage[4] << 1) & 0x06) | ((block_storage[3] >> 7) & 0x01)];
+    image[stride * 6] = alpha[(block_storage[4] >> 2) & 0x07];
+    image[stride * 7] = alpha[(block_storage[4] >> 5) & 0x07];
+    image[stride * 8] = alpha[block_storage[5] & 0x07];
+    image[stride * 9] = alpha[(block_storage[5] >> 3) & 0x07];
+    image[stride * 10] = alpha[((block_storage[6] << 2) & 0x04) | ((block_storage[5] >> 6) & 0x03)];
+    image[stride * 11] = alpha[(block_storage[6] >> 1) & 0x07];
+    image[stride * 12] = alpha[(block_storage[6] >> 4) & 0x07];
+    image[stride * 13] = alpha[((block_storage[7] << 1) & 0x06) | ((block_storage[6] >> 7) & 0x01)];
+    image[stride * 14] = alpha[(block_storage[7] >> 2) & 0x07];
+    image[stride * 15] = alpha[(block_storage[7] >> 5) & 0x07];
+}
+
+/**
+ * \brief Decompresses one block of a signed alpha texture and stores the resulting pixels at the appropriate offset in 'image'.
+ *
+ * \param block_storage     pointer to the block to decompress.
+ * \param image             pointer to image where the decompressed pixel data should be stored.
+ * \param offset            offset to where data should be written.
+ * \param stride            stride between bytes to where data should be written.
+ **/
+static void decompress_block_alpha_signed(const uint8_t *block_storage, uint8_t *image, const uint32_t offset, const uint32_t stride) {
+    int8_t alpha[8];
+
+    alpha[0] = static_cast<int8_t>(block_storage[0]);
+    alpha[1] = static_cast<int8_t>(block_storage[1]);
+
+    if (alpha[0] > alpha[1]) {
+        // 8-alpha block:  derive the other six alphas.
+        // Bit code 000 = alpha_0, 001 = alpha_1, others are interpolated.
+        alpha[2] = static_cast<int8_t>((6 * alpha[0] + 1 * alpha[1] + 3) / 7); // bit code 010
+        alpha[3] = static_cast<int8_t>((5 * alpha[0] + 2 * alpha[1] + 3) / 7); // bit code 011
+        alpha[4] = static_cast<int8_t>((4 * alpha[0] + 3 * alpha[1] + 3) / 7); // bit code 100
+        alpha[5] = static_cast<int8_t>((3 * alpha[0] + 4 * alpha[1] + 3) / 7); // bit code 101
+        alpha[6] = static_cast<int8_t>((2 * alpha[0] + 5 * alpha[1] + 3) / 7); // bit code 110
+        alpha[7] = static_cast<int8_t>((1 * alpha[0] + 6 * alpha[1] + 3) / 7); // bit code 111
+    } else {
+        // 6-alpha block.
+        // Bit code 000 = alpha_0, 001 = alpha_1, others are interpolated.
+        alpha[2] = static_cast<int8_t>((4 * alpha[0] + 1 * alpha[1] + 2) / 5); // Bit code 010
+        alpha[3] = static_cast<int8_t>((3 * alpha[0] + 2 * alpha[1] + 2) / 5); // Bit code 011
+        alpha[4] = static_cast<int8_t>((2 * alpha[0] + 3 * alpha[1] + 2) / 5); // Bit code 100
+        alpha[5] = static_cast<int8_t>((1 * alpha[0] + 4 * alpha[1] + 2) / 5); // Bit code 101
+        alpha[6] = -128; // Bit code 110
+        alpha[7] = 127; // Bit code 111
+    }
+
+    image += offset;
+
+    image[stride * 0] = static_cast<uint8_t>(alpha[block_storage[2] & 0x07]);
+    image[stride * 1] = static_cast<uint8_t>(alpha[(block_storage[2] >> 3) & 0x07]);
+    image[stride * 2] = static_cast<uint8_t>(alpha[((block_storage[3] << 2) & 0x04) | ((block_storage[2] >> 6) & 0x03)]);
+    image[stride * 3] = static_cast<uint8_t>(alpha[(block_storage[3] >> 1) & 0x07]);
+    image[stride * 4] = static_cast<uint8_t>(alpha[(block_storage[3] >> 4) & 0x07]);
+    image[stride * 5] = static_cast<uint8_t>(alpha[((block_storage[4] << 1) & 0x06) | ((block_storage[3] >> 7) & 0x01)]);
+    image[stride * 6] = static_cast<uint8_t>(alpha[(block_storage[4] >> 2) & 0x07]);
+    image[stride * 7] = static_cast<uint8_t>(alpha[(block_storage[4] >> 5) & 0x07]);
+    image[stride * 8] = static_cast<uint8_t>(alpha[block_storage[5] & 0x07]);
+    image[stride * 9] = static_cast<uint8_t>(alpha[(block_storage[5] >> 3) & 0x07]);
+    image[stride * 10] = static_cast<uint8_t>(alpha[((block_storage[6] << 2) & 0x04) | ((block_storage[5] >> 6) & 0x03)]);
+    image[stride * 11] = static_cast<uint8_t>(alpha[(block_storage[6] >> 1) & 0x07]);
+    image[stride * 12] = static_cast<uint8_t>(alpha[(block_storage[6] >> 4) & 0x07]);
+    image[stride * 13] = static_cast<uint8_t>(alpha[((block_storage[7] << 1) & 0x06) | ((block_storage[6] >> 7) & 0x01)]);
+    image[stride * 14] = static_cast<uint8_t>(alpha[(block_storage[7] >> 2) & 0x07]);
+    image[stride * 15] = static_cast<uint8_t>(alpha[(block_storage[7] >> 5) & 0x07]);
+}
+
+/**
+ * \brief Decompresses one block of a BC2 texture and stores the resulting pixels at the appropriate offset in 'image'.
+ *
+ * \param block_storage     pointer to the block to decompress.
+ * \param image             pointer to image where the decompressed pixel data should be stored.
+ **/
+static void decompress_block_bc2(const uint8_t *block_storage, uint32_t *image) {
+    decompress_block_bc1(block_storage + 8, image);
+
+    for (int i = 0; i < 8; i++) {
+        image[2 * i] = (((block_storage[i] & 0x0F) | ((block_storage[i] & 0x0F) << 4)) << 24) | (image[2 * i] & 0x00FFFFFF);
+        image[2 * i + 1] = (((block_storage[i] & 0xF0) | ((block_storage[i] & 0xF0) >> 4)) << 24) | (image[2 * i + 1] & 0x00FFFFFF);
+    }
+}
+
+/**
+ * \brief Decompresses one block of a BC3 texture and stores the resulting pixels at the appropriate offset in 'image'.
+ *
+ * \param block_storage     pointer to the block to decompress.
+ * \param image             pointer to image where the decompressed pixel data should be stored.
+ **/
+static void decompress_block_bc3(const uint8_t *block_storage, uint32_t *image) {
+    decompress_block_bc1(block_storage + 8, image);
+    decompress_block_alpha(block_storage, reinterpret_cast<std::uint8_t *>(image), 3, 4);
+}
+
+/**
+ * \brief Decompresses one block of a BC4U texture and stores the resulting pixels at the appropriate offset in 'image'.
+ *
+ * \param block_storage     pointer to the block to decompress.
+ * \param image             pointer to image where the decompressed pixel data should be stored.
+ **/
+static void decompress_block_bc4u(const uint8_t *block_storage, uint8_t *image) {
+    for (int i = 0; i < 16; i++)
+        image[i] = 0x00;
+    decompress_block_alpha(block_storage, image, 0, 1);
+}
+
+/**
+ * \brief Decompresses one block of a BC4S texture and stores the resulting pixels at the appropriate offset in 'image'.
+ *
+ * \param block_storage     pointer to the block to decompress.
+ * \param image             pointer to image where the decompressed pixel data should be stored.
+ **/
+static void decompress_block_bc4s(const uint8_t *block_storage, uint8_t *image) {
+    for (int i = 0; i < 16; i++)
+        image[i] = 0x00;
+    decompress_block_alpha_signed(block_storage, image, 0, 1);
+}
+
+/**
+ * \brief Decompresses one block of a BC5U texture and stores the resulting pixels at the appropriate offset in 'image'.
+ *
+ * \param block_storage     pointer to the block to decompress.
+ * \param image             pointer to image where the decompressed pixel data should be stored.
+ **/
+static void decompress_block_bc5u(const uint8_t *block_storage, uint16_t *image) {
+    for (int i = 0; i < 16; i++)
+        image[i] = 0x0000;
+    decompress_block_alpha(block_storage, reinterpret_cast<uint8_t *>(image), 0, 2);
+    decompress_block_alpha(block_storage + 8, reinterpret_cast<uint8_t *>(image), 1, 2);
+}
+
+/**
+ * \brief Decompresses one block of a BC5S texture and stores the resulting pixels at the appropriate offset in 'image'.
+ *
+ * \param block_storage     pointer to the block to decompress.
+ * \param image             pointer to image where the decompressed pixel data should be stored.
+ **/
+static void decompress_block_bc5s(const uint8_t *block_storage, uint16_t *image) {
+    for (int i = 0; i < 16; i++)
+        image[i] = 0x0000;
+    decompress_block_alpha_signed(block_storage, reinterpret_cast<uint8_t *>(image), 0, 2);
+    decompress_block_alpha_signed(block_storage + 8, reinterpret_cast<uint8_t *>(image), 1, 2);
+}
+
+// The image is decompressed one row of blocks at a time. Blocks are handled by groups of 4 so that the
+// SIMD kernels can share the endpoint expansion between them. In both cases, dest points to the top-left
+// texel of the first block and stride is the number of texels in a row of the image.
+template <uint8_t format_id>
+static void decode_block(const uint8_t *block, uint32_t *dest, size_t stride) {
+    uint32_t texels[16];
+    if constexpr (format_id == 1) {
+        decompress_block_bc1(block, texels);
+    } else if constexpr (format_id == 2) {
+        decompress_block_bc2(block, texels);
+    } else if constexpr (format_id == 3) {
+        decompress_block_bc3(block, texels);
+    } else if constexpr (format_id == 4 || format_id == 5) {
+        uint8_t values[16];
+        if constexpr (format_id == 4)
+            decompress_block_bc4u(block, values);
+        else
+            decompress_block_bc4s(block, values);
+        std::copy(values, values + 16, texels);
+    } else {
+        uint16_t values[16];
+        if constexpr (format_id == 6)
+            decompress_block_bc5u(block, values);
+        else
+            decompress_block_bc5s(block, values);
+        std::copy(values, values + 16, texels);
+    }
+
+    for (size_t row = 0; row < 4; row++)
+        memcpy(dest + row * stride, texels + row * 4, 4 * sizeof(uint32_t));
+}
+
+template <uint8_t format_id>
+static void decode_blocks_4(const uint8_t *const blocks[4], uint32_t *dest, size_t stride) {
+    for (size_t i = 0; i < 4; i++)
+        decode_block<format_id>(blocks[i], dest + i * 4, stride);
+}
+
+#if defined(__x86_64__) || defined(_M_X64)
+// SSE2 is always available on x86-64, SSSE3 is only used after a runtime check
+
+// take b where mask is set, a otherwise
+static __m128i blend(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, b), _mm_andnot_si128(mask, a));
+}
+
+// swap the two 16-bit halves of each 32-bit lane
+static __m128i swap_words(__m128i v) {
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+static void store_rows(const __m128i rows[4], uint32_t *dest, size_t stride) {
+    for (size_t row = 0; row < 4; row++)
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + row * stride), rows[row]);
+}
+
+// Expand the RGB565 endpoints of 4 BC1 color blocks and interpolate the other colors of their palettes,
+// this is the same computation as decompress_block_bc1. Each palette contains the 4 RGBA8 colors of a block.
+static void compute_color_palettes(const uint8_t *const blocks[4], __m128i palettes[4], uint32_t indices[4]) {
+    const __m128 first = _mm_castsi128_ps(_mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(blocks[0])),
+        _mm_loadl_epi64(reinterpret_cast<const __m128i *>(blocks[1]))));
+    const __m128 second = _mm_castsi128_ps(_mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(blocks[2])),
+        _mm_loadl_epi64(reinterpret_cast<const __m128i *>(blocks[3]))));
+    // the 16-bit lanes contain c0 and c1 of each block
+    const __m128i endpoints = _mm_castps_si128(_mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(indices), _mm_castps_si128(_mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1))));
+
+    const __m128i r5 = _mm_srli_epi16(endpoints, 11);
+    const __m128i g6 = _mm_and_si128(_mm_srli_epi16(endpoints, 5), _mm_set1_epi16(0x3F));
+    const __m128i b5 = _mm_and_si128(endpoints, _mm_set1_epi16(0x1F));
+    const __m128i red = _mm_or_si128(_mm_slli_epi16(r5, 3), _mm_srli_epi16(r5, 2));
+    const __m128i green = _mm_or_si128(_mm_slli_epi16(g6, 2), _mm_srli_epi16(g6, 4));
+    const __m128i blue = _mm_or_si128(_mm_slli_epi16(b5, 3), _mm_srli_epi16(b5, 2));
+
+    // blocks with c0 > c1 (unsigned comparison) have 4 opaque colors
+    const __m128i sign = _mm_set1_epi16(static_cast<int16_t>(0x8000));
+    const __m128i greater = _mm_cmpgt_epi16(_mm_xor_si128(endpoints, sign), _mm_xor_si128(swap_words(endpoints), sign));
+    const __m128i four_colors = _mm_shufflehi_epi16(_mm_shufflelo_epi16(greater, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 2, 0, 0));
+    const __m128i even_lanes = _mm_set1_epi32(0x0000FFFF);
+
+    // c2 = (2 * c0 + c1 + 1) / 3 and c3 = (2 * c1 + c0 + 1) / 3, or c2 = (c0 + c1) / 2 and c3 = 0
+    const auto interpolate = [&](__m128i c) {
+        const __m128i swapped = swap_words(c);
+        // x / 3 == (x * 0xAAAB) >> 17 for all the values involved
+        const __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_slli_epi16(c, 1), swapped), _mm_set1_epi16(1));
+        const __m128i thirds = _mm_srli_epi16(_mm_mulhi_epu16(sum, _mm_set1_epi16(static_cast<int16_t>(0xAAAB))), 1);
+        const __m128i halves = _mm_and_si128(_mm_srli_epi16(_mm_add_epi16(c, swapped), 1), even_lanes);
+        return blend(four_colors, halves, thirds);
+    };
+
+    const __m128i opaque = _mm_set1_epi16(0xFF);
+    // c3 is transparent black in 3 color blocks
+    const __m128i interpolated_alpha = _mm_and_si128(_mm_or_si128(four_colors, even_lanes), opaque);
+
+    const __m128i rg = _mm_or_si128(red, _mm_slli_epi16(green, 8));
+    const __m128i ba = _mm_or_si128(blue, _mm_slli_epi16(opaque, 8));
+    const __m128i interpolated_rg = _mm_or_si128(interpolate(red), _mm_slli_epi16(interpolate(green), 8));
+    const __m128i interpolated_ba = _mm_or_si128(interpolate(blue), _mm_slli_epi16(interpolated_alpha, 8));
+
+    // c0 c1 of blocks 0 and 1, then of blocks 2 and 3
+    const __m128i endpoints_low = _mm_unpacklo_epi16(rg, ba);
+    const __m128i endpoints_high = _mm_unpackhi_epi16(rg, ba);
+    const __m128i interpolated_low = _mm_unpacklo_epi16(interpolated_rg, interpolated_ba);
+    const __m128i interpolated_high = _mm_unpackhi_epi16(interpolated_rg, interpolated_ba);
+    palettes[0] = _mm_unpacklo_epi64(endpoints_low, interpolated_low);
+    palettes[1] = _mm_unpackhi_epi64(endpoints_low, interpolated_low);
+    palettes[2] = _mm_unpacklo_epi64(endpoints_high, interpolated_high);
+    palettes[3] = _mm_unpackhi_epi64(endpoints_high, interpolated_high);
+}
+
+// look up the color of each texel of a block in its palette, one row of the block per register
+static void expand_color_indices(__m128i palette, uint32_t indices, __m128i rows[4]) {
+    const __m128i colors[4] = {
+        _mm_shuffle_epi32(palette, _MM_SHUFFLE(0, 0, 0, 0)),
+        _mm_shuffle_epi32(palette, _MM_SHUFFLE(1, 1, 1, 1)),
+        _mm_shuffle_epi32(palette, _MM_SHUFFLE(2, 2, 2, 2)),
+        _mm_shuffle_epi32(palette, _MM_SHUFFLE(3, 3, 3, 3)),
+    };
+    // the index of the i-th texel of a row is at bit 2 * i of the row byte
+    const __m128i index_mask = _mm_setr_epi32(0x03, 0x0C, 0x30, 0xC0);
+    const __m128i index_1 = _mm_setr_epi32(0x01, 0x04, 0x10, 0x40);
+    const __m128i index_2 = _mm_setr_epi32(0x02, 0x08, 0x20, 0x80);
+
+    for (int row = 0; row < 4; row++) {
+        const __m128i index = _mm_and_si128(_mm_set1_epi32(static_cast<int32_t>(indices >> (row * 8))), index_mask);
+        const __m128i first = _mm_or_si128(_mm_and_si128(_mm_cmpeq_epi32(index, _mm_setzero_si128()), colors[0]),
+            _mm_and_si128(_mm_cmpeq_epi32(index, index_1), colors[1]));
+        const __m128i second = _mm_or_si128(_mm_and_si128(_mm_cmpeq_epi32(index, index_2), colors[2]),
+            _mm_and_si128(_mm_cmpeq_epi32(index, index_mask), colors[3]));
+        rows[row] = _mm_or_si128(first, second);
+    }
+}
+
+// move 16 values (one byte per texel, in texel order) to the alpha channel of the rows of a block
+static void merge_alpha(__m128i alpha, __m128i rows[4]) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i low = _mm_unpacklo_epi8(zero, alpha);
+    const __m128i high = _mm_unpackhi_epi8(zero, alpha);
+    const __m128i alpha_rows[4] = {
+        _mm_unpacklo_epi16(zero, low),
+        _mm_unpackhi_epi16(zero, low),
+        _mm_unpacklo_epi16(zero, high),
+        _mm_unpackhi_epi16(zero, high),
+    };
+
+    const __m128i color_mask = _mm_set1_epi32(0x00FFFFFF);
+    for (int row = 0; row < 4; row++)
+        rows[row] = _mm_or_si128(_mm_and_si128(rows[row], color_mask), alpha_rows[row]);
+}
+
+// the 4-bit alpha values of a BC2 block expanded to 8 bits, in texel order
+static __m128i decode_explicit_alpha(const uint8_t *block) {
+    const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(block));
+    const __m128i nibble_mask = _mm_set1_epi8(0x0F);
+    const __m128i alpha = _mm_unpacklo_epi8(_mm_and_si128(packed, nibble_mask), _mm_and_si128(_mm_srli_epi16(packed, 4), nibble_mask));
+    return _mm_or_si128(alpha, _mm_slli_epi16(alpha, 4));
+}
+
+// Interpolate the values of a BC3 alpha, BC4 or BC5 channel block for 8 indices at once. Every value is computed
+// directly from its index, which gives the same results as decompress_block_alpha(_signed)
+template <bool is_signed>
+static __m128i interpolate_values(const uint8_t *block, __m128i index) {
+    const int16_t value_0 = is_signed ? static_cast<int8_t>(block[0]) : block[0];
+    const int16_t value_1 = is_signed ? static_cast<int8_t>(block[1]) : block[1];
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i first = _mm_set1_epi16(value_0);
+    const __m128i second = _mm_set1_epi16(value_1);
+
+    // both modes are equally likely, so they are selected without branching
+    const __m128i six_values = _mm_cmpgt_epi16(_mm_add_epi16(second, one), first);
+    const __m128i total_weight = blend(six_values, _mm_set1_epi16(7), _mm_set1_epi16(5));
+    const __m128i rounding = _mm_srli_epi16(total_weight, 1);
+    // x / 7 == (x * 9363) >> 16 and x / 5 == (x * 13108) >> 16 for all the values involved
+    const __m128i reciprocal = blend(six_values, _mm_set1_epi16(9363), _mm_set1_epi16(13108));
+
+    // weight of the second value: none for index 0, all of it for index 1, index - 1 for the others
+    __m128i weight = _mm_max_epi16(_mm_sub_epi16(index, one), zero);
+    weight = _mm_or_si128(weight, _mm_and_si128(_mm_cmpeq_epi16(index, one), total_weight));
+    const __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(first, _mm_sub_epi16(total_weight, weight)),
+                                          _mm_mullo_epi16(second, weight)),
+        rounding);
+
+    __m128i value;
+    if constexpr (is_signed) {
+        // the division truncates toward 0, and the rounding term is not right for negative endpoints
+        const __m128i sign = _mm_srai_epi16(sum, 15);
+        value = _mm_mulhi_epu16(_mm_sub_epi16(_mm_xor_si128(sum, sign), sign), reciprocal);
+        value = _mm_sub_epi16(_mm_xor_si128(value, sign), sign);
+        value = blend(_mm_cmpeq_epi16(index, zero), value, first);
+        value = blend(_mm_cmpeq_epi16(index, one), value, second);
+    } else {
+        value = _mm_mulhi_epu16(sum, reciprocal);
+    }
+
+    // with 6 interpolated values, indices 6 and 7 are the minimum and maximum values
+    value = blend(_mm_and_si128(six_values, _mm_cmpeq_epi16(index, _mm_set1_epi16(6))), value, _mm_set1_epi16(is_signed ? -128 : 0));
+    value = blend(_mm_and_si128(six_values, _mm_cmpeq_epi16(index, _mm_set1_epi16(7))), value, _mm_set1_epi16(is_signed ? 127 : 255));
+    return value;
+}
+
+template <bool is_signed>
+static __m128i pack_values(__m128i low, __m128i high) {
+    return is_signed ? _mm_packs_epi16(low, high) : _mm_packus_epi16(low, high);
+}
+
+// the 3-bit indices of a BC3 alpha, BC4 or BC5 channel block, one byte per texel
+static __m128i get_value_indices(const uint8_t *block) {
+    uint64_t bits = 0;
+    memcpy(&bits, block + 2, 6);
+    const auto spread = [](uint64_t x) {
+        x = (x | (x << 20)) & 0x00000FFF00000FFFULL;
+        x = (x | (x << 10)) & 0x003F003F003F003FULL;
+        x = (x | (x << 5)) & 0x0707070707070707ULL;
+        return static_cast<int64_t>(x);
+    };
+    return _mm_set_epi64x(spread(bits >> 24), spread(bits & 0xFFFFFF));
+}
+
+// with SSSE3, only the 8 palette values are interpolated and the texels are looked up with a single shuffle
+template <bool is_signed>
+static TARGET_SSSE3 __m128i decode_values_ssse3(const uint8_t *block) {
+    const __m128i palette = interpolate_values<is_signed>(block, _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7));
+    return _mm_shuffle_epi8(pack_values<is_signed>(palette, palette), get_value_indices(block));
+}
+
+template <bool is_signed>
+static __m128i decode_values_sse2(const uint8_t *block) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i indices = get_value_indices(block);
+    return pack_values<is_signed>(interpolate_values<is_signed>(block, _mm_unpacklo_epi8(indices, zero)),
+        interpolate_values<is_signed>(block, _mm_unpackhi_epi8(indices, zero)));
+}
+
+static const bool has_ssse3 = util::instrset::instrset_detect() >= util::instrset::instrset_SSSE3;
+
+// the 16 values of a BC3 alpha, BC4 or BC5 channel block, in texel order
+template <bool is_signed>
+static __m128i decode_values(const uint8_t *block) {
+    return has_ssse3 ? decode_values_ssse3<is_signed>(block) : decode_values_sse2<is_signed>(block);
+}
+
+template <uint8_t format_id>
+static void decode_color_blocks_4(const uint8_t *const blocks[4], uint32_t *dest, size_t stride) {
+    // BC2 and BC3 blocks start with the alpha, then contain a BC1 block
+    constexpr size_t color_offset = (format_id == 1) ? 0 : 8;
+    const uint8_t *const color_blocks[4] = { blocks[0] + color_offset, blocks[1] + color_offset, blocks[2] + color_offset, blocks[3] + color_offset };
+
+    __m128i palettes[4];
+    uint32_t indices[4];
+    compute_color_palettes(color_blocks, palettes, indices);
+
+    for (size_t i = 0; i < 4; i++) {
+        __m128i rows[4];
+        expand_color_indices(palettes[i], indices[i], rows);
+        if constexpr (format_id == 2)
+            merge_alpha(decode_explicit_alpha(blocks[i]), rows);
+        else if constexpr (format_id == 3)
+            merge_alpha(decode_values<false>(blocks[i]), rows);
+
+        store_rows(rows, dest + i * 4, stride);
+    }
+}
+
+template <>
+void decode_blocks_4<1>(const uint8_t *const blocks[4], uint32_t *dest, size_t stride) {
+    decode_color_blocks_4<1>(blocks, dest, stride);
+}
+
+template <>
+void decode_blocks_4<2>(const uint8_t *const blocks[4], uint32_t *dest, size_t stride) {
+    decode_color_blocks_4<2>(blocks, dest, stride);
+}
+
+template <>
+void decode_blocks_4<3>(const uint8_t *const blocks[4], uint32_t *dest, size_t stride) {
+    decode_color_blocks_4<3>(blocks, dest, stride);
+}
+
+// BC4 and BC5 blocks have no shared part, so the kernels work on a single block
+template <bool is_signed>
+static void decode_bc4_block(const uint8_t *block, uint32_t *dest, size_t stride) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i values = decode_values<is_signed>(block);
+    const __m128i low = _mm_unpacklo_epi8(values, zero);
+    const __m128i high = _mm_unpackhi_epi8(values, zero);
+    const __m128i rows[4] = {
+        _mm_unpacklo_epi16(low, zero),
+        _mm_unpackhi_epi16(low, zero),
+        _mm_unpacklo_epi16(high, zero),
+        _mm_unpackhi_epi16(high, zero),
+    };
+    store_rows(rows, dest, stride);
+}
+
+template <bool is_signed>
+static void decode_bc5_block(const uint8_t *block, uint32_t *dest, size_t stride) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i red = decode_values<is_signed>(block);
+    const __m128i green = decode_values<is_signed>(block + 8);
+    const __m128i low = _mm_unpacklo_epi8(red, green);
+    const __m128i high = _mm_unpackhi_epi8(red, green);
+    const __m128i rows[4] = {
+        _mm_unpacklo_epi16(low, zero),
+        _mm_unpackhi_epi16(low, zero),
+        _mm_unpacklo_epi16(high, zero),
+        _mm_unpackhi_epi16(high, zero),
+    };
+    store_rows(rows, dest, stride);
+}
+
+template <>
+void decode_block<4>(const uint8_t *block, uint32_t *dest, size_t stride) {
+    decode_bc4_block<false>(block, dest, stride);
+}
+
+template <>
+void decode_block<5>(const uint8_t *block, uint32_t *dest, size_t stride) {
+    decode_bc4_block<true>(block, dest, stride);
+}
+
+template <>
+void decode_block<6>(const uint8_t *block, uint32_t *dest, size_t stride) {
+    decode_bc5_block<false>(block, dest, stride);
+}
+
+template <>
+void decode_block<7>(const uint8_t *block, uint32_t *dest, size_t stride) {
+    decode_bc5_block<true>(block, dest, stride);
+}
+#endif
+
+// masks of the x and y bits in a morton code, used to increment one coordinate without decoding it
+static constexpr uint32_t morton_x_mask = 0xAAAAAAAA;
+static constexpr uint32_t morton_y_mask = 0x55555555;
+
+// Index of the first block of each column (or row) of a swizzled texture. Swizzled textures are made of
+// square areas whose side is the smallest dimension of the texture, the blocks of each area being in
+// morton order, the x bits being the odd bits of the code.
+static std::vector<uint32_t> get_swizzled_offsets(uint32_t count, uint32_t square_size, uint32_t morton_mask) {
+    const uint32_t square_shift = 2 * (std::bit_width(square_size) - 1);
+    std::vector<uint32_t> offsets(count);
+    uint32_t morton = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if ((i & (square_size - 1)) == 0)
+            morton = 0;
+        offsets[i] = ((i / square_size) << square_shift) | morton;
+        morton = (morton - morton_mask) & morton_mask;
+    }
+
+    return offsets;
+}
+
+// only used for swizzled textures whose size is not a power of two, same block placement as resolve_z_order_compressed_image
+template <uint8_t format_id>
+static void decompress_swizzled_blocks_basic(uint32_t width_in_blocks, uint32_t height_in_blocks, const uint8_t *src, uint32_t *image) {
+    constexpr size_t block_size = (format_id == 1 || format_id == 4 || format_id == 5) ? 8 : 16;
+    const size_t stride = static_cast<size_t>(width_in_blocks) * 4;
+    const uint32_t size = std::min(width_in_blocks, height_in_blocks);
+    const uint32_t k = std::bit_width(size) - 1;
+
+    for (uint32_t i = 0; i < width_in_blocks * height_in_blocks; i++) {
+        uint32_t x = 0;
+        uint32_t y = 0;
+        for (uint32_t bit = 0; bit < 16; bit++) {
+            x |= ((i >> (2 * bit + 1)) & 1) << bit;
+            y |= ((i >> (2 * bit)) & 1) << bit;
+        }
+        x &= size - 1;
+        y &= size - 1;
+        const uint32_t upper_bits = (i >> (2 * k)) << k;
+        if (width_in_blocks >= height_in_blocks)
+            x |= upper_bits;
+        else
+            y |= upper_bits;
+
+        if (x < width_in_blocks && y < height_in_blocks)
+            decode_block<format_id>(src + i * block_size, image + y * 4 * stride + x * 4, stride);
+    }
+}
+
+// each texel of the image is written exactly once, right after its block was decoded
+template <uint8_t format_id, bool swizzled>
+static void decompress_blocks(uint32_t width_in_blocks, uint32_t height_in_blocks, const uint8_t *src, uint32_t *image) {
+    constexpr size_t block_size = (format_id == 1 || format_id == 4 || format_id == 5) ? 8 : 16;
+    const size_t stride = static_cast<size_t>(width_in_blocks) * 4;
+
+    std::vector<uint32_t> column_offsets;
+    std::vector<uint32_t> row_offsets;
+    if constexpr (swizzled) {
+        if (!std::has_single_bit(width_in_blocks) || !std::has_single_bit(height_in_blocks)) {
+            decompress_swizzled_blocks_basic<format_id>(width_in_blocks, height_in_blocks, src, image);
+            return;
+        }
+
+        const uint32_t square_size = std::min(width_in_blocks, height_in_blocks);
+        column_offsets = get_swizzled_offsets(width_in_blocks, square_size, morton_x_mask);
+        row_offsets = get_swizzled_offsets(height_in_blocks, square_size, morton_y_mask);
+    } else {
+        column_offsets.resize(width_in_blocks);
+        row_offsets.resize(height_in_blocks);
+        for (uint32_t x = 0; x < width_in_blocks; x++)
+            column_offsets[x] = x;
+        for (uint32_t y = 0; y < height_in_blocks; y++)
+            row_offsets[y] = y * width_in_blocks;
+    }
+
+    for (uint32_t y = 0; y < height_in_blocks; y++) {
+        const uint8_t *row_src = src + static_cast<size_t>(row_offsets[y]) * block_size;
+        uint32_t *row_dest = image + y * 4 * stride;
+
+        uint32_t x = 0;
+        for (; x + 4 <= width_in_blocks; x += 4) {
+            const uint8_t *const blocks[4] = {
+                row_src + static_cast<size_t>(column_offsets[x]) * block_size,
+                row_src + static_cast<size_t>(column_offsets[x + 1]) * block_size,
+                row_src + static_cast<size_t>(column_offsets[x + 2]) * block_size,
+                row_src + static_cast<size_t>(column_offsets[x + 3]) * block_size,
+            };
+            decode_blocks_4<format_id>(blocks, row_dest + x * 4, stride);
+        }
+
+        // only the smallest mips are less than 4 blocks wide
+        for (; x < width_in_blocks; x++)
+            decode_block<format_id>(row_src + static_cast<size_t>(column_offsets[x]) * block_size, row_dest + x * 4, stride);
+    }
+}
+
+template <bool swizzled>
+static void decompress_bc(uint32_t width, uint32_t height, const uint8_t *block_storage, uint32_t *image, const uint8_t format_id) {
+    const uint32_t block_count_x = (width + 3) / 4;
+    const uint32_t block_count_y = (height + 3) / 4;
+    if (block_count_x == 0 || block_count_y == 0)
+        return;
+
+    switch (format_id) {
+    case 1: return decompress_blocks<1, swizzled>(block_count_x, block_count_y, block_storage, image);
+    case 2: return decompress_blocks<2, swizzled>(block_count_x, block_count_y, block_storage, image);
+    case 3: return decompress_blocks<3, swizzled>(block_count_x, block_count_y, block_storage, image);
+    case 4: return decompress_blocks<4, swizzled>(block_count_x, block_count_y, block_storage, image);
+    case 5: return decompress_blocks<5, swizzled>(block_count_x, block_count_y, block_storage, image);
+    case 6: return decompress_blocks<6, swizzled>(block_count_x, block_count_y, block_storage, image);
+    case 7: return decompress_blocks<7, swizzled>(block_count_x, block_count_y, block_storage, image);
+    default:
+        break;
+    }
+}
+
+void decompress_bc_image(uint32_t width, uint32_t height, const uint8_t *block_storage, uint32_t *image, const uint8_t format_id) {
+    decompress_bc<false>(width, height, block_storage, image, format_id);
+}
+
+void decompress_bc_swizzled_image(uint32_t width, uint32_t height, const uint8_t *block_storage, uint32_t *image, const uint8_t format_id) {
+    decompress_bc<true>(width, height, block_storage, image, format_id);
+}
+
+} // namespace renderer::texture
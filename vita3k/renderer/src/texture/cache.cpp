@@ -16,11 +16,16 @@
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
 #include <renderer/functions.h>
+#include <renderer/memory_budget.h>
 
 #include <renderer/profile.h>
 #include <renderer/texture_cache.h>
+#include <renderer/texture_decoder.h>
+#include <renderer/texture_disk_cache.h>
+#include <renderer/texture_pack.h>
 
 #include <gxm/functions.h>
+#include <mem/functions.h>
 #include <mem/ptr.h>
 #include <util/align.h>
 #include <util/bit_cast.h>
@@ -288,9 +293,19 @@ uint16_t get_upload_mip(const uint16_t true_mip, const uint16_t width, const uin
 
 using namespace texture;
 
+TextureCache::TextureCache() = default;
+
+TextureCache::~TextureCache() {
+    // the decoder threads may still be writing to the backend staging memory
+    wait_pending_decodes();
+}
+
 bool TextureCache::init(const bool hashless_texture_cache, const fs::path &texture_folder, std::string_view game_id, const size_t sampler_cache_size) {
     use_protect = hashless_texture_cache;
 
+    if (!decoder)
+        decoder = std::make_unique<TextureDecoder>();
+
     // initialize the texture queue
     texture_queue.init(TextureCacheSize);
     // set the proper index of each entry
@@ -312,12 +327,345 @@ bool TextureCache::init(const bool hashless_texture_cache, const fs::path &textu
 
     export_folder = texture_folder / "export" / std::string(game_id);
     import_folder = texture_folder / "import" / std::string(game_id);
+    disk_cache_folder = texture_folder / "cache" / std::string(game_id);
 
     refresh_available_textures();
 
     return true;
 }
 
+void TextureCache::init_disk_cache(uint64_t max_size) {
+    disk_cache = std::make_unique<TextureDiskCache>();
+    if (!disk_cache->init(disk_cache_folder, max_size))
+        disk_cache.reset();
+}
+
+void decode_texture(TextureDecodeJob &job) {
+    const SceGxmTexture &gxm_texture = job.texture;
+    const SceGxmTextureFormat fmt = gxm::get_format(gxm_texture);
+    const SceGxmTextureBaseFormat base_format = gxm::get_base_format(fmt);
+    const auto texture_type = gxm_texture.texture_type();
+    const bool is_swizzled = (texture_type == SCE_GXM_TEXTURE_SWIZZLED) || (texture_type == SCE_GXM_TEXTURE_CUBE) || (texture_type == SCE_GXM_TEXTURE_SWIZZLED_ARBITRARY) || (texture_type == SCE_GXM_TEXTURE_CUBE_ARBITRARY);
+
+    uint32_t bpp = gxm::bits_per_pixel(base_format);
+    uint32_t bytes_per_pixel = (bpp + 7) >> 3;
+
+    const uint32_t pixels_per_stride = job.pixels_per_stride;
+    const uint32_t memory_height = job.memory_height;
+    std::vector<uint8_t> &texture_data_decompressed = job.decompressed;
+    const void *pixels = job.src;
+    // BC formats are decompressed when the host GPU can't sample them
+    const bool decompress_bcn = gxm::is_bcn_format(base_format) && job.upload_format != base_format;
+
+    // perform all needed conversions (formats not supported by modern GPUs)
+    switch (base_format) {
+    case SCE_GXM_TEXTURE_BASE_FORMAT_P4:
+    case SCE_GXM_TEXTURE_BASE_FORMAT_P8:
+        texture_data_decompressed.resize(pixels_per_stride * memory_height * 4);
+        if (base_format == SCE_GXM_TEXTURE_BASE_FORMAT_P8) {
+            palette_texture_to_rgba_8(reinterpret_cast<uint32_t *>(texture_data_decompressed.data()),
+                static_cast<const uint8_t *>(pixels), pixels_per_stride, memory_height, job.palette);
+        } else {
+            palette_texture_to_rgba_4(reinterpret_cast<uint32_t *>(texture_data_decompressed.data()),
+                static_cast<const uint8_t *>(pixels), pixels_per_stride, memory_height, job.palette);
+        }
+        pixels = texture_data_decompressed.data();
+        bytes_per_pixel = 4;
+        bpp = 32;
+        break;
+    case SCE_GXM_TEXTURE_BASE_FORMAT_PVRT2BPP:
+    case SCE_GXM_TEXTURE_BASE_FORMAT_PVRT4BPP:
+    case SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII2BPP:
+    case SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII4BPP:
+        if (!is_swizzled)
+            LOG_ERROR_ONCE("Unhandled non-swizzled PVRT format, please report it to the developers");
+        // the backend decodes it, the words are left twiddled
+        if (job.upload_format == base_format)
+            break;
+
+        texture_data_decompressed.resize(pixels_per_stride * memory_height * 4);
+        // this actually also unswizzles the texture
+        decompress_compressed_texture(base_format, texture_data_decompressed.data(), pixels, pixels_per_stride, memory_height);
+        bytes_per_pixel = 4;
+        bpp = 32;
+        pixels = texture_data_decompressed.data();
+        break;
+    case SCE_GXM_TEXTURE_BASE_FORMAT_UBC1:
+    case SCE_GXM_TEXTURE_BASE_FORMAT_UBC2:
+    case SCE_GXM_TEXTURE_BASE_FORMAT_UBC3:
+    case SCE_GXM_TEXTURE_BASE_FORMAT_UBC4:
+    case SCE_GXM_TEXTURE_BASE_FORMAT_SBC4:
+    case SCE_GXM_TEXTURE_BASE_FORMAT_UBC5:
+    case SCE_GXM_TEXTURE_BASE_FORMAT_SBC5:
+        if (!decompress_bcn)
+            break;
+        if (texture_type == SCE_GXM_TEXTURE_TILED)
+            LOG_ERROR_ONCE("Unhandled tiled BC format, please report it to the developers");
+
+        texture_data_decompressed.resize(pixels_per_stride * memory_height * 4);
+        // swizzled blocks are unswizzled at the same time
+        decompress_compressed_texture(base_format, texture_data_decompressed.data(), pixels, pixels_per_stride, memory_height, is_swizzled);
+        bytes_per_pixel = 4;
+        bpp = 32;
+        pixels = texture_data_decompressed.data();
+        break;
+    case SCE_GXM_TEXTURE_BASE_FORMAT_U8U3U3U2:
+        // Convert U8U3U3U2 to U8U8U8U8
+        texture_data_decompressed.resize(pixels_per_stride * memory_height * 4);
+        convert_U8U3U3U2_to_U8U8U8U8(texture_data_decompressed.data(), pixels, pixels_per_stride, memory_height);
+        pixels = texture_data_decompressed.data();
+        bpp = 32;
+        break;
+    case SCE_GXM_TEXTURE_BASE_FORMAT_SE5M9M9M9:
+        // this format is supported on all GPUs with vulkan
+        if (job.is_vulkan)
+            break;
+        texture_data_decompressed.resize(pixels_per_stride * memory_height * 6);
+        decompress_packed_float_e5m9m9m9(base_format, texture_data_decompressed.data(), pixels, job.width, memory_height);
+        pixels = texture_data_decompressed.data();
+        break;
+    case SCE_GXM_TEXTURE_BASE_FORMAT_U2F10F10F10:
+        // don't change what openGL is doing (which is completely wrong)
+        if (!job.is_vulkan)
+            break;
+        texture_data_decompressed.resize(pixels_per_stride * memory_height * 8);
+        convert_u2f10f10f10_to_f16f16f16f16(texture_data_decompressed.data(), pixels, pixels_per_stride, memory_height, fmt);
+        pixels = texture_data_decompressed.data();
+        break;
+    case SCE_GXM_TEXTURE_BASE_FORMAT_X8U24:
+        texture_data_decompressed.resize(pixels_per_stride * memory_height * 4);
+        if (job.is_vulkan) {
+            // d24_u8 or x8_d24 is not supported on all GPUs (thanks AMD)
+            convert_x8u24_to_f32(texture_data_decompressed.data(), pixels, pixels_per_stride, memory_height, fmt);
+        } else {
+            // X8 = [24-31], D24 = [0-23], technically this is GL_UNSIGNED_INT_24_8_REV which does not exist
+            // TODO: Requires shader to convert the normalized value read by GL to unsigned int. Just multiply by 2^24-1 when reading and you're done.
+            // TODO: this is wrong, the depth is in the upper or lower 24 bits according to the swizzle
+            convert_x8u24_to_u24x8(texture_data_decompressed.data(), pixels, pixels_per_stride, memory_height);
+        }
+        pixels = texture_data_decompressed.data();
+        break;
+    case SCE_GXM_TEXTURE_BASE_FORMAT_F32M:
+        // Convert F32M to F32
+        texture_data_decompressed.resize(pixels_per_stride * memory_height * 4);
+        convert_f32m_to_f32(texture_data_decompressed.data(), pixels, pixels_per_stride, memory_height);
+        pixels = texture_data_decompressed.data();
+        break;
+    case SCE_GXM_TEXTURE_BASE_FORMAT_YUV420P2:
+    case SCE_GXM_TEXTURE_BASE_FORMAT_YUV420P3:
+        if (job.upload_format == base_format) {
+            // the backend converts it, the chroma plane(s) must directly follow the luma plane
+            const uint32_t luma_size = pixels_per_stride * memory_height;
+            const uint32_t layout_size = job.layout_width * job.layout_height;
+            if (layout_size == luma_size)
+                break;
+
+            const uint8_t *src = static_cast<const uint8_t *>(pixels);
+            const uint32_t chroma_size = pixels_per_stride * ((memory_height + 1) / 2);
+            texture_data_decompressed.resize(luma_size + chroma_size);
+            memcpy(texture_data_decompressed.data(), src, luma_size);
+            if (base_format == SCE_GXM_TEXTURE_BASE_FORMAT_YUV420P3) {
+                memcpy(texture_data_decompressed.data() + luma_size, src + layout_size, chroma_size / 2);
+                memcpy(texture_data_decompressed.data() + luma_size + chroma_size / 2, src + layout_size + layout_size / 4, chroma_size / 2);
+            } else {
+                memcpy(texture_data_decompressed.data() + luma_size, src + layout_size, chroma_size);
+            }
+            pixels = texture_data_decompressed.data();
+            break;
+        }
+
+        texture_data_decompressed.resize(pixels_per_stride * memory_height * 4);
+        yuv420_texture_to_rgb(texture_data_decompressed.data(),
+            static_cast<const uint8_t *>(pixels), pixels_per_stride, memory_height, job.layout_width, job.layout_height,
+            base_format == SCE_GXM_TEXTURE_BASE_FORMAT_YUV420P3);
+        pixels = texture_data_decompressed.data();
+        bpp = 32;
+        break;
+    default:
+        break;
+    }
+
+    if (texture_type != SCE_GXM_TEXTURE_LINEAR && texture_type != SCE_GXM_TEXTURE_LINEAR_STRIDED && !gxm::is_pvrt_format(base_format) && !decompress_bcn) {
+        // Convert data to linear layout
+        std::vector<uint8_t> &texture_pixels_lineared = job.lineared;
+        texture_pixels_lineared.resize(pixels_per_stride * memory_height * bytes_per_pixel);
+
+        if (is_swizzled && gxm::is_bcn_format(base_format))
+            // just unswizzle the blocks
+            resolve_z_order_compressed_texture(base_format, texture_pixels_lineared.data(), pixels, pixels_per_stride, memory_height);
+        else if (is_swizzled)
+            swizzled_texture_to_linear_texture(texture_pixels_lineared.data(), static_cast<const uint8_t *>(pixels), pixels_per_stride, memory_height,
+                static_cast<std::uint8_t>(bpp));
+        else
+            tiled_texture_to_linear_texture(texture_pixels_lineared.data(), static_cast<const uint8_t *>(pixels), pixels_per_stride, memory_height,
+                static_cast<std::uint8_t>(bpp));
+
+        pixels = texture_pixels_lineared.data();
+    }
+
+    job.pixels = pixels;
+}
+
+// format the content of a face / mip has once decoded
+static SceGxmTextureBaseFormat get_upload_format(SceGxmTextureBaseFormat base_format, bool is_vulkan, bool support_bcn, bool backend_decode) {
+    // these formats are then decoded by the backend on the GPU
+    if (backend_decode && is_backend_decodable_format(base_format, support_bcn))
+        return base_format;
+
+    if (!support_bcn && gxm::is_bcn_format(base_format))
+        return get_bcn_decompressed_format(base_format);
+
+    switch (base_format) {
+    case SCE_GXM_TEXTURE_BASE_FORMAT_P4:
+    case SCE_GXM_TEXTURE_BASE_FORMAT_P8:
+    case SCE_GXM_TEXTURE_BASE_FORMAT_PVRT2BPP:
+    case SCE_GXM_TEXTURE_BASE_FORMAT_PVRT4BPP:
+    case SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII2BPP:
+    case SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII4BPP:
+    case SCE_GXM_TEXTURE_BASE_FORMAT_U8U3U3U2:
+    case SCE_GXM_TEXTURE_BASE_FORMAT_YUV420P2:
+    case SCE_GXM_TEXTURE_BASE_FORMAT_YUV420P3:
+        return SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8U8;
+    case SCE_GXM_TEXTURE_BASE_FORMAT_U2F10F10F10:
+        return is_vulkan ? SCE_GXM_TEXTURE_BASE_FORMAT_F16F16F16F16 : base_format;
+    case SCE_GXM_TEXTURE_BASE_FORMAT_X8U24:
+        return is_vulkan ? SCE_GXM_TEXTURE_BASE_FORMAT_F32 : base_format;
+    case SCE_GXM_TEXTURE_BASE_FORMAT_F32M:
+        return SCE_GXM_TEXTURE_BASE_FORMAT_F32;
+    default:
+        return base_format;
+    }
+}
+
+// is the conversion of the texture to its upload format done on the CPU?
+static bool is_decoded_on_cpu(SceGxmTextureBaseFormat base_format, SceGxmTextureBaseFormat upload_format, SceGxmTextureType texture_type) {
+    if (upload_format != base_format)
+        return true;
+
+    // PVRT textures uploaded as is are untwiddled by the backend
+    return texture_type != SCE_GXM_TEXTURE_LINEAR && texture_type != SCE_GXM_TEXTURE_LINEAR_STRIDED && !gxm::is_pvrt_format(base_format);
+}
+
+// use the content of the disk cache for the jobs if it is there, return false otherwise
+static bool load_from_disk_cache(TextureDiskCache &disk_cache, TextureDecodeTicket &ticket) {
+    std::vector<TextureDiskCacheLevel> levels;
+    if (!disk_cache.load(ticket.disk_cache_key, ticket.disk_cache_content, levels) || levels.size() != ticket.jobs.size())
+        return false;
+
+    for (size_t i = 0; i < levels.size(); i++) {
+        const TextureDiskCacheLevel &level = levels[i];
+        const TextureDecodeJob &job = ticket.jobs[i];
+        // can happen with strided textures, the stride is not part of the key
+        if (level.face != static_cast<uint32_t>(job.face) || level.mip_index != job.mip_index
+            || level.pixels_per_stride != job.pixels_per_stride || level.memory_height != job.memory_height)
+            return false;
+    }
+
+    for (size_t i = 0; i < levels.size(); i++)
+        ticket.jobs[i].pixels = levels[i].data;
+
+    return true;
+}
+
+void TextureCache::store_in_disk_cache(TextureDecodeTicket &ticket) {
+    if (!ticket.store_in_disk_cache)
+        return;
+
+    std::vector<TextureDiskCacheLevel> levels;
+    levels.reserve(ticket.jobs.size());
+    for (const auto &job : ticket.jobs) {
+        size_t size;
+        if (job.pixels == job.decompressed.data())
+            size = job.decompressed.size();
+        else if (job.pixels == job.lineared.data())
+            size = job.lineared.size();
+        else
+            // no conversion was needed after all
+            return;
+
+        levels.push_back({ static_cast<uint32_t>(job.face), job.mip_index, job.pixels_per_stride, job.memory_height,
+            static_cast<uint32_t>(size), static_cast<const uint8_t *>(job.pixels) });
+    }
+
+    // the disk cache compresses and writes the content on its own thread, it takes the decoded buffers with it
+    std::vector<std::vector<uint8_t>> buffers;
+    buffers.reserve(ticket.jobs.size());
+    for (auto &job : ticket.jobs) {
+        buffers.push_back(std::move((job.pixels == job.decompressed.data()) ? job.decompressed : job.lineared));
+        job.pixels = nullptr;
+    }
+
+    disk_cache->store(ticket.disk_cache_key, std::move(levels), std::move(buffers));
+}
+
+// can the face / mip located at [addr, addr + size) have been written to since the texture was last uploaded?
+static bool is_source_range_dirty(const TextureCacheInfo &info, const MemState &mem, Address addr, uint32_t size) {
+    // only the pages fully covered by the texture are tracked
+    const Address protect_end = info.protect_begin + static_cast<uint32_t>(info.page_generations.size()) * KiB(4);
+    if (addr < info.protect_begin || addr + size > protect_end)
+        return true;
+
+    for (Address page = align_down(addr, KiB(4)); page < addr + size; page += KiB(4)) {
+        if (get_page_generation(mem, page) != info.page_generations[(page - info.protect_begin) / KiB(4)])
+            return true;
+    }
+
+    return false;
+}
+
+// write protect the texture pages so that the texture is marked as dirty when they are written to,
+// once protected only the pages which were written to since need to be protected again
+static void protect_texture_pages(TextureCacheInfo &info, const SceGxmTexture &gxm_texture, MemState &mem) {
+    if (!info.page_generations.empty()) {
+        Address range_begin = 0;
+        uint32_t range_size = 0;
+        for (size_t i = 0; i < info.page_generations.size(); i++) {
+            const Address page = info.protect_begin + static_cast<uint32_t>(i) * KiB(4);
+            const uint32_t generation = get_page_generation(mem, page);
+            if (generation == info.page_generations[i])
+                continue;
+
+            info.page_generations[i] = generation;
+            if (range_size > 0 && range_begin + range_size == page) {
+                range_size += KiB(4);
+            } else {
+                if (range_size > 0)
+                    reprotect_pages(mem, range_begin, range_size);
+                range_begin = page;
+                range_size = KiB(4);
+            }
+        }
+        if (range_size > 0)
+            reprotect_pages(mem, range_begin, range_size);
+
+        return;
+    }
+
+    // replacement textures are not uploaded by upload_texture, only the first mip is known to be there
+    const Address data_addr = gxm_texture.data_addr << 2;
+    const uint32_t source_size = std::max(info.source_size, info.texture_size);
+    const Address range_protect_begin = align(data_addr, mem.page_size);
+    const Address range_protect_end = align_down(data_addr + source_size, mem.page_size);
+    if (range_protect_end <= range_protect_begin)
+        return;
+
+    info.protect_begin = range_protect_begin;
+    info.page_generations.resize((range_protect_end - range_protect_begin) / KiB(4));
+    for (size_t i = 0; i < info.page_generations.size(); i++)
+        info.page_generations[i] = get_page_generation(mem, range_protect_begin + static_cast<uint32_t>(i) * KiB(4));
+
+    // info.texture is the representation used as the cache key, it may not contain the sampler state
+    TextureCacheInfo *info_ptr = &info;
+    add_page_protect(mem, range_protect_begin, range_protect_end - range_protect_begin, [info_ptr, texture = info.texture](Address, bool) {
+        // once the texture info is used by another texture, this range no longer needs to be tracked
+        if (memcmp(&info_ptr->texture, &texture, sizeof(SceGxmTexture)) != 0)
+            return false;
+
+        info_ptr->dirty = true;
+        return true;
+    });
+}
+
 void TextureCache::upload_texture(const SceGxmTexture &gxm_texture, MemState &mem) {
     R_PROFILE(__func__);
 
@@ -341,17 +689,11 @@ void TextureCache::upload_texture(const SceGxmTexture &gxm_texture, MemState &me
         return;
     }
 
-    std::vector<uint8_t> texture_data_decompressed;
-    std::vector<uint8_t> texture_pixels_lineared;
-
-    const void *pixels = nullptr;
-
     uint32_t pixels_per_stride = 0;
-    uint32_t bpp = gxm::bits_per_pixel(base_format);
-    uint32_t bytes_per_pixel = (bpp + 7) >> 3;
+    const uint32_t bpp = gxm::bits_per_pixel(base_format);
+    const uint32_t bytes_per_pixel = (bpp + 7) >> 3;
 
     const auto texture_type = gxm_texture.texture_type();
-    const bool is_swizzled = (texture_type == SCE_GXM_TEXTURE_SWIZZLED) || (texture_type == SCE_GXM_TEXTURE_CUBE) || (texture_type == SCE_GXM_TEXTURE_SWIZZLED_ARBITRARY) || (texture_type == SCE_GXM_TEXTURE_CUBE_ARBITRARY);
 
     uint32_t mip_index = 0;
     uint32_t total_mip = get_upload_mip(gxm_texture.true_mip_count(), width, height);
@@ -412,10 +754,15 @@ void TextureCache::upload_texture(const SceGxmTexture &gxm_texture, MemState &me
     const uint32_t org_layout_width = layout_width;
     const uint32_t org_layout_height = layout_height;
 
-    while (face_uploaded_count < face_total_count && org_width > 0 && org_height > 0) {
-        pixels = texture_data;
+    const SceGxmTextureBaseFormat upload_format = get_upload_format(base_format, is_vulkan, support_bcn, current_info->backend_decode);
+    const uint32_t *palette = gxm::is_paletted_format(base_format) ? get_texture_palette(gxm_texture, mem) : nullptr;
+
+    auto ticket = std::make_unique<TextureDecodeTicket>();
+    ticket->cache = this;
+    ticket->jobs.reserve(face_total_count * total_mip);
 
-        SceGxmTextureBaseFormat upload_format = base_format;
+    // first only go through the texture layout, the decoding of each face / mip is done afterwards
+    while (face_uploaded_count < face_total_count && org_width > 0 && org_height > 0) {
         uint32_t memory_height = height;
 
         // Get pixels per stride
@@ -437,121 +784,31 @@ void TextureCache::upload_texture(const SceGxmTexture &gxm_texture, MemState &me
         pixels_per_stride = align(pixels_per_stride, align_width);
         memory_height = align(memory_height, align_height);
 
-        // perform all needed conversions (formats not supported by modern GPUs)
-        switch (base_format) {
-        case SCE_GXM_TEXTURE_BASE_FORMAT_P4:
-        case SCE_GXM_TEXTURE_BASE_FORMAT_P8:
-            texture_data_decompressed.resize(pixels_per_stride * memory_height * 4);
-            if (base_format == SCE_GXM_TEXTURE_BASE_FORMAT_P8) {
-                palette_texture_to_rgba_8(reinterpret_cast<uint32_t *>(texture_data_decompressed.data()),
-                    static_cast<const uint8_t *>(pixels), pixels_per_stride, memory_height, get_texture_palette(gxm_texture, mem));
-            } else {
-                palette_texture_to_rgba_4(reinterpret_cast<uint32_t *>(texture_data_decompressed.data()),
-                    static_cast<const uint8_t *>(pixels), pixels_per_stride, memory_height, get_texture_palette(gxm_texture, mem));
-            }
-            pixels = texture_data_decompressed.data();
-            bytes_per_pixel = 4;
-            bpp = 32;
-            upload_format = SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8U8;
-            break;
-        case SCE_GXM_TEXTURE_BASE_FORMAT_PVRT2BPP:
-        case SCE_GXM_TEXTURE_BASE_FORMAT_PVRT4BPP:
-        case SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII2BPP:
-        case SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII4BPP:
-            if (!is_swizzled)
-                LOG_ERROR_ONCE("Unhandled non-swizzled PVRT format, please report it to the developers");
-
-            texture_data_decompressed.resize(pixels_per_stride * memory_height * 4);
-            // this actually also unswizzles the texture
-            decompress_compressed_texture(base_format, texture_data_decompressed.data(), pixels, pixels_per_stride, memory_height);
-            bytes_per_pixel = 4;
-            bpp = 32;
-            upload_format = SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8U8;
-            pixels = texture_data_decompressed.data();
-            break;
-        case SCE_GXM_TEXTURE_BASE_FORMAT_U8U3U3U2:
-            // Convert U8U3U3U2 to U8U8U8U8
-            texture_data_decompressed.resize(pixels_per_stride * memory_height * 4);
-            convert_U8U3U3U2_to_U8U8U8U8(texture_data_decompressed.data(), pixels, pixels_per_stride, memory_height);
-            pixels = texture_data_decompressed.data();
-            upload_format = SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8U8;
-            bpp = 32;
-            break;
-        case SCE_GXM_TEXTURE_BASE_FORMAT_SE5M9M9M9:
-            // this format is supported on all GPUs with vulkan
-            if (is_vulkan)
-                break;
-            texture_data_decompressed.resize(pixels_per_stride * memory_height * 6);
-            decompress_packed_float_e5m9m9m9(base_format, texture_data_decompressed.data(), pixels, width, memory_height);
-            pixels = texture_data_decompressed.data();
-            break;
-        case SCE_GXM_TEXTURE_BASE_FORMAT_U2F10F10F10:
-            // don't change what openGL is doing (which is completely wrong)
-            if (!is_vulkan)
-                break;
-            texture_data_decompressed.resize(pixels_per_stride * memory_height * 8);
-            convert_u2f10f10f10_to_f16f16f16f16(texture_data_decompressed.data(), pixels, pixels_per_stride, memory_height, fmt);
-            pixels = texture_data_decompressed.data();
-            upload_format = SCE_GXM_TEXTURE_BASE_FORMAT_F16F16F16F16;
-            break;
-        case SCE_GXM_TEXTURE_BASE_FORMAT_X8U24:
-            texture_data_decompressed.resize(pixels_per_stride * memory_height * 4);
-            if (is_vulkan) {
-                // d24_u8 or x8_d24 is not supported on all GPUs (thanks AMD)
-                convert_x8u24_to_f32(texture_data_decompressed.data(), pixels, pixels_per_stride, memory_height, fmt);
-                upload_format = SCE_GXM_TEXTURE_BASE_FORMAT_F32;
-            } else {
-                // X8 = [24-31], D24 = [0-23], technically this is GL_UNSIGNED_INT_24_8_REV which does not exist
-                // TODO: Requires shader to convert the normalized value read by GL to unsigned int. Just multiply by 2^24-1 when reading and you're done.
-                // TODO: this is wrong, the depth is in the upper or lower 24 bits according to the swizzle
-                convert_x8u24_to_u24x8(texture_data_decompressed.data(), pixels, pixels_per_stride, memory_height);
-            }
-            pixels = texture_data_decompressed.data();
-            break;
-        case SCE_GXM_TEXTURE_BASE_FORMAT_F32M:
-            // Convert F32M to F32
-            texture_data_decompressed.resize(pixels_per_stride * memory_height * 4);
-            convert_f32m_to_f32(texture_data_decompressed.data(), pixels, pixels_per_stride, memory_height);
-            pixels = texture_data_decompressed.data();
-            upload_format = SCE_GXM_TEXTURE_BASE_FORMAT_F32;
-            break;
-        case SCE_GXM_TEXTURE_BASE_FORMAT_YUV420P2:
-        case SCE_GXM_TEXTURE_BASE_FORMAT_YUV420P3:
-            texture_data_decompressed.resize(pixels_per_stride * memory_height * 4);
-            yuv420_texture_to_rgb(texture_data_decompressed.data(),
-                static_cast<const uint8_t *>(pixels), pixels_per_stride, memory_height, layout_width, layout_height,
-                base_format == SCE_GXM_TEXTURE_BASE_FORMAT_YUV420P3);
-            pixels = texture_data_decompressed.data();
-            bpp = 32;
-            upload_format = SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8U8;
-            break;
-        default:
-            break;
-        }
-
-        if (texture_type != SCE_GXM_TEXTURE_LINEAR && texture_type != SCE_GXM_TEXTURE_LINEAR_STRIDED && !gxm::is_pvrt_format(base_format)) {
-            // Convert data to linear layout
-            texture_pixels_lineared.resize(pixels_per_stride * memory_height * bytes_per_pixel);
-
-            if (is_swizzled && gxm::is_bcn_format(base_format))
-                // just unswizzle the blocks
-                resolve_z_order_compressed_texture(base_format, texture_pixels_lineared.data(), pixels, pixels_per_stride, memory_height);
-            else if (is_swizzled)
-                swizzled_texture_to_linear_texture(texture_pixels_lineared.data(), static_cast<const uint8_t *>(pixels), pixels_per_stride, memory_height,
-                    static_cast<std::uint8_t>(bpp));
-            else
-                tiled_texture_to_linear_texture(texture_pixels_lineared.data(), static_cast<const uint8_t *>(pixels), pixels_per_stride, memory_height,
-                    static_cast<std::uint8_t>(bpp));
+        const uint32_t nb_pixels = align(layout_width, align_width) * align(layout_height, align_height);
+        const uint32_t mip_size = (nb_pixels >> block_shift) * block_size;
 
-            pixels = texture_pixels_lineared.data();
+        // during a partial upload, a face / mip whose pages were not written to is still up to date on the GPU
+        if (!partial_upload || is_source_range_dirty(*current_info, mem, data.address() + total_source_so_far, mip_size)) {
+            TextureDecodeJob &job = ticket->jobs.emplace_back();
+            job.texture = gxm_texture;
+            job.src = texture_data;
+            job.palette = palette;
+            job.upload_format = upload_format;
+            job.width = width;
+            job.height = height;
+            job.memory_height = memory_height;
+            job.pixels_per_stride = pixels_per_stride;
+            job.layout_width = layout_width;
+            job.layout_height = layout_height;
+            job.mip_index = mip_index;
+            job.face = upload_type;
+            job.is_vulkan = is_vulkan;
+            job.ticket = ticket.get();
+            // exported textures need the decoded content on this thread
+            if (!export_textures)
+                job.upload_dest = reserve_texture_upload(upload_format, width, height, mip_index, upload_type, pixels_per_stride);
         }
 
-        upload_texture_impl(upload_format, width, height, mip_index, pixels, upload_type, pixels_per_stride);
-        if (export_textures)
-            export_texture_impl(upload_format, width, height, mip_index, pixels, upload_type, pixels_per_stride);
-
-        const uint32_t nb_pixels = align(layout_width, align_width) * align(layout_height, align_height);
-        const uint32_t mip_size = (nb_pixels >> block_shift) * block_size;
         texture_data += mip_size;
         total_source_so_far += mip_size;
 
@@ -585,11 +842,71 @@ void TextureCache::upload_texture(const SceGxmTexture &gxm_texture, MemState &me
             upload_type++;
 
             uint32_t source_unaligned_size = total_source_so_far;
+            current_info->source_size = source_unaligned_size;
             total_source_so_far = align(total_source_so_far, face_align_bytes);
 
             texture_data += total_source_so_far - source_unaligned_size;
         }
     }
+
+    if (ticket->jobs.empty())
+        return;
+
+    // a partial upload only has some of the faces / mips
+    if (disk_cache && !partial_upload && is_decoded_on_cpu(base_format, upload_format, texture_type)) {
+        TextureDiskCacheKey &key = ticket->disk_cache_key;
+        // unlike the hash used by the texture cache, this one covers all the faces / mips
+        key.hash = hash_texture_data(gxm_texture, current_info->source_size, mem);
+        key.format = fmt;
+        key.upload_format = upload_format;
+        key.texture_type = texture_type;
+        key.width = static_cast<uint16_t>(org_width);
+        key.height = static_cast<uint16_t>(org_height);
+        key.mip_count = static_cast<uint16_t>(total_mip);
+        key.is_vulkan = is_vulkan;
+
+        ticket->store_in_disk_cache = !load_from_disk_cache(*disk_cache, *ticket);
+    }
+
+    const bool need_upload = std::any_of(ticket->jobs.begin(), ticket->jobs.end(), [](const TextureDecodeJob &job) {
+        return job.upload_dest == nullptr;
+    });
+
+    if (decoder && decoder->is_async() && (!need_upload || ticket->jobs.size() > 1)) {
+        decoder->submit(*ticket);
+
+        if (!need_upload) {
+            // everything has already been recorded by the backend, the GPU will wait for the ticket
+            pending_decodes.push_back(std::move(ticket));
+            return;
+        }
+
+        ticket->wait();
+    } else {
+        for (auto &job : ticket->jobs)
+            TextureDecoder::run(job);
+    }
+
+    for (const auto &job : ticket->jobs) {
+        if (job.upload_dest)
+            continue;
+
+        upload_texture_impl(job.upload_format, job.width, job.height, job.mip_index, job.pixels, job.face, job.pixels_per_stride);
+        if (export_textures)
+            export_texture_impl(job.upload_format, job.width, job.height, job.mip_index, job.pixels, job.face, job.pixels_per_stride);
+    }
+
+    // last, the decoded buffers are given to the disk cache
+    store_in_disk_cache(*ticket);
+}
+
+void TextureCache::wait_pending_decodes() {
+    for (auto &ticket : pending_decodes) {
+        ticket->wait();
+        store_in_disk_cache(*ticket);
+    }
+
+    pending_decodes.clear();
 }
 
 // remove everything related to the sampler state
@@ -627,9 +944,6 @@ void TextureCache::cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemS
         // we found the texture in the cache
         cached_gxm_texture_index = gxm_it->second->index;
 
-    Address range_protect_begin = 0;
-    Address range_protect_end = 0;
-
     TextureCacheInfo *info;
     if (cached_gxm_texture_index == -1) {
         // Texture not found in cache.
@@ -640,8 +954,12 @@ void TextureCache::cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemS
             // Cache is full.
             LOG_WARN_ONCE("Texture cache is full. Starting to replace textures");
             texture_lookup.erase(std::bit_cast<TextureGxmDataRepr>(info->texture));
+            if (memory_budget)
+                memory_budget->record_eviction(CacheType::Texture);
         }
         texture_lookup[texture_repr] = info;
+        if (memory_budget)
+            memory_budget->record_miss(CacheType::Texture);
 
         configure = true;
         upload = true;
@@ -657,8 +975,8 @@ void TextureCache::cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemS
         // or replace with an entire new texture.
         bool should_use_hash = true;
         if (use_protect && info->texture_size >= mem.page_size * 4) {
-            range_protect_begin = align(gxm_texture.data_addr << 2, mem.page_size);
-            range_protect_end = align_down((gxm_texture.data_addr << 2) + info->texture_size, mem.page_size);
+            const Address range_protect_begin = align(gxm_texture.data_addr << 2, mem.page_size);
+            const Address range_protect_end = align_down((gxm_texture.data_addr << 2) + info->texture_size, mem.page_size);
 
             if (range_protect_end - range_protect_begin >= mem.page_size * 4) {
                 should_use_hash = false;
@@ -666,6 +984,10 @@ void TextureCache::cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemS
         }
 
         info->use_hash = should_use_hash;
+        // the pages of the previous texture are no longer tracked for this one
+        info->source_size = 0;
+        info->page_generations.clear();
+        info->waiting_for_import = false;
         if (info->use_hash) {
             if (import_textures || export_textures)
                 info->hash = hash_texture_nostride(gxm_texture, mem);
@@ -678,6 +1000,8 @@ void TextureCache::cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemS
         index = cached_gxm_texture_index;
         info = gxm_it->second;
         configure = false;
+        if (memory_budget)
+            memory_budget->record_hit(CacheType::Texture);
         if (info->use_hash) {
             const uint64_t previous_hash = info->hash;
             if (import_textures || export_textures)
@@ -689,6 +1013,12 @@ void TextureCache::cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemS
         } else {
             upload = info->dirty;
         }
+
+        // the replacement texture has been streamed in since the last time
+        if (!upload && info->waiting_for_import && import_textures && texture_pack) {
+            const TexturePackEntry *entry = texture_pack->find(info->hash);
+            upload = entry && texture_pack->is_ready(*entry);
+        }
     }
     current_info = info;
 
@@ -703,52 +1033,74 @@ void TextureCache::cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemS
 
     importing_texture = false;
     if (upload && import_textures) {
+        info->waiting_for_import = false;
         auto it = available_textures_hash.find(info->hash);
         if (it != available_textures_hash.end()) {
             importing_texture = true;
             loading_texture = it->second;
-            // always configure for replacement texture (although it may have no effect)
-            // the reason being that we may have two replacement textures for the same gxm identifier
-            // with different dimensions, so we can't assume
-            configure = true;
+        } else if (const TexturePackEntry *entry = texture_pack ? texture_pack->find(info->hash) : nullptr) {
+            if (texture_pack->request(*entry)) {
+                importing_texture = true;
+                loading_texture = { entry->type == TexturePackEntryType::Dds, nullptr, entry };
+            } else {
+                // don't wait for the disk, keep using the original texture until then
+                info->waiting_for_import = true;
+            }
         }
+
+        // always configure for replacement texture (although it may have no effect)
+        // the reason being that we may have two replacement textures for the same gxm identifier
+        // with different dimensions, so we can't assume
+        if (importing_texture)
+            configure = true;
     }
 
     if (upload && !importing_texture && info->is_imported)
         configure = true;
 
+    // exported textures need their content decoded on the CPU
+    if (upload && export_textures && info->backend_decode)
+        configure = true;
+
     select(index, gxm_texture);
 
     if (configure) {
         bool need_configure = true;
+        const uint64_t previous_memory_size = info->memory_size;
 
         if (importing_texture)
             need_configure = !import_configure_texture();
 
         if (need_configure) {
+            info->backend_decode = support_backend_decode && !export_textures;
             configure_texture(gxm_texture);
             importing_texture = false;
             info->is_imported = false;
         }
+
+        if (memory_budget) {
+            memory_budget->resize_entry(CacheType::Texture, previous_memory_size, info->memory_size);
+            if (memory_budget->get_excess() > 0)
+                evict_textures(info);
+        }
     }
     if (upload) {
         if (export_textures && !importing_texture)
             export_select(gxm_texture);
 
+        // the pages of a protected texture tell which faces / mips were written to, only these ones are uploaded again
+        partial_upload = !configure && !info->use_hash && !info->page_generations.empty() && !export_textures;
+
         if (importing_texture)
             import_upload_texture();
         else
             upload_texture(gxm_texture, mem);
 
+        partial_upload = false;
+
         if (!info->use_hash) {
             info->dirty = false;
-            add_protect(mem, range_protect_begin, range_protect_end - range_protect_begin, MemPerm::ReadOnly, [info, gxm_texture](Address, bool) {
-                if (memcmp(&info->texture, &gxm_texture, sizeof(SceGxmTexture)) == 0) {
-                    info->dirty = true;
-                }
-
-                return true;
-            });
+            protect_texture_pages(*info, gxm_texture, mem);
         }
 
         upload_done();
@@ -767,6 +1119,30 @@ void TextureCache::cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemS
         cache_and_bind_sampler(gxm_texture);
 }
 
+void TextureCache::evict_textures(const TextureCacheInfo *current) {
+    // the most recently bound textures may be used by the draw being prepared
+    constexpr size_t kept_textures = 32;
+
+    TextureCacheInfo *info = texture_queue.get_lru();
+    for (size_t i = 0; i + kept_textures < TextureCacheSize && memory_budget->get_excess() > 0; i++) {
+        TextureCacheInfo *next = texture_queue.get_more_recent(info);
+        if (info != current && info->memory_size > 0) {
+            texture_lookup.erase(std::bit_cast<TextureGxmDataRepr>(info->texture));
+            release_texture(info->index);
+            memory_budget->resize_entry(CacheType::Texture, info->memory_size, 0);
+            memory_budget->record_eviction(CacheType::Texture);
+
+            info->memory_size = 0;
+            info->texture_size = 0;
+            info->page_generations.clear();
+            // the page protection callback must not consider this info to still be the evicted texture
+            memset(&info->texture, 0, sizeof(SceGxmTexture));
+            texture_queue.set_as_lru(info);
+        }
+        info = next;
+    }
+}
+
 int TextureCache::cache_and_bind_sampler(const SceGxmTexture &gxm_texture) {
     uint32_t compact_repr = 0;
     if (gxm_texture.texture_type() != SCE_GXM_TEXTURE_LINEAR_STRIDED) {
@@ -0,0 +1,89 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <renderer/texture_decoder.h>
+
+#include <renderer/functions.h>
+#include <renderer/texture_cache.h>
+
+#include <util/log.h>
+
+#include <algorithm>
+
+namespace renderer {
+
+void TextureDecodeTicket::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return remaining == 0; });
+}
+
+TextureDecoder::TextureDecoder() {
+    // leave some room for the render and guest threads, the decoding is only worth it when there is some
+    const int nb_logical_threads = static_cast<int>(std::thread::hardware_concurrency());
+    const int nb_worker_threads = std::clamp(nb_logical_threads / 2 - 1, 1, 4);
+
+    LOG_INFO("Using {} threads for texture decoding", nb_worker_threads);
+    for (int i = 0; i < nb_worker_threads; i++)
+        threads.emplace_back(&TextureDecoder::worker_thread, this);
+}
+
+TextureDecoder::~TextureDecoder() {
+    // if a thread receives nullptr, it exits
+    for (size_t i = 0; i < threads.size(); i++)
+        queue.enqueue(nullptr);
+
+    for (auto &thread : threads)
+        thread.join();
+}
+
+void TextureDecoder::run(TextureDecodeJob &job) {
+    // jobs loaded from the disk cache are already decoded
+    if (!job.pixels)
+        texture::decode_texture(job);
+
+    if (job.upload_dest)
+        job.ticket->cache->write_texture_upload(job.upload_dest, job.upload_format, job.height, job.pixels, job.pixels_per_stride);
+}
+
+void TextureDecoder::submit(TextureDecodeTicket &ticket) {
+    ticket.remaining = static_cast<uint32_t>(ticket.jobs.size());
+
+    for (auto &job : ticket.jobs)
+        queue.enqueue(&job);
+}
+
+void TextureDecoder::worker_thread() {
+    moodycamel::ConsumerToken consumer_token(queue);
+
+    TextureDecodeJob *job;
+    while (true) {
+        queue.wait_dequeue(consumer_token, job);
+
+        if (job == nullptr)
+            break;
+
+        run(*job);
+
+        // notify while holding the lock, the ticket can be destroyed as soon as the waiter gets it
+        TextureDecodeTicket &ticket = *job->ticket;
+        const std::lock_guard<std::mutex> guard(ticket.mutex);
+        if (--ticket.remaining == 0)
+            ticket.done.notify_all();
+    }
+}
+
+} // namespace renderer
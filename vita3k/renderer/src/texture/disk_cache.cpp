@@ -0,0 +1,323 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <renderer/texture_disk_cache.h>
+
+#include <util/log.h>
+
+#include <miniz.h>
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+namespace renderer {
+
+// 'VTXC'
+static constexpr uint32_t DISK_CACHE_MAGIC = 0x43585456;
+// increase it when the content of the decoded textures changes
+static constexpr uint32_t DISK_CACHE_VERSION = 1;
+
+struct DiskCacheFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t level_count;
+    uint32_t raw_size;
+    uint32_t compressed_size;
+};
+
+struct DiskCacheLevelHeader {
+    uint32_t face;
+    uint32_t mip_index;
+    uint32_t pixels_per_stride;
+    uint32_t memory_height;
+    uint32_t size;
+};
+
+static std::string get_file_name(const TextureDiskCacheKey &key) {
+    return fmt::format("{:016X}_{:08X}_{:08X}_{:08X}_{}x{}_{}_{}.bin", key.hash, key.format, key.upload_format, key.texture_type,
+        key.width, key.height, key.mip_count, key.is_vulkan ? "vk" : "gl");
+}
+
+TextureDiskCache::~TextureDiskCache() {
+    // the queued textures are written before the thread exits
+    if (writer.joinable()) {
+        write_queue.enqueue(nullptr);
+        writer.join();
+    }
+}
+
+bool TextureDiskCache::init(const fs::path &folder, uint64_t max_size) {
+    flush();
+    const std::lock_guard<std::mutex> guard(mutex);
+    this->folder = folder;
+    this->max_size = max_size;
+    entries.clear();
+    total_size = 0;
+
+    boost::system::error_code err;
+    fs::create_directories(folder, err);
+    if (err) {
+        LOG_ERROR("Failed to create the texture disk cache folder {}: {}", folder, err.message());
+        return false;
+    }
+
+    for (const auto &file : fs::directory_iterator(folder, err)) {
+        if (!fs::is_regular_file(file.path()))
+            continue;
+
+        if (file.path().extension() != ".bin") {
+            // leftover of an interrupted write
+            fs::remove(file.path(), err);
+            continue;
+        }
+
+        const uint64_t size = fs::file_size(file.path(), err);
+        if (err)
+            continue;
+
+        entries[file.path().filename().string()] = size;
+        total_size += size;
+    }
+
+    LOG_INFO("Texture disk cache: {} textures, {} MiB", entries.size(), total_size / (1024 * 1024));
+    cleanup();
+
+    if (!writer.joinable())
+        writer = std::thread(&TextureDiskCache::writer_thread, this);
+
+    return true;
+}
+
+bool TextureDiskCache::load(const TextureDiskCacheKey &key, std::vector<uint8_t> &content, std::vector<TextureDiskCacheLevel> &levels) {
+    const std::string file_name = get_file_name(key);
+    {
+        const std::lock_guard<std::mutex> guard(mutex);
+        if (!entries.contains(file_name))
+            return false;
+    }
+
+    const fs::path path = folder / file_name;
+    std::vector<uint8_t> file_data;
+    bool valid = fs_utils::read_data(path, file_data) && file_data.size() >= sizeof(DiskCacheFileHeader);
+
+    DiskCacheFileHeader header{};
+    if (valid) {
+        memcpy(&header, file_data.data(), sizeof(header));
+        const uint64_t data_offset = sizeof(DiskCacheFileHeader) + static_cast<uint64_t>(header.level_count) * sizeof(DiskCacheLevelHeader);
+        valid = header.magic == DISK_CACHE_MAGIC && header.version == DISK_CACHE_VERSION
+            && data_offset + header.compressed_size == file_data.size();
+    }
+
+    if (valid) {
+        const uint8_t *level_data = file_data.data() + sizeof(DiskCacheFileHeader);
+        content.resize(header.raw_size);
+        levels.resize(header.level_count);
+
+        uint64_t offset = 0;
+        for (auto &level : levels) {
+            DiskCacheLevelHeader level_header;
+            memcpy(&level_header, level_data, sizeof(level_header));
+            level_data += sizeof(level_header);
+
+            level.face = level_header.face;
+            level.mip_index = level_header.mip_index;
+            level.pixels_per_stride = level_header.pixels_per_stride;
+            level.memory_height = level_header.memory_height;
+            level.size = level_header.size;
+            level.data = content.data() + offset;
+            offset += level_header.size;
+        }
+
+        mz_ulong raw_size = header.raw_size;
+        valid = offset == header.raw_size
+            && mz_uncompress(content.data(), &raw_size, level_data, header.compressed_size) == MZ_OK
+            && raw_size == header.raw_size;
+    }
+
+    if (!valid) {
+        LOG_WARN("Removing invalid texture disk cache file {}", file_name);
+        boost::system::error_code err;
+        fs::remove(path, err);
+        const std::lock_guard<std::mutex> guard(mutex);
+        const auto entry = entries.find(file_name);
+        if (entry != entries.end()) {
+            total_size -= entry->second;
+            entries.erase(entry);
+        }
+        levels.clear();
+        return false;
+    }
+
+    // the modification time is used to know which textures were the least recently used
+    boost::system::error_code err;
+    fs::last_write_time(path, std::time(nullptr), err);
+
+    return true;
+}
+
+void TextureDiskCache::store(const TextureDiskCacheKey &key, std::vector<TextureDiskCacheLevel> levels, std::vector<std::vector<uint8_t>> buffers) {
+    auto pending = std::make_unique<PendingWrite>();
+    pending->file_name = get_file_name(key);
+    {
+        const std::lock_guard<std::mutex> guard(mutex);
+        if (entries.contains(pending->file_name) || !pending_files.insert(pending->file_name).second)
+            return;
+    }
+
+    // the data of the levels point to the heap storage of the buffers, moving them keeps it in place
+    pending->levels = std::move(levels);
+    pending->buffers = std::move(buffers);
+    if (writer.joinable()) {
+        write_queue.enqueue(std::move(pending));
+        return;
+    }
+
+    write(*pending);
+}
+
+void TextureDiskCache::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    writes_done.wait(lock, [&] { return pending_files.empty(); });
+}
+
+void TextureDiskCache::writer_thread() {
+    std::unique_ptr<PendingWrite> pending;
+    while (true) {
+        write_queue.wait_dequeue(pending);
+        if (!pending)
+            break;
+
+        write(*pending);
+        pending.reset();
+    }
+}
+
+void TextureDiskCache::write(const PendingWrite &pending) {
+    const uint64_t file_size = write_file(pending);
+
+    // a texture which could not be written is tried again the next time it is decoded
+    const std::lock_guard<std::mutex> guard(mutex);
+    pending_files.erase(pending.file_name);
+    if (file_size > 0) {
+        entries[pending.file_name] = file_size;
+        total_size += file_size;
+        if (max_size > 0 && total_size > max_size)
+            cleanup();
+    }
+    writes_done.notify_all();
+}
+
+uint64_t TextureDiskCache::write_file(const PendingWrite &pending) const {
+    const std::string &file_name = pending.file_name;
+    const std::vector<TextureDiskCacheLevel> &levels = pending.levels;
+
+    std::vector<uint8_t> raw_content;
+    std::vector<DiskCacheLevelHeader> level_headers;
+    level_headers.reserve(levels.size());
+    for (const auto &level : levels) {
+        level_headers.push_back({ level.face, level.mip_index, level.pixels_per_stride, level.memory_height, level.size });
+        raw_content.insert(raw_content.end(), level.data, level.data + level.size);
+    }
+
+    // favor the speed, textures are written while the game is running
+    mz_ulong compressed_size = mz_compressBound(static_cast<mz_ulong>(raw_content.size()));
+    std::vector<uint8_t> compressed(compressed_size);
+    if (mz_compress2(compressed.data(), &compressed_size, raw_content.data(), static_cast<mz_ulong>(raw_content.size()), MZ_BEST_SPEED) != MZ_OK) {
+        LOG_ERROR("Failed to compress texture {} for the disk cache", file_name);
+        return 0;
+    }
+
+    const DiskCacheFileHeader header = {
+        DISK_CACHE_MAGIC,
+        DISK_CACHE_VERSION,
+        static_cast<uint32_t>(levels.size()),
+        static_cast<uint32_t>(raw_content.size()),
+        static_cast<uint32_t>(compressed_size)
+    };
+
+    // write to a temporary file first so that an interrupted write never leaves a truncated entry
+    const fs::path path = folder / file_name;
+    const fs::path tmp_path = fs_utils::path_concat(path, ".tmp");
+    {
+        fs::ofstream file(tmp_path, std::ios::binary);
+        if (!file) {
+            LOG_ERROR("Failed to open {} for writing", tmp_path);
+            return 0;
+        }
+
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(level_headers.data()), level_headers.size() * sizeof(DiskCacheLevelHeader));
+        file.write(reinterpret_cast<const char *>(compressed.data()), compressed_size);
+        if (!file) {
+            LOG_ERROR("Failed to write {}", tmp_path);
+            file.close();
+            boost::system::error_code err;
+            fs::remove(tmp_path, err);
+            return 0;
+        }
+    }
+
+    boost::system::error_code err;
+    fs::rename(tmp_path, path, err);
+    if (err) {
+        LOG_ERROR("Failed to rename {}: {}", tmp_path, err.message());
+        fs::remove(tmp_path, err);
+        return 0;
+    }
+
+    return sizeof(header) + level_headers.size() * sizeof(DiskCacheLevelHeader) + compressed_size;
+}
+
+void TextureDiskCache::cleanup() {
+    if (max_size == 0 || total_size <= max_size)
+        return;
+
+    struct FileUse {
+        std::time_t last_use;
+        std::string name;
+    };
+    std::vector<FileUse> files;
+    files.reserve(entries.size());
+    for (const auto &[name, size] : entries) {
+        boost::system::error_code err;
+        const std::time_t last_use = fs::last_write_time(folder / name, err);
+        files.push_back({ err ? 0 : last_use, name });
+    }
+
+    std::sort(files.begin(), files.end(), [](const FileUse &a, const FileUse &b) {
+        return a.last_use < b.last_use;
+    });
+
+    // go a bit below the limit, this way the folder doesn't need to be looked at again on the next store
+    const uint64_t target_size = max_size - max_size / 4;
+    size_t nb_removed = 0;
+    for (const auto &file : files) {
+        if (total_size <= target_size)
+            break;
+
+        boost::system::error_code err;
+        fs::remove(folder / file.name, err);
+        total_size -= entries[file.name];
+        entries.erase(file.name);
+        nb_removed++;
+    }
+
+    LOG_INFO("Removed {} textures from the disk cache, {} MiB left", nb_removed, total_size / (1024 * 1024));
+}
+
+} // namespace renderer
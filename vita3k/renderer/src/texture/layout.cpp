@@ -0,0 +1,396 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <renderer/texture_layout.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+// All the kernels are specialized at compile time on the pixel size, so that every pixel
+// or row copy has a constant size and gets turned into plain (vector) moves
+
+namespace renderer::texture {
+
+// Swizzled textures are made of square blocks whose side is the smallest dimension of the texture,
+// the pixels of each block being in morton order (the x bits are the odd bits of the code).
+// The kernels move 4x4 pixel blocks, which are 16 consecutive pixels in the swizzled layout,
+// in the linear layout the i-th pixel of such a block is at position morton_4x4[i] (= y * 4 + x)
+static constexpr std::array<uint8_t, 16> morton_4x4 = {
+    0, 4, 1, 5, 8, 12, 9, 13, 2, 6, 3, 7, 10, 14, 11, 15
+};
+
+// masks of the x and y bits in a morton code, used to increment one coordinate without decoding it
+static constexpr uint32_t morton_x_mask = 0xAAAAAAAA;
+static constexpr uint32_t morton_y_mask = 0x55555555;
+
+// linear points to the top-left pixel of the block and stride is the size of a linear row in bytes
+template <size_t N>
+static void deswizzle_4x4(uint8_t *linear, size_t stride, const uint8_t *swizzled) {
+    for (size_t i = 0; i < 16; i++)
+        memcpy(linear + (morton_4x4[i] >> 2) * stride + (morton_4x4[i] & 3) * N, swizzled + i * N, N);
+}
+
+template <size_t N>
+static void swizzle_4x4(uint8_t *swizzled, const uint8_t *linear, size_t stride) {
+    for (size_t i = 0; i < 16; i++)
+        memcpy(swizzled + i * N, linear + (morton_4x4[i] >> 2) * stride + (morton_4x4[i] & 3) * N, N);
+}
+
+#if defined(__aarch64__)
+// a row of 4 pixels is made of the even or odd pixels of two groups of 4 swizzled pixels
+template <>
+void deswizzle_4x4<4>(uint8_t *linear, size_t stride, const uint8_t *swizzled) {
+    const uint32_t *src = reinterpret_cast<const uint32_t *>(swizzled);
+    const uint32x4_t a = vld1q_u32(src);
+    const uint32x4_t b = vld1q_u32(src + 4);
+    const uint32x4_t c = vld1q_u32(src + 8);
+    const uint32x4_t d = vld1q_u32(src + 12);
+    vst1q_u32(reinterpret_cast<uint32_t *>(linear), vuzp1q_u32(a, c));
+    vst1q_u32(reinterpret_cast<uint32_t *>(linear + stride), vuzp2q_u32(a, c));
+    vst1q_u32(reinterpret_cast<uint32_t *>(linear + 2 * stride), vuzp1q_u32(b, d));
+    vst1q_u32(reinterpret_cast<uint32_t *>(linear + 3 * stride), vuzp2q_u32(b, d));
+}
+
+template <>
+void swizzle_4x4<4>(uint8_t *swizzled, const uint8_t *linear, size_t stride) {
+    const uint32x4_t row0 = vld1q_u32(reinterpret_cast<const uint32_t *>(linear));
+    const uint32x4_t row1 = vld1q_u32(reinterpret_cast<const uint32_t *>(linear + stride));
+    const uint32x4_t row2 = vld1q_u32(reinterpret_cast<const uint32_t *>(linear + 2 * stride));
+    const uint32x4_t row3 = vld1q_u32(reinterpret_cast<const uint32_t *>(linear + 3 * stride));
+    uint32_t *dst = reinterpret_cast<uint32_t *>(swizzled);
+    vst1q_u32(dst, vzip1q_u32(row0, row1));
+    vst1q_u32(dst + 4, vzip1q_u32(row2, row3));
+    vst1q_u32(dst + 8, vzip2q_u32(row0, row1));
+    vst1q_u32(dst + 12, vzip2q_u32(row2, row3));
+}
+#elif defined(__x86_64__) || defined(_M_X64)
+// SSE2 is always available on x86-64, no need for a runtime check
+template <>
+void deswizzle_4x4<4>(uint8_t *linear, size_t stride, const uint8_t *swizzled) {
+    const __m128 a = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(swizzled)));
+    const __m128 b = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(swizzled + 16)));
+    const __m128 c = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(swizzled + 32)));
+    const __m128 d = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(swizzled + 48)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(linear), _mm_castps_si128(_mm_shuffle_ps(a, c, _MM_SHUFFLE(2, 0, 2, 0))));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(linear + stride), _mm_castps_si128(_mm_shuffle_ps(a, c, _MM_SHUFFLE(3, 1, 3, 1))));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(linear + 2 * stride), _mm_castps_si128(_mm_shuffle_ps(b, d, _MM_SHUFFLE(2, 0, 2, 0))));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(linear + 3 * stride), _mm_castps_si128(_mm_shuffle_ps(b, d, _MM_SHUFFLE(3, 1, 3, 1))));
+}
+
+template <>
+void swizzle_4x4<4>(uint8_t *swizzled, const uint8_t *linear, size_t stride) {
+    const __m128i row0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(linear));
+    const __m128i row1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(linear + stride));
+    const __m128i row2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(linear + 2 * stride));
+    const __m128i row3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(linear + 3 * stride));
+    __m128i *dst = reinterpret_cast<__m128i *>(swizzled);
+    _mm_storeu_si128(dst, _mm_unpacklo_epi32(row0, row1));
+    _mm_storeu_si128(dst + 1, _mm_unpacklo_epi32(row2, row3));
+    _mm_storeu_si128(dst + 2, _mm_unpackhi_epi32(row0, row1));
+    _mm_storeu_si128(dst + 3, _mm_unpackhi_epi32(row2, row3));
+}
+
+// the even pixels of a block give rows 0 and 2, the odd ones rows 1 and 3
+template <>
+void deswizzle_4x4<1>(uint8_t *linear, size_t stride, const uint8_t *swizzled) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(swizzled));
+    const __m128i even = _mm_and_si128(v, _mm_set1_epi16(0x00FF));
+    const __m128i odd = _mm_srli_epi16(v, 8);
+    // the words of (even | odd) are the 2-pixel halves of rows 0, 2, 0, 2, 1, 3, 1, 3
+    __m128i rows = _mm_packus_epi16(even, odd);
+    rows = _mm_shufflehi_epi16(_mm_shufflelo_epi16(rows, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+    const int row_order[] = { 0, 2, 1, 3 };
+    for (int i = 0; i < 4; i++) {
+        const int32_t row = _mm_cvtsi128_si32(rows);
+        memcpy(linear + row_order[i] * stride, &row, 4);
+        rows = _mm_srli_si128(rows, 4);
+    }
+}
+
+template <>
+void swizzle_4x4<1>(uint8_t *swizzled, const uint8_t *linear, size_t stride) {
+    __m128i row[4];
+    for (int i = 0; i < 4; i++) {
+        int32_t value;
+        memcpy(&value, linear + i * stride, 4);
+        row[i] = _mm_cvtsi32_si128(value);
+    }
+
+    __m128i rows = _mm_unpacklo_epi64(_mm_unpacklo_epi32(row[0], row[2]), _mm_unpacklo_epi32(row[1], row[3]));
+    rows = _mm_shufflehi_epi16(_mm_shufflelo_epi16(rows, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+    // rows now contains the even pixels followed by the odd ones
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(swizzled), _mm_unpacklo_epi8(rows, _mm_srli_si128(rows, 8)));
+}
+
+// [ w0 w1 w2 w3 w4 w5 w6 w7 ] -> [ w0 w2 w4 w6 w1 w3 w5 w7 ], each step is its own inverse
+static __m128i separate_even_odd_words(__m128i v) {
+    v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+static __m128i merge_even_odd_words(__m128i v) {
+    v = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+template <>
+void deswizzle_4x4<2>(uint8_t *linear, size_t stride, const uint8_t *swizzled) {
+    const __m128i a = separate_even_odd_words(_mm_loadu_si128(reinterpret_cast<const __m128i *>(swizzled)));
+    const __m128i c = separate_even_odd_words(_mm_loadu_si128(reinterpret_cast<const __m128i *>(swizzled + 16)));
+    // rows 0 and 2, then rows 1 and 3
+    const __m128i even_rows = _mm_unpacklo_epi32(a, c);
+    const __m128i odd_rows = _mm_unpackhi_epi32(a, c);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(linear), even_rows);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(linear + stride), odd_rows);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(linear + 2 * stride), _mm_unpackhi_epi64(even_rows, even_rows));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(linear + 3 * stride), _mm_unpackhi_epi64(odd_rows, odd_rows));
+}
+
+template <>
+void swizzle_4x4<2>(uint8_t *swizzled, const uint8_t *linear, size_t stride) {
+    const __m128i row0 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(linear));
+    const __m128i row1 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(linear + stride));
+    const __m128i row2 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(linear + 2 * stride));
+    const __m128i row3 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(linear + 3 * stride));
+    const __m128i even_rows = _mm_shuffle_epi32(_mm_unpacklo_epi64(row0, row2), _MM_SHUFFLE(3, 1, 2, 0));
+    const __m128i odd_rows = _mm_shuffle_epi32(_mm_unpacklo_epi64(row1, row3), _MM_SHUFFLE(3, 1, 2, 0));
+    __m128i *dst = reinterpret_cast<__m128i *>(swizzled);
+    _mm_storeu_si128(dst, merge_even_odd_words(_mm_unpacklo_epi64(even_rows, odd_rows)));
+    _mm_storeu_si128(dst + 1, merge_even_odd_words(_mm_unpackhi_epi64(even_rows, odd_rows)));
+}
+
+template <>
+void deswizzle_4x4<8>(uint8_t *linear, size_t stride, const uint8_t *swizzled) {
+    const __m128i *src = reinterpret_cast<const __m128i *>(swizzled);
+    __m128i s[8];
+    for (int i = 0; i < 8; i++)
+        s[i] = _mm_loadu_si128(src + i);
+
+    // each register contains 2 pixels, the rows are made of the low or high halves of 4 of them
+    for (int row = 0; row < 4; row++) {
+        const int first = (row & 2) ? 2 : 0;
+        __m128i *dst = reinterpret_cast<__m128i *>(linear + row * stride);
+        if (row & 1) {
+            _mm_storeu_si128(dst, _mm_unpackhi_epi64(s[first], s[first + 1]));
+            _mm_storeu_si128(dst + 1, _mm_unpackhi_epi64(s[first + 4], s[first + 5]));
+        } else {
+            _mm_storeu_si128(dst, _mm_unpacklo_epi64(s[first], s[first + 1]));
+            _mm_storeu_si128(dst + 1, _mm_unpacklo_epi64(s[first + 4], s[first + 5]));
+        }
+    }
+}
+
+template <>
+void swizzle_4x4<8>(uint8_t *swizzled, const uint8_t *linear, size_t stride) {
+    __m128i r[4][2];
+    for (int row = 0; row < 4; row++) {
+        r[row][0] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(linear + row * stride));
+        r[row][1] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(linear + row * stride) + 1);
+    }
+
+    __m128i *dst = reinterpret_cast<__m128i *>(swizzled);
+    for (int half = 0; half < 2; half++) {
+        _mm_storeu_si128(dst + 4 * half, _mm_unpacklo_epi64(r[0][half], r[1][half]));
+        _mm_storeu_si128(dst + 4 * half + 1, _mm_unpackhi_epi64(r[0][half], r[1][half]));
+        _mm_storeu_si128(dst + 4 * half + 2, _mm_unpacklo_epi64(r[2][half], r[3][half]));
+        _mm_storeu_si128(dst + 4 * half + 3, _mm_unpackhi_epi64(r[2][half], r[3][half]));
+    }
+}
+#endif
+
+// convert a square block of side size (at least 4) between the swizzled and linear layouts
+template <size_t N, bool to_linear>
+static void convert_swizzled_square(uint8_t *swizzled, uint8_t *linear, uint32_t size, size_t stride) {
+    const uint32_t nb_blocks = size / 4;
+    uint32_t morton_y = 0;
+    for (uint32_t by = 0; by < nb_blocks; by++) {
+        uint8_t *linear_row = linear + by * 4 * stride;
+        uint32_t morton_x = 0;
+        for (uint32_t bx = 0; bx < nb_blocks; bx++) {
+            uint8_t *block = swizzled + static_cast<size_t>(morton_x | morton_y) * 16 * N;
+            if constexpr (to_linear)
+                deswizzle_4x4<N>(linear_row + bx * 4 * N, stride, block);
+            else
+                swizzle_4x4<N>(block, linear_row + bx * 4 * N, stride);
+
+            morton_x = (morton_x - morton_x_mask) & morton_x_mask;
+        }
+        morton_y = (morton_y - morton_y_mask) & morton_y_mask;
+    }
+}
+
+template <size_t N, bool to_linear>
+static void convert_swizzled(uint8_t *swizzled, uint8_t *linear, uint32_t width, uint32_t height) {
+    const uint32_t size = std::min(width, height);
+    const size_t stride = static_cast<size_t>(width) * N;
+    const uint32_t nb_squares = std::max(width, height) / size;
+    for (uint32_t i = 0; i < nb_squares; i++) {
+        // the squares follow each other along the largest dimension
+        const size_t linear_offset = (width >= height) ? i * size * N : i * size * stride;
+        convert_swizzled_square<N, to_linear>(swizzled + static_cast<size_t>(i) * size * size * N, linear + linear_offset, size, stride);
+    }
+}
+
+// only used for the smallest mips and unusual pixel sizes
+static void convert_swizzled_basic(uint8_t *swizzled, uint8_t *linear, uint32_t width, uint32_t height, uint32_t bytes_per_pixel, bool to_linear) {
+    const uint32_t size = std::min(width, height);
+    const uint32_t k = std::bit_width(size) - 1;
+
+    for (uint32_t i = 0; i < width * height; i++) {
+        uint32_t x = 0;
+        uint32_t y = 0;
+        for (uint32_t bit = 0; bit < 16; bit++) {
+            x |= ((i >> (2 * bit + 1)) & 1) << bit;
+            y |= ((i >> (2 * bit)) & 1) << bit;
+        }
+        x &= size - 1;
+        y &= size - 1;
+        const uint32_t upper_bits = (i >> (2 * k)) << k;
+        if (width >= height)
+            x |= upper_bits;
+        else
+            y |= upper_bits;
+
+        uint8_t *linear_pixel = linear + (y * width + x) * bytes_per_pixel;
+        uint8_t *swizzled_pixel = swizzled + i * bytes_per_pixel;
+        if (to_linear)
+            memcpy(linear_pixel, swizzled_pixel, bytes_per_pixel);
+        else
+            memcpy(swizzled_pixel, linear_pixel, bytes_per_pixel);
+    }
+}
+
+template <bool to_linear>
+static void convert_swizzled(uint8_t *swizzled, uint8_t *linear, uint32_t width, uint32_t height, uint8_t bits_per_pixel) {
+    if (bits_per_pixel % 8 != 0) {
+        // Don't support yet
+        return;
+    }
+
+    const uint32_t bytes_per_pixel = bits_per_pixel >> 3;
+    if (std::min(width, height) < 4 || !std::has_single_bit(width) || !std::has_single_bit(height)) {
+        convert_swizzled_basic(swizzled, linear, width, height, bytes_per_pixel, to_linear);
+        return;
+    }
+
+    switch (bytes_per_pixel) {
+    case 1: return convert_swizzled<1, to_linear>(swizzled, linear, width, height);
+    case 2: return convert_swizzled<2, to_linear>(swizzled, linear, width, height);
+    case 3: return convert_swizzled<3, to_linear>(swizzled, linear, width, height);
+    case 4: return convert_swizzled<4, to_linear>(swizzled, linear, width, height);
+    case 6: return convert_swizzled<6, to_linear>(swizzled, linear, width, height);
+    case 8: return convert_swizzled<8, to_linear>(swizzled, linear, width, height);
+    case 16: return convert_swizzled<16, to_linear>(swizzled, linear, width, height);
+    default:
+        convert_swizzled_basic(swizzled, linear, width, height, bytes_per_pixel, to_linear);
+        break;
+    }
+}
+
+void swizzled_texture_to_linear_texture(uint8_t *dest, const uint8_t *src, uint16_t width, uint16_t height, uint8_t bits_per_pixel) {
+    // src is only read from
+    convert_swizzled<true>(const_cast<uint8_t *>(src), dest, width, height, bits_per_pixel);
+}
+
+void linear_texture_to_swizzled_texture(uint8_t *dest, const uint8_t *src, uint16_t width, uint16_t height, uint8_t bits_per_pixel) {
+    convert_swizzled<false>(dest, const_cast<uint8_t *>(src), width, height, bits_per_pixel);
+}
+
+// Tiled textures are made of 32x32 pixel tiles, each tile being linear. So each row of a tile
+// is a contiguous row of 32 pixels in the linear layout
+template <size_t N, bool to_linear>
+static void convert_tiled(uint8_t *tiled, uint8_t *linear, uint32_t width, uint32_t height) {
+    constexpr size_t tile_row_size = 32 * N;
+    constexpr size_t tile_size = 32 * tile_row_size;
+    const uint32_t width_in_tiles = (width + 31) >> 5;
+    const uint32_t full_tiles = width >> 5;
+    const size_t tail_size = (width & 31) * N;
+
+    for (uint32_t y = 0; y < height; y++) {
+        uint8_t *tiled_row = tiled + (y >> 5) * width_in_tiles * tile_size + (y & 31) * tile_row_size;
+        uint8_t *linear_row = linear + static_cast<size_t>(y) * width * N;
+        for (uint32_t tile = 0; tile < full_tiles; tile++) {
+            if constexpr (to_linear)
+                memcpy(linear_row + tile * tile_row_size, tiled_row + tile * tile_size, tile_row_size);
+            else
+                memcpy(tiled_row + tile * tile_size, linear_row + tile * tile_row_size, tile_row_size);
+        }
+
+        if (tail_size > 0) {
+            if constexpr (to_linear)
+                memcpy(linear_row + full_tiles * tile_row_size, tiled_row + full_tiles * tile_size, tail_size);
+            else
+                memcpy(tiled_row + full_tiles * tile_size, linear_row + full_tiles * tile_row_size, tail_size);
+        }
+    }
+}
+
+static void convert_tiled_basic(uint8_t *tiled, uint8_t *linear, uint32_t width, uint32_t height, uint32_t bytes_per_pixel, bool to_linear) {
+    const uint32_t width_in_tiles = (width + 31) >> 5;
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            const uint32_t texel_offset_in_tile = (x & 0b11111) | ((y & 0b11111) << 5);
+            const uint32_t tile_address = (x >> 5) + width_in_tiles * (y >> 5);
+            uint8_t *tiled_pixel = tiled + ((tile_address << 10) | texel_offset_in_tile) * bytes_per_pixel;
+            uint8_t *linear_pixel = linear + (y * width + x) * bytes_per_pixel;
+            if (to_linear)
+                memcpy(linear_pixel, tiled_pixel, bytes_per_pixel);
+            else
+                memcpy(tiled_pixel, linear_pixel, bytes_per_pixel);
+        }
+    }
+}
+
+template <bool to_linear>
+static void convert_tiled(uint8_t *tiled, uint8_t *linear, uint32_t width, uint32_t height, uint8_t bits_per_pixel) {
+    if (bits_per_pixel % 8 != 0) {
+        // Don't support yet
+        return;
+    }
+
+    switch (bits_per_pixel >> 3) {
+    case 1: return convert_tiled<1, to_linear>(tiled, linear, width, height);
+    case 2: return convert_tiled<2, to_linear>(tiled, linear, width, height);
+    case 3: return convert_tiled<3, to_linear>(tiled, linear, width, height);
+    case 4: return convert_tiled<4, to_linear>(tiled, linear, width, height);
+    case 6: return convert_tiled<6, to_linear>(tiled, linear, width, height);
+    case 8: return convert_tiled<8, to_linear>(tiled, linear, width, height);
+    case 16: return convert_tiled<16, to_linear>(tiled, linear, width, height);
+    default:
+        convert_tiled_basic(tiled, linear, width, height, bits_per_pixel >> 3, to_linear);
+        break;
+    }
+}
+
+void tiled_texture_to_linear_texture(uint8_t *dest, const uint8_t *src, uint16_t width, uint16_t height, uint8_t bits_per_pixel) {
+    convert_tiled<true>(const_cast<uint8_t *>(src), dest, width, height, bits_per_pixel);
+}
+
+void linear_texture_to_tiled_texture(uint8_t *dest, const uint8_t *src, uint16_t width, uint16_t height, uint8_t bits_per_pixel) {
+    convert_tiled<false>(dest, const_cast<uint8_t *>(src), width, height, bits_per_pixel);
+}
+
+} // namespace renderer::texture
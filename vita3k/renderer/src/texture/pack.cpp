@@ -0,0 +1,260 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <renderer/texture_pack.h>
+
+#include <mem/util.h>
+#include <util/align.h>
+#include <util/log.h>
+
+#include <ddspp.h>
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <vector>
+
+namespace renderer {
+
+// 'VTPK'
+static constexpr uint32_t TEXTURE_PACK_MAGIC = 0x4B505456;
+static constexpr uint32_t TEXTURE_PACK_VERSION = 1;
+// payloads are aligned on this, this way they never share a cache line or a page boundary with the index
+static constexpr uint64_t TEXTURE_PACK_ALIGNMENT = 64;
+
+struct TexturePackHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t reserved;
+};
+
+enum : uint8_t {
+    ENTRY_NOT_REQUESTED = 0,
+    ENTRY_STREAMING = 1,
+    ENTRY_READY = 2,
+};
+
+TexturePack::~TexturePack() {
+    if (stream_thread.joinable()) {
+        stream_queue.enqueue(UINT32_MAX);
+        stream_thread.join();
+    }
+}
+
+bool TexturePack::open(const fs::path &path) {
+    if (!file.open(path))
+        return false;
+
+    TexturePackHeader header;
+    bool valid = file.size() >= sizeof(header);
+    if (valid) {
+        memcpy(&header, file.data(), sizeof(header));
+        valid = header.magic == TEXTURE_PACK_MAGIC && header.version == TEXTURE_PACK_VERSION
+            && sizeof(header) + static_cast<uint64_t>(header.entry_count) * sizeof(TexturePackEntry) <= file.size();
+    }
+
+    if (valid) {
+        entries = reinterpret_cast<const TexturePackEntry *>(file.data() + sizeof(header));
+        entry_count = header.entry_count;
+
+        for (uint32_t i = 0; i < entry_count && valid; i++) {
+            const TexturePackEntry &entry = entries[i];
+            valid = entry.offset + entry.size <= file.size() && (i == 0 || entries[i - 1].hash < entry.hash);
+            if (entry.type == TexturePackEntryType::Dds)
+                valid &= entry.size >= ddspp::MAX_HEADER_SIZE;
+            else
+                valid &= entry.size >= static_cast<uint64_t>(entry.width) * entry.height * 4;
+        }
+    }
+
+    if (!valid) {
+        LOG_ERROR("Texture pack {} is invalid or was made by another version", path);
+        file.close();
+        entries = nullptr;
+        entry_count = 0;
+        return false;
+    }
+
+    entry_states = std::make_unique<std::atomic<uint8_t>[]>(entry_count);
+    stream_thread = std::thread(&TexturePack::stream_thread_func, this);
+
+    return true;
+}
+
+const TexturePackEntry *TexturePack::find(uint64_t hash) const {
+    const TexturePackEntry *end = entries + entry_count;
+    const TexturePackEntry *entry = std::lower_bound(entries, end, hash, [](const TexturePackEntry &entry, uint64_t hash) {
+        return entry.hash < hash;
+    });
+
+    if (entry == end || entry->hash != hash)
+        return nullptr;
+
+    return entry;
+}
+
+bool TexturePack::request(const TexturePackEntry &entry) {
+    const uint32_t index = static_cast<uint32_t>(&entry - entries);
+    uint8_t state = ENTRY_NOT_REQUESTED;
+    if (entry_states[index].compare_exchange_strong(state, ENTRY_STREAMING)) {
+        stream_queue.enqueue(index);
+        return false;
+    }
+
+    return state == ENTRY_READY;
+}
+
+bool TexturePack::is_ready(const TexturePackEntry &entry) const {
+    return entry_states[&entry - entries] == ENTRY_READY;
+}
+
+void TexturePack::stream_thread_func() {
+    while (true) {
+        uint32_t index;
+        stream_queue.wait_dequeue(index);
+        if (index == UINT32_MAX)
+            break;
+
+        const TexturePackEntry &entry = entries[index];
+        file.prefetch(entry.offset, entry.size);
+
+        // read one byte of each page, the render thread then doesn't get any page fault when using it
+        const volatile uint8_t *data = file.data() + entry.offset;
+        uint8_t sum = 0;
+        for (uint64_t offset = 0; offset < entry.size; offset += KiB(4))
+            sum += data[offset];
+        (void)sum;
+
+        entry_states[index] = ENTRY_READY;
+    }
+}
+
+bool create_texture_pack(const fs::path &folder, const fs::path &pack_path) {
+    if (!fs::is_directory(folder)) {
+        LOG_ERROR("{} is not a folder", folder);
+        return false;
+    }
+
+    // same rules as when importing textures from the folder: dds files are preferred over png ones
+    std::map<uint64_t, fs::path> textures;
+    for (const auto &file_entry : fs::recursive_directory_iterator(folder)) {
+        const fs::path &file = file_entry.path();
+        if (!fs::is_regular_file(file))
+            continue;
+
+        uint64_t hash;
+        if (!(std::istringstream{ file.filename().string() } >> std::hex >> hash))
+            continue;
+
+        const bool is_dds = file.extension() == ".dds";
+        if (!is_dds && file.extension() != ".png")
+            continue;
+
+        if (is_dds || !textures.contains(hash))
+            textures[hash] = file;
+    }
+
+    if (textures.empty()) {
+        LOG_ERROR("No texture found in {}", folder);
+        return false;
+    }
+
+    const fs::path tmp_path = fs_utils::path_concat(pack_path, ".tmp");
+    fs::ofstream output(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!output) {
+        LOG_ERROR("Failed to open {} for writing", tmp_path);
+        return false;
+    }
+
+    // the index is written last, when the location of each texture is known
+    const uint64_t index_end = sizeof(TexturePackHeader) + textures.size() * sizeof(TexturePackEntry);
+    uint64_t offset = align(index_end, TEXTURE_PACK_ALIGNMENT);
+    output.seekp(offset);
+
+    std::vector<TexturePackEntry> entries;
+    entries.reserve(textures.size());
+    std::vector<uint8_t> content;
+    for (const auto &[hash, file] : textures) {
+        TexturePackEntry entry{};
+        entry.hash = hash;
+        entry.offset = offset;
+
+        if (file.extension() == ".dds") {
+            ddspp::Descriptor descriptor;
+            if (!fs_utils::read_data(file, content) || content.size() < ddspp::MAX_HEADER_SIZE
+                || ddspp::decode_header(content.data(), descriptor) != ddspp::Success) {
+                LOG_WARN("Skipping invalid dds file {}", file);
+                continue;
+            }
+
+            entry.type = TexturePackEntryType::Dds;
+            entry.width = descriptor.width;
+            entry.height = descriptor.height;
+            entry.size = content.size();
+            output.write(reinterpret_cast<const char *>(content.data()), content.size());
+        } else {
+            int width, height, nb_channels;
+            uint8_t *pixels = stbi_load(fs_utils::path_to_utf8(file).c_str(), &width, &height, &nb_channels, 4);
+            if (!pixels) {
+                LOG_WARN("Skipping invalid png file {}", file);
+                continue;
+            }
+
+            entry.type = TexturePackEntryType::Rgba8;
+            entry.width = width;
+            entry.height = height;
+            entry.nb_channels = nb_channels;
+            entry.size = static_cast<uint64_t>(width) * height * 4;
+            output.write(reinterpret_cast<const char *>(pixels), entry.size);
+            stbi_image_free(pixels);
+        }
+
+        entries.push_back(entry);
+        offset = align(offset + entry.size, TEXTURE_PACK_ALIGNMENT);
+        output.seekp(offset);
+
+        if (entries.size() % 1000 == 0)
+            LOG_INFO("Packed {}/{} textures", entries.size(), textures.size());
+    }
+
+    const TexturePackHeader header = { TEXTURE_PACK_MAGIC, TEXTURE_PACK_VERSION, static_cast<uint32_t>(entries.size()), 0 };
+    output.seekp(0);
+    output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(TexturePackEntry));
+    output.close();
+
+    if (!output) {
+        LOG_ERROR("Failed to write {}", tmp_path);
+        fs::remove(tmp_path);
+        return false;
+    }
+
+    boost::system::error_code err;
+    fs::rename(tmp_path, pack_path, err);
+    if (err) {
+        LOG_ERROR("Failed to rename {}: {}", tmp_path, err.message());
+        return false;
+    }
+
+    LOG_INFO("Packed {} textures in {} ({} MiB)", entries.size(), pack_path, offset / MiB(1));
+    return true;
+}
+
+} // namespace renderer
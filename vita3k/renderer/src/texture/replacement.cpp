@@ -17,6 +17,7 @@
 
 #include "renderer/functions.h"
 #include "renderer/texture_cache.h"
+#include "renderer/texture_pack.h"
 
 #include "gxm/functions.h"
 #include "util/align.h"
@@ -433,12 +434,16 @@ void TextureCache::export_done() {
 
 bool TextureCache::import_configure_texture() {
     uint64_t hash = current_info->hash;
+    const TexturePackEntry *pack_entry = loading_texture.pack_entry;
     const std::string file_name = fmt::format("{:016X}.{}", hash, loading_texture.is_dds ? "dds" : "png");
-    fs::path import_name = *loading_texture.folder_path / file_name;
+    fs::path import_name;
 
-    if (!fs::exists(import_name)) {
-        LOG_ERROR("Texture {} was listed as available but was not found", file_name);
-        return false;
+    if (!pack_entry) {
+        import_name = *loading_texture.folder_path / file_name;
+        if (!fs::exists(import_name)) {
+            LOG_ERROR("Texture {} was listed as available but was not found", file_name);
+            return false;
+        }
     }
 
     SceGxmTexture &gxm_texture = current_info->texture;
@@ -465,16 +470,23 @@ bool TextureCache::import_configure_texture() {
         if (dds_descriptor == nullptr)
             dds_descriptor = new ddspp::Descriptor;
 
-        auto res = fs_utils::read_data(import_name, imported_texture_raw_data);
-        if (!res) {
-            LOG_ERROR("Failed to read {}", file_name);
-            return false;
-        }
-        if (imported_texture_raw_data.size() < ddspp::MAX_HEADER_SIZE) {
-            imported_texture_raw_data.resize(ddspp::MAX_HEADER_SIZE);
+        const uint8_t *dds_data;
+        if (pack_entry) {
+            // the texture pack is mapped in memory, no need to read anything
+            dds_data = texture_pack->get_data(*pack_entry);
+        } else {
+            auto res = fs_utils::read_data(import_name, imported_texture_raw_data);
+            if (!res) {
+                LOG_ERROR("Failed to read {}", file_name);
+                return false;
+            }
+            if (imported_texture_raw_data.size() < ddspp::MAX_HEADER_SIZE) {
+                imported_texture_raw_data.resize(ddspp::MAX_HEADER_SIZE);
+            }
+            dds_data = imported_texture_raw_data.data();
         }
 
-        if (ddspp::decode_header(imported_texture_raw_data.data(), *dds_descriptor) != ddspp::Success) {
+        if (ddspp::decode_header(const_cast<uint8_t *>(dds_data), *dds_descriptor) != ddspp::Success) {
             LOG_ERROR("Failed to decode file {} header", file_name);
             return false;
         }
@@ -498,19 +510,46 @@ bool TextureCache::import_configure_texture() {
         is_srgb = ddspp::is_srgb(dds_descriptor->format);
         swap_rb = dds_swap_rb(dds_descriptor->format);
 
-        imported_texture_decoded = imported_texture_raw_data.data() + dds_descriptor->headerSize;
+        imported_texture_decoded = dds_data + dds_descriptor->headerSize;
     } else {
-        int nb_channels;
-        imported_texture_decoded = stbi_load(fs_utils::path_to_utf8(import_name).c_str(), reinterpret_cast<int *>(&width), reinterpret_cast<int *>(&height), &nb_channels, nb_comp);
-        if (imported_texture_decoded == nullptr) {
-            LOG_ERROR("Failed to decode {}", file_name);
-            return false;
-        }
+        if (pack_entry) {
+            // the png was already decoded with 4 components when the pack was made
+            width = pack_entry->width;
+            height = pack_entry->height;
+            if (nb_comp >= 3 && pack_entry->nb_channels <= 2) {
+                LOG_ERROR("Texture {} has {} channels, expected {}", file_name, pack_entry->nb_channels, nb_comp);
+                return false;
+            }
 
-        if (nb_comp >= 3 && nb_channels <= 2) {
-            LOG_ERROR("Texture {} has {} channels, expected {}", file_name, nb_channels, nb_comp);
-            stbi_image_free(imported_texture_decoded);
-            return false;
+            const uint8_t *pixels = texture_pack->get_data(*pack_entry);
+            if (nb_comp == 4) {
+                imported_texture_decoded = pixels;
+            } else {
+                // same conversion as stb_image when asking for a grey (+ alpha) image
+                const uint32_t nb_pixels = width * height;
+                imported_texture_raw_data.resize(nb_pixels * nb_comp);
+                for (uint32_t i = 0; i < nb_pixels; i++) {
+                    const uint8_t *pixel = pixels + i * 4;
+                    imported_texture_raw_data[i * nb_comp] = static_cast<uint8_t>((pixel[0] * 77 + pixel[1] * 150 + pixel[2] * 29) >> 8);
+                    if (nb_comp == 2)
+                        imported_texture_raw_data[i * nb_comp + 1] = pixel[3];
+                }
+                imported_texture_decoded = imported_texture_raw_data.data();
+            }
+        } else {
+            int nb_channels;
+            uint8_t *png_pixels = stbi_load(fs_utils::path_to_utf8(import_name).c_str(), reinterpret_cast<int *>(&width), reinterpret_cast<int *>(&height), &nb_channels, nb_comp);
+            if (png_pixels == nullptr) {
+                LOG_ERROR("Failed to decode {}", file_name);
+                return false;
+            }
+
+            if (nb_comp >= 3 && nb_channels <= 2) {
+                LOG_ERROR("Texture {} has {} channels, expected {}", file_name, nb_channels, nb_comp);
+                stbi_image_free(png_pixels);
+                return false;
+            }
+            imported_texture_decoded = png_pixels;
         }
 
         if (nb_comp == 1)
@@ -573,12 +612,12 @@ void TextureCache::import_upload_texture() {
 }
 
 void TextureCache::import_done() {
-    if (loading_texture.is_dds) {
+    if (loading_texture.is_dds || loading_texture.pack_entry) {
         imported_texture_raw_data.clear();
         imported_texture_decoded = nullptr;
     } else {
         if (imported_texture_decoded) {
-            stbi_image_free(imported_texture_decoded);
+            stbi_image_free(const_cast<uint8_t *>(imported_texture_decoded));
             imported_texture_decoded = nullptr;
         }
     }
@@ -626,6 +665,7 @@ void TextureCache::refresh_available_textures() {
     }
 
     available_textures_hash.clear();
+    texture_pack.reset();
     if (import_textures) {
         // to reduce memory, reuse the same path for multiple textures in the same folder
         std::map<fs::path, std::shared_ptr<fs::path>> found_folders;
@@ -648,6 +688,15 @@ void TextureCache::refresh_available_textures() {
 
         if (!available_textures_hash.empty())
             LOG_INFO("Found {} textures ready to be imported", available_textures_hash.size());
+
+        const fs::path pack_path = fs_utils::path_concat(import_folder, ".vtp");
+        if (fs::exists(pack_path)) {
+            texture_pack = std::make_unique<TexturePack>();
+            if (texture_pack->open(pack_path))
+                LOG_INFO("Found {} textures ready to be imported in {}", texture_pack->size(), pack_path);
+            else
+                texture_pack.reset();
+        }
     }
 }
 
@@ -425,6 +425,9 @@ void VKContext::stop_recording(const SceGxmNotification &notif1, const SceGxmNot
     if (state.features.support_memory_mapping && !state.disable_surface_sync)
         surface_info = state.surface_cache.perform_surface_sync();
 
+    // the texture uploads recorded in the prerender command must have their content ready
+    state.texture_cache.wait_pending_decodes();
+
     prerender_cmd.end();
     render_cmd.end();
 
@@ -558,6 +561,7 @@ void new_frame(VKContext &context) {
         frame.frag_descriptors[i].descriptors_idx = 0;
     }
     frame.color_descriptor.descriptors_idx = 0;
+    frame.decode_descriptor.descriptors_idx = 0;
 
     // deferred destruction of the objects
     frame.destroy_queue.destroy_objects();
@@ -47,12 +47,22 @@ struct CompileRequest {
     vk::Pipeline *pipeline;
 
     // this is everything we need to compile the shader on another thread (as the original data will change)
+    uint64_t key;
     SceGxmPrimitiveType type;
     vk::RenderPass render_pass;
+    vk::Format color_format;
     SceGxmVertexProgram *vertex_program_gxm;
     SceGxmFragmentProgram *fragment_program_gxm;
     shader::Hints hints;
 
+    // the request is for a fallback pipeline, the record state which is set dynamically is already reset
+    bool is_fallback = false;
+
+    // set when the pipeline comes from the warm-up list, nothing else except render_pass is used then
+    std::unique_ptr<PipelineDescription> description;
+    vk::ShaderModule vertex_module;
+    vk::ShaderModule fragment_module;
+
     // the content of the record useful for the pipeline creation
     alignas(8) uint8_t record_data[record_pipeline_len];
 
@@ -321,6 +331,7 @@ void PipelineCache::save_pipeline_cache() {
         shader_cache_copy = state.shaders_cache_hashs;
     }
     renderer::save_shaders_cache_hashs(state, shader_cache_copy);
+    save_warmup_pipelines();
 
     const std::vector<uint8_t> pipeline_data = state.device.getPipelineCacheData(pipeline_cache);
     if (pipeline_data.empty())
@@ -352,6 +363,205 @@ void PipelineCache::save_pipeline_cache() {
     LOG_INFO("Pipeline cache saved");
 }
 
+// magic number put at the beginning of the pipeline warm-up file
+constexpr uint32_t pipeline_warmup_magic = 0xBEEF4322;
+// sanity check when reading the file, there are at most 16 attributes and matrices take at most 4 locations
+constexpr uint32_t max_warmup_attributes = 64;
+
+enum PipelineWarmupFlags : uint8_t {
+    WARMUP_SHADER_INTERLOCK = 1 << 0,
+    WARMUP_FRAGMENT_DISABLED = 1 << 1,
+    WARMUP_SRGB_CONSTANT = 1 << 2,
+};
+
+static fs::path get_warmup_path(const fs::path &shaders_path) {
+    return shaders_path / fmt::format("pipelines-vk{}.dat", shader::CURRENT_VERSION);
+}
+
+void PipelineCache::read_warmup_pipelines() {
+    warmup_pipelines.clear();
+    warmup_keys.clear();
+    warmup_saved_count = 0;
+
+    fs::ifstream warmup_file(get_warmup_path(state.shaders_path), std::ios::in | std::ios::binary);
+    if (!warmup_file.is_open())
+        return;
+
+    auto read_data = [&](void *data, size_t size) {
+        warmup_file.read(reinterpret_cast<char *>(data), size);
+        return static_cast<bool>(warmup_file);
+    };
+    auto read_integer = [&]<typename T>(T &val) {
+        return read_data(&val, sizeof(T));
+    };
+
+    uint32_t magic_number = 0;
+    uint32_t record_len = 0;
+    // the layout of the record may change without the shader version being bumped
+    if (!read_integer(magic_number) || !read_integer(record_len) || magic_number != pipeline_warmup_magic || record_len != record_pipeline_len) {
+        LOG_WARN("Pipeline warm-up list is corrupted or outdated, ignoring it.");
+        return;
+    }
+
+    while (warmup_file.peek() != fs::ifstream::traits_type::eof()) {
+        PipelineDescription description;
+        uint32_t type;
+        uint32_t color_format;
+        uint8_t flags;
+        uint32_t nb_bindings;
+        uint32_t nb_attributes;
+        if (!read_integer(description.key) || !read_data(description.vertex_hash.data(), sizeof(Sha256Hash))
+            || !read_data(description.fragment_hash.data(), sizeof(Sha256Hash)) || !read_integer(type)
+            || !read_integer(color_format) || !read_integer(flags) || !read_integer(description.vertex_texture_count)
+            || !read_integer(description.fragment_texture_count) || !read_integer(description.blending)
+            || !read_integer(nb_bindings) || nb_bindings > SCE_GXM_MAX_VERTEX_STREAMS)
+            break;
+
+        description.bindings.resize(nb_bindings);
+        if (!read_data(description.bindings.data(), nb_bindings * sizeof(vk::VertexInputBindingDescription))
+            || !read_integer(nb_attributes) || nb_attributes > max_warmup_attributes)
+            break;
+
+        description.attributes.resize(nb_attributes);
+        description.record.resize(record_pipeline_len);
+        if (!read_data(description.attributes.data(), nb_attributes * sizeof(vk::VertexInputAttributeDescription))
+            || !read_data(description.record.data(), record_pipeline_len))
+            break;
+
+        if (description.vertex_texture_count > 16 || description.fragment_texture_count > 16)
+            break;
+
+        description.type = static_cast<SceGxmPrimitiveType>(type);
+        description.color_format = static_cast<vk::Format>(color_format);
+        description.use_shader_interlock = flags & WARMUP_SHADER_INTERLOCK;
+        description.is_fragment_disabled = flags & WARMUP_FRAGMENT_DISABLED;
+        description.use_srgb_constant = flags & WARMUP_SRGB_CONSTANT;
+
+        if (warmup_keys.insert(description.key).second)
+            warmup_pipelines.push_back(std::move(description));
+    }
+
+    // if the end of the file is damaged, it gets rewritten with the valid descriptions at the next save
+    if (warmup_file.eof() && !warmup_file.fail())
+        warmup_saved_count = warmup_pipelines.size();
+}
+
+void PipelineCache::save_warmup_pipelines() {
+    std::lock_guard<std::mutex> guard(warmup_mutex);
+    if (warmup_pipelines.size() == warmup_saved_count)
+        return;
+
+    fs::ofstream warmup_file(get_warmup_path(state.shaders_path), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!warmup_file.is_open())
+        return;
+
+    auto write_data = [&](const void *data, size_t size) {
+        warmup_file.write(reinterpret_cast<const char *>(data), size);
+    };
+    auto write_integer = [&]<typename T>(T val) {
+        write_data(&val, sizeof(T));
+    };
+
+    write_integer(pipeline_warmup_magic);
+    write_integer(static_cast<uint32_t>(record_pipeline_len));
+    for (const PipelineDescription &description : warmup_pipelines) {
+        uint8_t flags = 0;
+        if (description.use_shader_interlock)
+            flags |= WARMUP_SHADER_INTERLOCK;
+        if (description.is_fragment_disabled)
+            flags |= WARMUP_FRAGMENT_DISABLED;
+        if (description.use_srgb_constant)
+            flags |= WARMUP_SRGB_CONSTANT;
+
+        write_integer(description.key);
+        write_data(description.vertex_hash.data(), sizeof(Sha256Hash));
+        write_data(description.fragment_hash.data(), sizeof(Sha256Hash));
+        write_integer(static_cast<uint32_t>(description.type));
+        write_integer(static_cast<uint32_t>(description.color_format));
+        write_integer(flags);
+        write_integer(description.vertex_texture_count);
+        write_integer(description.fragment_texture_count);
+        write_integer(description.blending);
+        write_integer(static_cast<uint32_t>(description.bindings.size()));
+        write_data(description.bindings.data(), description.bindings.size() * sizeof(vk::VertexInputBindingDescription));
+        write_integer(static_cast<uint32_t>(description.attributes.size()));
+        write_data(description.attributes.data(), description.attributes.size() * sizeof(vk::VertexInputAttributeDescription));
+        write_data(description.record.data(), record_pipeline_len);
+    }
+
+    warmup_saved_count = warmup_pipelines.size();
+    LOG_INFO("Pipeline warm-up list saved with {} pipelines", warmup_saved_count);
+}
+
+void PipelineCache::record_warmup_pipeline(PipelineDescription &&description) {
+    std::lock_guard<std::mutex> guard(warmup_mutex);
+    if (warmup_keys.insert(description.key).second)
+        warmup_pipelines.push_back(std::move(description));
+}
+
+uint32_t PipelineCache::warm_up_pipelines() {
+    read_warmup_pipelines();
+    warmup_compiled_count = 0;
+    if (warmup_pipelines.empty())
+        return 0;
+
+    // can't use constexpr because of apple clang...
+    const vk::Pipeline pipeline_compiling = std::bit_cast<vk::Pipeline, uint64_t>(~0ULL);
+
+    std::vector<CompileRequest *> requests;
+    for (const PipelineDescription &description : warmup_pipelines) {
+        auto it = pipelines.find(description.key);
+        if (it != pipelines.end() && it->second != nullptr)
+            continue;
+
+        // the shaders are missing if they could not be loaded from the shader cache
+        const vk::ShaderModule vertex_module = precompile_shader(description.vertex_hash);
+        const vk::ShaderModule fragment_module = precompile_shader(description.fragment_hash);
+        if (!vertex_module || !fragment_module)
+            continue;
+
+        // render passes with the same formats are compatible, whatever their load and store operations are
+        // retrieving it here also makes sure the render pass map is only accessed by the main thread
+        const vk::RenderPass render_pass = retrieve_render_pass(description.color_format, true, true, description.use_shader_interlock);
+
+        vk::Pipeline &pipeline = pipelines[description.key];
+        pipeline = pipeline_compiling;
+
+        CompileRequest *request = new CompileRequest;
+        *request = {
+            .pipeline = &pipeline,
+            .render_pass = render_pass,
+            .description = std::make_unique<PipelineDescription>(description),
+            .vertex_module = vertex_module,
+            .fragment_module = fragment_module
+        };
+        requests.push_back(request);
+    }
+
+    if (requests.empty())
+        return 0;
+
+    LOG_INFO("Warming up {} pipelines", requests.size());
+
+    // when async compilation is disabled, the compiler threads only run until the warm-up is over
+    if (!use_async_compilation) {
+        for (int i = 0; i < nb_worker_threads; i++) {
+            std::thread thread(&PipelineCache::compiler_thread, this, std::ref(*state.mem));
+            thread.detach();
+        }
+    }
+
+    pipeline_compile_queue.enqueue_bulk(pipeline_compile_queue_token, requests.data(), requests.size());
+
+    if (!use_async_compilation) {
+        for (int i = 0; i < nb_worker_threads; i++)
+            // if a thread receives nullptr, it exits
+            pipeline_compile_queue.enqueue(pipeline_compile_queue_token, nullptr);
+    }
+
+    return static_cast<uint32_t>(requests.size());
+}
+
 // Vulkan structs used to specify a specialization constant
 // Also, booleans in SPIRV are 32bit wide
 static const vk::SpecializationMapEntry srgb_entry = {
@@ -377,18 +587,12 @@ static const vk::SpecializationInfo srgb_info_false = {
     .pData = &srgb_entry_false
 };
 
-vk::PipelineShaderStageCreateInfo PipelineCache::retrieve_shader(const SceGxmProgram *program, const Sha256Hash &hash, bool is_vertex, bool maskupdate, MemState &mem, const shader::Hints &hints, bool is_srgb) {
+vk::ShaderModule PipelineCache::retrieve_shader(const SceGxmProgram *program, const Sha256Hash &hash, bool is_vertex, bool maskupdate, MemState &mem, const shader::Hints &hints) {
     if (maskupdate)
         LOG_CRITICAL("Mask not implemented in the vulkan renderer!");
 
     const vk::ShaderModule shader_compiling = std::bit_cast<vk::ShaderModule>(~0ULL);
 
-    const vk::SpecializationInfo *spec_info = nullptr;
-    if (!is_vertex && state.features.should_use_shader_interlock() && program->is_frag_color_used()) {
-        // if the specialization constant is used in the shader
-        spec_info = is_srgb ? &srgb_info_true : &srgb_info_false;
-    }
-
     vk::ShaderModule *shader_module;
     {
         // look if it is in the cache
@@ -413,22 +617,15 @@ vk::PipelineShaderStageCreateInfo PipelineCache::retrieve_shader(const SceGxmPro
         precompile_shader(hash, false);
     }
 
-    if (*shader_module != shader_compiling) {
-        vk::PipelineShaderStageCreateInfo shader_stage_info{
-            .stage = is_vertex ? vk::ShaderStageFlagBits::eVertex : vk::ShaderStageFlagBits::eFragment,
-            .module = *shader_module,
-            .pName = is_vertex ? "main_vs" : "main_fs",
-            .pSpecializationInfo = spec_info,
-        };
-        return shader_stage_info;
-    }
+    if (*shader_module != shader_compiling)
+        return *shader_module;
 
     const std::string hash_text = hex_string(hash);
 
     LOG_INFO("Generating vulkan spv shader {}", hash_text);
     const std::string shader_version = fmt::format("vk{}", shader::CURRENT_VERSION);
 
-    shader::usse::SpirvCode source = load_spirv_shader(*program, state.features, true, hints, maskupdate, state.shaders_path, state.shaders_log_path, shader_version, true);
+    shader::usse::SpirvCode source = load_spirv_shader(*program, state.features, true, hints, maskupdate, state.shader_cache_file, state.shaders_log_path, shader_version, true);
 
     vk::ShaderModuleCreateInfo shader_info{
         .codeSize = sizeof(uint32_t) * source.size(),
@@ -448,14 +645,7 @@ vk::PipelineShaderStageCreateInfo PipelineCache::retrieve_shader(const SceGxmPro
         }
     }
 
-    vk::PipelineShaderStageCreateInfo shader_stage_info{
-        .stage = is_vertex ? vk::ShaderStageFlagBits::eVertex : vk::ShaderStageFlagBits::eFragment,
-        .module = *shader_module,
-        .pName = is_vertex ? "main_vs" : "main_fs",
-        .pSpecializationInfo = spec_info,
-    };
-
-    return shader_stage_info;
+    return *shader_module;
 }
 
 vk::RenderPass PipelineCache::retrieve_render_pass(vk::Format format, bool force_load, bool force_store, bool no_color) {
@@ -582,11 +772,9 @@ vk::RenderPass PipelineCache::retrieve_render_pass(vk::Format format, bool force
     return render_passes_map[format];
 }
 
-vk::PipelineVertexInputStateCreateInfo PipelineCache::get_vertex_input_state(const SceGxmVertexProgram &vertex_program, MemState &mem) {
-    // pointer to these objects are returned (so it needs to be static)
-    // and each thread needs one (hence the thread_local)
-    static thread_local std::vector<vk::VertexInputBindingDescription> binding_descr;
-    static thread_local std::vector<vk::VertexInputAttributeDescription> attr_descr;
+void PipelineCache::get_vertex_input_state(const SceGxmVertexProgram &vertex_program, PipelineDescription &description) {
+    std::vector<vk::VertexInputBindingDescription> &binding_descr = description.bindings;
+    std::vector<vk::VertexInputAttributeDescription> &attr_descr = description.attributes;
     binding_descr.clear();
     attr_descr.clear();
 
@@ -686,11 +874,6 @@ vk::PipelineVertexInputStateCreateInfo PipelineCache::get_vertex_input_state(con
             .stride = stride,
             .inputRate = is_instanced ? vk::VertexInputRate::eInstance : vk::VertexInputRate::eVertex });
     }
-
-    vk::PipelineVertexInputStateCreateInfo vertex_input{};
-    vertex_input.setVertexBindingDescriptions(binding_descr);
-    vertex_input.setVertexAttributeDescriptions(attr_descr);
-    return vertex_input;
 }
 
 void PipelineCache::compiler_thread(MemState &mem) {
@@ -705,13 +888,23 @@ void PipelineCache::compiler_thread(MemState &mem) {
             // use this as an instruction to stop the thread
             break;
 
-        vk::Pipeline pipeline = compile_pipeline(request->type, request->render_pass, *request->vertex_program_gxm, *request->fragment_program_gxm, *request->get_record(), request->hints, mem);
+        const auto time_s = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        if (request->description) {
+            // pipeline from the warm-up list, the guest programs may not even exist yet
+            *request->pipeline = create_pipeline(*request->description, request->vertex_module, request->fragment_module, request->render_pass);
+            next_pipeline_cache_save = time_s + pipeline_cache_save_delay;
+            warmup_compiled_count.fetch_add(1, std::memory_order_release);
+
+            delete request;
+            continue;
+        }
+
+        vk::Pipeline pipeline = compile_pipeline(request->key, request->type, request->render_pass, request->color_format, *request->vertex_program_gxm, *request->fragment_program_gxm, *request->get_record(), request->hints, mem, request->is_fallback);
         *request->pipeline = pipeline;
 
         request->vertex_program_gxm->compile_threads_on.fetch_sub(1, std::memory_order_release);
         request->fragment_program_gxm->compile_threads_on.fetch_sub(1, std::memory_order_release);
 
-        const auto time_s = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
         next_pipeline_cache_save = time_s + pipeline_cache_save_delay;
 
         state.shaders_count_compiled++;
@@ -729,30 +922,83 @@ static vk::StencilOpState convert_op_state(const GxmStencilStateOp &state) {
     };
 }
 
-vk::Pipeline PipelineCache::compile_pipeline(SceGxmPrimitiveType type, vk::RenderPass render_pass, const SceGxmVertexProgram &vertex_program_gxm, const SceGxmFragmentProgram &fragment_program_gxm, const GxmRecordState &record, const shader::Hints &hints, MemState &mem) {
+vk::Pipeline PipelineCache::compile_pipeline(uint64_t key, SceGxmPrimitiveType type, vk::RenderPass render_pass, vk::Format color_format, const SceGxmVertexProgram &vertex_program_gxm, const SceGxmFragmentProgram &fragment_program_gxm, const GxmRecordState &record, const shader::Hints &hints, MemState &mem, bool is_fallback) {
     const VertexProgram &vertex_program = *vertex_program_gxm.renderer_data;
     const SceGxmProgram *gxm_fragment_shader = fragment_program_gxm.program.get(mem);
     const VKFragmentProgram &fragment_program = *reinterpret_cast<VKFragmentProgram *>(
         fragment_program_gxm.renderer_data.get());
 
+    PipelineDescription description{
+        .key = key,
+        .vertex_hash = vertex_program.hash,
+        .fragment_hash = fragment_program.hash,
+        .type = type,
+        .color_format = color_format,
+        .use_shader_interlock = state.features.support_shader_interlock && gxm_fragment_shader->is_frag_color_used(),
+        // disable the fragment shader if gxm asks us to
+        .is_fragment_disabled = record.front_side_fragment_program_mode == SCE_GXM_FRAGMENT_PROGRAM_DISABLED || gxm_fragment_shader->has_no_effect(),
+        .use_srgb_constant = state.features.should_use_shader_interlock() && gxm_fragment_shader->is_frag_color_used(),
+        .use_dynamic_state = is_fallback,
+        .vertex_texture_count = static_cast<uint8_t>(vertex_program.texture_count),
+        .fragment_texture_count = static_cast<uint8_t>(fragment_program.texture_count),
+        .record = std::vector<uint8_t>(reinterpret_cast<const uint8_t *>(&record), reinterpret_cast<const uint8_t *>(&record) + record_pipeline_len)
+    };
+
     // the vertex input state must be computed before shader are retrieved in case symbols are stripped
-    const vk::PipelineVertexInputStateCreateInfo vertex_input = get_vertex_input_state(vertex_program_gxm, mem);
+    get_vertex_input_state(vertex_program_gxm, description);
+
+    const vk::ShaderModule vertex_module = retrieve_shader(vertex_program_gxm.program.get(mem), vertex_program.hash, true, fragment_program_gxm.is_maskupdate, mem, hints);
+    const vk::ShaderModule fragment_module = retrieve_shader(gxm_fragment_shader, fragment_program.hash, false, fragment_program_gxm.is_maskupdate, mem, hints);
 
-    const vk::PipelineShaderStageCreateInfo vertex_shader = retrieve_shader(vertex_program_gxm.program.get(mem), vertex_program.hash, true, fragment_program_gxm.is_maskupdate, mem, hints);
-    const vk::PipelineShaderStageCreateInfo fragment_shader = retrieve_shader(gxm_fragment_shader, fragment_program.hash, false, fragment_program_gxm.is_maskupdate, mem, hints, record.is_gamma_corrected);
-    const vk::PipelineShaderStageCreateInfo shader_stages[] = { vertex_shader, fragment_shader };
-    // disable the fragment shader if gxm asks us to
-    const bool is_fragment_disabled = record.front_side_fragment_program_mode == SCE_GXM_FRAGMENT_PROGRAM_DISABLED || gxm_fragment_shader->has_no_effect();
-    const uint32_t shader_stage_count = is_fragment_disabled ? 1U : 2U;
+    const bool frag_has_no_output = static_cast<bool>(gxm_fragment_shader->program_flags & SCE_GXM_PROGRAM_FLAG_OUTPUT_UNDEFINED);
+    if (description.is_fragment_disabled || frag_has_no_output || description.use_shader_interlock) {
+        // The write mask must be empty as the lack of a fragment shader results in undefined values
+        description.blending = {
+            .blendEnable = VK_FALSE,
+            .colorWriteMask = vk::ColorComponentFlags()
+        };
+    } else {
+        description.blending = fragment_program.blending;
+    }
+
+    const vk::Pipeline pipeline = create_pipeline(description, vertex_module, fragment_module, render_pass);
+    // the fallback pipelines are only needed until the other ones are compiled
+    if (pipeline && !is_fallback)
+        record_warmup_pipeline(std::move(description));
+
+    return pipeline;
+}
+
+vk::Pipeline PipelineCache::create_pipeline(const PipelineDescription &description, vk::ShaderModule vertex_module, vk::ShaderModule fragment_module, vk::RenderPass render_pass) {
+    // note: this object is only half defined, but we are only looking at the part that's defined
+    const GxmRecordState &record = *reinterpret_cast<const GxmRecordState *>(description.record.data());
+
+    const vk::PipelineShaderStageCreateInfo shader_stages[] = {
+        vk::PipelineShaderStageCreateInfo{
+            .stage = vk::ShaderStageFlagBits::eVertex,
+            .module = vertex_module,
+            .pName = "main_vs",
+        },
+        vk::PipelineShaderStageCreateInfo{
+            .stage = vk::ShaderStageFlagBits::eFragment,
+            .module = fragment_module,
+            .pName = "main_fs",
+            // if the specialization constant is used in the shader
+            .pSpecializationInfo = description.use_srgb_constant ? (record.is_gamma_corrected ? &srgb_info_true : &srgb_info_false) : nullptr,
+        }
+    };
+    const uint32_t shader_stage_count = description.is_fragment_disabled ? 1U : 2U;
+
+    vk::PipelineVertexInputStateCreateInfo vertex_input{};
+    vertex_input.setVertexBindingDescriptions(description.bindings);
+    vertex_input.setVertexAttributeDescriptions(description.attributes);
 
     const vk::PipelineInputAssemblyStateCreateInfo input_assembly{
-        .topology = translate_primitive(type)
+        .topology = translate_primitive(description.type)
     };
 
     const bool two_sided = (record.two_sided == SCE_GXM_TWO_SIDED_ENABLED);
 
-    const bool use_shader_interlock = state.features.support_shader_interlock && gxm_fragment_shader->is_frag_color_used();
-
     const vk::PipelineRasterizationStateCreateInfo rasterizer{
         .depthClampEnable = state.physical_device_features.depthClamp,
         .polygonMode = translate_polygon_mode(record.front_polygon_mode),
@@ -777,20 +1023,9 @@ vk::Pipeline PipelineCache::compile_pipeline(SceGxmPrimitiveType type, vk::Rende
     };
 
     vk::PipelineColorBlendStateCreateInfo color_blending{};
-    const bool frag_has_no_output = static_cast<bool>(gxm_fragment_shader->program_flags & SCE_GXM_PROGRAM_FLAG_OUTPUT_UNDEFINED);
-    if (is_fragment_disabled || frag_has_no_output || use_shader_interlock) {
-        // The write mask must be empty as the lack of a fragment shader results in undefined values
-        static const vk::PipelineColorBlendAttachmentState blending = {
-            .blendEnable = VK_FALSE,
-            .colorWriteMask = vk::ColorComponentFlags()
-        };
-        color_blending.setAttachments(blending);
-    } else {
-        const vk::PipelineColorBlendAttachmentState &blending = fragment_program.blending;
-        color_blending.setAttachments(blending);
-    }
+    color_blending.setAttachments(description.blending);
 
-    vk::PipelineLayout pipeline_layout = pipeline_layouts[vertex_program.texture_count][fragment_program.texture_count];
+    vk::PipelineLayout pipeline_layout = pipeline_layouts[description.vertex_texture_count][description.fragment_texture_count];
 
     // all of these can be changed at any time using the vita graphics api (like opengl)
     // Because each one can take a lot of different values, it's better to set them as dynamic
@@ -803,8 +1038,25 @@ vk::Pipeline PipelineCache::compile_pipeline(SceGxmPrimitiveType type, vk::Rende
         vk::DynamicState::eStencilWriteMask,
         vk::DynamicState::eDepthBias
     };
+    // the fallback pipelines are used for all the draws with the same programs, whatever their fixed-function state is
+    static vk::DynamicState fallback_dynamic_states[] = {
+        vk::DynamicState::eViewport,
+        vk::DynamicState::eScissor,
+        vk::DynamicState::eLineWidth,
+        vk::DynamicState::eStencilCompareMask,
+        vk::DynamicState::eStencilReference,
+        vk::DynamicState::eStencilWriteMask,
+        vk::DynamicState::eDepthBias,
+        vk::DynamicState::eCullModeEXT,
+        vk::DynamicState::eDepthWriteEnableEXT,
+        vk::DynamicState::eDepthCompareOpEXT,
+        vk::DynamicState::eStencilOpEXT
+    };
     vk::PipelineDynamicStateCreateInfo dynamic_info{};
-    dynamic_info.setDynamicStates(dynamic_states);
+    if (description.use_dynamic_state)
+        dynamic_info.setDynamicStates(fallback_dynamic_states);
+    else
+        dynamic_info.setDynamicStates(dynamic_states);
 
     // we still need to specify the viewport and scissor count even though they are dynamic
     vk::PipelineViewportStateCreateInfo viewport{
@@ -860,12 +1112,14 @@ vk::Pipeline PipelineCache::retrieve_pipeline(VKContext &context, SceGxmPrimitiv
     // if the pipeline is in the pipeline cache, we can expect its creation time to be almost instantaneous
     bool already_in_cache = false;
 
+    context.is_fallback_pipeline = false;
+
     auto it = pipelines.find(key);
     if (it != pipelines.end()) {
         if (it->second != nullptr) {
             if (it->second == pipeline_compiling)
                 // pipeline is still compiling
-                return nullptr;
+                return retrieve_fallback_pipeline(context, type, mem);
             else
                 return it->second;
         }
@@ -891,8 +1145,10 @@ vk::Pipeline PipelineCache::retrieve_pipeline(VKContext &context, SceGxmPrimitiv
         CompileRequest *request = new CompileRequest;
         *request = {
             .pipeline = &it->second,
+            .key = key,
             .type = type,
             .render_pass = render_pass,
+            .color_format = context.current_color_format,
             .vertex_program_gxm = &vertex_program_gxm,
             .fragment_program_gxm = &fragment_program_gxm,
             .hints = context.shader_hints
@@ -904,12 +1160,15 @@ vk::Pipeline PipelineCache::retrieve_pipeline(VKContext &context, SceGxmPrimitiv
         vertex_program_gxm.compile_threads_on.fetch_add(1, std::memory_order_relaxed);
         fragment_program_gxm.compile_threads_on.fetch_add(1, std::memory_order_relaxed);
 
+        // if the fallback pipeline must be compiled too, it is queued first so that it is ready sooner
+        const vk::Pipeline fallback_pipeline = retrieve_fallback_pipeline(context, type, mem);
+
         pipeline_compile_queue.enqueue(pipeline_compile_queue_token, request);
 
-        return nullptr;
+        return fallback_pipeline;
     } else {
         // can't wait, compile it right now
-        vk::Pipeline result = compile_pipeline(type, render_pass, vertex_program_gxm, fragment_program_gxm, record, context.shader_hints, mem);
+        vk::Pipeline result = compile_pipeline(key, type, render_pass, context.current_color_format, vertex_program_gxm, fragment_program_gxm, record, context.shader_hints, mem);
 
         const auto time_s = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
         next_pipeline_cache_save = time_s + pipeline_cache_save_delay;
@@ -923,21 +1182,101 @@ vk::Pipeline PipelineCache::retrieve_pipeline(VKContext &context, SceGxmPrimitiv
     }
 }
 
+vk::Pipeline PipelineCache::retrieve_fallback_pipeline(VKContext &context, SceGxmPrimitiveType type, MemState &mem) {
+    if (!support_extended_dynamic_state || !use_async_compilation)
+        return nullptr;
+
+    // the state set by set_fallback_dynamic_state is put back to its default value
+    alignas(8) uint8_t record_data[record_pipeline_len];
+    memcpy(record_data, &context.record, record_pipeline_len);
+    // note: this object is only half defined, but we are only looking at the part that's defined
+    GxmRecordState &fallback_record = *reinterpret_cast<GxmRecordState *>(record_data);
+    fallback_record.cull_mode = SCE_GXM_CULL_NONE;
+    fallback_record.two_sided = SCE_GXM_TWO_SIDED_DISABLED;
+    fallback_record.front_stencil_state_op = {};
+    fallback_record.back_stencil_state_op = {};
+    fallback_record.front_depth_func = SCE_GXM_DEPTH_FUNC_LESS_EQUAL;
+    fallback_record.back_depth_func = SCE_GXM_DEPTH_FUNC_LESS_EQUAL;
+    fallback_record.front_depth_write_mode = SCE_GXM_DEPTH_WRITE_ENABLED;
+    fallback_record.back_depth_write_mode = SCE_GXM_DEPTH_WRITE_ENABLED;
+
+    SceGxmFragmentProgram &fragment_program_gxm = *context.record.fragment_program.get(mem);
+    SceGxmVertexProgram &vertex_program_gxm = *context.record.vertex_program.get(mem);
+    const VKFragmentProgram &fragment_program = *reinterpret_cast<VKFragmentProgram *>(
+        fragment_program_gxm.renderer_data.get());
+
+    // same as the key of the other pipelines
+    uint64_t key = XXH3_64bits(record_data, record_pipeline_len);
+    key ^= fragment_program.blending_hash;
+    key ^= vertex_program_gxm.key_hash;
+    key ^= static_cast<uint64_t>(type);
+
+    // can't use constexpr because of apple clang...
+    const vk::Pipeline pipeline_compiling = std::bit_cast<vk::Pipeline, uint64_t>(~0ULL);
+
+    auto [it, inserted] = fallback_pipelines.insert({ key, pipeline_compiling });
+    if (!inserted) {
+        // still compiling or the compilation failed
+        if (it->second == pipeline_compiling || it->second == nullptr)
+            return nullptr;
+
+        context.is_fallback_pipeline = true;
+        return it->second;
+    }
+
+    const SceGxmProgram *gxm_fragment_shader = fragment_program_gxm.program.get(mem);
+    const bool use_shader_interlock = state.features.support_shader_interlock && gxm_fragment_shader->is_frag_color_used();
+    const vk::RenderPass render_pass = use_shader_interlock ? context.current_shader_interlock_pass : context.current_render_pass;
+    context.shader_hints.color_format = context.record.color_surface.colorFormat;
+    context.shader_hints.attributes = &vertex_program_gxm.attributes;
+
+    CompileRequest *request = new CompileRequest;
+    *request = {
+        .pipeline = &it->second,
+        .key = key,
+        .type = type,
+        .render_pass = render_pass,
+        .color_format = context.current_color_format,
+        .vertex_program_gxm = &vertex_program_gxm,
+        .fragment_program_gxm = &fragment_program_gxm,
+        .hints = context.shader_hints,
+        .is_fallback = true
+    };
+    memcpy(request->record_data, record_data, record_pipeline_len);
+
+    // we must not delete these programs until the worker is done
+    vertex_program_gxm.compile_threads_on.fetch_add(1, std::memory_order_relaxed);
+    fragment_program_gxm.compile_threads_on.fetch_add(1, std::memory_order_relaxed);
+
+    pipeline_compile_queue.enqueue(pipeline_compile_queue_token, request);
+
+    return nullptr;
+}
+
+void PipelineCache::set_fallback_dynamic_state(VKContext &context) {
+    const GxmRecordState &record = context.record;
+    const bool two_sided = (record.two_sided == SCE_GXM_TWO_SIDED_ENABLED);
+    const vk::StencilOpState front = convert_op_state(record.front_stencil_state_op);
+    const vk::StencilOpState back = convert_op_state(two_sided ? record.back_stencil_state_op : record.front_stencil_state_op);
+
+    // same values as the ones create_pipeline uses
+    context.render_cmd.setCullModeEXT(translate_cull_mode(record.cull_mode));
+    context.render_cmd.setDepthWriteEnableEXT(record.front_depth_write_mode == SCE_GXM_DEPTH_WRITE_ENABLED);
+    context.render_cmd.setDepthCompareOpEXT(translate_depth_func(record.front_depth_func));
+    context.render_cmd.setStencilOpEXT(vk::StencilFaceFlagBits::eFront, front.failOp, front.passOp, front.depthFailOp, front.compareOp);
+    context.render_cmd.setStencilOpEXT(vk::StencilFaceFlagBits::eBack, back.failOp, back.passOp, back.depthFailOp, back.compareOp);
+}
+
 vk::ShaderModule PipelineCache::precompile_shader(const Sha256Hash &hash, bool search_first) {
     if (search_first) {
-        // happens while loading the thread, no parallel access so no need for a mutex
+        // the shaders are loaded by multiple threads at boot
+        std::lock_guard<std::mutex> guard(shaders_mutex);
         auto it = shaders.find(hash);
         if (it != shaders.end())
             return it->second;
     }
 
-    if (!fs::exists(state.shaders_path) || fs::is_empty(state.shaders_path))
-        return nullptr;
-
-    Sha256Hash shader_hash;
-    memcpy(shader_hash.data(), hash.data(), sizeof(Sha256Hash));
-    const std::string shader_file_name = fmt::format("vk{}-{}.spv", shader::CURRENT_VERSION, hex_string(shader_hash));
-    const std::vector<uint32_t> source = renderer::pre_load_shader_spirv(state.shaders_path / shader_file_name);
+    const std::vector<uint32_t> source = renderer::pre_load_shader_spirv(state.shader_cache_file, hash);
 
     if (source.empty())
         return nullptr;
@@ -16,6 +16,7 @@
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
 #include <renderer/functions.h>
+#include <renderer/shader_jobs.h>
 #include <renderer/types.h>
 #include <renderer/vulkan/functions.h>
 #include <renderer/vulkan/state.h>
@@ -30,6 +31,8 @@
 
 #include <SDL_vulkan.h>
 
+#include <set>
+
 #ifdef __APPLE__
 #include <MoltenVK/mvk_vulkan.h>
 #endif
@@ -354,6 +357,7 @@ bool VKState::create(SDL_Window *window, std::unique_ptr<renderer::State> &state
             .fillModeNonSolid = physical_device_features.fillModeNonSolid,
             .wideLines = physical_device_features.wideLines,
             .samplerAnisotropy = physical_device_features.samplerAnisotropy,
+            .textureCompressionBC = physical_device_features.textureCompressionBC,
             .occlusionQueryPrecise = physical_device_features.occlusionQueryPrecise,
             .fragmentStoresAndAtomics = physical_device_features.fragmentStoresAndAtomics,
             .shaderStorageImageExtendedFormats = physical_device_features.shaderStorageImageExtendedFormats,
@@ -387,6 +391,8 @@ bool VKState::create(SDL_Window *window, std::unique_ptr<renderer::State> &state
             { vk::KHRShaderFloat16Int8ExtensionName, &support_fsr },
             // used for accurate programmable blending on desktop GPUs
             { vk::EXTFragmentShaderInterlockExtensionName, &support_shader_interlock },
+            // lets draws use a generic pipeline while the one matching their state is compiling
+            { vk::EXTExtendedDynamicStateExtensionName, &pipeline_cache.support_extended_dynamic_state },
 #ifdef __APPLE__
             // Needed to create the MoltenVK device
             { vk::KHRPortabilitySubsetExtensionName, &temp_bool },
@@ -467,11 +473,17 @@ bool VKState::create(SDL_Window *window, std::unique_ptr<renderer::State> &state
             features.support_shader_interlock = support_shader_interlock;
         }
 
+        if (pipeline_cache.support_extended_dynamic_state) {
+            auto props = physical_device.getFeatures2KHR<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT>();
+            pipeline_cache.support_extended_dynamic_state = static_cast<bool>(props.get<vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT>().extendedDynamicState);
+        }
+
         vk::StructureChain<vk::DeviceCreateInfo,
             vk::PhysicalDeviceBufferDeviceAddressFeatures,
             vk::PhysicalDeviceUniformBufferStandardLayoutFeatures,
             vk::PhysicalDeviceShaderFloat16Int8Features,
-            vk::PhysicalDeviceFragmentShaderInterlockFeaturesEXT>
+            vk::PhysicalDeviceFragmentShaderInterlockFeaturesEXT,
+            vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT>
             device_info{
                 vk::DeviceCreateInfo{
                     .pEnabledFeatures = &enabled_features },
@@ -483,7 +495,9 @@ bool VKState::create(SDL_Window *window, std::unique_ptr<renderer::State> &state
                     // FSR uses float16
                     .shaderFloat16 = VK_TRUE },
                 vk::PhysicalDeviceFragmentShaderInterlockFeaturesEXT{
-                    .fragmentShaderSampleInterlock = VK_TRUE }
+                    .fragmentShaderSampleInterlock = VK_TRUE },
+                vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT{
+                    .extendedDynamicState = VK_TRUE }
             };
         device_info.get().setQueueCreateInfos(queue_infos);
         device_info.get().setPEnabledExtensionNames(device_extensions);
@@ -500,6 +514,9 @@ bool VKState::create(SDL_Window *window, std::unique_ptr<renderer::State> &state
         if (!support_shader_interlock)
             device_info.unlink<vk::PhysicalDeviceFragmentShaderInterlockFeaturesEXT>();
 
+        if (!pipeline_cache.support_extended_dynamic_state)
+            device_info.unlink<vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT>();
+
         try {
             device = physical_device.createDevice(device_info.get());
         } catch (vk::NotPermittedError &) {
@@ -647,7 +664,20 @@ void VKState::late_init(const Config &cfg, const std::string_view game_id, MemSt
 
     pipeline_cache.init();
 
-    texture_cache.init(false, texture_folder(), game_id);
+    texture_cache.init(false, texture_folder(), game_id, cfg.compute_texture_decode);
+
+    // in MiB, 0 means the caches are only limited by their number of entries
+    memory_budget.set_budget(static_cast<uint64_t>(std::max(cfg.vram_budget, 0)) * MiB(1));
+    texture_cache.memory_budget = &memory_budget;
+
+    // in MiB, 0 means the size of the folder is not limited
+    if (cfg.disk_texture_cache)
+        texture_cache.init_disk_cache(static_cast<uint64_t>(std::max(cfg.disk_texture_cache_size, 0)) * MiB(1));
+}
+
+VKState::~VKState() {
+    // the jobs use the pipeline cache and the device, which are destroyed before the base class members
+    shader_jobs.reset();
 }
 
 void VKState::cleanup() {
@@ -970,15 +1000,53 @@ void VKState::precompile_shader(const ShadersHash &hash) {
         pipeline_cache.precompile_shader(hash.frag);
     }
 
-    programs_count_pre_compiled++;
-    LOG_INFO("Program Compiled {}/{}", programs_count_pre_compiled, shaders_cache_hashs.size());
+    const uint32_t programs_count = ++programs_count_pre_compiled;
+    LOG_INFO("Program Compiled {}/{}", programs_count, shaders_cache_hashs.size());
+}
+
+bool VKState::precompile_shaders_async() {
+    if (!shader_jobs)
+        return false;
+
+    // a shader used by multiple programs is only loaded by the job of the first one
+    std::set<Sha256Hash> claimed_shaders;
+    const Sha256Hash empty_hash{};
+    for (const ShadersHash &hash : shaders_cache_hashs) {
+        std::vector<Sha256Hash> shaders_to_load;
+        for (const Sha256Hash &shader_hash : { hash.vert, hash.frag }) {
+            if (shader_hash != empty_hash && claimed_shaders.insert(shader_hash).second)
+                shaders_to_load.push_back(shader_hash);
+        }
+
+        shader_jobs->submit([this, shaders_to_load = std::move(shaders_to_load)]() {
+            for (const Sha256Hash &shader_hash : shaders_to_load)
+                pipeline_cache.precompile_shader(shader_hash);
+
+            programs_count_pre_compiled++;
+        });
+    }
+
+    LOG_INFO("Loading {} shaders of {} programs in the background", claimed_shaders.size(), shaders_cache_hashs.size());
+    return true;
+}
+
+uint32_t VKState::warm_up_pipelines() {
+    return pipeline_cache.warm_up_pipelines();
+}
+
+uint32_t VKState::get_warmed_up_pipelines_count() {
+    return pipeline_cache.warmup_compiled_count.load(std::memory_order_acquire);
 }
 
 void VKState::preclose_action() {
+    // the jobs still running may add shaders and pipelines
+    shader_jobs.reset();
+
     // make sure we are in a game
     if (shaders_path.empty())
         return;
 
     pipeline_cache.save_pipeline_cache();
+    memory_budget.log_stats();
 }
 } // namespace renderer::vulkan
@@ -376,6 +376,12 @@ void draw(VKContext &context, SceGxmPrimitiveType type, SceGxmIndexFormat format
             if (new_pipeline != nullptr)
                 context.render_cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, context.current_pipeline);
         }
+
+        if (context.is_fallback_pipeline) {
+            context.state.pipeline_cache.set_fallback_dynamic_state(context);
+            // the pipeline matching the state may be compiled by the next draw
+            context.refresh_pipeline = true;
+        }
     }
 
     // can happen with asynchronous pipeline compilation
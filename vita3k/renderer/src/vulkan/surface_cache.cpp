@@ -18,6 +18,7 @@
 #include <renderer/vulkan/surface_cache.h>
 
 #include <gxm/functions.h>
+#include <renderer/texture_layout.h>
 #include <renderer/vulkan/gxm_to_vulkan.h>
 #include <renderer/vulkan/state.h>
 #include <renderer/vulkan/types.h>
@@ -91,6 +92,9 @@ void VKSurfaceCache::destroy_surface(ColorSurfaceCacheInfo &info) {
 
     destroy_framebuffers(info.texture.view);
     destroy_queue.add_image(info.texture);
+
+    state.memory_budget.resize_entry(CacheType::Surface, info.memory_size, 0);
+    info.memory_size = 0;
 }
 
 void VKSurfaceCache::destroy_surface(DepthStencilSurfaceCacheInfo &info) {
@@ -107,6 +111,9 @@ void VKSurfaceCache::destroy_surface(DepthStencilSurfaceCacheInfo &info) {
 
     destroy_framebuffers(info.texture.view);
     destroy_queue.add_image(info.texture);
+
+    state.memory_budget.resize_entry(CacheType::Surface, info.memory_size, 0);
+    info.memory_size = 0;
 }
 
 VKSurfaceCache::VKSurfaceCache(VKState &state)
@@ -187,6 +194,7 @@ SurfaceRetrieveResult VKSurfaceCache::retrieve_color_surface_for_framebuffer(Mem
             color_address_lookup.erase(ite);
             color_surface_queue.set_as_lru(&info);
         } else {
+            state.memory_budget.record_hit(CacheType::Surface);
             color_surface_queue.set_as_mru(&info);
             last_written_surface = &info;
 
@@ -216,10 +224,13 @@ SurfaceRetrieveResult VKSurfaceCache::retrieve_color_surface_for_framebuffer(Mem
     }
 
     // get the least recently used (probably unused) color surface
+    state.memory_budget.record_miss(CacheType::Surface);
     ColorSurfaceCacheInfo &info_added = *color_surface_queue.get_lru();
-    if (info_added.texture.image)
+    if (info_added.texture.image) {
         // deferred destruction of the existing surface
         destroy_surface(info_added);
+        state.memory_budget.record_eviction(CacheType::Surface);
+    }
     if (info_added.data)
         color_address_lookup.erase(info_added.data.address());
 
@@ -263,6 +274,8 @@ SurfaceRetrieveResult VKSurfaceCache::retrieve_color_surface_for_framebuffer(Mem
     if (state.features.support_shader_interlock)
         surface_usages |= vk::ImageUsageFlagBits::eStorage;
     image.init_image(surface_usages, vkutil::default_comp_mapping, image_create_flags, image_info_pNext);
+    info_added.memory_size = state.allocator.getAllocationInfo(image.allocation).size;
+    state.memory_budget.resize_entry(CacheType::Surface, 0, info_added.memory_size);
 
     // do it in the prerender if we read from this texture in the same scene (although this would be useless)
     vk::CommandBuffer cmd_buffer = context->prerender_cmd;
@@ -634,15 +647,20 @@ SurfaceRetrieveResult VKSurfaceCache::retrieve_depth_stencil_for_framebuffer(Sce
             || cached_info->stride_samples != depth_stencil->get_stride()
             || cached_info->tiling != tiling;
 
-        if (!need_remake)
+        if (!need_remake) {
+            state.memory_budget.record_hit(CacheType::Surface);
             return {
                 cached_info->texture.view,
                 &cached_info->texture
             };
+        }
     } else {
         // retrieve a new depth stencil
         cached_info = ds_surface_queue.get_lru();
+        if (cached_info->texture.image)
+            state.memory_budget.record_eviction(CacheType::Surface);
     }
+    state.memory_budget.record_miss(CacheType::Surface);
 
     // erase it if it was used previously
     if (cached_info->surface.depth_data)
@@ -691,6 +709,8 @@ SurfaceRetrieveResult VKSurfaceCache::retrieve_depth_stencil_for_framebuffer(Sce
     image.format = vk::Format::eD32SfloatS8Uint;
     image.layout = vkutil::ImageLayout::Undefined;
     image.init_image(vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eSampled);
+    cached_info->memory_size = state.allocator.getAllocationInfo(image.allocation).size;
+    state.memory_budget.resize_entry(CacheType::Surface, 0, cached_info->memory_size);
 
     image.transition_to(cmd_buffer, vkutil::ImageLayout::TransferDst, vkutil::ds_subresource_range);
     vk::ClearDepthStencilValue clear_value{
@@ -1110,6 +1130,18 @@ bool VKSurfaceCache::check_for_surface(MemState &mem, Address source_address, Ca
     return true;
 }
 
+// the linear to swizzled / tiled conversion must not write outside of the surface
+static bool can_relayout_surface(const ColorSurfaceCacheInfo &surface) {
+    if (format_need_additional_memory(surface.format))
+        return false;
+
+    const uint32_t pixel_stride = (surface.stride_bytes * 8) / gxm::bits_per_pixel(surface.format);
+    if (surface.tiling == SurfaceTiling::Swizzled)
+        return std::has_single_bit(pixel_stride) && std::has_single_bit<uint32_t>(surface.original_height);
+    else
+        return (pixel_stride % 32) == 0 && (surface.original_height % 32) == 0;
+}
+
 ColorSurfaceCacheInfo *VKSurfaceCache::perform_surface_sync() {
     // surface sync is supported only if memory mapping is enabled
     if (!state.features.support_memory_mapping)
@@ -1165,9 +1197,17 @@ ColorSurfaceCacheInfo *VKSurfaceCache::perform_surface_sync() {
         image_layout = vk::ImageLayout::eTransferSrcOptimal;
     }
 
+    // swizzled and tiled surfaces are first copied to a linear buffer, the post surface sync then converts them to their layout
+    bool need_relayout = last_written_surface->tiling != SurfaceTiling::Linear;
+    if (need_relayout && !can_relayout_surface(*last_written_surface)) {
+        LOG_WARN_ONCE("Surface sync of a {} surface with format {} and height {} is not supported",
+            last_written_surface->tiling == SurfaceTiling::Tiled ? "tiled" : "swizzled", vk::to_string(last_written_surface->texture.format), last_written_surface->original_height);
+        need_relayout = false;
+    }
+
     vk::Buffer buffer;
     uint32_t offset;
-    if (format_need_additional_memory(last_written_surface->format)) {
+    if (format_need_additional_memory(last_written_surface->format) || need_relayout) {
         if (!last_written_surface->copy_buffer)
             last_written_surface->copy_buffer = std::make_unique<vkutil::Buffer>();
 
@@ -1194,7 +1234,7 @@ ColorSurfaceCacheInfo *VKSurfaceCache::perform_surface_sync() {
     };
     cmd_buffer.copyImageToBuffer(image_to_copy, image_layout, buffer, copy);
 
-    const bool need_post_sync = !is_swizzle_identity || format_need_additional_memory(last_written_surface->format);
+    const bool need_post_sync = !is_swizzle_identity || format_need_additional_memory(last_written_surface->format) || need_relayout;
     ColorSurfaceCacheInfo *return_value = need_post_sync ? last_written_surface : nullptr;
     last_written_surface = nullptr;
 
@@ -1280,16 +1320,31 @@ void VKSurfaceCache::perform_post_surface_sync(const MemState &mem, ColorSurface
         return;
     }
 
-    switch (vk::componentBits(surface->texture.format, 0)) {
-    case 8:
-        swizzle_text_T<uint8_t>(pixels, nb_pixels, surface);
-        break;
-    case 16:
-        swizzle_text_T<uint16_t>(reinterpret_cast<uint16_t *>(pixels), nb_pixels, surface);
-        break;
-    case 32:
-        swizzle_text_T<uint32_t>(reinterpret_cast<uint32_t *>(pixels), nb_pixels, surface);
-        break;
+    const bool need_relayout = surface->tiling != SurfaceTiling::Linear && can_relayout_surface(*surface);
+    // in this case the surface was copied linearly to the copy buffer
+    uint8_t *linear_pixels = need_relayout ? static_cast<uint8_t *>(surface->copy_buffer->mapped_data) : pixels;
+
+    const bool is_swizzle_identity = surface->swizzle.r == vk::ComponentSwizzle::eR || !format_support_swizzle(surface->format);
+    if (!is_swizzle_identity) {
+        switch (vk::componentBits(surface->texture.format, 0)) {
+        case 8:
+            swizzle_text_T<uint8_t>(linear_pixels, nb_pixels, surface);
+            break;
+        case 16:
+            swizzle_text_T<uint16_t>(reinterpret_cast<uint16_t *>(linear_pixels), nb_pixels, surface);
+            break;
+        case 32:
+            swizzle_text_T<uint32_t>(reinterpret_cast<uint32_t *>(linear_pixels), nb_pixels, surface);
+            break;
+        }
+    }
+
+    if (need_relayout) {
+        const uint8_t bpp = static_cast<uint8_t>(gxm::bits_per_pixel(surface->format));
+        if (surface->tiling == SurfaceTiling::Swizzled)
+            renderer::texture::linear_texture_to_swizzled_texture(pixels, linear_pixels, pixel_stride, surface->original_height, bpp);
+        else
+            renderer::texture::linear_texture_to_tiled_texture(pixels, linear_pixels, pixel_stride, surface->original_height, bpp);
     }
 }
 
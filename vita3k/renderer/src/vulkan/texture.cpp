@@ -55,6 +55,20 @@ static bool is_depth_stencil_compatible_format(SceGxmTextureBaseFormat format) {
 VKTextureCache::VKTextureCache(VKState &state)
     : state(state) {}
 
+// push constants of the texture decoding shaders, both use the same layout
+struct TextureDecodeParams {
+    // in 32-bit words
+    uint32_t src_offset;
+    uint32_t width;
+    uint32_t height;
+    // for BC, the format id used by decompress_bc_image, for PVRT, bit 0 is set for 2bpp and bit 1 for PVRTC2
+    // for YUV420, bit 0 is set for the 3 planes layout
+    uint32_t format;
+    // number of blocks (BC) or words (PVRT) in each dimension, for YUV420 the luma stride in bytes
+    uint32_t size_x;
+    uint32_t size_y;
+};
+
 void sync_texture(VKContext &context, MemState &mem, std::size_t index, SceGxmTexture texture, const Config &config) {
     // why are we doing this here?
     // well textures are synced right before the draw
@@ -166,6 +180,7 @@ void VKTextureCache::prepare_staging_buffer(bool is_configure) {
             assert(current_fence == staging_buffer->waiting_fence);
             // special case, all the staging buffer are occupied by the current scene
             // submit the command buffer and wait for it
+            wait_pending_decodes();
             context->prerender_cmd.end();
             context->cmdbuffers_to_submit.push_back(context->prerender_cmd);
 
@@ -219,7 +234,8 @@ void VKTextureCache::prepare_staging_buffer(bool is_configure) {
             staging_buffer->buffer.destroy();
 
             staging_buffer->buffer.size = current_texture->memory_needed;
-            staging_buffer->buffer.init_buffer(vk::BufferUsageFlagBits::eTransferSrc, vkutil::vma_mapped_alloc);
+            // the compressed content is read as a storage buffer when it is decoded on the GPU
+            staging_buffer->buffer.init_buffer(vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eStorageBuffer, vkutil::vma_mapped_alloc);
         }
     }
 
@@ -232,27 +248,117 @@ void VKTextureCache::prepare_staging_buffer(bool is_configure) {
         .layerCount = current_texture->is_cube ? 6U : 1U
     };
 
+    const vkutil::ImageLayout upload_layout = current_texture->use_compute_decode ? vkutil::ImageLayout::StorageImage : vkutil::ImageLayout::TransferDst;
     // if this is done during configure, layout is undefined, otherwise it is shader read only
     if (is_configure)
-        vkutil::transition_image_layout(cmd_buffer, current_texture->texture.image, vkutil::ImageLayout::Undefined, vkutil::ImageLayout::TransferDst, range);
+        vkutil::transition_image_layout(cmd_buffer, current_texture->texture.image, vkutil::ImageLayout::Undefined, upload_layout, range);
+    else if (partial_upload)
+        // the faces / mips which are not uploaded again must be kept
+        vkutil::transition_image_layout(cmd_buffer, current_texture->texture.image, vkutil::ImageLayout::SampledImage, upload_layout, range);
     else
-        vkutil::transition_image_layout_discard(cmd_buffer, current_texture->texture.image, vkutil::ImageLayout::SampledImage, vkutil::ImageLayout::TransferDst, range);
+        vkutil::transition_image_layout_discard(cmd_buffer, current_texture->texture.image, vkutil::ImageLayout::SampledImage, upload_layout, range);
 
     is_texture_transfer_ready = true;
 }
 
-bool VKTextureCache::init(const bool hashless_texture_cache, const fs::path &texture_folder, const std::string_view game_id) {
+bool VKTextureCache::init(const bool hashless_texture_cache, const fs::path &texture_folder, const std::string_view game_id, const bool compute_decode) {
     // set a limit to the number of samplers which can be allocated at the same time
     const size_t max_sampler_used = std::min(state.physical_device_properties.limits.maxSamplerAllocationCount / 2, 512U);
 
     TextureCache::init(hashless_texture_cache, texture_folder, game_id, max_sampler_used);
     backend = Backend::Vulkan;
 
+    support_bcn = state.physical_device_features.textureCompressionBC;
+    support_backend_decode = compute_decode && init_compute_decode();
+    if (support_backend_decode)
+        LOG_WARN("PVRT and YUV420 textures are decoded with compute shaders, disable compute-texture-decode if they are not displayed correctly");
+    if (!support_bcn)
+        LOG_INFO("Your GPU does not support BC textures, they will be decompressed on the {}", support_backend_decode ? "GPU" : "CPU");
+
     samplers.resize(max_sampler_used);
 
     return true;
 }
 
+bool VKTextureCache::init_compute_decode() {
+    // already done for a previous game
+    if (decode_bcn_pipeline && decode_pvrtc_pipeline && decode_yuv420_pipeline)
+        return true;
+
+    const fs::path builtin_shaders_path = state.static_assets / "shaders-builtin/vulkan";
+    vk::ShaderModule bcn_shader = vkutil::load_shader(state.device, builtin_shaders_path / "texture_decode_bcn.comp.spv");
+    vk::ShaderModule pvrtc_shader = vkutil::load_shader(state.device, builtin_shaders_path / "texture_decode_pvrtc.comp.spv");
+    vk::ShaderModule yuv420_shader = vkutil::load_shader(state.device, builtin_shaders_path / "texture_decode_yuv420.comp.spv");
+    if (!bcn_shader || !pvrtc_shader || !yuv420_shader) {
+        LOG_WARN("Could not load the texture decoding shaders, compressed and video textures will be decoded on the CPU");
+        for (vk::ShaderModule shader : { bcn_shader, pvrtc_shader, yuv420_shader }) {
+            if (shader)
+                state.device.destroy(shader);
+        }
+        return false;
+    }
+
+    std::array<vk::DescriptorSetLayoutBinding, 2> layout_bindings = {
+        // compressed content
+        vk::DescriptorSetLayoutBinding{
+            .binding = 0,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .descriptorCount = 1,
+            .stageFlags = vk::ShaderStageFlagBits::eCompute },
+        // decoded face / mip
+        vk::DescriptorSetLayoutBinding{
+            .binding = 1,
+            .descriptorType = vk::DescriptorType::eStorageImage,
+            .descriptorCount = 1,
+            .stageFlags = vk::ShaderStageFlagBits::eCompute },
+    };
+
+    vk::DescriptorSetLayoutCreateInfo layout_create_info{};
+    layout_create_info.setBindings(layout_bindings);
+    decode_set_layout = state.device.createDescriptorSetLayout(layout_create_info);
+
+    vk::PipelineLayoutCreateInfo layout_info{};
+    layout_info.setSetLayouts(decode_set_layout);
+    vk::PushConstantRange push_constant{
+        .stageFlags = vk::ShaderStageFlagBits::eCompute,
+        .offset = 0,
+        .size = sizeof(TextureDecodeParams),
+    };
+    layout_info.setPushConstantRanges(push_constant);
+    decode_pipeline_layout = state.device.createPipelineLayout(layout_info);
+
+    vk::ComputePipelineCreateInfo compute_info{
+        .stage = {
+            .stage = vk::ShaderStageFlagBits::eCompute,
+            .module = bcn_shader,
+            .pName = "main" },
+        .layout = decode_pipeline_layout
+    };
+    auto result = state.device.createComputePipeline(nullptr, compute_info);
+    if (result.result != vk::Result::eSuccess)
+        LOG_ERROR("Failed to create compute pipeline");
+    decode_bcn_pipeline = result.value;
+
+    compute_info.stage.module = pvrtc_shader;
+    result = state.device.createComputePipeline(nullptr, compute_info);
+    if (result.result != vk::Result::eSuccess)
+        LOG_ERROR("Failed to create compute pipeline");
+    decode_pvrtc_pipeline = result.value;
+
+    compute_info.stage.module = yuv420_shader;
+    result = state.device.createComputePipeline(nullptr, compute_info);
+    if (result.result != vk::Result::eSuccess)
+        LOG_ERROR("Failed to create compute pipeline");
+    decode_yuv420_pipeline = result.value;
+
+    // the modules are no longer needed once the pipelines are created
+    state.device.destroy(bcn_shader);
+    state.device.destroy(pvrtc_shader);
+    state.device.destroy(yuv420_shader);
+
+    return decode_bcn_pipeline && decode_pvrtc_pipeline && decode_yuv420_pipeline;
+}
+
 void VKTextureCache::select(size_t index, const SceGxmTexture &texture) {
     current_texture = &textures[index];
     is_texture_transfer_ready = false;
@@ -311,13 +417,18 @@ void VKTextureCache::configure_texture(const SceGxmTexture &gxm_texture) {
 
     const uint16_t mip_count = renderer::texture::get_upload_mip(gxm_texture.true_mip_count(), width, height);
 
-    vk::Format vk_format = texture::translate_format(base_format);
+    const vk::Format linear_format = texture::translate_format(support_bcn ? base_format : renderer::texture::get_bcn_decompressed_format(base_format));
+    vk::Format vk_format = linear_format;
     if (gxm_texture.gamma_mode) {
         vk_format = linear_to_srgb(vk_format);
     }
 
+    // formats the GPU can't sample which were not decoded on the CPU
+    const bool use_compute_decode = current_info->backend_decode && renderer::texture::is_backend_decodable_format(base_format, support_bcn);
+
     current_texture->mip_count = mip_count;
     current_texture->is_cube = is_cube;
+    current_texture->use_compute_decode = use_compute_decode;
     uint32_t memory_needed = get_image_memory_upper_bound(gxm_texture, vk_format, base_format);
     if (mip_count > 1)
         // using mips, the overall memory needed will be 4/3 of the base memory
@@ -356,7 +467,15 @@ void VKTextureCache::configure_texture(const SceGxmTexture &gxm_texture) {
         .initialLayout = vk::ImageLayout::eUndefined,
     };
 
+    if (use_compute_decode) {
+        // the compute shader writes to a R8G8B8A8_UINT view, and storage is not supported on sRGB formats
+        image_info.flags |= vk::ImageCreateFlagBits::eMutableFormat;
+        image_info.format = linear_format;
+        image_info.usage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eStorage;
+    }
+
     std::tie(image.image, image.allocation) = state.allocator.createImage(image_info, vkutil::vma_auto_alloc);
+    current_info->memory_size = state.allocator.getAllocationInfo(image.allocation).size;
 
     // create image view
     vk::ImageSubresourceRange range{
@@ -383,11 +502,8 @@ void VKTextureCache::configure_texture(const SceGxmTexture &gxm_texture) {
 }
 
 // add an alpha channel to u8u8u8 textures
-static void *add_alpha_channel(const void *pixels, const uint32_t width, const uint32_t height, std::vector<uint8_t> &data) {
-    data.resize(width * height * 4);
-
+static void add_alpha_channel(const void *pixels, const uint32_t width, const uint32_t height, uint8_t *dst) {
     const uint8_t *src = static_cast<const uint8_t *>(pixels);
-    uint8_t *dst = data.data();
     for (uint32_t y = 0; y < height; y++) {
         for (uint32_t x = 0; x < width; x++) {
             dst[0] = src[0];
@@ -400,12 +516,57 @@ static void *add_alpha_channel(const void *pixels, const uint32_t width, const u
             dst += 4;
         }
     }
+}
+
+static bool needs_alpha_channel(const SceGxmTextureBaseFormat base_format) {
+    return base_format == SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8 || base_format == SCE_GXM_TEXTURE_BASE_FORMAT_S8S8S8;
+}
+
+// the PVRT decoder considers a texture to be made of at least 2x2 words, the words being twiddled
+// the dimensions must also be powers of two (this is what the CPU decoder gets from the texture layout)
+static std::pair<uint32_t, uint32_t> get_pvrt_word_count(SceGxmTextureBaseFormat base_format, const uint32_t pixels_per_stride, const uint32_t height) {
+    const bool is_2bpp = (base_format == SCE_GXM_TEXTURE_BASE_FORMAT_PVRT2BPP) || (base_format == SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII2BPP);
+    const uint32_t word_width = is_2bpp ? 8 : 4;
+    const uint32_t true_width = std::max(next_power_of_two(pixels_per_stride), word_width * 2);
+    const uint32_t true_height = std::max(next_power_of_two(height), 8U);
 
-    return data.data();
+    return { true_width / word_width, true_height / 4 };
+}
+
+// size taken in the staging buffer by a face / mip
+static vk::DeviceSize get_upload_size(SceGxmTextureBaseFormat base_format, const uint32_t pixels_per_stride, const uint32_t height) {
+    if (needs_alpha_channel(base_format))
+        base_format = (base_format == SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8) ? SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8U8 : SCE_GXM_TEXTURE_BASE_FORMAT_S8S8S8S8;
+
+    if (gxm::is_bcn_format(base_format))
+        return renderer::texture::get_compressed_size(base_format, pixels_per_stride, height);
+
+    if (gxm::is_pvrt_format(base_format)) {
+        const auto [words_x, words_y] = get_pvrt_word_count(base_format, pixels_per_stride, height);
+        return words_x * words_y * 8;
+    }
+
+    // the luma plane followed by the chroma plane(s), both layouts take the same space
+    if (base_format == SCE_GXM_TEXTURE_BASE_FORMAT_YUV420P2 || base_format == SCE_GXM_TEXTURE_BASE_FORMAT_YUV420P3)
+        return pixels_per_stride * height + pixels_per_stride * ((height + 1) / 2);
+
+    size_t bpp = gxm::bits_per_pixel(base_format);
+    size_t bytes_per_pixel = (bpp + 7) >> 3;
+    return pixels_per_stride * height * bytes_per_pixel;
 }
 
 void VKTextureCache::upload_texture_impl(SceGxmTextureBaseFormat base_format, uint32_t width, uint32_t height,
     uint32_t mip_index, const void *pixels, int face, uint32_t pixels_per_stride) {
+    if (pixels_per_stride == 0)
+        pixels_per_stride = width;
+
+    uint8_t *dest = reserve_texture_upload(base_format, width, height, mip_index, face, pixels_per_stride);
+    if (dest)
+        write_texture_upload(dest, base_format, height, pixels, pixels_per_stride);
+}
+
+uint8_t *VKTextureCache::reserve_texture_upload(SceGxmTextureBaseFormat base_format, uint32_t width, uint32_t height,
+    uint32_t mip_index, int face, uint32_t pixels_per_stride) {
     if (!is_texture_transfer_ready)
         prepare_staging_buffer();
 
@@ -415,34 +576,25 @@ void VKTextureCache::upload_texture_impl(SceGxmTextureBaseFormat base_format, ui
     if (face > 0)
         face--;
 
-    if (pixels_per_stride == 0)
-        pixels_per_stride = width;
-
-    const void *text_data = pixels;
-    std::vector<uint8_t> temp_data;
-    if (base_format == SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8 || base_format == SCE_GXM_TEXTURE_BASE_FORMAT_S8S8S8) {
-        text_data = add_alpha_channel(pixels, pixels_per_stride, height, temp_data);
-        base_format = (base_format == SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8) ? SCE_GXM_TEXTURE_BASE_FORMAT_U8U8U8U8 : SCE_GXM_TEXTURE_BASE_FORMAT_S8S8S8S8;
-    }
-
-    vk::DeviceSize upload_size;
+    const vk::DeviceSize upload_size = get_upload_size(base_format, pixels_per_stride, height);
     uint32_t buffer_height = height;
     if (gxm::is_bcn_format(base_format)) {
-        upload_size = renderer::texture::get_compressed_size(base_format, pixels_per_stride, height);
         pixels_per_stride = align(pixels_per_stride, 4);
         buffer_height = align(buffer_height, 4);
-    } else {
-        size_t bpp = gxm::bits_per_pixel(base_format);
-        size_t bytes_per_pixel = (bpp + 7) >> 3;
-        upload_size = pixels_per_stride * height * bytes_per_pixel;
     }
 
     if (staging_buffer.used_so_far + upload_size > staging_buffer.buffer.size) {
         LOG_ERROR("Staging buffer size left ({}) is too small for texture size {}!", staging_buffer.buffer.size - staging_buffer.used_so_far, upload_size);
-        return;
+        return nullptr;
     }
 
-    memcpy(static_cast<uint8_t *>(staging_buffer.buffer.mapped_data) + staging_buffer.used_so_far, text_data, upload_size);
+    uint8_t *dest = static_cast<uint8_t *>(staging_buffer.buffer.mapped_data) + staging_buffer.used_so_far;
+
+    if (current_texture->use_compute_decode) {
+        record_compute_decode(base_format, width, height, mip_index, face, pixels_per_stride, upload_size);
+        staging_buffer.used_so_far += upload_size;
+        return dest;
+    }
 
     vk::ImageSubresourceLayers layer{
         .aspectMask = vk::ImageAspectFlagBits::eColor,
@@ -460,9 +612,174 @@ void VKTextureCache::upload_texture_impl(SceGxmTextureBaseFormat base_format, ui
     };
     cmd_buffer.copyBufferToImage(staging_buffer.buffer.buffer, image.image, vk::ImageLayout::eTransferDstOptimal, region);
     staging_buffer.used_so_far += upload_size;
+
+    return dest;
+}
+
+// when needed, how many decode descriptors we allocate for each frame at once
+static constexpr uint32_t DECODE_DESCRIPTOR_PACK_SIZE = 16;
+
+static vk::DescriptorSet retrieve_decode_descriptor(VKState &state, vk::DescriptorSetLayout set_layout) {
+    FrameDescriptor &frame_descriptor = state.frame().decode_descriptor;
+    if (frame_descriptor.descriptors_idx < frame_descriptor.sets.size())
+        return frame_descriptor.sets[frame_descriptor.descriptors_idx++];
+
+    // we have no more frame descriptor available, create a bunch of new ones
+    std::array<vk::DescriptorPoolSize, 2> pool_sizes{
+        vk::DescriptorPoolSize{
+            .type = vk::DescriptorType::eStorageBuffer,
+            .descriptorCount = DECODE_DESCRIPTOR_PACK_SIZE * MAX_FRAMES_RENDERING },
+        vk::DescriptorPoolSize{
+            .type = vk::DescriptorType::eStorageImage,
+            .descriptorCount = DECODE_DESCRIPTOR_PACK_SIZE * MAX_FRAMES_RENDERING },
+    };
+
+    vk::DescriptorPoolCreateInfo descriptor_pool_info{
+        .maxSets = DECODE_DESCRIPTOR_PACK_SIZE * MAX_FRAMES_RENDERING
+    };
+    descriptor_pool_info.setPoolSizes(pool_sizes);
+
+    vk::DescriptorPool descriptor_pool = state.device.createDescriptorPool(descriptor_pool_info);
+    state.frame_descriptor_pools.push_back(descriptor_pool);
+
+    // allocate all the descriptor sets
+    std::vector<vk::DescriptorSetLayout> layouts(DECODE_DESCRIPTOR_PACK_SIZE * MAX_FRAMES_RENDERING, set_layout);
+    vk::DescriptorSetAllocateInfo descr_set_info{
+        .descriptorPool = descriptor_pool
+    };
+    descr_set_info.setSetLayouts(layouts);
+    auto descriptor_sets = state.device.allocateDescriptorSets(descr_set_info);
+
+    // distribute them among all frames
+    for (int frame_idx = 0; frame_idx < MAX_FRAMES_RENDERING; frame_idx++) {
+        FrameDescriptor &frame_descr = state.frames[frame_idx].decode_descriptor;
+
+        auto descr_it = descriptor_sets.begin() + frame_idx * DECODE_DESCRIPTOR_PACK_SIZE;
+        frame_descr.sets.insert(frame_descr.sets.end(), descr_it, descr_it + DECODE_DESCRIPTOR_PACK_SIZE);
+    }
+
+    return frame_descriptor.sets[frame_descriptor.descriptors_idx++];
+}
+
+static uint32_t get_bcn_format_id(SceGxmTextureBaseFormat base_format) {
+    switch (base_format) {
+    case SCE_GXM_TEXTURE_BASE_FORMAT_UBC1:
+        return 1;
+    case SCE_GXM_TEXTURE_BASE_FORMAT_UBC2:
+        return 2;
+    case SCE_GXM_TEXTURE_BASE_FORMAT_UBC3:
+        return 3;
+    case SCE_GXM_TEXTURE_BASE_FORMAT_UBC4:
+        return 4;
+    case SCE_GXM_TEXTURE_BASE_FORMAT_SBC4:
+        return 5;
+    case SCE_GXM_TEXTURE_BASE_FORMAT_UBC5:
+        return 6;
+    case SCE_GXM_TEXTURE_BASE_FORMAT_SBC5:
+        return 7;
+    default:
+        return 0;
+    }
+}
+
+void VKTextureCache::record_compute_decode(SceGxmTextureBaseFormat base_format, uint32_t width, uint32_t height, uint32_t mip_index, int face, uint32_t pixels_per_stride, vk::DeviceSize upload_size) {
+    TextureStagingBuffer &staging_buffer = staging_buffers[staging_idx];
+    vkutil::Image &image = current_texture->texture;
+
+    // the shaders write the decoded bytes as they are, whatever the format of the image
+    vk::ImageViewCreateInfo view_info{
+        .image = image.image,
+        .viewType = vk::ImageViewType::e2D,
+        .format = vk::Format::eR8G8B8A8Uint,
+        .subresourceRange = {
+            .aspectMask = vk::ImageAspectFlagBits::eColor,
+            .baseMipLevel = mip_index,
+            .levelCount = 1,
+            .baseArrayLayer = static_cast<uint32_t>(face),
+            .layerCount = 1 }
+    };
+    vk::ImageView storage_view = state.device.createImageView(view_info);
+
+    // the buffer offset must be aligned, the remaining offset is given to the shader
+    const vk::DeviceSize offset_alignment = state.physical_device_properties.limits.minStorageBufferOffsetAlignment;
+    const vk::DeviceSize buffer_offset = staging_buffer.used_so_far - staging_buffer.used_so_far % offset_alignment;
+    assert((staging_buffer.used_so_far - buffer_offset) % 4 == 0);
+
+    vk::DescriptorBufferInfo buffer_info{
+        .buffer = staging_buffer.buffer.buffer,
+        .offset = buffer_offset,
+        .range = staging_buffer.used_so_far - buffer_offset + upload_size
+    };
+    vk::DescriptorImageInfo image_info{
+        .imageView = storage_view,
+        .imageLayout = vk::ImageLayout::eGeneral
+    };
+
+    const vk::DescriptorSet descriptor_set = retrieve_decode_descriptor(state, decode_set_layout);
+    std::array<vk::WriteDescriptorSet, 2> write_descr{
+        vk::WriteDescriptorSet{
+            .dstSet = descriptor_set,
+            .dstBinding = 0,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .pBufferInfo = &buffer_info },
+        vk::WriteDescriptorSet{
+            .dstSet = descriptor_set,
+            .dstBinding = 1,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eStorageImage,
+            .pImageInfo = &image_info },
+    };
+    state.device.updateDescriptorSets(write_descr, {});
+
+    TextureDecodeParams params{
+        .src_offset = static_cast<uint32_t>((staging_buffer.used_so_far - buffer_offset) / 4),
+        .width = width,
+        .height = height,
+    };
+
+    if (gxm::is_pvrt_format(base_format)) {
+        const bool is_2bpp = (base_format == SCE_GXM_TEXTURE_BASE_FORMAT_PVRT2BPP) || (base_format == SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII2BPP);
+        const bool is_ii = (base_format == SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII2BPP) || (base_format == SCE_GXM_TEXTURE_BASE_FORMAT_PVRTII4BPP);
+        params.format = (is_2bpp ? 1 : 0) | (is_ii ? 2 : 0);
+        std::tie(params.size_x, params.size_y) = get_pvrt_word_count(base_format, pixels_per_stride, height);
+        cmd_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, decode_pvrtc_pipeline);
+    } else if (base_format == SCE_GXM_TEXTURE_BASE_FORMAT_YUV420P2 || base_format == SCE_GXM_TEXTURE_BASE_FORMAT_YUV420P3) {
+        params.format = (base_format == SCE_GXM_TEXTURE_BASE_FORMAT_YUV420P3) ? 1 : 0;
+        params.size_x = pixels_per_stride;
+        params.size_y = height;
+        cmd_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, decode_yuv420_pipeline);
+    } else {
+        // the blocks have already been linearized
+        params.format = get_bcn_format_id(base_format);
+        params.size_x = pixels_per_stride / 4;
+        params.size_y = (height + 3) / 4;
+        cmd_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, decode_bcn_pipeline);
+    }
+
+    cmd_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, decode_pipeline_layout, 0, descriptor_set, {});
+    cmd_buffer.pushConstants(decode_pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(TextureDecodeParams), &params);
+    cmd_buffer.dispatch((width + 7) / 8, (height + 7) / 8, 1);
+
+    state.frame().destroy_queue.add(storage_view);
+}
+
+void VKTextureCache::write_texture_upload(uint8_t *dest, SceGxmTextureBaseFormat base_format, uint32_t height, const void *pixels, uint32_t pixels_per_stride) const {
+    if (needs_alpha_channel(base_format))
+        add_alpha_channel(pixels, pixels_per_stride, height, dest);
+    else
+        memcpy(dest, pixels, get_upload_size(base_format, pixels_per_stride, height));
+}
+
+void VKTextureCache::release_texture(size_t index) {
+    state.frame().destroy_queue.add_image(textures[index].texture);
 }
 
 void VKTextureCache::upload_done() {
+    // nothing was uploaded
+    if (!is_texture_transfer_ready)
+        return;
+
     // transition the texture back to read only
     vk::ImageSubresourceRange range{
         .aspectMask = vk::ImageAspectFlagBits::eColor,
@@ -471,7 +788,8 @@ void VKTextureCache::upload_done() {
         .baseArrayLayer = 0,
         .layerCount = current_texture->is_cube ? 6U : 1U
     };
-    vkutil::transition_image_layout(cmd_buffer, current_texture->texture.image, vkutil::ImageLayout::TransferDst, vkutil::ImageLayout::SampledImage, range);
+    const vkutil::ImageLayout upload_layout = current_texture->use_compute_decode ? vkutil::ImageLayout::StorageImage : vkutil::ImageLayout::TransferDst;
+    vkutil::transition_image_layout(cmd_buffer, current_texture->texture.image, upload_layout, vkutil::ImageLayout::SampledImage, range);
     current_texture->texture.layout = vkutil::ImageLayout::SampledImage;
     // this should not be necessary
     cmd_buffer = nullptr;
@@ -522,6 +840,7 @@ void VKTextureCache::import_configure_impl(SceGxmTextureBaseFormat base_format,
     current_texture->memory_needed = align(texture_size, 16);
 
     current_texture->mip_count = mipcount;
+    current_texture->use_compute_decode = false;
     if (mipcount > 1)
         current_texture->memory_needed += current_texture->memory_needed / 2;
 
@@ -564,6 +883,7 @@ void VKTextureCache::import_configure_impl(SceGxmTextureBaseFormat base_format,
     };
 
     std::tie(image.image, image.allocation) = state.allocator.createImage(image_info, vkutil::vma_auto_alloc);
+    current_info->memory_size = state.allocator.getAllocationInfo(image.allocation).size;
 
     // create image view
     vk::ImageSubresourceRange range{
@@ -0,0 +1,207 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <gtest/gtest.h>
+
+#include <renderer/texture_bcn.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace renderer::texture;
+
+static uint32_t get_block_size(uint8_t format_id) {
+    return (format_id == 1 || format_id == 4 || format_id == 5) ? 8 : 16;
+}
+
+// per-texel decoding the kernels are checked against
+static void reference_color_palette(const uint8_t *block, uint32_t palette[4]) {
+    const uint16_t n0 = block[0] | (block[1] << 8);
+    const uint16_t n1 = block[2] | (block[3] << 8);
+    const auto expand = [](uint16_t n) {
+        const uint32_t r = n >> 11;
+        const uint32_t g = (n >> 5) & 0x3F;
+        const uint32_t b = n & 0x1F;
+        return std::array<uint32_t, 3>{ (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2) };
+    };
+    const auto c0 = expand(n0);
+    const auto c1 = expand(n1);
+
+    uint32_t colors[4][4] = {};
+    for (int ch = 0; ch < 3; ch++) {
+        colors[0][ch] = c0[ch];
+        colors[1][ch] = c1[ch];
+        if (n0 > n1) {
+            colors[2][ch] = (2 * c0[ch] + c1[ch] + 1) / 3;
+            colors[3][ch] = (2 * c1[ch] + c0[ch] + 1) / 3;
+        } else {
+            colors[2][ch] = (c0[ch] + c1[ch]) / 2;
+        }
+    }
+    colors[0][3] = colors[1][3] = colors[2][3] = 255;
+    colors[3][3] = (n0 > n1) ? 255 : 0;
+
+    for (int i = 0; i < 4; i++)
+        palette[i] = colors[i][0] | (colors[i][1] << 8) | (colors[i][2] << 16) | (colors[i][3] << 24);
+}
+
+static void reference_interpolated_values(const uint8_t *block, bool is_signed, uint8_t values[16]) {
+    const int a0 = is_signed ? static_cast<int8_t>(block[0]) : block[0];
+    const int a1 = is_signed ? static_cast<int8_t>(block[1]) : block[1];
+    int palette[8] = { a0, a1 };
+    if (a0 > a1) {
+        for (int i = 1; i <= 6; i++)
+            palette[i + 1] = ((7 - i) * a0 + i * a1 + 3) / 7;
+    } else {
+        for (int i = 1; i <= 4; i++)
+            palette[i + 1] = ((5 - i) * a0 + i * a1 + 2) / 5;
+        palette[6] = is_signed ? -128 : 0;
+        palette[7] = is_signed ? 127 : 255;
+    }
+
+    uint64_t bits = 0;
+    memcpy(&bits, block + 2, 6);
+    for (uint32_t texel = 0; texel < 16; texel++)
+        values[texel] = static_cast<uint8_t>(palette[(bits >> (3 * texel)) & 7]);
+}
+
+static void reference_block(const uint8_t *block, uint8_t format_id, uint32_t texels[16]) {
+    uint8_t values[16];
+    uint8_t second_values[16];
+    switch (format_id) {
+    case 1:
+    case 2:
+    case 3: {
+        const uint8_t *color_block = (format_id == 1) ? block : block + 8;
+        uint32_t palette[4];
+        reference_color_palette(color_block, palette);
+        if (format_id == 3)
+            reference_interpolated_values(block, false, values);
+
+        for (uint32_t texel = 0; texel < 16; texel++) {
+            texels[texel] = palette[(color_block[4 + texel / 4] >> (texel % 4 * 2)) & 3];
+            if (format_id == 2) {
+                const uint32_t alpha = (block[texel / 2] >> (texel % 2 * 4)) & 0xF;
+                texels[texel] = (texels[texel] & 0x00FFFFFF) | ((alpha * 17) << 24);
+            } else if (format_id == 3) {
+                texels[texel] = (texels[texel] & 0x00FFFFFF) | (values[texel] << 24);
+            }
+        }
+        break;
+    }
+    case 4:
+    case 5:
+        reference_interpolated_values(block, format_id == 5, values);
+        std::copy(values, values + 16, texels);
+        break;
+    default:
+        reference_interpolated_values(block, format_id == 7, values);
+        reference_interpolated_values(block + 8, format_id == 7, second_values);
+        for (uint32_t texel = 0; texel < 16; texel++)
+            texels[texel] = values[texel] | (second_values[texel] << 8);
+        break;
+    }
+}
+
+static uint32_t reference_swizzled_offset(uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    const uint32_t size = std::min(width, height);
+    const uint32_t k = std::bit_width(size) - 1;
+    uint32_t offset = ((x >> k) | (y >> k)) << (2 * k);
+    for (uint32_t bit = 0; bit < k; bit++) {
+        offset |= ((x >> bit) & 1) << (2 * bit + 1);
+        offset |= ((y >> bit) & 1) << (2 * bit);
+    }
+    return offset;
+}
+
+static void reference_decompress(uint32_t *image, const uint8_t *src, uint32_t width, uint32_t height, uint8_t format_id, bool swizzled) {
+    const uint32_t width_in_blocks = (width + 3) / 4;
+    const uint32_t height_in_blocks = (height + 3) / 4;
+    const uint32_t stride = width_in_blocks * 4;
+    for (uint32_t y = 0; y < height_in_blocks; y++) {
+        for (uint32_t x = 0; x < width_in_blocks; x++) {
+            const uint32_t index = swizzled ? reference_swizzled_offset(x, y, width_in_blocks, height_in_blocks) : y * width_in_blocks + x;
+            uint32_t texels[16];
+            reference_block(src + index * get_block_size(format_id), format_id, texels);
+            for (uint32_t row = 0; row < 4; row++)
+                memcpy(&image[(y * 4 + row) * stride + x * 4], texels + row * 4, sizeof(uint32_t) * 4);
+        }
+    }
+}
+
+static std::vector<uint8_t> make_blocks(size_t nb_blocks, uint8_t format_id) {
+    std::mt19937 rng(format_id);
+    const uint32_t block_size = get_block_size(format_id);
+    std::vector<uint8_t> data(nb_blocks * block_size);
+    for (auto &byte : data)
+        byte = static_cast<uint8_t>(rng());
+    // make sure all the palette modes are used, including identical endpoints
+    for (size_t i = 0; i < nb_blocks; i += 3) {
+        uint8_t *block = data.data() + i * block_size;
+        block[0] = block[1];
+        if (block_size == 16)
+            block[8] = block[9];
+    }
+    return data;
+}
+
+TEST(texture_bcn, matches_reference) {
+    const std::pair<uint32_t, uint32_t> sizes[] = { { 1, 1 }, { 2, 8 }, { 4, 4 }, { 8, 4 }, { 16, 16 }, { 64, 8 }, { 8, 128 }, { 256, 256 }, { 20, 12 } };
+    for (uint8_t format_id = 1; format_id <= 7; format_id++) {
+        for (const auto &[width, height] : sizes) {
+            const uint32_t width_in_blocks = (width + 3) / 4;
+            const uint32_t height_in_blocks = (height + 3) / 4;
+            const auto src = make_blocks(width_in_blocks * height_in_blocks, format_id);
+            std::vector<uint32_t> image(width_in_blocks * height_in_blocks * 16);
+            std::vector<uint32_t> expected(image.size());
+
+            decompress_bc_image(width, height, src.data(), image.data(), format_id);
+            reference_decompress(expected.data(), src.data(), width, height, format_id, false);
+            ASSERT_EQ(image, expected) << "BC format " << int(format_id) << " " << width << "x" << height;
+
+            if (!std::has_single_bit(width_in_blocks) || !std::has_single_bit(height_in_blocks))
+                continue;
+
+            decompress_bc_swizzled_image(width, height, src.data(), image.data(), format_id);
+            reference_decompress(expected.data(), src.data(), width, height, format_id, true);
+            ASSERT_EQ(image, expected) << "swizzled BC format " << int(format_id) << " " << width << "x" << height;
+        }
+    }
+}
+
+// every pair of endpoints of the interpolated formats
+TEST(texture_bcn, all_endpoints) {
+    for (const uint8_t format_id : { 3, 4, 5, 6, 7 }) {
+        auto src = make_blocks(256 * 256, format_id);
+        const uint32_t block_size = get_block_size(format_id);
+        for (uint32_t i = 0; i < 256 * 256; i++) {
+            uint8_t *block = src.data() + i * block_size;
+            block[0] = static_cast<uint8_t>(i);
+            block[1] = static_cast<uint8_t>(i >> 8);
+        }
+        std::vector<uint32_t> image(256 * 256 * 16);
+        std::vector<uint32_t> expected(image.size());
+
+        decompress_bc_image(1024, 1024, src.data(), image.data(), format_id);
+        reference_decompress(expected.data(), src.data(), 1024, 1024, format_id, false);
+        ASSERT_EQ(image, expected) << "BC format " << int(format_id);
+    }
+}
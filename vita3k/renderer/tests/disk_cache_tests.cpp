@@ -0,0 +1,152 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <gtest/gtest.h>
+
+#include <renderer/texture_disk_cache.h>
+
+#include <ctime>
+#include <numeric>
+#include <vector>
+
+using namespace renderer;
+
+class texture_disk_cache : public ::testing::Test {
+protected:
+    fs::path folder;
+
+    void SetUp() override {
+        folder = fs::temp_directory_path() / fs::unique_path("vita3k-disk-cache-%%%%-%%%%");
+    }
+
+    void TearDown() override {
+        fs::remove_all(folder);
+    }
+};
+
+static TextureDiskCacheKey make_key(uint64_t hash) {
+    TextureDiskCacheKey key;
+    key.hash = hash;
+    key.format = 0x0C001000;
+    key.upload_format = 0x0C000000;
+    key.width = 64;
+    key.height = 32;
+    key.mip_count = 2;
+    return key;
+}
+
+TEST_F(texture_disk_cache, store_and_load) {
+    std::vector<uint8_t> mip0(64 * 32 * 4);
+    std::vector<uint8_t> mip1(32 * 16 * 4);
+    std::iota(mip0.begin(), mip0.end(), 0);
+    std::iota(mip1.begin(), mip1.end(), 7);
+
+    {
+        // the cache takes the buffers, the levels keep pointing to their content
+        std::vector<std::vector<uint8_t>> buffers = { mip0, mip1 };
+        std::vector<TextureDiskCacheLevel> levels(2);
+        levels[0] = { 0, 0, 64, 32, static_cast<uint32_t>(buffers[0].size()), buffers[0].data() };
+        levels[1] = { 0, 1, 32, 16, static_cast<uint32_t>(buffers[1].size()), buffers[1].data() };
+
+        TextureDiskCache cache;
+        ASSERT_TRUE(cache.init(folder, 0));
+        cache.store(make_key(1), std::move(levels), std::move(buffers));
+        cache.flush();
+        ASSERT_GT(cache.get_size(), 0);
+    }
+
+    // the content is still there after a restart
+    TextureDiskCache cache;
+    ASSERT_TRUE(cache.init(folder, 0));
+
+    std::vector<uint8_t> content;
+    std::vector<TextureDiskCacheLevel> loaded;
+    ASSERT_FALSE(cache.load(make_key(2), content, loaded));
+    // the same content used with another format is a different texture
+    TextureDiskCacheKey other_format = make_key(1);
+    other_format.format = 0x0C002000;
+    ASSERT_FALSE(cache.load(other_format, content, loaded));
+
+    ASSERT_TRUE(cache.load(make_key(1), content, loaded));
+    ASSERT_EQ(loaded.size(), 2);
+    ASSERT_EQ(loaded[1].mip_index, 1);
+    ASSERT_EQ(loaded[1].pixels_per_stride, 32);
+    ASSERT_EQ(loaded[1].memory_height, 16);
+    ASSERT_EQ(loaded[0].size, mip0.size());
+    ASSERT_EQ(memcmp(loaded[0].data, mip0.data(), mip0.size()), 0);
+    ASSERT_EQ(loaded[1].size, mip1.size());
+    ASSERT_EQ(memcmp(loaded[1].data, mip1.data(), mip1.size()), 0);
+}
+
+TEST_F(texture_disk_cache, corrupted_file) {
+    std::vector<uint8_t> pixels(256, 0xAB);
+    std::vector<TextureDiskCacheLevel> levels = { { 0, 0, 8, 8, static_cast<uint32_t>(pixels.size()), pixels.data() } };
+
+    TextureDiskCache cache;
+    ASSERT_TRUE(cache.init(folder, 0));
+    cache.store(make_key(1), levels);
+    cache.flush();
+
+    for (const auto &file : fs::directory_iterator(folder))
+        fs::resize_file(file.path(), fs::file_size(file.path()) - 1);
+
+    std::vector<uint8_t> content;
+    std::vector<TextureDiskCacheLevel> loaded;
+    ASSERT_FALSE(cache.load(make_key(1), content, loaded));
+    // the invalid file is removed
+    ASSERT_EQ(cache.get_size(), 0);
+    ASSERT_TRUE(fs::is_empty(folder));
+}
+
+TEST_F(texture_disk_cache, least_recently_used_removed) {
+    // random data, it is not compressible
+    std::vector<uint8_t> pixels(64 * 1024);
+    uint32_t seed = 1;
+    for (auto &value : pixels) {
+        seed = seed * 1103515245 + 12345;
+        value = static_cast<uint8_t>(seed >> 16);
+    }
+    std::vector<TextureDiskCacheLevel> levels = { { 0, 0, 128, 128, static_cast<uint32_t>(pixels.size()), pixels.data() } };
+
+    TextureDiskCache cache;
+    // room for 3 textures
+    ASSERT_TRUE(cache.init(folder, 3 * 70 * 1024));
+    cache.store(make_key(1), levels);
+    cache.store(make_key(2), levels);
+    cache.store(make_key(3), levels);
+    cache.flush();
+
+    // make the order of use explicit, the file times may only have a precision of one second
+    const std::time_t now = std::time(nullptr);
+    for (const auto &file : fs::directory_iterator(folder)) {
+        const std::string name = file.path().filename().string();
+        const std::time_t age = (name[15] == '1') ? 10 : (name[15] == '2') ? 30 : 20;
+        fs::last_write_time(file.path(), now - age);
+    }
+
+    // going over the limit removes the least recently used textures, here 2 then 3
+    cache.store(make_key(4), levels);
+    cache.flush();
+    ASSERT_LE(cache.get_size(), 3 * 70 * 1024);
+
+    std::vector<uint8_t> content;
+    std::vector<TextureDiskCacheLevel> loaded;
+    ASSERT_FALSE(cache.load(make_key(2), content, loaded));
+    ASSERT_FALSE(cache.load(make_key(3), content, loaded));
+    ASSERT_TRUE(cache.load(make_key(1), content, loaded));
+    ASSERT_TRUE(cache.load(make_key(4), content, loaded));
+}
@@ -0,0 +1,111 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <gtest/gtest.h>
+
+#include <renderer/texture_layout.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+using namespace renderer::texture;
+
+// per-pixel conversions the kernels are checked against
+static uint32_t reference_swizzled_offset(uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    const uint32_t size = std::min(width, height);
+    const uint32_t k = std::bit_width(size) - 1;
+    uint32_t offset = ((x >> k) | (y >> k)) << (2 * k);
+    for (uint32_t bit = 0; bit < k; bit++) {
+        offset |= ((x >> bit) & 1) << (2 * bit + 1);
+        offset |= ((y >> bit) & 1) << (2 * bit);
+    }
+    return offset;
+}
+
+static uint32_t reference_tiled_offset(uint32_t x, uint32_t y, uint32_t width) {
+    const uint32_t width_in_tiles = (width + 31) >> 5;
+    return (((x >> 5) + width_in_tiles * (y >> 5)) << 10) | (x & 31) | ((y & 31) << 5);
+}
+
+template <typename F>
+static void reference_to_linear(uint8_t *dest, const uint8_t *src, uint32_t width, uint32_t height, uint32_t bytes_per_pixel, F offset) {
+    for (uint32_t y = 0; y < height; y++)
+        for (uint32_t x = 0; x < width; x++)
+            memcpy(dest + (y * width + x) * bytes_per_pixel, src + offset(x, y) * bytes_per_pixel, bytes_per_pixel);
+}
+
+static std::vector<uint8_t> make_pattern(size_t size) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; i++)
+        data[i] = static_cast<uint8_t>(i * 7 + (i >> 8));
+    return data;
+}
+
+static constexpr uint32_t tested_bpps[] = { 8, 16, 24, 32, 48, 64, 96, 128 };
+
+TEST(texture_layout, swizzled_matches_reference) {
+    const std::pair<uint32_t, uint32_t> sizes[] = { { 1, 1 }, { 2, 8 }, { 4, 4 }, { 16, 16 }, { 64, 8 }, { 8, 128 }, { 256, 256 } };
+    for (const uint32_t bpp : tested_bpps) {
+        for (const auto &[width, height] : sizes) {
+            const uint32_t bytes_per_pixel = bpp / 8;
+            const auto swizzled = make_pattern(width * height * bytes_per_pixel);
+            std::vector<uint8_t> expected(swizzled.size());
+            std::vector<uint8_t> linear(swizzled.size());
+            std::vector<uint8_t> back(swizzled.size());
+
+            reference_to_linear(expected.data(), swizzled.data(), width, height, bytes_per_pixel, [&](uint32_t x, uint32_t y) {
+                return reference_swizzled_offset(x, y, width, height);
+            });
+            swizzled_texture_to_linear_texture(linear.data(), swizzled.data(), width, height, bpp);
+            ASSERT_EQ(linear, expected) << bpp << "bpp " << width << "x" << height;
+
+            linear_texture_to_swizzled_texture(back.data(), linear.data(), width, height, bpp);
+            ASSERT_EQ(back, swizzled) << bpp << "bpp " << width << "x" << height;
+        }
+    }
+}
+
+TEST(texture_layout, tiled_matches_reference) {
+    const std::pair<uint32_t, uint32_t> sizes[] = { { 32, 32 }, { 64, 40 }, { 96, 7 }, { 256, 256 } };
+    for (const uint32_t bpp : tested_bpps) {
+        for (const auto &[width, height] : sizes) {
+            const uint32_t bytes_per_pixel = bpp / 8;
+            const uint32_t tiled_height = (height + 31) & ~31;
+            const auto tiled = make_pattern(width * tiled_height * bytes_per_pixel);
+            std::vector<uint8_t> expected(width * height * bytes_per_pixel);
+            std::vector<uint8_t> linear(expected.size());
+
+            reference_to_linear(expected.data(), tiled.data(), width, height, bytes_per_pixel, [&](uint32_t x, uint32_t y) {
+                return reference_tiled_offset(x, y, width);
+            });
+            tiled_texture_to_linear_texture(linear.data(), tiled.data(), width, height, bpp);
+            ASSERT_EQ(linear, expected) << bpp << "bpp " << width << "x" << height;
+
+            // only the pixels inside the texture are written back
+            std::vector<uint8_t> back(tiled.size(), 0);
+            linear_texture_to_tiled_texture(back.data(), linear.data(), width, height, bpp);
+            for (uint32_t y = 0; y < height; y++)
+                for (uint32_t x = 0; x < width; x++) {
+                    const size_t offset = reference_tiled_offset(x, y, width) * bytes_per_pixel;
+                    ASSERT_EQ(memcmp(back.data() + offset, tiled.data() + offset, bytes_per_pixel), 0);
+                }
+        }
+    }
+}
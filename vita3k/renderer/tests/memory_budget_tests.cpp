@@ -0,0 +1,84 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <gtest/gtest.h>
+
+#include <renderer/memory_budget.h>
+#include <util/containers.h>
+
+#include <vector>
+
+using namespace renderer;
+
+TEST(memory_budget, tracks_entries) {
+    MemoryBudget budget;
+    budget.resize_entry(CacheType::Texture, 0, 1000);
+    budget.resize_entry(CacheType::Surface, 0, 500);
+    ASSERT_EQ(budget.get_used(), 1500);
+    // no budget, never in excess
+    ASSERT_EQ(budget.get_excess(), 0);
+
+    budget.set_budget(1200);
+    ASSERT_EQ(budget.get_excess(), 300);
+
+    // an entry is reconfigured with a smaller texture
+    budget.resize_entry(CacheType::Texture, 1000, 600);
+    ASSERT_EQ(budget.get_stats(CacheType::Texture).bytes, 600);
+    ASSERT_EQ(budget.get_excess(), 0);
+
+    budget.resize_entry(CacheType::Surface, 500, 0);
+    ASSERT_EQ(budget.get_used(), 600);
+}
+
+TEST(memory_budget, counters) {
+    MemoryBudget budget;
+    budget.record_hit(CacheType::Texture);
+    budget.record_hit(CacheType::Texture);
+    budget.record_miss(CacheType::Texture);
+    budget.record_eviction(CacheType::Surface);
+
+    ASSERT_EQ(budget.get_stats(CacheType::Texture).hits, 2);
+    ASSERT_EQ(budget.get_stats(CacheType::Texture).misses, 1);
+    ASSERT_EQ(budget.get_stats(CacheType::Texture).evictions, 0);
+    ASSERT_EQ(budget.get_stats(CacheType::Surface).evictions, 1);
+}
+
+// the texture cache evicts entries going from the least to the most recently used one
+TEST(memory_budget, lru_traversal) {
+    lru::Queue<int> queue;
+    queue.init(4);
+    for (int i = 0; i < 4; i++)
+        queue.items[i].content = i;
+
+    queue.set_as_mru(&queue.items[2].content);
+    queue.set_as_mru(&queue.items[0].content);
+
+    std::vector<int> order;
+    int *item = queue.get_lru();
+    for (int i = 0; i < 4; i++) {
+        order.push_back(*item);
+        item = queue.get_more_recent(item);
+    }
+    ASSERT_EQ(order, std::vector<int>({ 1, 3, 2, 0 }));
+    // the most recently used one is followed by the least recently used one
+    ASSERT_EQ(*item, 1);
+
+    // an evicted entry is used first
+    queue.set_as_lru(&queue.items[2].content);
+    ASSERT_EQ(*queue.get_lru(), 2);
+    ASSERT_EQ(*queue.get_more_recent(queue.get_lru()), 1);
+}
@@ -0,0 +1,111 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <gtest/gtest.h>
+
+#include <renderer/texture_pack.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <ddspp.h>
+#include <stb_image.h>
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace renderer;
+
+class texture_pack : public ::testing::Test {
+protected:
+    fs::path folder;
+
+    void SetUp() override {
+        folder = fs::temp_directory_path() / fs::unique_path("vita3k-texture-pack-%%%%-%%%%");
+        fs::create_directories(folder / "subfolder");
+    }
+
+    void TearDown() override {
+        fs::remove_all(folder);
+        fs::remove(fs_utils::path_concat(folder, ".vtp"));
+    }
+
+    // write a 4x4 rgba8 dds file whose pixels are all set to value
+    std::vector<uint8_t> write_dds(const fs::path &path, uint8_t value) {
+        ddspp::Header header = {};
+        ddspp::HeaderDXT10 dxt_header = {};
+        ddspp::encode_header(ddspp::R8G8B8A8_UNORM, 4, 4, 1, ddspp::Texture2D, 1, 1, header, dxt_header);
+
+        std::vector<uint8_t> content(ddspp::MAX_HEADER_SIZE + 4 * 4 * 4, value);
+        memcpy(content.data(), &ddspp::DDS_MAGIC, sizeof(ddspp::DDS_MAGIC));
+        memcpy(content.data() + sizeof(ddspp::DDS_MAGIC), &header, sizeof(header));
+        memcpy(content.data() + sizeof(ddspp::DDS_MAGIC) + sizeof(header), &dxt_header, sizeof(dxt_header));
+        fs_utils::dump_data(path, content.data(), content.size());
+
+        return content;
+    }
+};
+
+TEST_F(texture_pack, create_and_open) {
+    const auto content_10 = write_dds(folder / "0000000000000010.dds", 0x10);
+    const auto content_20 = write_dds(folder / "subfolder" / "0000000000000020.dds", 0x20);
+    write_dds(folder / "0000000000000030.dds", 0x30);
+    // dds files are preferred, the png is not even looked at
+    fs_utils::dump_data(folder / "0000000000000020.png", "not a png", 9);
+    fs_utils::dump_data(folder / "readme.txt", "texture pack", 12);
+
+    const fs::path pack_path = fs_utils::path_concat(folder, ".vtp");
+    ASSERT_TRUE(create_texture_pack(folder, pack_path));
+
+    TexturePack pack;
+    ASSERT_TRUE(pack.open(pack_path));
+    ASSERT_EQ(pack.size(), 3);
+    ASSERT_EQ(pack.find(0x40), nullptr);
+
+    const TexturePackEntry *entry = pack.find(0x20);
+    ASSERT_NE(entry, nullptr);
+    ASSERT_EQ(entry->type, TexturePackEntryType::Dds);
+    ASSERT_EQ(entry->width, 4);
+    ASSERT_EQ(entry->height, 4);
+    ASSERT_EQ(entry->size, content_20.size());
+    ASSERT_EQ(memcmp(pack.get_data(*entry), content_20.data(), content_20.size()), 0);
+
+    entry = pack.find(0x10);
+    ASSERT_NE(entry, nullptr);
+    ASSERT_EQ(memcmp(pack.get_data(*entry), content_10.data(), content_10.size()), 0);
+
+    // the first request starts the streaming
+    ASSERT_FALSE(pack.request(*entry));
+    for (int i = 0; i < 1000 && !pack.is_ready(*entry); i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ASSERT_TRUE(pack.is_ready(*entry));
+    ASSERT_TRUE(pack.request(*entry));
+}
+
+TEST_F(texture_pack, invalid_pack) {
+    const fs::path pack_path = fs_utils::path_concat(folder, ".vtp");
+    const std::vector<uint8_t> garbage(256, 0xCD);
+    fs_utils::dump_data(pack_path, garbage.data(), garbage.size());
+
+    TexturePack pack;
+    ASSERT_FALSE(pack.open(pack_path));
+    ASSERT_EQ(pack.size(), 0);
+}
+
+TEST_F(texture_pack, empty_folder) {
+    ASSERT_FALSE(create_texture_pack(folder, fs_utils::path_concat(folder, ".vtp")));
+}
@@ -0,0 +1,172 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#include <gtest/gtest.h>
+
+#include <renderer/shader_cache.h>
+
+#include <string>
+#include <vector>
+
+using namespace renderer;
+
+class shader_cache : public ::testing::Test {
+protected:
+    fs::path folder;
+    fs::path path;
+
+    void SetUp() override {
+        folder = fs::temp_directory_path() / fs::unique_path("vita3k-shader-cache-%%%%-%%%%");
+        path = folder / "shaders-vk.bin";
+    }
+
+    void TearDown() override {
+        fs::remove_all(folder);
+    }
+};
+
+static Sha256Hash make_hash(uint8_t value) {
+    Sha256Hash hash{};
+    hash.fill(value);
+    return hash;
+}
+
+TEST_F(shader_cache, store_and_load) {
+    const std::vector<uint32_t> spirv = { 0x07230203, 1, 2, 3 };
+    const std::string glsl = "void main() {}";
+    {
+        ShaderCacheFile cache;
+        ASSERT_FALSE(cache.open(path, 13, 0));
+        ASSERT_TRUE(cache.create(path, 13, 0));
+        cache.store({ make_hash(1), 42, ShaderCacheType::Spirv }, spirv.data(), spirv.size() * sizeof(uint32_t));
+        cache.store({ make_hash(2), 42, ShaderCacheType::Glsl }, glsl.data(), glsl.size());
+        cache.store_programs({ { make_hash(2), make_hash(1) } });
+
+        // what was just stored can be read back
+        std::vector<uint32_t> loaded;
+        ASSERT_TRUE(cache.load({ make_hash(1), 42, ShaderCacheType::Spirv }, loaded));
+        ASSERT_EQ(loaded, spirv);
+    }
+
+    // the content is still there after a restart
+    ShaderCacheFile cache;
+    ASSERT_TRUE(cache.open(path, 13, 0));
+
+    std::vector<uint32_t> loaded_spirv;
+    std::string loaded_glsl;
+    ASSERT_TRUE(cache.load({ make_hash(1), 42, ShaderCacheType::Spirv }, loaded_spirv));
+    ASSERT_EQ(loaded_spirv, spirv);
+    ASSERT_TRUE(cache.load({ make_hash(2), 42, ShaderCacheType::Glsl }, loaded_glsl));
+    ASSERT_EQ(loaded_glsl, glsl);
+
+    // other hints or another type are another shader
+    ASSERT_FALSE(cache.load({ make_hash(1), 43, ShaderCacheType::Spirv }, loaded_spirv));
+    ASSERT_FALSE(cache.load({ make_hash(2), 42, ShaderCacheType::Spirv }, loaded_spirv));
+    ASSERT_TRUE(cache.load({ make_hash(1), ShaderCacheKey::ANY_HINTS, ShaderCacheType::Spirv }, loaded_spirv));
+
+    const std::vector<ShadersHash> programs = cache.get_programs();
+    ASSERT_EQ(programs.size(), 1);
+    ASSERT_EQ(programs[0].frag, make_hash(2));
+    ASSERT_EQ(programs[0].vert, make_hash(1));
+}
+
+TEST_F(shader_cache, version_mismatch) {
+    {
+        ShaderCacheFile cache;
+        ASSERT_TRUE(cache.create(path, 13, 0));
+        const uint32_t word = 0;
+        cache.store({ make_hash(1), 42, ShaderCacheType::Spirv }, &word, sizeof(word));
+    }
+
+    ShaderCacheFile cache;
+    ASSERT_FALSE(cache.open(path, 14, 0));
+    ASSERT_FALSE(cache.open(path, 13, 1));
+    ASSERT_TRUE(cache.open(path, 13, 0));
+}
+
+TEST_F(shader_cache, damaged_end_and_compaction) {
+    const std::vector<uint32_t> first = { 1, 2, 3 };
+    const std::vector<uint32_t> second = { 4, 5, 6, 7 };
+    {
+        ShaderCacheFile cache;
+        ASSERT_TRUE(cache.create(path, 13, 0));
+        // the same shader translated with other hints, the most recent one is used when the hints are unknown
+        cache.store({ make_hash(1), 42, ShaderCacheType::Spirv }, first.data(), first.size() * sizeof(uint32_t));
+        cache.store({ make_hash(1), 43, ShaderCacheType::Spirv }, second.data(), second.size() * sizeof(uint32_t));
+        // stored again, the first entry can't be looked up anymore
+        for (int i = 0; i < 8; i++)
+            cache.store({ make_hash(2), 42, ShaderCacheType::Spirv }, first.data(), first.size() * sizeof(uint32_t));
+    }
+
+    // simulate the app being closed while an entry was written
+    const uint64_t valid_size = fs::file_size(path);
+    {
+        fs::ofstream file(path, std::ios::out | std::ios::binary | std::ios::app);
+        const uint32_t partial_entry[] = { 1, 1000 };
+        file.write(reinterpret_cast<const char *>(partial_entry), sizeof(partial_entry));
+    }
+
+    {
+        ShaderCacheFile cache;
+        ASSERT_TRUE(cache.open(path, 13, 0));
+        ASSERT_EQ(cache.get_wasted_size(), 0);
+        ASSERT_LT(fs::file_size(path), valid_size);
+
+        std::vector<uint32_t> loaded;
+        ASSERT_TRUE(cache.load({ make_hash(1), ShaderCacheKey::ANY_HINTS, ShaderCacheType::Spirv }, loaded));
+        ASSERT_EQ(loaded, second);
+        ASSERT_TRUE(cache.load({ make_hash(1), 42, ShaderCacheType::Spirv }, loaded));
+        ASSERT_EQ(loaded, first);
+        ASSERT_TRUE(cache.load({ make_hash(2), 42, ShaderCacheType::Spirv }, loaded));
+        ASSERT_EQ(loaded, first);
+
+        // entries can still be appended after the compaction
+        cache.store({ make_hash(3), 42, ShaderCacheType::Spirv }, second.data(), second.size() * sizeof(uint32_t));
+    }
+
+    ShaderCacheFile cache;
+    ASSERT_TRUE(cache.open(path, 13, 0));
+    std::vector<uint32_t> loaded;
+    ASSERT_TRUE(cache.load({ make_hash(3), 42, ShaderCacheType::Spirv }, loaded));
+    ASSERT_EQ(loaded, second);
+    ASSERT_TRUE(cache.load({ make_hash(1), ShaderCacheKey::ANY_HINTS, ShaderCacheType::Spirv }, loaded));
+    ASSERT_EQ(loaded, second);
+}
+
+TEST_F(shader_cache, speculative_shaders) {
+    const std::vector<uint32_t> spirv = { 1, 2, 3 };
+    {
+        ShaderCacheFile cache;
+        ASSERT_TRUE(cache.create(path, 13, 0));
+        ASSERT_TRUE(cache.claim_speculative({ make_hash(1), 42, ShaderCacheType::Spirv }));
+        // already being translated
+        ASSERT_FALSE(cache.claim_speculative({ make_hash(1), 42, ShaderCacheType::Spirv }));
+        cache.store({ make_hash(1), 42, ShaderCacheType::Spirv }, spirv.data(), spirv.size() * sizeof(uint32_t), true);
+        // already in the cache
+        ASSERT_FALSE(cache.claim_speculative({ make_hash(1), 42, ShaderCacheType::Spirv }));
+    }
+
+    ShaderCacheFile cache;
+    ASSERT_TRUE(cache.open(path, 13, 0));
+    std::vector<uint32_t> loaded;
+    // the hints were only guessed, it is not used without them
+    ASSERT_FALSE(cache.load({ make_hash(1), ShaderCacheKey::ANY_HINTS, ShaderCacheType::Spirv }, loaded));
+    ASSERT_TRUE(cache.load({ make_hash(1), 42, ShaderCacheType::Spirv }, loaded));
+    ASSERT_EQ(loaded, spirv);
+    // the guess was right, it is now a regular shader
+    ASSERT_TRUE(cache.load({ make_hash(1), ShaderCacheKey::ANY_HINTS, ShaderCacheType::Spirv }, loaded));
+    ASSERT_EQ(loaded, spirv);
+}
@@ -0,0 +1,38 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <gtest/gtest.h>
+
+#include <renderer/shader_jobs.h>
+
+#include <atomic>
+
+using namespace renderer;
+
+TEST(shader_jobs, runs_all_jobs) {
+    std::atomic<int> done = 0;
+    {
+        ShaderJobPool pool;
+        for (int i = 0; i < 100; i++)
+            pool.submit([&done]() { done++; });
+
+        while (done < 100)
+            std::this_thread::yield();
+    }
+
+    ASSERT_EQ(done, 100);
+}
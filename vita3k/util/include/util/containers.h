@@ -101,6 +101,12 @@ struct Queue {
         head = item;
     }
 
+    // get the element used right after this one, the most recently used element is followed by the least recently used one
+    T *get_more_recent(T *ptr) const {
+        const Item<T> *item = reinterpret_cast<const Item<T> *>(reinterpret_cast<const char *>(ptr) - 2 * sizeof(void *));
+        return &item->prev->content;
+    }
+
     // set an element as the least recently used (useful if it is removed)
     void set_as_lru(T *ptr) {
         // just set as mru and change the head
@@ -0,0 +1,65 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <util/fs.h>
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * \brief Read-only view of a whole file mapped in memory.
+ *
+ * The content is only read from the disk when it is accessed, prefetch can be used
+ * to have the OS start reading a range in the background.
+ */
+class MappedFile {
+    const uint8_t *file_data = nullptr;
+    size_t file_size = 0;
+#ifdef _WIN32
+    void *file_handle = nullptr;
+    void *mapping_handle = nullptr;
+#else
+    int fd = -1;
+#endif
+
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const fs::path &path);
+    void close();
+
+    // ask the OS to read this range without waiting for it
+    void prefetch(size_t offset, size_t size) const;
+
+    bool is_open() const {
+        return file_data != nullptr;
+    }
+
+    const uint8_t *data() const {
+        return file_data;
+    }
+
+    size_t size() const {
+        return file_size;
+    }
+};
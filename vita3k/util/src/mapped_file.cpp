@@ -0,0 +1,143 @@
+// Vita3K emulator project
+// Copyright (C) 2025 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <util/log.h>
+#include <util/mapped_file.h>
+
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const fs::path &path) {
+    close();
+
+    // other handles may append to the file while it is mapped
+    file_handle = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        file_handle = nullptr;
+        LOG_ERROR("Failed to open {}", path);
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_handle, &size) || size.QuadPart == 0) {
+        LOG_ERROR("Failed to get the size of {} or it is empty", path);
+        close();
+        return false;
+    }
+    file_size = static_cast<size_t>(size.QuadPart);
+
+    mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_handle != nullptr)
+        file_data = static_cast<const uint8_t *>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+
+    if (file_data == nullptr) {
+        LOG_ERROR("Failed to map {} in memory", path);
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedFile::close() {
+    if (file_data)
+        UnmapViewOfFile(file_data);
+    if (mapping_handle)
+        CloseHandle(mapping_handle);
+    if (file_handle)
+        CloseHandle(file_handle);
+
+    file_data = nullptr;
+    file_size = 0;
+    mapping_handle = nullptr;
+    file_handle = nullptr;
+}
+
+void MappedFile::prefetch(size_t offset, size_t size) const {
+    if (!file_data || offset >= file_size)
+        return;
+
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = const_cast<uint8_t *>(file_data + offset);
+    range.NumberOfBytes = std::min(size, file_size - offset);
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+#else
+bool MappedFile::open(const fs::path &path) {
+    close();
+
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG_ERROR("Failed to open {}", path);
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        LOG_ERROR("Failed to get the size of {} or it is empty", path);
+        close();
+        return false;
+    }
+    file_size = static_cast<size_t>(file_stat.st_size);
+
+    void *mapping = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        LOG_ERROR("Failed to map {} in memory", path);
+        close();
+        return false;
+    }
+    file_data = static_cast<const uint8_t *>(mapping);
+
+    return true;
+}
+
+void MappedFile::close() {
+    if (file_data)
+        munmap(const_cast<uint8_t *>(file_data), file_size);
+    if (fd >= 0)
+        ::close(fd);
+
+    file_data = nullptr;
+    file_size = 0;
+    fd = -1;
+}
+
+void MappedFile::prefetch(size_t offset, size_t size) const {
+    if (!file_data || offset >= file_size)
+        return;
+
+    // madvise needs a page aligned address
+    const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t begin = offset & ~(page_size - 1);
+    const size_t end = std::min(offset + size, file_size);
+    madvise(const_cast<uint8_t *>(file_data + begin), end - begin, MADV_WILLNEED);
+}
+#endif